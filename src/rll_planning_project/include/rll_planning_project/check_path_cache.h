@@ -0,0 +1,159 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_PLANNING_PROJECT_CHECK_PATH_CACHE_H
+#define RLL_PLANNING_PROJECT_CHECK_PATH_CACHE_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+#include <geometry_msgs/Pose2D.h>
+#include <rll_move/move_iface_error.h>
+
+/**
+ * Thread-safe cache for the results of check_path requests.
+ *
+ * Start and goal pose are quantized with the given resolutions, so that requests that only differ by numerical noise
+ * share an entry. The cached results are only valid for the planning scene they were computed with, the owner has to
+ * clear the cache whenever the scene changes. Critical failures are never cached.
+ */
+class CheckPathCache
+{
+public:
+  using Key = std::array<int32_t, 6>;
+
+  explicit CheckPathCache(double resolution_trans = 0.0005, double resolution_rot = 0.001)
+    : resolution_trans_(resolution_trans), resolution_rot_(resolution_rot)
+  {
+  }
+
+  void setResolution(double resolution_trans, double resolution_rot)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    resolution_trans_ = resolution_trans;
+    resolution_rot_ = resolution_rot;
+    entries_.clear();
+  }
+
+  double resolutionTrans()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resolution_trans_;
+  }
+
+  double resolutionRot()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resolution_rot_;
+  }
+
+  bool lookup(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal, RLLErrorCode* error_code)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key(start, goal));
+    if (it == entries_.end())
+    {
+      ++misses_;
+      return false;
+    }
+
+    ++hits_;
+    *error_code = it->second;
+    return true;
+  }
+
+  void insert(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal, RLLErrorCode error_code)
+  {
+    if (error_code.isCriticalFailure())
+    {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[key(start, goal)] = error_code.value();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+  }
+
+  void resetCounters()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    hits_ = misses_ = 0;
+  }
+
+  uint64_t hits()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+  }
+
+  uint64_t misses()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+  }
+
+  size_t size()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+private:
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const
+    {
+      size_t seed = 0;
+      for (int32_t value : key)
+      {
+        // same mixing as boost::hash_combine
+        seed ^= std::hash<int32_t>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+      }
+      return seed;
+    }
+  };
+
+  std::mutex mutex_;
+  double resolution_trans_;
+  double resolution_rot_;
+  std::unordered_map<Key, RLLErrorCode::Code, KeyHash> entries_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+
+  Key key(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal) const
+  {
+    return Key{ quantize(start.x, resolution_trans_), quantize(start.y, resolution_trans_),
+                quantize(start.theta, resolution_rot_), quantize(goal.x, resolution_trans_),
+                quantize(goal.y, resolution_trans_),   quantize(goal.theta, resolution_rot_) };
+  }
+
+  static int32_t quantize(double value, double resolution)
+  {
+    return static_cast<int32_t>(std::lround(value / resolution));
+  }
+};
+
+#endif  // RLL_PLANNING_PROJECT_CHECK_PATH_CACHE_H
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_PLANNING_PROJECT_LATTICE_PLANNER_H
+#define RLL_PLANNING_PROJECT_LATTICE_PLANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <geometry_msgs/Pose2D.h>
+
+/**
+ * Lazy A* search on a regular (x, y, theta) lattice anchored at the start pose.
+ *
+ * The lattice motions are translations by one step along x or y and rotations on the spot by 90 degrees. Edges are
+ * only validated when a node is expanded. All outgoing edges of a node are handed to the edge checker in a single
+ * batch, so that they can be checked concurrently. A node close to the goal is connected to the exact goal pose with an
+ * additional edge.
+ */
+class LatticePlanner
+{
+public:
+  struct Edge
+  {
+    geometry_msgs::Pose2D start;
+    geometry_msgs::Pose2D goal;
+  };
+
+  // validates a batch of edges, valid has to be resized to the number of edges
+  using EdgeChecker = std::function<void(const std::vector<Edge>& edges, std::vector<bool>* valid)>;
+
+  struct Options
+  {
+    double step_trans = 0.05;
+    // cost of a rotation by 90 degrees, in meters
+    double rotation_cost = 0.05;
+    double goal_tolerance_trans = 0.01;
+    double goal_tolerance_rot = 0.05;
+    size_t max_expansions = 50000;
+    // nodes outside of these bounds are not considered
+    double x_min = -std::numeric_limits<double>::infinity();
+    double x_max = std::numeric_limits<double>::infinity();
+    double y_min = -std::numeric_limits<double>::infinity();
+    double y_max = std::numeric_limits<double>::infinity();
+  };
+
+  LatticePlanner(EdgeChecker edge_checker, const Options& options);
+
+  // the resulting path does not include the start pose, collinear translations are merged
+  bool plan(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+            std::vector<geometry_msgs::Pose2D>* path);
+
+  size_t numExpansions() const
+  {
+    return num_expansions_;
+  }
+
+  size_t numCheckedEdges() const
+  {
+    return num_checked_edges_;
+  }
+
+private:
+  static const int NUM_ORIENTATIONS = 4;
+
+  struct Node
+  {
+    int x;
+    int y;
+    int theta;  // in [0, NUM_ORIENTATIONS)
+  };
+
+  EdgeChecker edge_checker_;
+  Options options_;
+  geometry_msgs::Pose2D start_;
+  size_t num_expansions_ = 0;
+  size_t num_checked_edges_ = 0;
+
+  static uint64_t key(const Node& node);
+  static Node nodeFromKey(uint64_t key);
+  geometry_msgs::Pose2D pose(const Node& node) const;
+  bool inBounds(const geometry_msgs::Pose2D& pose) const;
+  double heuristic(const geometry_msgs::Pose2D& pose, const geometry_msgs::Pose2D& goal) const;
+  static double rotationDistance(double theta_a, double theta_b);
+  static void mergeCollinearTranslations(std::vector<geometry_msgs::Pose2D>* path);
+};
+
+#endif  // RLL_PLANNING_PROJECT_LATTICE_PLANNER_H
@@ -0,0 +1,148 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_PLANNING_PROJECT_PLANNING_CLIENT_H
+#define RLL_PLANNING_PROJECT_PLANNING_CLIENT_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <geometry_msgs/Pose2D.h>
+
+#include <rll_move_client/async_move_client.h>
+#include <rll_move_client/move_client_listener.h>
+#include <rll_planning_project/CheckPath.h>
+#include <rll_planning_project/CheckPaths.h>
+#include <rll_planning_project/GetCSpaceGrid.h>
+#include <rll_planning_project/GetRoadmap.h>
+#include <rll_planning_project/GetStartGoal.h>
+#include <rll_planning_project/Move.h>
+#include <rll_planning_project/MovePath.h>
+
+// C++ counterpart of the Python RLLPlanningProjectClient. Planners derive from it and implement execute(), which is
+// called for every job, or use RLLCallbackMoveClient<RLLPlanningProjectClient>.
+//
+// All services are called over persistent connections. Edge checks can additionally be pipelined: the asynchronous
+// variants spread the requests over several connections, which the planning interface serves concurrently, so that
+// the planner can keep expanding its search while earlier checks are still in flight.
+//
+// A planner that runs in the process of the planning interface, see planning_host.h, calls the queries directly
+// instead, which skips the serialization and the loopback round trip. Moves still go through the services.
+class RLLPlanningProjectClient : public RLLMoveClientListener, public RLLBasicMoveClient, public RLLAsyncMoveClient
+{
+public:
+  static const std::string CHECK_PATH_SRV_NAME;
+  static const std::string CHECK_PATHS_SRV_NAME;
+  static const std::string GET_CSPACE_GRID_SRV_NAME;
+  static const std::string GET_ROADMAP_SRV_NAME;
+  static const std::string GET_START_GOAL_SRV_NAME;
+  static const std::string MOVE_SRV_NAME;
+  static const std::string MOVE_PATH_SRV_NAME;
+  static const std::string MOVE_ASYNC_SRV_NAME;
+
+  static const size_t NUM_CHECK_CONNECTIONS = 4;
+
+  template <class SrvMsg>
+  using InProcessCall = std::function<bool(typename SrvMsg::Request&, typename SrvMsg::Response&)>;
+
+  // entry points of a planning interface in the same process, unset calls go through the services
+  struct InProcessServices
+  {
+    InProcessCall<rll_planning_project::CheckPath> check_path;
+    InProcessCall<rll_planning_project::CheckPaths> check_paths;
+    InProcessCall<rll_planning_project::GetCSpaceGrid> get_cspace_grid;
+    InProcessCall<rll_planning_project::GetRoadmap> get_roadmap;
+    InProcessCall<rll_planning_project::GetStartGoal> get_start_goal;
+  };
+
+  explicit RLLPlanningProjectClient();
+
+  // must be set before the first job is executed
+  void setInProcessServices(const InProcessServices& services)
+  {
+    in_process_ = services;
+  }
+
+  bool getStartGoal(geometry_msgs::Pose2D* start, geometry_msgs::Pose2D* goal);
+  bool move(const geometry_msgs::Pose2D& pose);
+  // queues the move in the interface and returns before it is executed, a failure is reported by the next move call
+  bool moveAsync(const geometry_msgs::Pose2D& pose);
+  bool movePath(const std::vector<geometry_msgs::Pose2D>& poses);
+
+  bool checkPath(const geometry_msgs::Pose2D& pose_start, const geometry_msgs::Pose2D& pose_goal);
+  // checks all edges from poses_start[i] to poses_goal[i] with a single service call
+  bool checkPaths(const std::vector<geometry_msgs::Pose2D>& poses_start,
+                  const std::vector<geometry_msgs::Pose2D>& poses_goal, std::vector<bool>* edges_success);
+  std::future<bool> checkPathAsync(const geometry_msgs::Pose2D& pose_start, const geometry_msgs::Pose2D& pose_goal);
+  // edges_success has to stay valid until the future is ready
+  std::future<bool> checkPathsAsync(const std::vector<geometry_msgs::Pose2D>& poses_start,
+                                    const std::vector<geometry_msgs::Pose2D>& poses_goal,
+                                    std::vector<bool>* edges_success);
+
+  bool getCSpaceGrid(const rll_planning_project::GetCSpaceGrid::Request& request,
+                     rll_planning_project::GetCSpaceGrid::Response* response);
+  // the edges validated so far in this scene, also by earlier runs if the interface persists them
+  bool getRoadmap(rll_planning_project::GetRoadmap::Response* response);
+
+protected:
+  ros::ServiceClient get_start_goal_;
+  ros::ServiceClient move_;
+  ros::ServiceClient move_async_;
+  ros::ServiceClient move_path_;
+  ros::ServiceClient check_path_;
+  ros::ServiceClient check_paths_;
+  ros::ServiceClient get_cspace_grid_;
+  ros::ServiceClient get_roadmap_;
+
+private:
+  InProcessServices in_process_;
+
+  template <class SrvMsg>
+  bool callQueryService(const std::string& srv_name, const InProcessCall<SrvMsg>& in_process,
+                        ros::ServiceClient* srv_client, SrvMsg* srv_data);
+
+  // the connections of one lane are only used by its worker
+  struct CheckLane
+  {
+    ros::ServiceClient check_path;
+    ros::ServiceClient check_paths;
+    RLLServiceCallQueue queue;
+  };
+
+  CheckLane* nextCheckLane();
+
+  std::vector<std::unique_ptr<CheckLane>> check_lanes_;
+  std::atomic<size_t> next_check_lane_{ 0 };
+};
+
+template <class SrvMsg>
+bool RLLPlanningProjectClient::callQueryService(const std::string& srv_name, const InProcessCall<SrvMsg>& in_process,
+                                                ros::ServiceClient* srv_client, SrvMsg* srv_data)
+{
+  if (!in_process)
+  {
+    return callPersistentService(srv_name, srv_client, srv_data);
+  }
+
+  logServiceCall(srv_name, srv_data->request);
+  bool call_success = in_process(srv_data->request, srv_data->response);
+  return handleResponseWithErrorCode(srv_name, call_success, srv_data->response.error_code);
+}
+
+#endif  // RLL_PLANNING_PROJECT_PLANNING_CLIENT_H
@@ -0,0 +1,70 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_PLANNING_PROJECT_PLANNING_HOST_H
+#define RLL_PLANNING_PROJECT_PLANNING_HOST_H
+
+#include <thread>
+
+#include <rll_planning_project/planning_client.h>
+#include <rll_planning_project/planning_iface.h>
+
+// Binds the queries of a planning interface in the same process, the interface has to outlive the client.
+inline RLLPlanningProjectClient::InProcessServices inProcessServices(PlanningIfaceBase* iface)
+{
+  using namespace std::placeholders;  // NOLINT google-build-using-namespace
+
+  RLLPlanningProjectClient::InProcessServices services;
+  services.check_path = std::bind(&PlanningIfaceBase::checkPathSrv, iface, _1, _2);
+  services.check_paths = std::bind(&PlanningIfaceBase::checkPathsSrv, iface, _1, _2);
+  services.get_cspace_grid = std::bind(&PlanningIfaceBase::getCSpaceGridSrv, iface, _1, _2);
+  services.get_roadmap = std::bind(&PlanningIfaceBase::getRoadmapSrv, iface, _1, _2);
+  services.get_start_goal = std::bind(&PlanningIfaceBase::getStartGoalSrv, iface, _1, _2);
+  return services;
+}
+
+// Main of a C++ planner that is hosted in the process of the planning interface. The interface is started as usual,
+// i.e. all services and actions are advertised, and the planner is run in the same process with its queries bound
+// to the interface. Replaces both the planning_iface node and the planner node, e.g.
+//
+//   int main(int argc, char** argv)
+//   {
+//     ros::init(argc, argv, "planning_iface");
+//     return runPlanningHost<PlanningIface, MyPlanner>();
+//   }
+template <class Iface, class Planner>
+int runPlanningHost()
+{
+  ros::NodeHandle nh;
+  if (!waitForMoveGroupAction())
+  {
+    return 1;
+  }
+
+  Iface iface(nh);
+  Planner planner;
+  planner.setInProcessServices(inProcessServices(&iface));
+
+  // the planner waits for the jobs that the interface starts, both stop on shutdown
+  std::thread planner_thread(&Planner::spin, &planner);
+  iface.startServicesAndRunNode(&nh);
+  planner_thread.join();
+
+  return 0;
+}
+
+#endif  // RLL_PLANNING_PROJECT_PLANNING_HOST_H
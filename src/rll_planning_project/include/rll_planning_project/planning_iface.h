@@ -25,34 +25,89 @@
 #include <rll_move/move_iface_gripper.h>
 
 #include <rll_planning_project/CheckPath.h>
+#include <rll_planning_project/CheckPaths.h>
+#include <rll_planning_project/check_path_cache.h>
+#include <rll_planning_project/roadmap_store.h>
+#include <rll_planning_project/robot_state_pool.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <rll_planning_project/GetCSpaceGrid.h>
+#include <rll_planning_project/GetRoadmap.h>
 #include <rll_planning_project/GetStartGoal.h>
 #include <rll_planning_project/Move.h>
+#include <rll_planning_project/MovePath.h>
+#include <rll_planning_project/PlanToGoalAction.h>
 
 class PlanningIfaceBase : public virtual RLLMoveIfaceGripperServices, public RLLMoveIfaceBase
 {
 public:
+  using PlanToGoalServer = actionlib::SimpleActionServer<rll_planning_project::PlanToGoalAction>;
+
   explicit PlanningIfaceBase(const ros::NodeHandle& nh);
 
   // NOLINTNEXTLINE google-runtime-references
   bool moveSrv(rll_planning_project::Move::Request& req, rll_planning_project::Move::Response& resp);
   // NOLINTNEXTLINE google-runtime-references
+  bool moveAsyncSrv(rll_planning_project::Move::Request& req, rll_planning_project::Move::Response& resp);
+  // NOLINTNEXTLINE google-runtime-references
+  bool movePathSrv(rll_planning_project::MovePath::Request& req, rll_planning_project::MovePath::Response& resp);
+  // NOLINTNEXTLINE google-runtime-references
   bool checkPathSrv(rll_planning_project::CheckPath::Request& req, rll_planning_project::CheckPath::Response& resp);
+  // NOLINTNEXTLINE google-runtime-references
+  bool checkPathsSrv(rll_planning_project::CheckPaths::Request& req, rll_planning_project::CheckPaths::Response& resp);
+  bool getCSpaceGridSrv(  // NOLINTNEXTLINE google-runtime-references
+      rll_planning_project::GetCSpaceGrid::Request& req, rll_planning_project::GetCSpaceGrid::Response& resp);
+  bool getRoadmapSrv(  // NOLINTNEXTLINE google-runtime-references
+      rll_planning_project::GetRoadmap::Request& req, rll_planning_project::GetRoadmap::Response& resp);
+  bool getStartGoalSrv(  // NOLINTNEXTLINE google-runtime-references
+      rll_planning_project::GetStartGoal::Request& req, rll_planning_project::GetStartGoal::Response& resp);
+  void planToGoalAction(const rll_planning_project::PlanToGoalGoalConstPtr& goal, PlanToGoalServer* server);
   void startServicesAndRunNode(ros::NodeHandle* nh) override;
 
 protected:
   RLLErrorCode idle() override;
   void runJob(const rll_msgs::JobEnvGoalConstPtr& goal, rll_msgs::JobEnvResult* result) override;
-  bool getStartGoalSrv(  // NOLINTNEXTLINE google-runtime-references
-      rll_planning_project::GetStartGoal::Request& req, rll_planning_project::GetStartGoal::Response& resp);
   RLLErrorCode checkPath(const rll_planning_project::CheckPath::Request& req);
+  RLLErrorCode checkPaths(const rll_planning_project::CheckPaths::Request& req,
+                          rll_planning_project::CheckPaths::Response* resp);
+  RLLErrorCode getCSpaceGrid(const rll_planning_project::GetCSpaceGrid::Request& req,
+                             rll_planning_project::GetCSpaceGrid::Response* resp);
+  RLLErrorCode getRoadmap(const rll_planning_project::GetRoadmap::Request& /*req*/,
+                          rll_planning_project::GetRoadmap::Response* resp);
   RLLErrorCode move(const rll_planning_project::Move::Request& req, rll_planning_project::Move::Response* /*resp*/);
+  RLLErrorCode moveAsync(const rll_planning_project::Move::Request& req,
+                         rll_planning_project::Move::Response* /*resp*/);
+  RLLErrorCode movePath(const rll_planning_project::MovePath::Request& req,
+                        rll_planning_project::MovePath::Response* /*resp*/);
+  RLLErrorCode planToGoal(const rll_planning_project::PlanToGoalGoal& goal,
+                          rll_planning_project::PlanToGoalResult* result);
 
   void registerPermissions();
+  // validity checks and queries run concurrently with each other and with moves, they are not tracked by the state
+  // machine, so the job waits for them separately
+  RLLErrorCode beginQuery(Permissions::ServiceId srv);
+  RLLErrorCode endQuery(Permissions::ServiceId srv, const RLLErrorCode& previous_error_code);
+  void waitForQueriesToEnd();
+  void planningSceneModified() override;
+  bool replayServiceCall(const RLLJobLogReader::Record& record, const planning_scene::PlanningScene& planning_scene,
+                         const robot_state::RobotState& start_state, const robot_state::RobotState& job_start_state,
+                         bool* matches) override;
 
 private:
   const std::string GET_START_GOAL_SRV_NAME = "get_start_goal";
   const std::string MOVE_SRV_NAME = "move";
+  const std::string MOVE_PATH_SRV_NAME = "move_path";
+  const std::string MOVE_ASYNC_SRV_NAME = "move_async";
   const std::string CHECK_PATH_SRV_NAME = "check_path";
+  const std::string CHECK_PATHS_SRV_NAME = "check_paths";
+  const std::string GET_CSPACE_GRID_SRV_NAME = "get_cspace_grid";
+  const std::string GET_ROADMAP_SRV_NAME = "get_roadmap";
+  const std::string PLAN_TO_GOAL_ACTION_NAME = "plan_to_goal";
 
   const float GOAL_TOLERANCE_TRANS = 0.04;
   const float GOAL_TOLERANCE_ROT = 10 * M_PI / 180;
@@ -60,14 +115,50 @@ private:
   const float VERT_GRIP_HEIGHT = 0.01;
   const float POSE_Z_ABOVE_MAZE = 0.2;
 
+  // each worker validates edges of a check_paths request with its own start state and planning scene copy
+  struct CheckPathWorker
+  {
+    robot_state::RobotState* state;  // acquired from check_path_states_
+    planning_scene::PlanningScenePtr planning_scene;
+  };
+
   bool grasp_object_at_goal_;
-  bool move_command_failed_;
+  std::atomic<bool> move_command_failed_;  // also accessed outside of move_queue_mutex_
   Permissions::Index plan_permission_;
+  Permissions::ServiceId check_path_srv_, check_paths_srv_, get_cspace_grid_srv_, get_roadmap_srv_;
+  Permissions::ServiceId get_start_goal_srv_;
+  std::mutex queries_mutex_;
+  std::condition_variable queries_ended_;
+  size_t queries_in_flight_;
+  // threads that serve check_path, check_paths and get_cspace_grid requests
+  int check_path_threads_;
   moveit_msgs::CollisionObject grasp_object_;
   geometry_msgs::Pose start_pose_grip_, start_pose_above_;
   geometry_msgs::Pose goal_pose_grip_, goal_pose_above_;
   geometry_msgs::Pose2D start_pose_2d_, goal_pose_2d_;
-  robot_state::RobotState* check_path_start_state_;
+  // seeded with the start state of the current job, one state per concurrent check
+  RobotStatePool check_path_states_;
+  size_t check_paths_num_workers_;
+  bool check_path_local_;
+  // the move group's Cartesian path service is called with a separate interface, so that checks don't interfere with
+  // the move group interface of a move in progress, it can only be used by one check at a time
+  std::unique_ptr<moveit::planning_interface::MoveGroupInterface> check_path_move_group_;
+  std::mutex check_path_move_group_mutex_;
+  CheckPathCache check_path_cache_;
+  // validated edges of earlier runs and jobs in the same scene, backs the check_path cache
+  RoadmapStore roadmap_store_;
+  std::string roadmap_directory_;
+  int roadmap_capacity_;
+  double native_planner_step_;
+  int native_planner_max_expansions_;
+  // poses of move_async requests, executed by runMoveQueue()
+  std::mutex move_queue_mutex_;
+  std::condition_variable move_queue_cv_;
+  std::deque<geometry_msgs::Pose2D> move_queue_;
+  size_t move_queue_pending_;  // queued, planned or executing moves
+  RLLErrorCode move_queue_error_;
+  bool move_queue_shutdown_;
+  bool move_queue_executed_;  // set by the execution task when the running segment has finished
 
   void insertGraspObject();
   void resetGraspObject();
@@ -75,9 +166,37 @@ private:
   bool runPlannerOnce(const rll_msgs::JobEnvGoalConstPtr& goal, rll_msgs::JobEnvResult* result);
   bool checkGoalState();
   bool writeResult(rll_msgs::JobEnvResult* result);
+  bool moveTooSmall(float move_dist, float dist_rot);
+  RLLErrorCode planSegment(const geometry_msgs::Pose2D& pose2d_start, const geometry_msgs::Pose2D& pose2d_goal,
+                           const robot_state::RobotState& state_start,
+                           robot_trajectory::RobotTrajectory* trajectory);
+  void runMoveQueue();
+  RLLErrorCode waitForMoveQueue();
+  void resetMoveQueue();
   void diffCurrentState(const geometry_msgs::Pose2D& pose_des, float* diff_trans, float* diff_rot,
                         geometry_msgs::Pose2D* pose2d_cur);
   void pose2dToPose3d(const geometry_msgs::Pose2D& pose2d, geometry_msgs::Pose* pose3d);
+  RLLErrorCode checkPathCached(const rll_planning_project::CheckPath::Request& req);
+  bool lookupCheckedPath(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+                         RLLErrorCode* error_code);
+  void storeCheckedPath(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+                        RLLErrorCode error_code);
+  void openRoadmap();
+  uint64_t roadmapSceneHash();
+  void logCheckPathCacheStats();
+  RLLErrorCode checkPathWaypoints(const rll_planning_project::CheckPath::Request& req, geometry_msgs::Pose* pose3d_start,
+                                  std::vector<geometry_msgs::Pose>* waypoints);
+  RLLErrorCode checkPathWorker(const rll_planning_project::CheckPath::Request& req, CheckPathWorker* worker);
+  // the scene must be a private copy or locked by the caller, it is read for the whole path
+  RLLErrorCode checkPathLocal(const rll_planning_project::CheckPath::Request& req, robot_state::RobotState* start_state,
+                              const planning_scene::PlanningScene& planning_scene);
+  RLLErrorCode checkPathsParallel(const rll_planning_project::CheckPaths::Request& req, size_t num_workers,
+                                  std::vector<RLLErrorCode>* edge_error_codes);
+  void runCheckPathWorkers(size_t num_tasks, size_t num_workers,
+                           const std::function<void(CheckPathWorker*, size_t)>& task);
+  static bool isStateValid(const planning_scene::PlanningScene* planning_scene, robot_state::RobotState* robot_state,
+                           const robot_state::JointModelGroup* group, const double* ik_solution);
+  bool getMazeExtents(double* x_min, double* x_max, double* y_min, double* y_max);
   void generateRotationWaypoints(const geometry_msgs::Pose2D& pose2d_start, float rot_step_size,
                                  std::vector<geometry_msgs::Pose>* waypoints);
 };
@@ -0,0 +1,101 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_PLANNING_PROJECT_ROADMAP_STORE_H
+#define RLL_PLANNING_PROJECT_ROADMAP_STORE_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <geometry_msgs/Pose2D.h>
+#include <rll_move/move_iface_error.h>
+
+/**
+ * Thread-safe store for validated edges that persists across runs and jobs.
+ *
+ * Unlike the CheckPathCache, the results are kept in a memory-mapped file, a hash table with a fixed capacity. Each
+ * file belongs to one planning scene, identified by a hash of its collision objects, and one quantization of the edge
+ * poses. Opening a file with a different scene hash or resolution starts an empty roadmap. The file is locked while it
+ * is open, so it is only used by one planning interface at a time. Critical failures are never stored.
+ */
+class RoadmapStore
+{
+public:
+  using Key = std::array<int32_t, 6>;
+
+  struct Edge
+  {
+    geometry_msgs::Pose2D start;
+    geometry_msgs::Pose2D goal;
+    RLLErrorCode::Code error_code;
+  };
+
+  static const char MAGIC[8];
+  static const uint32_t VERSION = 1;
+
+  RoadmapStore() = default;
+  ~RoadmapStore();
+  RoadmapStore(const RoadmapStore&) = delete;
+  RoadmapStore& operator=(const RoadmapStore&) = delete;
+
+  // capacity is the number of edges a new file can hold, an existing file keeps its capacity
+  bool open(const std::string& file_name, uint64_t scene_hash, double resolution_trans, double resolution_rot,
+            size_t capacity);
+  void close();
+  bool isOpen();
+
+  bool lookup(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal, RLLErrorCode* error_code);
+  void insert(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal, RLLErrorCode error_code);
+
+  // all stored edges, the poses are the centers of the quantization cells
+  void edges(std::vector<Edge>* edges);
+
+  size_t size();
+  uint64_t hits();
+  void resetCounters();
+
+private:
+  struct Entry
+  {
+    Key key;
+    uint8_t used;
+    uint8_t error_code;
+    uint8_t reserved[2];
+  };
+
+  struct FileHeader;
+
+  std::mutex mutex_;
+  int fd_ = -1;
+  uint8_t* data_ = nullptr;
+  size_t mapped_size_ = 0;
+  FileHeader* header_ = nullptr;
+  Entry* entries_ = nullptr;
+  double resolution_trans_ = 0.0;
+  double resolution_rot_ = 0.0;
+  uint64_t hits_ = 0;
+  bool full_warned_ = false;
+
+  void closeLocked();
+  Key key(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal) const;
+  Entry* find(const Key& key);
+};
+
+#endif  // RLL_PLANNING_PROJECT_ROADMAP_STORE_H
@@ -0,0 +1,151 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_PLANNING_PROJECT_ROBOT_STATE_POOL_H
+#define RLL_PLANNING_PROJECT_ROBOT_STATE_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <moveit/robot_state/robot_state.h>
+
+/**
+ * Pool of pre-allocated robot states that share a reference state, e.g. the start state of a job.
+ *
+ * A thread acquires a state for as long as it needs it, states are never shared between threads. Seeding an acquired
+ * state only copies the variable positions of the reference state instead of the full state with its transforms.
+ * reset() must not be called while states are acquired.
+ */
+class RobotStatePool
+{
+public:
+  class Handle
+  {
+  public:
+    Handle(RobotStatePool* pool, std::unique_ptr<robot_state::RobotState> state)
+      : pool_(pool), state_(std::move(state))
+    {
+    }
+
+    Handle(Handle&& other) noexcept = default;
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+
+    ~Handle()
+    {
+      if (state_)
+      {
+        pool_->release(std::move(state_));
+      }
+    }
+
+    robot_state::RobotState* get() const
+    {
+      return state_.get();
+    }
+
+    robot_state::RobotState& operator*() const
+    {
+      return *state_;
+    }
+
+    robot_state::RobotState* operator->() const
+    {
+      return state_.get();
+    }
+
+    void seed() const
+    {
+      pool_->seed(state_.get());
+    }
+
+  private:
+    RobotStatePool* pool_;
+    std::unique_ptr<robot_state::RobotState> state_;
+  };
+
+  void reset(const robot_state::RobotState& reference, size_t num_states)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reference_.reset(new robot_state::RobotState(reference));
+    reference_->update();
+    const double* positions = reference_->getVariablePositions();
+    reference_positions_.assign(positions, positions + reference_->getVariableCount());
+
+    free_states_.clear();
+    for (size_t i = 0; i < num_states; ++i)
+    {
+      free_states_.emplace_back(new robot_state::RobotState(*reference_));
+    }
+  }
+
+  bool isSet()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reference_ != nullptr;
+  }
+
+  const robot_state::RobotState& reference() const
+  {
+    return *reference_;
+  }
+
+  // reset a state of this pool to the reference state
+  void seed(robot_state::RobotState* state) const
+  {
+    state->setVariablePositions(reference_positions_);
+    state->update();
+  }
+
+  // the returned state is seeded with the reference state, the pool grows if all states are in use
+  Handle acquire()
+  {
+    std::unique_ptr<robot_state::RobotState> state;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (free_states_.empty())
+      {
+        state.reset(new robot_state::RobotState(*reference_));
+      }
+      else
+      {
+        state = std::move(free_states_.back());
+        free_states_.pop_back();
+      }
+    }
+
+    Handle handle(this, std::move(state));
+    handle.seed();
+    return handle;
+  }
+
+private:
+  std::mutex mutex_;
+  std::unique_ptr<robot_state::RobotState> reference_;
+  std::vector<double> reference_positions_;
+  std::vector<std::unique_ptr<robot_state::RobotState>> free_states_;
+
+  void release(std::unique_ptr<robot_state::RobotState> state)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_states_.push_back(std::move(state));
+  }
+};
+
+#endif  // RLL_PLANNING_PROJECT_ROBOT_STATE_POOL_H
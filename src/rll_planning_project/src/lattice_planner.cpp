@@ -0,0 +1,278 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <rll_planning_project/lattice_planner.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+double normalizeAngle(double angle)
+{
+  angle = std::fmod(angle, 2 * M_PI);
+  if (angle < 0)
+  {
+    angle += 2 * M_PI;
+  }
+  return angle;
+}
+}  // namespace
+
+LatticePlanner::LatticePlanner(EdgeChecker edge_checker, const Options& options)
+  : edge_checker_(std::move(edge_checker)), options_(options)
+{
+}
+
+bool LatticePlanner::plan(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+                          std::vector<geometry_msgs::Pose2D>* path)
+{
+  // lattice motions: dx, dy, dtheta
+  const std::array<std::array<int, 3>, 6> MOTIONS = { { { 1, 0, 0 },
+                                                        { -1, 0, 0 },
+                                                        { 0, 1, 0 },
+                                                        { 0, -1, 0 },
+                                                        { 0, 0, 1 },
+                                                        { 0, 0, -1 } } };
+  const double GOAL_CONNECT_DIST_TRANS = options_.step_trans * M_SQRT2;
+  const double GOAL_CONNECT_DIST_ROT = M_PI / 4 + options_.goal_tolerance_rot;
+
+  struct QueueEntry
+  {
+    double f;
+    double g;
+    uint64_t key;
+    bool operator<(const QueueEntry& rhs) const
+    {
+      return f > rhs.f;  // smallest f first
+    }
+  };
+
+  start_ = start;
+  num_expansions_ = 0;
+  num_checked_edges_ = 0;
+  path->clear();
+
+  std::priority_queue<QueueEntry> open;
+  std::unordered_map<uint64_t, double> g_values;
+  std::unordered_map<uint64_t, uint64_t> parents;
+  std::unordered_map<uint64_t, bool> closed;
+
+  Node start_node{ 0, 0, 0 };
+  uint64_t start_key = key(start_node);
+  g_values[start_key] = 0.0;
+  open.push({ heuristic(start, goal), 0.0, start_key });
+
+  std::vector<Edge> edges;
+  std::vector<uint64_t> successors;
+  std::vector<double> costs;
+  std::vector<bool> valid;
+
+  while (!open.empty() && num_expansions_ < options_.max_expansions)
+  {
+    QueueEntry current = open.top();
+    open.pop();
+    if (closed[current.key] || current.g > g_values[current.key])
+    {
+      continue;  // outdated entry
+    }
+    closed[current.key] = true;
+    ++num_expansions_;
+
+    Node node = nodeFromKey(current.key);
+    geometry_msgs::Pose2D node_pose = pose(node);
+
+    double dist_goal_trans = std::hypot(goal.x - node_pose.x, goal.y - node_pose.y);
+    double dist_goal_rot = rotationDistance(node_pose.theta, goal.theta);
+    bool goal_reached = dist_goal_trans < options_.goal_tolerance_trans && dist_goal_rot < options_.goal_tolerance_rot;
+
+    edges.clear();
+    successors.clear();
+    costs.clear();
+
+    // the connection to the goal is always checked first
+    bool connect_goal =
+        !goal_reached && dist_goal_trans <= GOAL_CONNECT_DIST_TRANS && dist_goal_rot <= GOAL_CONNECT_DIST_ROT;
+    if (connect_goal)
+    {
+      geometry_msgs::Pose2D goal_pose = goal;
+      // rotate along the shorter direction
+      goal_pose.theta = node_pose.theta + std::remainder(goal.theta - node_pose.theta, 2 * M_PI);
+      edges.push_back({ node_pose, goal_pose });
+    }
+
+    if (!goal_reached)
+    {
+      for (const auto& motion : MOTIONS)
+      {
+        Node next{ node.x + motion[0], node.y + motion[1],
+                   (node.theta + motion[2] + NUM_ORIENTATIONS) % NUM_ORIENTATIONS };
+        uint64_t next_key = key(next);
+        if (closed[next_key])
+        {
+          continue;
+        }
+
+        geometry_msgs::Pose2D next_pose = pose(next);
+        if (!inBounds(next_pose))
+        {
+          continue;
+        }
+
+        // keep the edge continuous in theta, otherwise a rotation by -90 degrees would be requested as 270 degrees
+        next_pose.theta = node_pose.theta + motion[2] * M_PI / 2;
+        edges.push_back({ node_pose, next_pose });
+        successors.push_back(next_key);
+        costs.push_back(motion[2] == 0 ? options_.step_trans : options_.rotation_cost);
+      }
+    }
+
+    if (!edges.empty())
+    {
+      valid.assign(edges.size(), false);
+      edge_checker_(edges, &valid);
+      num_checked_edges_ += edges.size();
+    }
+
+    if (goal_reached || (connect_goal && valid.front()))
+    {
+      if (connect_goal)
+      {
+        geometry_msgs::Pose2D goal_pose = goal;
+        goal_pose.theta = normalizeAngle(goal.theta);
+        path->push_back(goal_pose);
+      }
+
+      for (uint64_t k = current.key; k != start_key; k = parents[k])
+      {
+        path->push_back(pose(nodeFromKey(k)));
+      }
+      std::reverse(path->begin(), path->end());
+      mergeCollinearTranslations(path);
+      return true;
+    }
+
+    size_t offset = connect_goal ? 1 : 0;
+    for (size_t i = 0; i < successors.size(); ++i)
+    {
+      if (!valid[i + offset])
+      {
+        continue;
+      }
+
+      double g = current.g + costs[i];
+      auto it = g_values.find(successors[i]);
+      if (it != g_values.end() && it->second <= g)
+      {
+        continue;
+      }
+
+      g_values[successors[i]] = g;
+      parents[successors[i]] = current.key;
+      open.push({ g + heuristic(pose(nodeFromKey(successors[i])), goal), g, successors[i] });
+    }
+  }
+
+  return false;
+}
+
+uint64_t LatticePlanner::key(const Node& node)
+{
+  // 30 bits per translation index, offset to keep them positive
+  const int64_t OFFSET = 1 << 29;
+  return (static_cast<uint64_t>(node.x + OFFSET) << 32) | (static_cast<uint64_t>(node.y + OFFSET) << 2) |
+         static_cast<uint64_t>(node.theta);
+}
+
+LatticePlanner::Node LatticePlanner::nodeFromKey(uint64_t key)
+{
+  const int64_t OFFSET = 1 << 29;
+  const uint64_t MASK_30 = (1U << 30) - 1;
+  Node node;
+  node.x = static_cast<int>(static_cast<int64_t>(key >> 32) - OFFSET);
+  node.y = static_cast<int>(static_cast<int64_t>((key >> 2) & MASK_30) - OFFSET);
+  node.theta = static_cast<int>(key & 3);
+  return node;
+}
+
+geometry_msgs::Pose2D LatticePlanner::pose(const Node& node) const
+{
+  geometry_msgs::Pose2D pose;
+  pose.x = start_.x + node.x * options_.step_trans;
+  pose.y = start_.y + node.y * options_.step_trans;
+  pose.theta = normalizeAngle(start_.theta + node.theta * M_PI / 2);
+  return pose;
+}
+
+bool LatticePlanner::inBounds(const geometry_msgs::Pose2D& pose) const
+{
+  return pose.x >= options_.x_min && pose.x <= options_.x_max && pose.y >= options_.y_min && pose.y <= options_.y_max;
+}
+
+double LatticePlanner::heuristic(const geometry_msgs::Pose2D& pose, const geometry_msgs::Pose2D& goal) const
+{
+  double dist_trans = std::hypot(goal.x - pose.x, goal.y - pose.y);
+  double quarter_rotations = std::floor(rotationDistance(pose.theta, goal.theta) / (M_PI / 2));
+  return dist_trans + quarter_rotations * options_.rotation_cost;
+}
+
+double LatticePlanner::rotationDistance(double theta_a, double theta_b)
+{
+  return std::fabs(std::remainder(theta_a - theta_b, 2 * M_PI));
+}
+
+void LatticePlanner::mergeCollinearTranslations(std::vector<geometry_msgs::Pose2D>* path)
+{
+  // a translation can only be merged with the next one if they point in the same direction and neither rotates
+  const double TOL = 1E-06;
+  if (path->size() < 2)
+  {
+    return;
+  }
+
+  std::vector<geometry_msgs::Pose2D> merged;
+  geometry_msgs::Pose2D previous = path->front();
+  merged.push_back(previous);
+  for (size_t i = 1; i < path->size(); ++i)
+  {
+    const geometry_msgs::Pose2D& next = (*path)[i];
+    if (merged.size() >= 2)
+    {
+      const geometry_msgs::Pose2D& before = merged[merged.size() - 2];
+      double dx_1 = previous.x - before.x, dy_1 = previous.y - before.y;
+      double dx_2 = next.x - previous.x, dy_2 = next.y - previous.y;
+      bool no_rotation = rotationDistance(before.theta, previous.theta) < TOL &&
+                         rotationDistance(previous.theta, next.theta) < TOL;
+      bool collinear = std::fabs(dx_1 * dy_2 - dy_1 * dx_2) < TOL && dx_1 * dx_2 + dy_1 * dy_2 > 0;
+      if (no_rotation && collinear)
+      {
+        merged.back() = next;
+        previous = next;
+        continue;
+      }
+    }
+
+    merged.push_back(next);
+    previous = next;
+  }
+
+  *path = merged;
+}
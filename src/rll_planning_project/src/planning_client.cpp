@@ -0,0 +1,161 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <rll_planning_project/planning_client.h>
+
+const std::string RLLPlanningProjectClient::CHECK_PATH_SRV_NAME = "check_path";
+const std::string RLLPlanningProjectClient::CHECK_PATHS_SRV_NAME = "check_paths";
+const std::string RLLPlanningProjectClient::GET_CSPACE_GRID_SRV_NAME = "get_cspace_grid";
+const std::string RLLPlanningProjectClient::GET_ROADMAP_SRV_NAME = "get_roadmap";
+const std::string RLLPlanningProjectClient::GET_START_GOAL_SRV_NAME = "get_start_goal";
+const std::string RLLPlanningProjectClient::MOVE_SRV_NAME = "move";
+const std::string RLLPlanningProjectClient::MOVE_PATH_SRV_NAME = "move_path";
+const std::string RLLPlanningProjectClient::MOVE_ASYNC_SRV_NAME = "move_async";
+const size_t RLLPlanningProjectClient::NUM_CHECK_CONNECTIONS;
+
+namespace
+{
+void edgesSuccess(const rll_planning_project::CheckPaths::Response& response, std::vector<bool>* edges_success)
+{
+  edges_success->assign(response.edges_success.begin(), response.edges_success.end());
+}
+}  // namespace
+
+RLLPlanningProjectClient::RLLPlanningProjectClient()
+{
+  // the persistent connections are opened on the first call
+  for (size_t i = 0; i < NUM_CHECK_CONNECTIONS; ++i)
+  {
+    check_lanes_.push_back(std::make_unique<CheckLane>());
+  }
+}
+
+bool RLLPlanningProjectClient::getStartGoal(geometry_msgs::Pose2D* const start, geometry_msgs::Pose2D* const goal)
+{
+  rll_planning_project::GetStartGoal get_start_goal_msg;
+  bool success = callQueryService(GET_START_GOAL_SRV_NAME, in_process_.get_start_goal, &get_start_goal_,
+                                  &get_start_goal_msg);
+  if (success)
+  {
+    *start = get_start_goal_msg.response.start;
+    *goal = get_start_goal_msg.response.goal;
+  }
+  return success;
+}
+
+bool RLLPlanningProjectClient::move(const geometry_msgs::Pose2D& pose)
+{
+  rll_planning_project::Move move_msg;
+  move_msg.request.pose = pose;
+
+  return callPersistentService(MOVE_SRV_NAME, &move_, &move_msg);
+}
+
+bool RLLPlanningProjectClient::moveAsync(const geometry_msgs::Pose2D& pose)
+{
+  rll_planning_project::Move move_msg;
+  move_msg.request.pose = pose;
+
+  return callPersistentService(MOVE_ASYNC_SRV_NAME, &move_async_, &move_msg);
+}
+
+bool RLLPlanningProjectClient::movePath(const std::vector<geometry_msgs::Pose2D>& poses)
+{
+  rll_planning_project::MovePath move_path_msg;
+  move_path_msg.request.poses = poses;
+
+  return callPersistentService(MOVE_PATH_SRV_NAME, &move_path_, &move_path_msg);
+}
+
+bool RLLPlanningProjectClient::checkPath(const geometry_msgs::Pose2D& pose_start,
+                                         const geometry_msgs::Pose2D& pose_goal)
+{
+  rll_planning_project::CheckPath check_path_msg;
+  check_path_msg.request.pose_start = pose_start;
+  check_path_msg.request.pose_goal = pose_goal;
+
+  return callQueryService(CHECK_PATH_SRV_NAME, in_process_.check_path, &check_path_, &check_path_msg);
+}
+
+bool RLLPlanningProjectClient::checkPaths(const std::vector<geometry_msgs::Pose2D>& poses_start,
+                                          const std::vector<geometry_msgs::Pose2D>& poses_goal,
+                                          std::vector<bool>* const edges_success)
+{
+  rll_planning_project::CheckPaths check_paths_msg;
+  check_paths_msg.request.poses_start = poses_start;
+  check_paths_msg.request.poses_goal = poses_goal;
+
+  bool success =
+      callQueryService(CHECK_PATHS_SRV_NAME, in_process_.check_paths, &check_paths_, &check_paths_msg);
+  edgesSuccess(check_paths_msg.response, edges_success);
+  return success;
+}
+
+std::future<bool> RLLPlanningProjectClient::checkPathAsync(const geometry_msgs::Pose2D& pose_start,
+                                                           const geometry_msgs::Pose2D& pose_goal)
+{
+  rll_planning_project::CheckPath check_path_msg;
+  check_path_msg.request.pose_start = pose_start;
+  check_path_msg.request.pose_goal = pose_goal;
+
+  CheckLane* lane = nextCheckLane();
+  return lane->queue.push([this, lane, check_path_msg]() mutable {
+    return callQueryService(CHECK_PATH_SRV_NAME, in_process_.check_path, &lane->check_path, &check_path_msg);
+  });
+}
+
+std::future<bool> RLLPlanningProjectClient::checkPathsAsync(const std::vector<geometry_msgs::Pose2D>& poses_start,
+                                                            const std::vector<geometry_msgs::Pose2D>& poses_goal,
+                                                            std::vector<bool>* const edges_success)
+{
+  rll_planning_project::CheckPaths check_paths_msg;
+  check_paths_msg.request.poses_start = poses_start;
+  check_paths_msg.request.poses_goal = poses_goal;
+
+  CheckLane* lane = nextCheckLane();
+  return lane->queue.push([this, lane, check_paths_msg, edges_success]() mutable {
+    bool success =
+        callQueryService(CHECK_PATHS_SRV_NAME, in_process_.check_paths, &lane->check_paths, &check_paths_msg);
+    edgesSuccess(check_paths_msg.response, edges_success);
+    return success;
+  });
+}
+
+bool RLLPlanningProjectClient::getCSpaceGrid(const rll_planning_project::GetCSpaceGrid::Request& request,
+                                             rll_planning_project::GetCSpaceGrid::Response* const response)
+{
+  rll_planning_project::GetCSpaceGrid get_cspace_grid_msg;
+  get_cspace_grid_msg.request = request;
+
+  bool success = callQueryService(GET_CSPACE_GRID_SRV_NAME, in_process_.get_cspace_grid, &get_cspace_grid_,
+                                  &get_cspace_grid_msg);
+  *response = std::move(get_cspace_grid_msg.response);
+  return success;
+}
+
+bool RLLPlanningProjectClient::getRoadmap(rll_planning_project::GetRoadmap::Response* const response)
+{
+  rll_planning_project::GetRoadmap get_roadmap_msg;
+  bool success = callQueryService(GET_ROADMAP_SRV_NAME, in_process_.get_roadmap, &get_roadmap_, &get_roadmap_msg);
+  *response = std::move(get_roadmap_msg.response);
+  return success;
+}
+
+RLLPlanningProjectClient::CheckLane* RLLPlanningProjectClient::nextCheckLane()
+{
+  return check_lanes_[next_check_lane_.fetch_add(1) % check_lanes_.size()].get();
+}
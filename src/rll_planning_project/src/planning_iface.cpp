@@ -21,11 +21,73 @@
 #include <gazebo_msgs/SetModelState.h>
 #include <geometric_shapes/shape_operations.h>
 #include <rll_move/grasp_util.h>
+#include <rll_planning_project/lattice_planner.h>
 #include <rll_planning_project/planning_iface.h>
+#include <ros/callback_queue.h>
 #include <tf/tf.h>
 #include <tf/transform_datatypes.h>
 #include <visualization_msgs/Marker.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+// FNV-1a
+const uint64_t HASH_OFFSET = 14695981039346656037ULL;
+const uint64_t HASH_PRIME = 1099511628211ULL;
+// scene geometry is rounded to this precision before hashing
+const double HASH_RESOLUTION = 1E-04;
+
+void hashBytes(const void* data, size_t size, uint64_t* hash)
+{
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i)
+  {
+    *hash = (*hash ^ bytes[i]) * HASH_PRIME;
+  }
+}
+
+void hashString(const std::string& value, uint64_t* hash)
+{
+  hashBytes(value.data(), value.size() + 1, hash);
+}
+
+void hashRounded(double value, uint64_t* hash)
+{
+  int64_t rounded = std::llround(value / HASH_RESOLUTION);
+  hashBytes(&rounded, sizeof(rounded), hash);
+}
+
+void hashShapes(const std::vector<shapes::ShapeConstPtr>& shapes, const EigenSTL::vector_Isometry3d& poses,
+                const Eigen::Isometry3d& frame, uint64_t* hash)
+{
+  for (size_t i = 0; i < shapes.size() && i < poses.size(); ++i)
+  {
+    int type = shapes[i]->type;
+    hashBytes(&type, sizeof(type), hash);
+    Eigen::Vector3d extents = shapes::computeShapeExtents(shapes[i].get());
+    Eigen::Isometry3d pose = frame * poses[i];
+    for (int j = 0; j < 3; ++j)
+    {
+      hashRounded(extents[j], hash);
+      for (int k = 0; k < 4; ++k)
+      {
+        hashRounded(pose(j, k), hash);
+      }
+    }
+  }
+}
+}  // namespace
+
 PlanningIfaceBase::PlanningIfaceBase(const ros::NodeHandle& nh) : RLLMoveIfaceBase(nh)
 {
   float start_pos_x, start_pos_y, start_pos_theta, goal_pos_x, goal_pos_y, goal_pos_theta;
@@ -55,6 +117,45 @@ PlanningIfaceBase::PlanningIfaceBase(const ros::NodeHandle& nh) : RLLMoveIfaceBa
 
   insertGraspObject();
 
+  // batched check_paths requests are distributed among this number of worker threads
+  int num_workers = static_cast<int>(std::thread::hardware_concurrency());
+  ros::param::get(node_name_ + "/check_paths_num_workers", num_workers);
+  check_paths_num_workers_ = static_cast<size_t>(std::max(num_workers, 1));
+
+  // validate check_path requests in-process with the RLL kinematics instead of the move group's Cartesian path service
+  check_path_local_ = false;
+  ros::param::get(node_name_ + "/check_path_local", check_path_local_);
+  if (!check_path_local_)
+  {
+    check_path_move_group_.reset(new moveit::planning_interface::MoveGroupInterface(
+        sharedMoveGroupOptions(manip_move_group_.getName(), robot_model_loader_)));
+  }
+
+  check_path_threads_ = 4;
+  ros::param::get(node_name_ + "/check_path_threads", check_path_threads_);
+
+  double cache_resolution_trans = 0.0005, cache_resolution_rot = 0.001;
+  ros::param::get(node_name_ + "/check_path_cache_resolution_trans", cache_resolution_trans);
+  ros::param::get(node_name_ + "/check_path_cache_resolution_rot", cache_resolution_rot);
+  check_path_cache_.setResolution(cache_resolution_trans, cache_resolution_rot);
+
+  // lattice resolution and search limit of the server-side planner behind the plan_to_goal action
+  native_planner_step_ = 0.05;
+  native_planner_max_expansions_ = 50000;
+  ros::param::get(node_name_ + "/native_planner_step", native_planner_step_);
+  ros::param::get(node_name_ + "/native_planner_max_expansions", native_planner_max_expansions_);
+
+  // validated edges are persisted in this directory, one file per planning scene, disabled if empty
+  roadmap_capacity_ = 1 << 20;
+  ros::param::get(node_name_ + "/roadmap_directory", roadmap_directory_);
+  ros::param::get(node_name_ + "/roadmap_capacity", roadmap_capacity_);
+
+  move_queue_pending_ = 0;
+  move_queue_error_ = RLLErrorCode::SUCCESS;
+  move_queue_shutdown_ = false;
+  move_queue_executed_ = false;
+  queries_in_flight_ = 0;
+
   grasp_object_at_goal_ = false;
   move_command_failed_ = false;
   registerPermissions();
@@ -65,9 +166,12 @@ void PlanningIfaceBase::insertGraspObject()
   geometry_msgs::Pose box_pose;
   visualization_msgs::Marker marker;
   float grasp_object_dim_x, grasp_object_dim_y, grasp_object_dim_z;
-  bool headless;
+  bool headless = false;
+  bool fast_sim = false;
 
   ros::param::get(node_name_ + "/headless", headless);
+  // the fast simulation does not start RViz, nobody would subscribe to the marker
+  ros::param::get(node_name_ + "/fast_sim", fast_sim);
   ros::param::get(node_name_ + "/grasp_object_dim_x", grasp_object_dim_x);
   ros::param::get(node_name_ + "/grasp_object_dim_y", grasp_object_dim_y);
   ros::param::get(node_name_ + "/grasp_object_dim_z", grasp_object_dim_z);
@@ -109,7 +213,7 @@ void PlanningIfaceBase::insertGraspObject()
   marker.lifetime = ros::Duration();
 
   // Publish the marker
-  while (!headless && marker_pub.getNumSubscribers() < 1)
+  while (!headless && !fast_sim && marker_pub.getNumSubscribers() < 1)
   {
     ROS_INFO_ONCE("Waiting for marker subscribers");
     ros::Duration(1.0).sleep();
@@ -208,8 +312,9 @@ bool PlanningIfaceBase::runPlannerOnce(const rll_msgs::JobEnvGoalConstPtr& goal,
   rll_msgs::PickPlace::Request pick_place_req;
   rll_msgs::PickPlace::Response pick_place_resp;
 
-  // reset grasp object position in planning scene
-  bool success = planning_scene_interface_.applyCollisionObject(grasp_object_);
+  // reset grasp object position in planning scene, only its pose is sent if move_group knows the object
+  scene_diff_.addOrMove(grasp_object_);
+  bool success = applyPlanningSceneDiff();
   if (!success)
   {
     ROS_WARN("Failed to reset grasp object position");
@@ -246,15 +351,21 @@ bool PlanningIfaceBase::runPlannerOnce(const rll_msgs::JobEnvGoalConstPtr& goal,
   }
 
   // check_path needs this to have a proper start state
-  robot_state::RobotState start_state = getCurrentRobotState(true);
-  check_path_start_state_ = &start_state;
+  check_path_states_.reset(getCurrentRobotState(true), check_paths_num_workers_);
+  openRoadmap();
 
   permissions_.storeCurrentPermissions();
   permissions_.updateCurrentPermissions(plan_permission_, true);
 
+  check_path_cache_.resetCounters();
   ROS_INFO("calling the planning service\n");
   success = runClient(goal, result);
+  // the job isn't finished before all queued moves are executed
+  waitForMoveQueue();
   permissions_.restorePreviousPermissions();
+  // no query is admitted without the plan permission anymore, wait for those that are still running
+  waitForQueriesToEnd();
+  logCheckPathCacheStats();
   if (success)
   {
     ROS_INFO("successfully called the planning service, planning and moving took %d minutes and %d seconds",
@@ -295,18 +406,17 @@ bool PlanningIfaceBase::writeResult(rll_msgs::JobEnvResult* result)
 
 RLLErrorCode PlanningIfaceBase::idle()
 {
-  rll_msgs::MovePTP::Request move_ptp_req;
-  rll_msgs::MovePTP::Response move_ptp_resp;
+  geometry_msgs::Pose pose_above_goal;
   rll_msgs::PickPlace::Request pick_place_req;
-  rll_msgs::PickPlace::Response pick_place_resp;
   RLLErrorCode error_code;
 
+  // the transitions between the fixed poses of the reset are replayed from the trajectory cache
   if (grasp_object_at_goal_)
   {
     // pick up the grasp object
-    move_ptp_req.pose = goal_pose_above_;
-    move_ptp_req.pose.position.z = POSE_Z_ABOVE_MAZE;
-    error_code = movePTP(move_ptp_req, &move_ptp_resp);
+    pose_above_goal = goal_pose_above_;
+    pose_above_goal.position.z = POSE_Z_ABOVE_MAZE;
+    error_code = moveToGoalPTP(pose_above_goal, true);
     if (error_code.failed())
     {
       ROS_ERROR("Moving PTP above goal pos for reset failed");
@@ -318,7 +428,7 @@ RLLErrorCode PlanningIfaceBase::idle()
     pick_place_req.pose_grip = goal_pose_grip_;
     pick_place_req.gripper_close = RLL_SRV_TRUE;
     pick_place_req.grasp_object = grasp_object_.id;
-    error_code = pickPlace(pick_place_req, &pick_place_resp);
+    error_code = runPickPlace(pick_place_req, true);
     if (error_code.failed())
     {
       ROS_ERROR("Failed to pick up the grasp object at the goal!");
@@ -347,6 +457,115 @@ void PlanningIfaceBase::registerPermissions()
   permissions_.setRequiredPermissionsFor(RLLMoveIfaceServices::ROBOT_READY_SRV_NAME,
                                          Permissions::NO_PERMISSION_REQUIRED);
   permissions_.setRequiredPermissionsFor(RLLMoveIfaceBase::JOB_FINISHED_SRV_NAME, Permissions::NO_PERMISSION_REQUIRED);
+
+  check_path_srv_ = permissions_.registerService(CHECK_PATH_SRV_NAME);
+  check_paths_srv_ = permissions_.registerService(CHECK_PATHS_SRV_NAME);
+  get_cspace_grid_srv_ = permissions_.registerService(GET_CSPACE_GRID_SRV_NAME);
+  get_roadmap_srv_ = permissions_.registerService(GET_ROADMAP_SRV_NAME);
+  get_start_goal_srv_ = permissions_.registerService(GET_START_GOAL_SRV_NAME);
+}
+
+RLLErrorCode PlanningIfaceBase::beginQuery(Permissions::ServiceId srv)
+{
+  // counted before the checks, so that a query that is admitted is always waited for
+  {
+    std::lock_guard<std::mutex> lock(queries_mutex_);
+    ++queries_in_flight_;
+  }
+
+  return beforeQueryCall(srv);
+}
+
+RLLErrorCode PlanningIfaceBase::endQuery(Permissions::ServiceId srv, const RLLErrorCode& previous_error_code)
+{
+  RLLErrorCode error_code = afterQueryCall(srv, previous_error_code);
+
+  {
+    std::lock_guard<std::mutex> lock(queries_mutex_);
+    --queries_in_flight_;
+  }
+  queries_ended_.notify_all();
+  return error_code;
+}
+
+void PlanningIfaceBase::waitForQueriesToEnd()
+{
+  std::unique_lock<std::mutex> lock(queries_mutex_);
+  queries_ended_.wait(lock, [this] { return queries_in_flight_ == 0; });
+}
+
+void PlanningIfaceBase::planningSceneModified()
+{
+  // the cached check_path results are only valid for the scene they were computed with, the roadmap of the new scene
+  // is opened before the next run
+  check_path_cache_.clear();
+  roadmap_store_.close();
+}
+
+void PlanningIfaceBase::openRoadmap()
+{
+  roadmap_store_.resetCounters();
+  if (roadmap_directory_.empty())
+  {
+    return;
+  }
+
+  uint64_t scene_hash = roadmapSceneHash();
+  std::stringstream file_name;
+  file_name << roadmap_directory_ << "/roadmap_" << std::hex << std::setw(16) << std::setfill('0') << scene_hash
+            << ".rllroadmap";
+  roadmap_store_.open(file_name.str(), scene_hash, check_path_cache_.resolutionTrans(),
+                      check_path_cache_.resolutionRot(), static_cast<size_t>(std::max(roadmap_capacity_, 1)));
+}
+
+uint64_t PlanningIfaceBase::roadmapSceneHash()
+{
+  // Covers everything the validity of an edge depends on: the robot including the maze, the world objects and the
+  // attached grasp object. The geometry is rounded, so that e.g. a grasp object attached at a pose that differs by
+  // numerical noise does not start a new roadmap.
+  planning_scene::PlanningScenePtr planning_scene = clonePlanningScene();
+  const robot_state::RobotState& state = planning_scene->getCurrentState();
+
+  uint64_t hash = HASH_OFFSET;
+  hashString(manip_model_->getName(), &hash);
+  hashBytes(&check_path_local_, sizeof(check_path_local_), &hash);
+
+  std::string collision_link;
+  ros::param::get(node_name_ + "/collision_link", collision_link);
+  const robot_model::LinkModel* maze_link = manip_model_->getLinkModel(collision_link);
+  if (maze_link != nullptr)
+  {
+    hashShapes(maze_link->getShapes(), maze_link->getCollisionOriginTransforms(),
+               state.getGlobalLinkTransform(maze_link), &hash);
+  }
+
+  for (const auto& object : *planning_scene->getWorld())
+  {
+    hashString(object.first, &hash);
+    hashShapes(object.second->shapes_, object.second->shape_poses_, Eigen::Isometry3d::Identity(), &hash);
+  }
+
+  std::vector<const robot_state::AttachedBody*> attached_bodies;
+  state.getAttachedBodies(attached_bodies);
+  for (const robot_state::AttachedBody* attached_body : attached_bodies)
+  {
+    hashString(attached_body->getName(), &hash);
+    hashString(attached_body->getAttachedLinkName(), &hash);
+    hashShapes(attached_body->getShapes(), attached_body->getFixedTransforms(), Eigen::Isometry3d::Identity(), &hash);
+  }
+
+  return hash;
+}
+
+void PlanningIfaceBase::logCheckPathCacheStats()
+{
+  uint64_t hits = check_path_cache_.hits();
+  uint64_t misses = check_path_cache_.misses();
+  ROS_INFO("check_path cache: %lu hits, %lu misses, %lu entries", hits, misses, check_path_cache_.size());
+  if (roadmap_store_.isOpen())
+  {
+    ROS_INFO("roadmap: %lu edges reused, %lu edges stored", roadmap_store_.hits(), roadmap_store_.size());
+  }
 }
 
 void PlanningIfaceBase::generateRotationWaypoints(const geometry_msgs::Pose2D& pose2d_start, float rot_step_size,
@@ -365,7 +584,7 @@ void PlanningIfaceBase::generateRotationWaypoints(const geometry_msgs::Pose2D& p
 bool PlanningIfaceBase::getStartGoalSrv(rll_planning_project::GetStartGoal::Request& /*req*/,
                                         rll_planning_project::GetStartGoal::Response& resp)
 {
-  RLLErrorCode error_code = beforeServiceCall(GET_START_GOAL_SRV_NAME);
+  RLLErrorCode error_code = beginQuery(get_start_goal_srv_);
 
   if (error_code.succeeded())
   {
@@ -373,7 +592,7 @@ bool PlanningIfaceBase::getStartGoalSrv(rll_planning_project::GetStartGoal::Requ
     resp.goal = goal_pose_2d_;
   }
 
-  error_code = afterServiceCall(GET_START_GOAL_SRV_NAME, error_code);
+  error_code = endQuery(get_start_goal_srv_, error_code);
   resp.error_code = error_code.value();
   resp.success = error_code.succeededSrv();
   return true;
@@ -387,6 +606,13 @@ bool PlanningIfaceBase::moveSrv(rll_planning_project::Move::Request& req, rll_pl
 RLLErrorCode PlanningIfaceBase::move(const rll_planning_project::Move::Request& req,
                                      rll_planning_project::Move::Response* /*resp*/)
 {
+  // moves are executed in request order, so queued moves have to finish first
+  RLLErrorCode queue_error_code = waitForMoveQueue();
+  if (queue_error_code.failed())
+  {
+    return queue_error_code;
+  }
+
   if (move_command_failed_)
   {
     ROS_ERROR("Previous move command has failed, not executing this move command");
@@ -398,13 +624,9 @@ RLLErrorCode PlanningIfaceBase::move(const rll_planning_project::Move::Request&
   moveit_msgs::RobotTrajectory trajectory;
   float move_dist, dist_rot;
 
-  // enforce a lower bound for move command to ensure that Moveit has enough waypoints
   diffCurrentState(req.pose, &move_dist, &dist_rot, &pose2d_cur);
-  if ((move_dist < 0.005 && move_dist > DEFAULT_LINEAR_EEF_STEP) ||
-      (move_dist < DEFAULT_LINEAR_EEF_STEP && dist_rot < 20 * M_PI / 180))
+  if (moveTooSmall(move_dist, dist_rot))
   {
-    ROS_WARN("move commands that cover a distance between 0 and 5 mm or sole rotations less than 20 degrees are not "
-             "supported!");
     move_command_failed_ = true;
     return RLLErrorCode::TOO_FEW_WAYPOINTS;
   }
@@ -428,174 +650,1005 @@ RLLErrorCode PlanningIfaceBase::move(const rll_planning_project::Move::Request&
   return error_code;
 }
 
-bool PlanningIfaceBase::checkPathSrv(rll_planning_project::CheckPath::Request& req,
-                                     rll_planning_project::CheckPath::Response& resp)
+void PlanningIfaceBase::planToGoalAction(const rll_planning_project::PlanToGoalGoalConstPtr& goal,
+                                         PlanToGoalServer* server)
 {
-  RLLErrorCode error_code = beforeServiceCall(CHECK_PATH_SRV_NAME);
-  RLLErrorCode check_path_error_code = RLLErrorCode::SUCCESS;
+  rll_planning_project::PlanToGoalResult result;
+  RLLErrorCode error_code = beforeServiceCall(PLAN_TO_GOAL_ACTION_NAME);
 
   if (error_code.succeeded())
   {
-    check_path_error_code = checkPath(req);
+    error_code = planToGoal(*goal, &result);
   }
 
-  error_code = afterServiceCall(CHECK_PATH_SRV_NAME, error_code);
-  if (error_code.failed())
+  error_code = afterServiceCall(PLAN_TO_GOAL_ACTION_NAME, error_code);
+  result.success = error_code.succeeded();
+  result.error_code = error_code.value();
+
+  if (result.success)
   {
-    ROS_INFO("checkPathSrv call failed with: %s", error_code.message());
+    server->setSucceeded(result);
+  }
+  else
+  {
+    ROS_INFO("plan_to_goal action failed with: %s", error_code.message());
+    server->setAborted(result);
   }
-
-  error_code = error_code.determineWorse(check_path_error_code);
-  resp.success = error_code.succeededSrv();
-  resp.error_code = error_code.value();
-
-  return true;
 }
 
-RLLErrorCode PlanningIfaceBase::checkPath(const rll_planning_project::CheckPath::Request& req)
+RLLErrorCode PlanningIfaceBase::planToGoal(const rll_planning_project::PlanToGoalGoal& goal,
+                                           rll_planning_project::PlanToGoalResult* result)
 {
-  geometry_msgs::Pose pose3d_start, pose3d_goal;
-  std::vector<geometry_msgs::Pose> waypoints;
-  moveit_msgs::RobotTrajectory trajectory;
-  const double POSITIVE_ZERO = 1E-07;
+  LatticePlanner::Options options;
+  options.step_trans = native_planner_step_;
+  options.max_expansions = static_cast<size_t>(std::max(native_planner_max_expansions_, 1));
+  if (!getMazeExtents(&options.x_min, &options.x_max, &options.y_min, &options.y_max))
+  {
+    ROS_WARN("planning without bounds");
+  }
 
-  // Note on error codes:
-  // PROJECT_SPECIFIC_INVALID_1: too little movement
-  // PROJECT_SPECIFIC_INVALID_2: no path
+  // Edges are validated with the same checks as the check_paths service, so the batches of each expansion are
+  // distributed among the worker pool and repeated edges are answered from the cache.
+  RLLErrorCode check_error_code = RLLErrorCode::SUCCESS;
+  auto edge_checker = [&](const std::vector<LatticePlanner::Edge>& edges, std::vector<bool>* valid) {
+    rll_planning_project::CheckPaths::Request req;
+    rll_planning_project::CheckPaths::Response resp;
+    for (const auto& edge : edges)
+    {
+      req.poses_start.push_back(edge.start);
+      req.poses_goal.push_back(edge.goal);
+    }
 
-  // enforce a lower bound for check_path requests to ensure that Moveit has enough waypoints
-  float move_dist = sqrt(pow(req.pose_start.x - req.pose_goal.x, 2) + pow(req.pose_start.y - req.pose_goal.y, 2));
-  float dist_rot = fabs(req.pose_start.theta - req.pose_goal.theta);
-  if ((move_dist < 0.005 && move_dist > POSITIVE_ZERO) || (move_dist <= POSITIVE_ZERO && dist_rot < 20 * M_PI / 180))
+    RLLErrorCode error_code = check_error_code.failed() ? check_error_code : checkPaths(req, &resp);
+    if (error_code.failed())
+    {
+      check_error_code = error_code;
+      valid->assign(edges.size(), false);
+      return;
+    }
+
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+      (*valid)[i] = resp.edges_success[i];
+    }
+  };
+
+  LatticePlanner planner(edge_checker, options);
+  bool path_found = planner.plan(goal.start, goal.goal, &result->path);
+  ROS_INFO("native planner: %lu expansions, %lu checked edges", planner.numExpansions(), planner.numCheckedEdges());
+  if (check_error_code.failed())
   {
-    ROS_WARN("check path requests that cover a distance between 0 and 5 mm or sole rotations less than 20 degrees are "
-             "not supported!");
-    ROS_WARN("Moving distance would have been %f m", move_dist);
-    return RLLErrorCode::PROJECT_SPECIFIC_INVALID_1;
+    ROS_ERROR("checking edges failed with: %s", check_error_code.message());
+    return check_error_code;
+  }
+  if (!path_found)
+  {
+    ROS_WARN("native planner did not find a path");
+    return RLLErrorCode::MOVEIT_PLANNING_FAILED;
   }
 
-  if (move_dist <= POSITIVE_ZERO)
+  ROS_INFO("native planner found a path with %lu segments", result->path.size());
+  rll_planning_project::MovePath::Request move_req;
+  move_req.poses = result->path;
+  return movePath(move_req, nullptr);
+}
+
+bool PlanningIfaceBase::moveTooSmall(float move_dist, float dist_rot)
+{
+  // enforce a lower bound for move command to ensure that Moveit has enough waypoints
+  if ((move_dist < 0.005 && move_dist > DEFAULT_LINEAR_EEF_STEP) ||
+      (move_dist < DEFAULT_LINEAR_EEF_STEP && dist_rot < 20 * M_PI / 180))
   {
-    // generate more points here to ensure that there are at least ten
-    // for the continuity check
-    float rot_step_size = (req.pose_start.theta - req.pose_goal.theta) / LINEAR_MIN_STEPS_FOR_JUMP_THRESH;
-    generateRotationWaypoints(req.pose_start, rot_step_size, &waypoints);
+    ROS_WARN("move commands that cover a distance between 0 and 5 mm or sole rotations less than 20 degrees are not "
+             "supported!");
+    return true;
   }
 
-  pose2dToPose3d(req.pose_start, &pose3d_start);
-  pose2dToPose3d(req.pose_goal, &pose3d_goal);
+  return false;
+}
 
-  bool start_pose_valid = check_path_start_state_->setFromIK(manip_joint_model_group_, pose3d_start,
-                                                             manip_move_group_.getEndEffectorLink());
+RLLErrorCode PlanningIfaceBase::planSegment(const geometry_msgs::Pose2D& pose2d_start,
+                                            const geometry_msgs::Pose2D& pose2d_goal,
+                                            const robot_state::RobotState& state_start,
+                                            robot_trajectory::RobotTrajectory* trajectory)
+{
+  float move_dist = std::hypot(pose2d_goal.x - pose2d_start.x, pose2d_goal.y - pose2d_start.y);
+  float dist_rot = std::fabs(pose2d_goal.theta - pose2d_start.theta);
+  if (moveTooSmall(move_dist, dist_rot))
+  {
+    return RLLErrorCode::TOO_FEW_WAYPOINTS;
+  }
 
-  if (!start_pose_valid)
+  geometry_msgs::Pose pose3d_goal;
+  pose2dToPose3d(pose2d_goal, &pose3d_goal);
+  // the monitor keeps updating the scene while a segment executes, plan against a private copy
+  planning_scene::PlanningScenePtr planning_scene = clonePlanningScene();
+  RLLErrorCode error_code = computeLinearPath(state_start, pose3d_goal, *planning_scene, trajectory);
+  if (error_code.failed())
   {
-    return RLLErrorCode::INVALID_INPUT;
+    ROS_ERROR("computing path failed, move dist %f, dist rot %f", move_dist, dist_rot);
   }
+  return error_code;
+}
 
-  manip_move_group_.setStartState(*check_path_start_state_);
+bool PlanningIfaceBase::moveAsyncSrv(rll_planning_project::Move::Request& req,
+                                     rll_planning_project::Move::Response& resp)
+{
+  return controlledMovementExecution(req, &resp, MOVE_ASYNC_SRV_NAME, &PlanningIfaceBase::moveAsync);
+}
 
-  waypoints.push_back(pose3d_goal);
-  double achieved = manip_move_group_.computeCartesianPath(waypoints, DEFAULT_LINEAR_EEF_STEP,
-                                                           DEFAULT_LINEAR_JUMP_THRESHOLD, trajectory);
-  if (achieved < 1)
+RLLErrorCode PlanningIfaceBase::moveAsync(const rll_planning_project::Move::Request& req,
+                                          rll_planning_project::Move::Response* /*resp*/)
+{
+  if (move_command_failed_)
   {
-    return RLLErrorCode::PROJECT_SPECIFIC_INVALID_2;
+    ROS_ERROR("Previous move command has failed, not executing this move command");
+    return RLLErrorCode::PROJECT_SPECIFIC_RECOVERABLE_1;
   }
 
-  if (trajectory.joint_trajectory.points.size() < LINEAR_MIN_STEPS_FOR_JUMP_THRESH)
+  std::lock_guard<std::mutex> lock(move_queue_mutex_);
+  if (move_queue_error_.failed())
   {
-    ROS_ERROR("trajectory has not enough points to check for continuity, only got %lu",
-              trajectory.joint_trajectory.points.size());
-    ROS_ERROR("move dist %f, dist rot %f", move_dist, dist_rot);
-    return RLLErrorCode::PROJECT_SPECIFIC_INVALID_1;
+    // the failure of an earlier queued move is reported once, later requests are rejected by the check above
+    move_command_failed_ = true;
+    return move_queue_error_;
   }
 
+  ROS_INFO("queued move request to pos x=%.3f y=%.3f theta=%.3f", req.pose.x, req.pose.y, req.pose.theta);
+  move_queue_.push_back(req.pose);
+  ++move_queue_pending_;
+  move_queue_cv_.notify_all();
   return RLLErrorCode::SUCCESS;
 }
 
-bool PlanningIfaceBase::checkGoalState()
+RLLErrorCode PlanningIfaceBase::waitForMoveQueue()
 {
-  std::vector<geometry_msgs::Pose> waypoints;
-  geometry_msgs::Pose2D pose2d_cur;
-  moveit_msgs::RobotTrajectory trajectory;
-  const double EEF_STEP = 0.0001;
-  rll_msgs::PickPlace::Request pick_place_req;
-  rll_msgs::PickPlace::Response pick_place_resp;
-  rll_msgs::MoveLin::Request move_lin_req;
-  rll_msgs::MoveLin::Response move_lin_resp;
-  float dist_goal_trans, diff_goal_angle;
-  RLLErrorCode error_code;
+  std::unique_lock<std::mutex> lock(move_queue_mutex_);
+  move_queue_cv_.wait(lock, [this] { return move_queue_pending_ == 0; });
+  if (move_queue_error_.failed() && !move_command_failed_)
+  {
+    // report the failure of a queued move once, later requests are rejected due to move_command_failed_
+    move_command_failed_ = true;
+    return move_queue_error_;
+  }
+  return RLLErrorCode::SUCCESS;
+}
 
-  // check if we are close enough to the goal
-  diffCurrentState(goal_pose_2d_, &dist_goal_trans, &diff_goal_angle, &pose2d_cur);
+void PlanningIfaceBase::resetMoveQueue()
+{
+  waitForMoveQueue();
+  std::lock_guard<std::mutex> lock(move_queue_mutex_);
+  move_queue_error_ = RLLErrorCode::SUCCESS;
+}
 
-  if (dist_goal_trans < GOAL_TOLERANCE_TRANS && diff_goal_angle < GOAL_TOLERANCE_ROT)
+void PlanningIfaceBase::runMoveQueue()
+{
+  // Segment k + 1 is planned from the predicted end state of segment k while segment k is executed. A failure drops
+  // all queued moves, the error is reported with the next move request.
+  std::future<RLLErrorCode> execution;
+  moveit_msgs::RobotTrajectory next_trajectory;
+  bool next_planned = false;
+  robot_state::RobotState segment_start(manip_model_);
+  robot_trajectory::RobotTrajectory segment_trajectory(manip_model_, manip_move_group_.getName());
+  geometry_msgs::Pose2D pose2d_start;
+
+  std::unique_lock<std::mutex> lock(move_queue_mutex_);
+  while (!move_queue_shutdown_)
   {
-    ROS_INFO("distance to goal: %f, orientation diff: %f", dist_goal_trans, diff_goal_angle);
-
-    geometry_msgs::Pose reset_above_goal = goal_pose_above_;
-    reset_above_goal.position.z = POSE_Z_ABOVE_MAZE;
-    waypoints.push_back(reset_above_goal);
-    double achieved =
-        manip_move_group_.computeCartesianPath(waypoints, EEF_STEP, DEFAULT_LINEAR_JUMP_THRESHOLD, trajectory);
-    if (achieved < 1)
+    if (move_queue_executed_)
     {
-      ROS_WARN("You came close to the goal, but unfortunately, it's not reachable.\n");
-      grasp_object_at_goal_ = false;
-      return true;
+      move_queue_executed_ = false;
+      RLLErrorCode error_code = execution.get();
+      --move_queue_pending_;
+      if (error_code.failed())
+      {
+        ROS_ERROR("queued move failed with: %s, dropping %lu queued moves", error_code.message(),
+                  move_queue_.size() + (next_planned ? 1 : 0));
+        move_queue_error_ = error_code;
+        move_queue_pending_ -= move_queue_.size() + (next_planned ? 1 : 0);
+        move_queue_.clear();
+        next_planned = false;
+      }
+      move_queue_cv_.notify_all();
+      continue;
     }
 
-    ROS_INFO("Goal was reached, good job!\n");
-
-    // place the object at the goal
-    pick_place_req.pose_approach = goal_pose_above_;
-    pick_place_req.pose_retreat = goal_pose_above_;
-    pick_place_req.pose_grip = goal_pose_grip_;
-    pick_place_req.gripper_close = RLL_SRV_FALSE;
-    pick_place_req.grasp_object = grasp_object_.id;
-
-    error_code = pickPlace(pick_place_req, &pick_place_resp);
-    if (error_code.failed())
+    if (next_planned && !execution.valid())
     {
-      ROS_FATAL("Failed to place the grasp object at the goal!");
-      return false;
+      execution = std::async(std::launch::async, [this, next_trajectory] {
+        RLLErrorCode error_code = runLinearTrajectory(next_trajectory);
+        {
+          std::lock_guard<std::mutex> execution_lock(move_queue_mutex_);
+          move_queue_executed_ = true;
+        }
+        move_queue_cv_.notify_all();
+        return error_code;
+      });
+      next_planned = false;
+      continue;
     }
 
-    grasp_object_at_goal_ = true;
-
-    // move a little higher after placing the object
-    move_lin_req.pose = reset_above_goal;
-    error_code = moveLin(move_lin_req, &move_lin_resp);
-    if (error_code.failed())
+    if (!next_planned && !move_queue_.empty())
     {
-      ROS_FATAL("Moving above maze for reset to home failed");
-      return false;
-    }
+      geometry_msgs::Pose2D pose2d_goal = move_queue_.front();
+      move_queue_.pop_front();
+      bool robot_idle = !execution.valid();
+      lock.unlock();
 
-    error_code = resetToHome();
-    if (error_code.failed())
-    {
-      ROS_FATAL("Failed to reset to home from goal");
-      return false;
+      if (robot_idle)
+      {
+        float move_dist, dist_rot;
+        diffCurrentState(pose2d_goal, &move_dist, &dist_rot, &pose2d_start);
+        segment_start = getCurrentRobotState();
+      }
+      RLLErrorCode error_code = planSegment(pose2d_start, pose2d_goal, segment_start, &segment_trajectory);
+      if (error_code.succeeded())
+      {
+        segment_trajectory.getRobotTrajectoryMsg(next_trajectory);
+        segment_start = segment_trajectory.getLastWayPoint();
+        pose2d_start = pose2d_goal;
+      }
+
+      lock.lock();
+      if (error_code.failed())
+      {
+        // moves that are still being executed are accounted for when they finish
+        ROS_ERROR("planning queued move failed, dropping %lu queued moves", move_queue_.size());
+        move_queue_error_ = error_code;
+        move_queue_pending_ -= move_queue_.size() + 1;
+        move_queue_.clear();
+        move_queue_cv_.notify_all();
+      }
+      else
+      {
+        next_planned = move_queue_error_.succeeded();
+        if (!next_planned)
+        {
+          // the preceding execution failed meanwhile and already dropped the queue
+          --move_queue_pending_;
+          move_queue_cv_.notify_all();
+        }
+      }
+      continue;
     }
+
+    // woken up by new requests, by the end of the running execution or for the shutdown
+    move_queue_cv_.wait(lock, [this, &next_planned] {
+      return move_queue_shutdown_ || move_queue_executed_ || (!next_planned && !move_queue_.empty());
+    });
   }
-  else
+
+  lock.unlock();
+  if (execution.valid())
   {
-    ROS_WARN("Goal was not reached");
-    ROS_WARN("distance to goal: %f, orientation diff: %f\n", dist_goal_trans, diff_goal_angle);
-    grasp_object_at_goal_ = false;
+    execution.wait();
   }
-
-  return true;
 }
 
-void PlanningIfaceBase::diffCurrentState(const geometry_msgs::Pose2D& pose_des, float* diff_trans, float* diff_rot,
-                                         geometry_msgs::Pose2D* pose2d_cur)
+bool PlanningIfaceBase::movePathSrv(rll_planning_project::MovePath::Request& req,
+                                    rll_planning_project::MovePath::Response& resp)
 {
-  geometry_msgs::Pose current_pose = manip_move_group_.getCurrentPose().pose;
+  return controlledMovementExecution(req, &resp, MOVE_PATH_SRV_NAME, &PlanningIfaceBase::movePath);
+}
 
-  *diff_trans = sqrt(pow(current_pose.position.x - pose_des.x, 2) + pow(current_pose.position.y - pose_des.y, 2));
+RLLErrorCode PlanningIfaceBase::movePath(const rll_planning_project::MovePath::Request& req,
+                                         rll_planning_project::MovePath::Response* /*resp*/)
+{
+  RLLErrorCode queue_error_code = waitForMoveQueue();
+  if (queue_error_code.failed())
+  {
+    return queue_error_code;
+  }
+
+  if (move_command_failed_)
+  {
+    ROS_ERROR("Previous move command has failed, not executing this move command");
+    return RLLErrorCode::PROJECT_SPECIFIC_RECOVERABLE_1;
+  }
+
+  if (req.poses.empty())
+  {
+    ROS_WARN("move path request without poses");
+    return RLLErrorCode::INVALID_INPUT;
+  }
+
+  float move_dist, dist_rot;
+  geometry_msgs::Pose2D pose2d_prev;
+  diffCurrentState(req.poses.front(), &move_dist, &dist_rot, &pose2d_prev);
+
+  // Each segment starts at the last state of the previous one. The concatenated trajectory is time-parameterized and
+  // executed once, so the robot does not stop at the intermediate poses.
+  robot_state::RobotState segment_start = getCurrentRobotState();
+  robot_trajectory::RobotTrajectory path_trajectory(manip_model_, manip_move_group_.getName());
+  robot_trajectory::RobotTrajectory segment_trajectory(manip_model_, manip_move_group_.getName());
+  for (size_t i = 0; i < req.poses.size(); ++i)
+  {
+    RLLErrorCode error_code = planSegment(pose2d_prev, req.poses[i], segment_start, &segment_trajectory);
+    if (error_code.failed())
+    {
+      ROS_ERROR("computing segment %lu of the path failed", i);
+      move_command_failed_ = true;
+      return error_code;
+    }
+
+    // the first waypoint of a segment duplicates the last one of the previous segment
+    path_trajectory.append(segment_trajectory, 0.0, i == 0 ? 0 : 1);
+    segment_start = segment_trajectory.getLastWayPoint();
+    pose2d_prev = req.poses[i];
+  }
+
+  ROS_INFO("move path request with %lu poses, %lu trajectory points", req.poses.size(),
+           path_trajectory.getWayPointCount());
+  moveit_msgs::RobotTrajectory trajectory;
+  path_trajectory.getRobotTrajectoryMsg(trajectory);
+  RLLErrorCode error_code = runLinearTrajectory(trajectory);
+  if (error_code.failed())
+  {
+    move_command_failed_ = true;
+  }
+  return error_code;
+}
+
+bool PlanningIfaceBase::checkPathSrv(rll_planning_project::CheckPath::Request& req,
+                                     rll_planning_project::CheckPath::Response& resp)
+{
+  ros::WallTime start = ros::WallTime::now();
+  RLLErrorCode error_code = beginQuery(check_path_srv_);
+  RLLErrorCode check_path_error_code = RLLErrorCode::SUCCESS;
+
+  if (error_code.succeeded())
+  {
+    check_path_error_code = checkPathCached(req);
+  }
+
+  error_code = endQuery(check_path_srv_, error_code);
+  if (error_code.failed())
+  {
+    ROS_INFO("checkPathSrv call failed with: %s", error_code.message());
+  }
+
+  error_code = error_code.determineWorse(check_path_error_code);
+  resp.success = error_code.succeededSrv();
+  resp.error_code = error_code.value();
+
+  if (job_recorder_.recording())
+  {
+    job_recorder_.recordServiceCall(req, resp, start, ros::WallTime::now() - start, error_code.value(),
+                                    getCurrentManipJointValues());
+  }
+
+  return true;
+}
+
+bool PlanningIfaceBase::checkPathsSrv(rll_planning_project::CheckPaths::Request& req,
+                                      rll_planning_project::CheckPaths::Response& resp)
+{
+  // one query for the whole batch, the edges are checked in between
+  ros::WallTime start = ros::WallTime::now();
+  RLLErrorCode error_code = beginQuery(check_paths_srv_);
+  RLLErrorCode check_paths_error_code = RLLErrorCode::SUCCESS;
+
+  if (error_code.succeeded())
+  {
+    check_paths_error_code = checkPaths(req, &resp);
+  }
+
+  error_code = endQuery(check_paths_srv_, error_code);
+  if (error_code.failed())
+  {
+    ROS_INFO("checkPathsSrv call failed with: %s", error_code.message());
+  }
+
+  // the per-edge results are reported separately, success only reflects the call itself
+  error_code = error_code.determineWorse(check_paths_error_code);
+  resp.success = error_code.succeededSrv();
+  resp.error_code = error_code.value();
+
+  if (job_recorder_.recording())
+  {
+    job_recorder_.recordServiceCall(req, resp, start, ros::WallTime::now() - start, error_code.value(),
+                                    getCurrentManipJointValues());
+  }
+
+  return true;
+}
+
+RLLErrorCode PlanningIfaceBase::checkPaths(const rll_planning_project::CheckPaths::Request& req,
+                                           rll_planning_project::CheckPaths::Response* resp)
+{
+  if (req.poses_start.size() != req.poses_goal.size())
+  {
+    ROS_WARN("check paths request has %lu start poses, but %lu goal poses", req.poses_start.size(),
+             req.poses_goal.size());
+    return RLLErrorCode::INVALID_INPUT;
+  }
+
+  size_t num_edges = req.poses_start.size();
+  std::vector<RLLErrorCode> edge_error_codes(num_edges);
+  // The edges share the cache and the roadmap with check_path, so they are validated the same way. The move group's
+  // Cartesian path service can only be used sequentially, only the local validation is distributed among workers.
+  size_t num_workers = check_path_local_ ? std::min(num_edges, check_paths_num_workers_) : 1;
+
+  if (num_workers > 1)
+  {
+    RLLErrorCode error_code = checkPathsParallel(req, num_workers, &edge_error_codes);
+    if (error_code.failed())
+    {
+      return error_code;
+    }
+  }
+  else
+  {
+    rll_planning_project::CheckPath::Request edge_req;
+    for (size_t i = 0; i < num_edges; ++i)
+    {
+      edge_req.pose_start = req.poses_start[i];
+      edge_req.pose_goal = req.poses_goal[i];
+      edge_error_codes[i] = checkPathCached(edge_req);
+    }
+  }
+
+  resp->edges_success.resize(num_edges);
+  resp->edges_error_code.resize(num_edges);
+  for (size_t i = 0; i < num_edges; ++i)
+  {
+    if (edge_error_codes[i].isCriticalFailure())
+    {
+      ROS_ERROR("checking edge %lu failed critically with: %s", i, edge_error_codes[i].message());
+      return edge_error_codes[i];
+    }
+
+    resp->edges_success[i] = edge_error_codes[i].succeededSrv();
+    resp->edges_error_code[i] = edge_error_codes[i].value();
+  }
+
+  return RLLErrorCode::SUCCESS;
+}
+
+RLLErrorCode PlanningIfaceBase::checkPathsParallel(const rll_planning_project::CheckPaths::Request& req,
+                                                   size_t num_workers, std::vector<RLLErrorCode>* edge_error_codes)
+{
+  // only used with check_path_local, each worker has its own robot state and planning scene copy, the kinematics solver
+  // is stateless and can be shared
+  runCheckPathWorkers(edge_error_codes->size(), num_workers, [&](CheckPathWorker* worker, size_t i) {
+    rll_planning_project::CheckPath::Request edge_req;
+    edge_req.pose_start = req.poses_start[i];
+    edge_req.pose_goal = req.poses_goal[i];
+    RLLErrorCode& edge_error_code = (*edge_error_codes)[i];
+    if (!lookupCheckedPath(edge_req.pose_start, edge_req.pose_goal, &edge_error_code))
+    {
+      edge_error_code = checkPathWorker(edge_req, worker);
+      storeCheckedPath(edge_req.pose_start, edge_req.pose_goal, edge_error_code);
+    }
+  });
+
+  return RLLErrorCode::SUCCESS;
+}
+
+void PlanningIfaceBase::runCheckPathWorkers(size_t num_tasks, size_t num_workers,
+                                            const std::function<void(CheckPathWorker*, size_t)>& task)
+{
+  std::vector<CheckPathWorker> workers(num_workers);
+  std::vector<RobotStatePool::Handle> states;
+  states.reserve(num_workers);
+  for (auto& worker : workers)
+  {
+    states.push_back(check_path_states_.acquire());
+    worker.state = states.back().get();
+    worker.planning_scene = clonePlanningScene();
+  }
+
+  // the tasks are handed out one by one, so that workers with cheap tasks are not left idle
+  std::atomic<size_t> next_task(0);
+  auto run_worker = [&](CheckPathWorker* worker) {
+    for (size_t i = next_task++; i < num_tasks; i = next_task++)
+    {
+      task(worker, i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers);
+  for (auto& worker : workers)
+  {
+    threads.emplace_back(run_worker, &worker);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+bool PlanningIfaceBase::isStateValid(const planning_scene::PlanningScene* planning_scene,
+                                     robot_state::RobotState* robot_state, const robot_state::JointModelGroup* group,
+                                     const double* ik_solution)
+{
+  robot_state->setJointGroupPositions(group, ik_solution);
+  robot_state->update();
+  return !planning_scene->isStateColliding(*robot_state, group->getName());
+}
+
+RLLErrorCode PlanningIfaceBase::checkPathWorker(const rll_planning_project::CheckPath::Request& req,
+                                                CheckPathWorker* worker)
+{
+  // always seed the IK with the job's start state so that the result does not depend on the order of the edges
+  robot_state::RobotState& state = *worker->state;
+  check_path_states_.seed(&state);
+  return checkPathLocal(req, &state, *worker->planning_scene);
+}
+
+bool PlanningIfaceBase::getCSpaceGridSrv(rll_planning_project::GetCSpaceGrid::Request& req,
+                                         rll_planning_project::GetCSpaceGrid::Response& resp)
+{
+  RLLErrorCode error_code = beginQuery(get_cspace_grid_srv_);
+  RLLErrorCode grid_error_code = RLLErrorCode::SUCCESS;
+
+  if (error_code.succeeded())
+  {
+    grid_error_code = getCSpaceGrid(req, &resp);
+  }
+
+  error_code = endQuery(get_cspace_grid_srv_, error_code);
+  if (error_code.failed())
+  {
+    ROS_INFO("getCSpaceGridSrv call failed with: %s", error_code.message());
+  }
+
+  error_code = error_code.determineWorse(grid_error_code);
+  resp.success = error_code.succeededSrv();
+  resp.error_code = error_code.value();
+
+  return true;
+}
+
+RLLErrorCode PlanningIfaceBase::getCSpaceGrid(const rll_planning_project::GetCSpaceGrid::Request& req,
+                                              rll_planning_project::GetCSpaceGrid::Response* resp)
+{
+  const size_t MAX_NUM_CELLS = 10 * 1000 * 1000;
+
+  double x_min = req.x_min, x_max = req.x_max, y_min = req.y_min, y_max = req.y_max;
+  if (x_min >= x_max || y_min >= y_max)
+  {
+    if (!getMazeExtents(&x_min, &x_max, &y_min, &y_max))
+    {
+      return RLLErrorCode::INVALID_INPUT;
+    }
+  }
+
+  if (req.resolution_trans <= 0.0 || req.num_theta_bins == 0)
+  {
+    ROS_WARN("C-space grid requests need a positive resolution and at least one orientation bin");
+    return RLLErrorCode::INVALID_INPUT;
+  }
+
+  size_t num_x = std::ceil((x_max - x_min) / req.resolution_trans);
+  size_t num_y = std::ceil((y_max - y_min) / req.resolution_trans);
+  size_t num_theta = req.num_theta_bins;
+  size_t num_cells = num_x * num_y * num_theta;
+  if (num_cells > MAX_NUM_CELLS)
+  {
+    ROS_WARN("C-space grid with %lu cells requested, only up to %lu cells are supported", num_cells, MAX_NUM_CELLS);
+    return RLLErrorCode::INVALID_INPUT;
+  }
+
+  ROS_INFO("computing C-space grid with %lu x %lu x %lu cells", num_x, num_y, num_theta);
+
+  // each task covers one row of the grid, a row is filled by a single worker to keep the IK seeds close
+  std::vector<uint8_t> free_cells(num_cells);
+  size_t num_rows = num_y * num_theta;
+  runCheckPathWorkers(num_rows, std::min(num_rows, check_paths_num_workers_), [&](CheckPathWorker* worker,
+                                                                                  size_t row) {
+    geometry_msgs::Pose2D pose2d;
+    geometry_msgs::Pose pose3d;
+    pose2d.y = y_min + (static_cast<double>(row % num_y) + 0.5) * req.resolution_trans;
+    pose2d.theta = static_cast<double>(row / num_y) * 2 * M_PI / static_cast<double>(num_theta);
+    check_path_states_.seed(worker->state);
+    auto state_valid = boost::bind(&PlanningIfaceBase::isStateValid, worker->planning_scene.get(), _1, _2, _3);
+
+    for (size_t i_x = 0; i_x < num_x; ++i_x)
+    {
+      pose2d.x = x_min + (static_cast<double>(i_x) + 0.5) * req.resolution_trans;
+      pose2dToPose3d(pose2d, &pose3d);
+      bool cell_free = worker->state->setFromIK(manip_joint_model_group_, pose3d,
+                                                manip_move_group_.getEndEffectorLink(), 0.0, state_valid);
+      free_cells[row * num_x + i_x] = static_cast<uint8_t>(cell_free);
+    }
+  });
+
+  resp->x_min = x_min;
+  resp->y_min = y_min;
+  resp->resolution_trans = req.resolution_trans;
+  resp->num_x = num_x;
+  resp->num_y = num_y;
+  resp->num_theta = num_theta;
+  resp->free_cells.assign((num_cells + 7) / 8, 0);
+  for (size_t i = 0; i < num_cells; ++i)
+  {
+    resp->free_cells[i / 8] |= static_cast<uint8_t>(free_cells[i] << (i % 8));
+  }
+
+  return RLLErrorCode::SUCCESS;
+}
+
+bool PlanningIfaceBase::getRoadmapSrv(rll_planning_project::GetRoadmap::Request& req,
+                                      rll_planning_project::GetRoadmap::Response& resp)
+{
+  RLLErrorCode error_code = beginQuery(get_roadmap_srv_);
+  RLLErrorCode roadmap_error_code = RLLErrorCode::SUCCESS;
+
+  if (error_code.succeeded())
+  {
+    roadmap_error_code = getRoadmap(req, &resp);
+  }
+
+  error_code = endQuery(get_roadmap_srv_, error_code);
+  if (error_code.failed())
+  {
+    ROS_INFO("getRoadmapSrv call failed with: %s", error_code.message());
+  }
+
+  error_code = error_code.determineWorse(roadmap_error_code);
+  resp.success = error_code.succeededSrv();
+  resp.error_code = error_code.value();
+
+  return true;
+}
+
+RLLErrorCode PlanningIfaceBase::getRoadmap(const rll_planning_project::GetRoadmap::Request& /*req*/,
+                                           rll_planning_project::GetRoadmap::Response* resp)
+{
+  std::vector<RoadmapStore::Edge> edges;
+  roadmap_store_.edges(&edges);
+
+  // the edges share their end poses, each quantized pose becomes one node
+  std::map<std::array<double, 3>, uint32_t> node_indices;
+  auto node_index = [&](const geometry_msgs::Pose2D& pose) {
+    auto inserted = node_indices.emplace(std::array<double, 3>{ pose.x, pose.y, pose.theta }, resp->nodes.size());
+    if (inserted.second)
+    {
+      resp->nodes.push_back(pose);
+    }
+    return inserted.first->second;
+  };
+
+  resp->edges_start.reserve(edges.size());
+  resp->edges_goal.reserve(edges.size());
+  resp->edges_success.reserve(edges.size());
+  resp->edges_error_code.reserve(edges.size());
+  for (const auto& edge : edges)
+  {
+    RLLErrorCode edge_error_code = edge.error_code;
+    resp->edges_start.push_back(node_index(edge.start));
+    resp->edges_goal.push_back(node_index(edge.goal));
+    resp->edges_success.push_back(edge_error_code.succeededSrv());
+    resp->edges_error_code.push_back(edge_error_code.value());
+  }
+
+  ROS_INFO("returning a roadmap with %lu nodes and %lu edges", resp->nodes.size(), edges.size());
+  return RLLErrorCode::SUCCESS;
+}
+
+bool PlanningIfaceBase::getMazeExtents(double* x_min, double* x_max, double* y_min, double* y_max)
+{
+  std::string collision_link;
+  ros::param::get(node_name_ + "/collision_link", collision_link);
+  const robot_model::LinkModel* maze_link = manip_model_->getLinkModel(collision_link);
+  if (maze_link == nullptr || maze_link->getShapes().empty())
+  {
+    ROS_WARN("no collision geometry for the maze available, cannot determine the grid area");
+    return false;
+  }
+  if (!check_path_states_.isSet())
+  {
+    ROS_WARN("no start state available, cannot determine the grid area");
+    return false;
+  }
+
+  // axis-aligned bounding box of the maze's collision geometry in the planning frame
+  const robot_state::RobotState& state = check_path_states_.reference();
+  Eigen::Vector3d center = state.getGlobalLinkTransform(maze_link) * maze_link->getCenteredBoundingBoxOffset();
+  Eigen::Vector3d extents =
+      state.getGlobalLinkTransform(maze_link).linear().cwiseAbs() * maze_link->getShapeExtentsAtOrigin();
+  *x_min = center.x() - extents.x() / 2;
+  *x_max = center.x() + extents.x() / 2;
+  *y_min = center.y() - extents.y() / 2;
+  *y_max = center.y() + extents.y() / 2;
+
+  return true;
+}
+
+RLLErrorCode PlanningIfaceBase::checkPathCached(const rll_planning_project::CheckPath::Request& req)
+{
+  RLLErrorCode error_code;
+  if (lookupCheckedPath(req.pose_start, req.pose_goal, &error_code))
+  {
+    return error_code;
+  }
+
+  error_code = checkPath(req);
+  storeCheckedPath(req.pose_start, req.pose_goal, error_code);
+  return error_code;
+}
+
+bool PlanningIfaceBase::lookupCheckedPath(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+                                          RLLErrorCode* error_code)
+{
+  if (check_path_cache_.lookup(start, goal, error_code))
+  {
+    return true;
+  }
+
+  if (!roadmap_store_.lookup(start, goal, error_code))
+  {
+    return false;
+  }
+
+  check_path_cache_.insert(start, goal, *error_code);
+  return true;
+}
+
+void PlanningIfaceBase::storeCheckedPath(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+                                         RLLErrorCode error_code)
+{
+  check_path_cache_.insert(start, goal, error_code);
+  roadmap_store_.insert(start, goal, error_code);
+}
+
+RLLErrorCode PlanningIfaceBase::checkPath(const rll_planning_project::CheckPath::Request& req)
+{
+  geometry_msgs::Pose pose3d_start;
+  std::vector<geometry_msgs::Pose> waypoints;
+  moveit_msgs::RobotTrajectory trajectory;
+
+  // always seed the IK with the job's start state so that the result does not depend on earlier requests
+  RobotStatePool::Handle state = check_path_states_.acquire();
+  if (check_path_local_)
+  {
+    // concurrent check_path calls must not read the scene while the monitor updates it
+    planning_scene::PlanningScenePtr planning_scene = clonePlanningScene();
+    return checkPathLocal(req, state.get(), *planning_scene);
+  }
+
+  RLLErrorCode error_code = checkPathWaypoints(req, &pose3d_start, &waypoints);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  bool start_pose_valid =
+      state->setFromIK(manip_joint_model_group_, pose3d_start, manip_move_group_.getEndEffectorLink());
+
+  if (!start_pose_valid)
+  {
+    return RLLErrorCode::INVALID_INPUT;
+  }
+
+  double achieved;
+  {
+    std::lock_guard<std::mutex> lock(check_path_move_group_mutex_);
+    check_path_move_group_->setStartState(*state);
+    achieved = check_path_move_group_->computeCartesianPath(waypoints, DEFAULT_LINEAR_EEF_STEP,
+                                                           DEFAULT_LINEAR_JUMP_THRESHOLD, trajectory);
+  }
+  if (achieved < 1)
+  {
+    return RLLErrorCode::PROJECT_SPECIFIC_INVALID_2;
+  }
+
+  if (trajectory.joint_trajectory.points.size() < LINEAR_MIN_STEPS_FOR_JUMP_THRESH)
+  {
+    ROS_ERROR("trajectory has not enough points to check for continuity, only got %lu",
+              trajectory.joint_trajectory.points.size());
+    return RLLErrorCode::PROJECT_SPECIFIC_INVALID_1;
+  }
+
+  return RLLErrorCode::SUCCESS;
+}
+
+RLLErrorCode PlanningIfaceBase::checkPathLocal(const rll_planning_project::CheckPath::Request& req,
+                                               robot_state::RobotState* start_state,
+                                               const planning_scene::PlanningScene& planning_scene)
+{
+  geometry_msgs::Pose pose3d_start;
+  std::vector<geometry_msgs::Pose> waypoints;
+
+  RLLErrorCode error_code = checkPathWaypoints(req, &pose3d_start, &waypoints);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  if (!start_state->setFromIK(manip_joint_model_group_, pose3d_start, manip_move_group_.getEndEffectorLink()))
+  {
+    return RLLErrorCode::INVALID_INPUT;
+  }
+
+  // the interpolation takes care of pure rotations, only the goal is needed
+  robot_trajectory::RobotTrajectory trajectory(manip_model_, manip_joint_model_group_->getName());
+  error_code = computeLinearPath(*start_state, waypoints.back(), planning_scene, &trajectory);
+  if (error_code == RLLErrorCode::TOO_FEW_WAYPOINTS)
+  {
+    return RLLErrorCode::PROJECT_SPECIFIC_INVALID_1;
+  }
+  if (error_code.failed() && error_code.isNonCriticalFailure())
+  {
+    return RLLErrorCode::PROJECT_SPECIFIC_INVALID_2;
+  }
+
+  return error_code;
+}
+
+bool PlanningIfaceBase::replayServiceCall(const RLLJobLogReader::Record& record,
+                                          const planning_scene::PlanningScene& planning_scene,
+                                          const robot_state::RobotState& start_state,
+                                          const robot_state::RobotState& job_start_state, bool* matches)
+{
+  // the checks are always replayed in-process and without the cache, seeded with the job's start state
+  if (record.name == ros::message_traits::DataType<rll_planning_project::CheckPath::Request>::value())
+  {
+    rll_planning_project::CheckPath::Request req;
+    if (!RLLJobLogReader::deserializeRequest(record, &req))
+    {
+      return false;
+    }
+
+    robot_state::RobotState state = job_start_state;
+    RLLErrorCode error_code = checkPathLocal(req, &state, planning_scene);
+    *matches = replayMatches(record.header->error_code, error_code);
+    return true;
+  }
+
+  if (record.name == ros::message_traits::DataType<rll_planning_project::CheckPaths::Request>::value())
+  {
+    rll_planning_project::CheckPaths::Request req;
+    rll_planning_project::CheckPaths::Response resp;
+    if (!RLLJobLogReader::deserializeRequest(record, &req) || !RLLJobLogReader::deserializeResponse(record, &resp))
+    {
+      return false;
+    }
+
+    // rejected requests have no edge results
+    size_t num_edges = req.poses_start.size();
+    if (req.poses_goal.size() != num_edges || resp.edges_error_code.size() != num_edges)
+    {
+      return false;
+    }
+
+    rll_planning_project::CheckPath::Request edge_req;
+    *matches = true;
+    for (size_t i = 0; i < num_edges; ++i)
+    {
+      edge_req.pose_start = req.poses_start[i];
+      edge_req.pose_goal = req.poses_goal[i];
+      robot_state::RobotState state = job_start_state;
+      RLLErrorCode error_code = checkPathLocal(edge_req, &state, planning_scene);
+      *matches = replayMatches(resp.edges_error_code[i], error_code) && *matches;
+    }
+    return true;
+  }
+
+  return RLLMoveIfaceBase::replayServiceCall(record, planning_scene, start_state, job_start_state, matches);
+}
+
+RLLErrorCode PlanningIfaceBase::checkPathWaypoints(const rll_planning_project::CheckPath::Request& req,
+                                                   geometry_msgs::Pose* pose3d_start,
+                                                   std::vector<geometry_msgs::Pose>* waypoints)
+{
+  geometry_msgs::Pose pose3d_goal;
+  const double POSITIVE_ZERO = 1E-07;
+
+  // Note on error codes:
+  // PROJECT_SPECIFIC_INVALID_1: too little movement
+  // PROJECT_SPECIFIC_INVALID_2: no path
+
+  // enforce a lower bound for check_path requests to ensure that Moveit has enough waypoints
+  float move_dist = sqrt(pow(req.pose_start.x - req.pose_goal.x, 2) + pow(req.pose_start.y - req.pose_goal.y, 2));
+  float dist_rot = fabs(req.pose_start.theta - req.pose_goal.theta);
+  if ((move_dist < 0.005 && move_dist > POSITIVE_ZERO) || (move_dist <= POSITIVE_ZERO && dist_rot < 20 * M_PI / 180))
+  {
+    ROS_WARN("check path requests that cover a distance between 0 and 5 mm or sole rotations less than 20 degrees are "
+             "not supported!");
+    ROS_WARN("Moving distance would have been %f m", move_dist);
+    return RLLErrorCode::PROJECT_SPECIFIC_INVALID_1;
+  }
+
+  if (move_dist <= POSITIVE_ZERO)
+  {
+    // generate more points here to ensure that there are at least ten
+    // for the continuity check
+    float rot_step_size = (req.pose_start.theta - req.pose_goal.theta) / LINEAR_MIN_STEPS_FOR_JUMP_THRESH;
+    generateRotationWaypoints(req.pose_start, rot_step_size, waypoints);
+  }
+
+  pose2dToPose3d(req.pose_start, pose3d_start);
+  pose2dToPose3d(req.pose_goal, &pose3d_goal);
+  waypoints->push_back(pose3d_goal);
+
+  return RLLErrorCode::SUCCESS;
+}
+
+bool PlanningIfaceBase::checkGoalState()
+{
+  std::vector<geometry_msgs::Pose> waypoints;
+  geometry_msgs::Pose2D pose2d_cur;
+  moveit_msgs::RobotTrajectory trajectory;
+  const double EEF_STEP = 0.0001;
+  rll_msgs::PickPlace::Request pick_place_req;
+  rll_msgs::PickPlace::Response pick_place_resp;
+  rll_msgs::MoveLin::Request move_lin_req;
+  rll_msgs::MoveLin::Response move_lin_resp;
+  float dist_goal_trans, diff_goal_angle;
+  RLLErrorCode error_code;
+
+  // check if we are close enough to the goal
+  diffCurrentState(goal_pose_2d_, &dist_goal_trans, &diff_goal_angle, &pose2d_cur);
+
+  if (dist_goal_trans < GOAL_TOLERANCE_TRANS && diff_goal_angle < GOAL_TOLERANCE_ROT)
+  {
+    ROS_INFO("distance to goal: %f, orientation diff: %f", dist_goal_trans, diff_goal_angle);
+
+    geometry_msgs::Pose reset_above_goal = goal_pose_above_;
+    reset_above_goal.position.z = POSE_Z_ABOVE_MAZE;
+    waypoints.push_back(reset_above_goal);
+    double achieved =
+        manip_move_group_.computeCartesianPath(waypoints, EEF_STEP, DEFAULT_LINEAR_JUMP_THRESHOLD, trajectory);
+    if (achieved < 1)
+    {
+      ROS_WARN("You came close to the goal, but unfortunately, it's not reachable.\n");
+      grasp_object_at_goal_ = false;
+      return true;
+    }
+
+    ROS_INFO("Goal was reached, good job!\n");
+
+    // place the object at the goal
+    pick_place_req.pose_approach = goal_pose_above_;
+    pick_place_req.pose_retreat = goal_pose_above_;
+    pick_place_req.pose_grip = goal_pose_grip_;
+    pick_place_req.gripper_close = RLL_SRV_FALSE;
+    pick_place_req.grasp_object = grasp_object_.id;
+
+    error_code = pickPlace(pick_place_req, &pick_place_resp);
+    if (error_code.failed())
+    {
+      ROS_FATAL("Failed to place the grasp object at the goal!");
+      return false;
+    }
+
+    grasp_object_at_goal_ = true;
+
+    // move a little higher after placing the object
+    move_lin_req.pose = reset_above_goal;
+    error_code = moveLin(move_lin_req, &move_lin_resp);
+    if (error_code.failed())
+    {
+      ROS_FATAL("Moving above maze for reset to home failed");
+      return false;
+    }
+
+    error_code = resetToHome();
+    if (error_code.failed())
+    {
+      ROS_FATAL("Failed to reset to home from goal");
+      return false;
+    }
+  }
+  else
+  {
+    ROS_WARN("Goal was not reached");
+    ROS_WARN("distance to goal: %f, orientation diff: %f\n", dist_goal_trans, diff_goal_angle);
+    grasp_object_at_goal_ = false;
+  }
+
+  return true;
+}
+
+void PlanningIfaceBase::diffCurrentState(const geometry_msgs::Pose2D& pose_des, float* diff_trans, float* diff_rot,
+                                         geometry_msgs::Pose2D* pose2d_cur)
+{
+  geometry_msgs::Pose current_pose = getCurrentManipPose();
+
+  *diff_trans = sqrt(pow(current_pose.position.x - pose_des.x, 2) + pow(current_pose.position.y - pose_des.y, 2));
 
   tf::Quaternion q_current, q_orig, q_rot;
   // orientation of eef in home position
@@ -624,32 +1677,30 @@ void PlanningIfaceBase::diffCurrentState(const geometry_msgs::Pose2D& pose_des,
 
 RLLErrorCode PlanningIfaceBase::resetToStart()
 {
-  rll_msgs::MoveLin::Request move_lin_req;
-  rll_msgs::MoveLin::Response move_lin_resp;
-  rll_msgs::MovePTP::Request move_ptp_req;
-  rll_msgs::MovePTP::Response move_ptp_resp;
+  geometry_msgs::Pose pose_above_start;
   rll_msgs::PickPlace::Request pick_place_req;
-  rll_msgs::PickPlace::Response pick_place_resp;
-  geometry_msgs::Pose current_pose = manip_move_group_.getCurrentPose().pose;
+  geometry_msgs::Pose current_pose = getCurrentManipPose();
 
   // reset move command failed flag
+  resetMoveQueue();
   move_command_failed_ = false;
 
+  // The lift, the motion above the start pos and the pick place use the trajectory cache. They are fixed transitions
+  // after idle() picked up the grasp object at the goal, after a job the lift starts wherever the job ended.
   // set this a little higher to make sure we are moving above the maze
   current_pose.position.z = POSE_Z_ABOVE_MAZE;
-  move_lin_req.pose = current_pose;
-  RLLErrorCode error_code = moveLin(move_lin_req, &move_lin_resp);
+  RLLErrorCode error_code = moveToGoalLinear(current_pose, false, true);
   if (error_code.failed())
   {
     ROS_FATAL("Moving above maze for reset failed");
     return error_code;
   }
 
-  move_ptp_req.pose = start_pose_above_;
-  move_ptp_req.pose.position.z = POSE_Z_ABOVE_MAZE;
-  if (!poseGoalTooClose(move_ptp_req.pose))
+  pose_above_start = start_pose_above_;
+  pose_above_start.position.z = POSE_Z_ABOVE_MAZE;
+  if (!poseGoalTooClose(pose_above_start))
   {
-    error_code = movePTP(move_ptp_req, &move_ptp_resp);
+    error_code = moveToGoalPTP(pose_above_start, true);
     if (error_code.failed())
     {
       ROS_FATAL("Moving above start pos for reset failed");
@@ -665,7 +1716,7 @@ RLLErrorCode PlanningIfaceBase::resetToStart()
   pick_place_req.pose_grip = start_pose_grip_;
   pick_place_req.gripper_close = RLL_SRV_FALSE;
   pick_place_req.grasp_object = grasp_object_.id;
-  error_code = pickPlace(pick_place_req, &pick_place_resp);
+  error_code = runPickPlace(pick_place_req, true);
   if (error_code.failed())
   {
     ROS_FATAL("Failed to place the grasp object at the start pos");
@@ -718,16 +1769,59 @@ void PlanningIfaceBase::startServicesAndRunNode(ros::NodeHandle* nh)
                                           boost::bind(&RLLMoveIfaceBase::idleAction, iface_ptr, _1, &server_idle),
                                           false);
   server_idle.start();
-  ros::ServiceServer move = nh->advertiseService(MOVE_SRV_NAME, &PlanningIfaceBase::moveSrv, iface_ptr);
+
+  // Each class of services is served from its own callback queue, so that one class never waits for another:
+  // - motions are executed one at a time in the order they arrive, a single thread serves them
+  // - validity checks are served by several threads, concurrently with each other and with a motion in progress
+  // - read-only queries are answered by their own thread, even while all check threads are busy
+  // - the job control services stay on the global queue, so that job_finished is never blocked by a motion
+  ros::CallbackQueue motion_queue, check_queue, query_queue;
+  ros::NodeHandle motion_nh(*nh), check_nh(*nh), query_nh(*nh);
+  motion_nh.setCallbackQueue(&motion_queue);
+  check_nh.setCallbackQueue(&check_queue);
+  query_nh.setCallbackQueue(&query_queue);
+
+  PlanToGoalServer server_plan_to_goal(
+      motion_nh, PLAN_TO_GOAL_ACTION_NAME,
+      boost::bind(&PlanningIfaceBase::planToGoalAction, iface_ptr, _1, &server_plan_to_goal), false);
+  server_plan_to_goal.start();
+  ros::ServiceServer move = motion_nh.advertiseService(MOVE_SRV_NAME, &PlanningIfaceBase::moveSrv, iface_ptr);
+  ros::ServiceServer move_path =
+      motion_nh.advertiseService(MOVE_PATH_SRV_NAME, &PlanningIfaceBase::movePathSrv, iface_ptr);
+  ros::ServiceServer move_async =
+      motion_nh.advertiseService(MOVE_ASYNC_SRV_NAME, &PlanningIfaceBase::moveAsyncSrv, iface_ptr);
   ros::ServiceServer check_path =
-      nh->advertiseService(CHECK_PATH_SRV_NAME, &PlanningIfaceBase::checkPathSrv, iface_ptr);
+      check_nh.advertiseService(CHECK_PATH_SRV_NAME, &PlanningIfaceBase::checkPathSrv, iface_ptr);
+  ros::ServiceServer check_paths =
+      check_nh.advertiseService(CHECK_PATHS_SRV_NAME, &PlanningIfaceBase::checkPathsSrv, iface_ptr);
+  ros::ServiceServer get_cspace_grid =
+      check_nh.advertiseService(GET_CSPACE_GRID_SRV_NAME, &PlanningIfaceBase::getCSpaceGridSrv, iface_ptr);
+  ros::ServiceServer get_roadmap =
+      query_nh.advertiseService(GET_ROADMAP_SRV_NAME, &PlanningIfaceBase::getRoadmapSrv, iface_ptr);
   ros::ServiceServer get_start_goal =
-      nh->advertiseService(GET_START_GOAL_SRV_NAME, &PlanningIfaceBase::getStartGoalSrv, iface_ptr);
+      query_nh.advertiseService(GET_START_GOAL_SRV_NAME, &PlanningIfaceBase::getStartGoalSrv, iface_ptr);
+
+  ros::AsyncSpinner motion_spinner(1, &motion_queue);
+  ros::AsyncSpinner check_spinner(static_cast<uint32_t>(std::max(check_path_threads_, 1)), &check_queue);
+  ros::AsyncSpinner query_spinner(1, &query_queue);
+  motion_spinner.start();
+  check_spinner.start();
+  query_spinner.start();
+
   ros::ServiceServer robot_ready = nh->advertiseService(RLLMoveIfaceServices::ROBOT_READY_SRV_NAME,
                                                         &RLLMoveIfaceServices::robotReadySrv, move_iface_ptr);
   ros::ServiceServer job_finished =
       nh->advertiseService(RLLMoveIfaceBase::JOB_FINISHED_SRV_NAME, &RLLMoveIfaceBase::jobFinishedSrv, base_iface_ptr);
 
+  std::thread move_queue_thread(&PlanningIfaceBase::runMoveQueue, this);
+
   ROS_INFO("RLL Planning Interface started\n");
   ros::waitForShutdown();
+
+  {
+    std::lock_guard<std::mutex> lock(move_queue_mutex_);
+    move_queue_shutdown_ = true;
+  }
+  move_queue_cv_.notify_all();
+  move_queue_thread.join();
 }
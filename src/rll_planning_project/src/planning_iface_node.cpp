@@ -18,14 +18,27 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <rll_planning_project/planning_iface_kinematic.h>
 #include <rll_planning_project/planning_iface_simulation.h>
 
 int main(int argc, char** argv)
 {
   ros::init(argc, argv, "planning_iface");
   ros::NodeHandle nh;
-  PlanningIface iface(nh);
-  iface.startServicesAndRunNode(&nh);
+
+  bool kinematic_execution = false;
+  ros::param::get("~kinematic_execution", kinematic_execution);
+
+  if (kinematic_execution)
+  {
+    PlanningKinematicIface iface(nh);
+    iface.startServicesAndRunNode(&nh);
+  }
+  else
+  {
+    PlanningIface iface(nh);
+    iface.startServicesAndRunNode(&nh);
+  }
 
   return 0;
 }
@@ -0,0 +1,32 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * Copyright (C) 2018 Wolfgang Wiedmeyer <wolfgang.wiedmeyer@kit.edu>
+ * Copyright (C) 2019 Mark Weinreuter <uieai@student.kit.edu>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+
+#include <rll_move/job_replay.h>
+#include <rll_planning_project/planning_iface_simulation.h>
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "planning_job_replay");
+  return runJobReplay<PlanningIface>(argc, argv);
+}
+
+/*
+ * Local Variables:
+ * c-file-style: "google"
+ * End:
+ */
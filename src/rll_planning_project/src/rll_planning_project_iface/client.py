@@ -1,16 +1,28 @@
-from typing import Tuple  # pylint: disable=unused-import
+from typing import List, Tuple  # pylint: disable=unused-import
+import actionlib
 import rospy
 from geometry_msgs.msg import Pose2D  # pylint: disable=unused-import
 from rll_move_client.client import RLLBasicMoveClient, RLLMoveClientListener
 from rll_move_client.error import RLLErrorCode
 from rll_move_client.formatting import override_formatting_for_ros_types
-from rll_planning_project.srv import CheckPath, GetStartGoal, Move
+from rll_planning_project.srv import (CheckPath, CheckPaths, GetCSpaceGrid,
+                                      GetRoadmap, GetStartGoal, Move,
+                                      MovePath)
+from rll_planning_project.srv import GetCSpaceGridResponse  # pylint: disable=unused-import
+from rll_planning_project.srv import GetRoadmapResponse  # pylint: disable=unused-import
+from rll_planning_project.msg import PlanToGoalAction, PlanToGoalGoal
 
 
 class RLLPlanningProjectClient(RLLBasicMoveClient, RLLMoveClientListener):
     CHECK_PATH_SRV_NAME = "check_path"
+    CHECK_PATHS_SRV_NAME = "check_paths"
+    GET_CSPACE_GRID_SRV_NAME = "get_cspace_grid"
+    GET_ROADMAP_SRV_NAME = "get_roadmap"
     GET_START_GOAL_SRV_NAME = "get_start_goal"
     MOVE_SRV_NAME = "move"
+    MOVE_PATH_SRV_NAME = "move_path"
+    MOVE_ASYNC_SRV_NAME = "move_async"
+    PLAN_TO_GOAL_ACTION_NAME = "plan_to_goal"
 
     def __init__(self, execute=None, verbose=True):
         self.verbose = verbose
@@ -20,8 +32,17 @@ class RLLPlanningProjectClient(RLLBasicMoveClient, RLLMoveClientListener):
         self.get_start_goal_srv = rospy.ServiceProxy('get_start_goal',
                                                      GetStartGoal)
         self.move_srv = rospy.ServiceProxy('move', Move)
+        self.move_path_srv = rospy.ServiceProxy('move_path', MovePath)
+        self.move_async_srv = rospy.ServiceProxy('move_async', Move)
         self.check_srv = rospy.ServiceProxy(
             'check_path', CheckPath, persistent=True)
+        self.check_paths_srv = rospy.ServiceProxy(
+            'check_paths', CheckPaths, persistent=True)
+        self.get_cspace_grid_srv = rospy.ServiceProxy('get_cspace_grid',
+                                                      GetCSpaceGrid)
+        self.get_roadmap_srv = rospy.ServiceProxy('get_roadmap', GetRoadmap)
+        self.plan_to_goal_client = actionlib.SimpleActionClient(
+            'plan_to_goal', PlanToGoalAction)
 
         RLLErrorCode.set_error_code_details(
             RLLErrorCode.PROJECT_SPECIFIC_RECOVERABLE_1,
@@ -50,6 +71,27 @@ class RLLPlanningProjectClient(RLLBasicMoveClient, RLLMoveClientListener):
             self._handle_response_error_code,
             pose)
 
+    def move_async(self, pose):
+        # type: (Pose2D) -> bool
+        """Queue a move and return before it is executed.
+
+        A failure of a queued move is reported by the next move call."""
+        return self._call_service_with_error_check(
+            self.move_async_srv,
+            self.MOVE_ASYNC_SRV_NAME,
+            "%s requested with: %s",
+            self._handle_response_error_code,
+            pose)
+
+    def move_path(self, poses):
+        # type: (List[Pose2D]) -> bool
+        return self._call_service_with_error_check(
+            self.move_path_srv,
+            self.MOVE_PATH_SRV_NAME,
+            "%s requested with: %s",
+            self._handle_response_error_code,
+            poses)
+
     def get_start_goal(self, ):
         # type: () -> Tuple[Pose2D, Pose2D]
 
@@ -70,3 +112,64 @@ class RLLPlanningProjectClient(RLLBasicMoveClient, RLLMoveClientListener):
             self.check_srv, self.CHECK_PATH_SRV_NAME,
             "%s requested from '%s' to '%s'", self._handle_response_error_code,
             pose_a, pose_b)
+
+    def check_paths(self, poses_start, poses_goal):
+        # type: (List[Pose2D], List[Pose2D]) -> List[bool]
+
+        def handle_return_values(resp):
+            return [bool(success) for success in resp.edges_success]
+
+        return self._call_service_with_error_check(
+            self.check_paths_srv, self.CHECK_PATHS_SRV_NAME,
+            "%s requested from '%s' to '%s'",
+            self._handle_resp_with_values(handle_return_values),
+            poses_start, poses_goal)
+
+    def get_cspace_grid(self, resolution_trans, num_theta_bins, x_min=0,
+                        x_max=0, y_min=0, y_max=0):
+        # type: (float, int, float, float, float, float) -> GetCSpaceGridResponse
+
+        def handle_return_values(resp):
+            return resp
+
+        return self._call_service_with_error_check(
+            self.get_cspace_grid_srv, self.GET_CSPACE_GRID_SRV_NAME,
+            "%s requested for x in [%s, %s), y in [%s, %s), resolution %s "
+            "and %s orientations",
+            self._handle_resp_with_values(handle_return_values),
+            x_min, x_max, y_min, y_max, resolution_trans, num_theta_bins)
+
+    def get_roadmap(self):
+        # type: () -> GetRoadmapResponse
+        """Return the edges validated so far in this scene.
+
+        If the interface persists its roadmap, this includes the edges of
+        earlier runs and jobs."""
+
+        def handle_return_values(resp):
+            return resp
+
+        return self._call_service_with_error_check(
+            self.get_roadmap_srv, self.GET_ROADMAP_SRV_NAME, "%s requested",
+            self._handle_resp_with_values(handle_return_values))
+
+    def plan_to_goal_native(self, start, goal):
+        # type: (Pose2D, Pose2D) -> List[Pose2D]
+        """Plan and execute a path with the planner built into the interface.
+
+        Returns the executed path or None on failure."""
+
+        def send_goal(start, goal):
+            self.plan_to_goal_client.wait_for_server()
+            self.plan_to_goal_client.send_goal_and_wait(
+                PlanToGoalGoal(start=start, goal=goal))
+            return self.plan_to_goal_client.get_result()
+
+        def handle_return_values(resp):
+            return resp.path
+
+        return self._call_service_with_error_check(
+            send_goal, self.PLAN_TO_GOAL_ACTION_NAME,
+            "%s requested from '%s' to '%s'",
+            self._handle_resp_with_values(handle_return_values),
+            start, goal)
@@ -0,0 +1,306 @@
+/*
+ * This file is part of the Robot Learning Lab Path Planning Project
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+#include <ros/console.h>
+
+#include <rll_planning_project/roadmap_store.h>
+
+const char RoadmapStore::MAGIC[8] = { 'R', 'L', 'L', 'R', 'O', 'A', 'D', 'M' };
+const uint32_t RoadmapStore::VERSION;
+
+struct RoadmapStore::FileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t scene_hash;
+  double resolution_trans;
+  double resolution_rot;
+  uint64_t capacity;
+  uint64_t size;
+};
+
+namespace
+{
+// new edges are rejected above this load, the linear probing gets slow for fuller tables
+const double MAX_LOAD_FACTOR = 0.75;
+}  // namespace
+
+RoadmapStore::~RoadmapStore()
+{
+  close();
+}
+
+bool RoadmapStore::open(const std::string& file_name, uint64_t scene_hash, double resolution_trans,
+                        double resolution_rot, size_t capacity)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  closeLocked();
+
+  fd_ = ::open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0)
+  {
+    ROS_ERROR("failed to open the roadmap %s: %s", file_name.c_str(), std::strerror(errno));
+    return false;
+  }
+
+  if (flock(fd_, LOCK_EX | LOCK_NB) != 0)
+  {
+    ROS_WARN("roadmap %s is used by another process", file_name.c_str());
+    closeLocked();
+    return false;
+  }
+
+  struct stat file_stat = {};
+  if (fstat(fd_, &file_stat) != 0)
+  {
+    ROS_ERROR("failed to stat the roadmap %s: %s", file_name.c_str(), std::strerror(errno));
+    closeLocked();
+    return false;
+  }
+
+  // an existing file is only reused if it was written for the same scene and quantization
+  FileHeader file_header = {};
+  auto file_size = static_cast<size_t>(file_stat.st_size);
+  bool reuse = file_size >= sizeof(FileHeader) &&
+               pread(fd_, &file_header, sizeof(FileHeader), 0) == static_cast<ssize_t>(sizeof(FileHeader)) &&
+               std::memcmp(file_header.magic, MAGIC, sizeof(MAGIC)) == 0 && file_header.version == VERSION &&
+               file_header.scene_hash == scene_hash && file_header.resolution_trans == resolution_trans &&
+               file_header.resolution_rot == resolution_rot && file_header.capacity > 0 &&
+               file_size == sizeof(FileHeader) + file_header.capacity * sizeof(Entry);
+
+  if (!reuse)
+  {
+    std::memset(&file_header, 0, sizeof(FileHeader));
+    std::memcpy(file_header.magic, MAGIC, sizeof(MAGIC));
+    file_header.version = VERSION;
+    file_header.scene_hash = scene_hash;
+    file_header.resolution_trans = resolution_trans;
+    file_header.resolution_rot = resolution_rot;
+    file_header.capacity = std::max<size_t>(capacity, 1);
+    file_size = sizeof(FileHeader) + file_header.capacity * sizeof(Entry);
+
+    // truncating first zeroes all entries of an outdated roadmap
+    if (ftruncate(fd_, 0) != 0 || ftruncate(fd_, static_cast<off_t>(file_size)) != 0 ||
+        pwrite(fd_, &file_header, sizeof(FileHeader), 0) != static_cast<ssize_t>(sizeof(FileHeader)))
+    {
+      ROS_ERROR("failed to initialize the roadmap %s: %s", file_name.c_str(), std::strerror(errno));
+      closeLocked();
+      return false;
+    }
+  }
+
+  void* mapping = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (mapping == MAP_FAILED)
+  {
+    ROS_ERROR("failed to map the roadmap %s: %s", file_name.c_str(), std::strerror(errno));
+    closeLocked();
+    return false;
+  }
+
+  data_ = static_cast<uint8_t*>(mapping);
+  mapped_size_ = file_size;
+  header_ = reinterpret_cast<FileHeader*>(data_);
+  entries_ = reinterpret_cast<Entry*>(data_ + sizeof(FileHeader));
+  resolution_trans_ = resolution_trans;
+  resolution_rot_ = resolution_rot;
+  full_warned_ = false;
+
+  ROS_INFO("%s roadmap %s with %lu edges", reuse ? "reusing" : "created", file_name.c_str(), header_->size);
+  return true;
+}
+
+void RoadmapStore::close()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  closeLocked();
+}
+
+void RoadmapStore::closeLocked()
+{
+  if (data_ != nullptr)
+  {
+    // the kernel writes the shared mapping back, even if the process is killed later on
+    munmap(data_, mapped_size_);
+    data_ = nullptr;
+    header_ = nullptr;
+    entries_ = nullptr;
+    mapped_size_ = 0;
+  }
+
+  if (fd_ >= 0)
+  {
+    // closing the file releases the lock
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool RoadmapStore::isOpen()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return data_ != nullptr;
+}
+
+bool RoadmapStore::lookup(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+                          RLLErrorCode* error_code)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (data_ == nullptr)
+  {
+    return false;
+  }
+
+  Entry* entry = find(key(start, goal));
+  if (entry == nullptr || entry->used == 0)
+  {
+    return false;
+  }
+
+  ++hits_;
+  *error_code = static_cast<RLLErrorCode::Code>(entry->error_code);
+  return true;
+}
+
+void RoadmapStore::insert(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal,
+                          RLLErrorCode error_code)
+{
+  if (error_code.isCriticalFailure())
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (data_ == nullptr)
+  {
+    return;
+  }
+
+  Key edge_key = key(start, goal);
+  Entry* entry = find(edge_key);
+  if (entry != nullptr && entry->used != 0)
+  {
+    entry->error_code = error_code.value();
+    return;
+  }
+
+  if (entry == nullptr || header_->size + 1 > MAX_LOAD_FACTOR * header_->capacity)
+  {
+    if (!full_warned_)
+    {
+      ROS_WARN("roadmap is full with %lu edges, new edges are not stored", header_->size);
+      full_warned_ = true;
+    }
+    return;
+  }
+
+  // the entry is marked as used last, so that a partially written entry is never read
+  entry->key = edge_key;
+  entry->error_code = error_code.value();
+  entry->used = 1;
+  ++header_->size;
+}
+
+void RoadmapStore::edges(std::vector<Edge>* edges)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  edges->clear();
+  if (data_ == nullptr)
+  {
+    return;
+  }
+
+  edges->reserve(header_->size);
+  for (size_t i = 0; i < header_->capacity; ++i)
+  {
+    const Entry& entry = entries_[i];
+    if (entry.used == 0)
+    {
+      continue;
+    }
+
+    Edge edge;
+    edge.start.x = entry.key[0] * resolution_trans_;
+    edge.start.y = entry.key[1] * resolution_trans_;
+    edge.start.theta = entry.key[2] * resolution_rot_;
+    edge.goal.x = entry.key[3] * resolution_trans_;
+    edge.goal.y = entry.key[4] * resolution_trans_;
+    edge.goal.theta = entry.key[5] * resolution_rot_;
+    edge.error_code = static_cast<RLLErrorCode::Code>(entry.error_code);
+    edges->push_back(edge);
+  }
+}
+
+size_t RoadmapStore::size()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return data_ != nullptr ? header_->size : 0;
+}
+
+uint64_t RoadmapStore::hits()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+void RoadmapStore::resetCounters()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  hits_ = 0;
+}
+
+RoadmapStore::Key RoadmapStore::key(const geometry_msgs::Pose2D& start, const geometry_msgs::Pose2D& goal) const
+{
+  auto quantize = [](double value, double resolution) { return static_cast<int32_t>(std::lround(value / resolution)); };
+  return Key{ quantize(start.x, resolution_trans_), quantize(start.y, resolution_trans_),
+              quantize(start.theta, resolution_rot_), quantize(goal.x, resolution_trans_),
+              quantize(goal.y, resolution_trans_),   quantize(goal.theta, resolution_rot_) };
+}
+
+RoadmapStore::Entry* RoadmapStore::find(const Key& key)
+{
+  // same mixing as boost::hash_combine, the slot must not depend on the process, std::hash<int32_t> is the identity
+  uint64_t seed = 0;
+  for (int32_t value : key)
+  {
+    seed ^= static_cast<uint64_t>(static_cast<uint32_t>(value)) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  }
+
+  // linear probing, returns the matching entry or the free slot the key would be inserted at
+  size_t capacity = header_->capacity;
+  for (size_t i = 0; i < capacity; ++i)
+  {
+    Entry* entry = &entries_[(seed + i) % capacity];
+    if (entry->used == 0 || entry->key == key)
+    {
+      return entry;
+    }
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <rll_planning_project/check_path_cache.h>
+
+namespace
+{
+geometry_msgs::Pose2D pose2D(double x, double y, double theta)
+{
+  geometry_msgs::Pose2D pose;
+  pose.x = x;
+  pose.y = y;
+  pose.theta = theta;
+  return pose;
+}
+}  // namespace
+
+TEST(CheckPathCacheTest, testQuantization)
+{
+  CheckPathCache cache(0.001, 0.01);
+  cache.insert(pose2D(0.1, 0.2, 0.5), pose2D(0.3, 0.2, 0.5), RLLErrorCode::SUCCESS);
+  EXPECT_EQ(cache.size(), 1u);
+
+  // numerical noise below half the resolution shares the entry
+  RLLErrorCode error_code;
+  ASSERT_TRUE(cache.lookup(pose2D(0.1004, 0.1996, 0.504), pose2D(0.3, 0.2004, 0.496), &error_code));
+  EXPECT_EQ(error_code.value(), RLLErrorCode::SUCCESS);
+
+  // a difference of one resolution step in any component is a different edge
+  EXPECT_FALSE(cache.lookup(pose2D(0.101, 0.2, 0.5), pose2D(0.3, 0.2, 0.5), &error_code));
+  EXPECT_FALSE(cache.lookup(pose2D(0.1, 0.2, 0.5), pose2D(0.3, 0.199, 0.5), &error_code));
+  EXPECT_FALSE(cache.lookup(pose2D(0.1, 0.2, 0.51), pose2D(0.3, 0.2, 0.5), &error_code));
+  // start and goal are not interchangeable
+  EXPECT_FALSE(cache.lookup(pose2D(0.3, 0.2, 0.5), pose2D(0.1, 0.2, 0.5), &error_code));
+
+  EXPECT_EQ(cache.hits(), 1u);
+  EXPECT_EQ(cache.misses(), 4u);
+  cache.resetCounters();
+  EXPECT_EQ(cache.hits(), 0u);
+  EXPECT_EQ(cache.misses(), 0u);
+}
+
+TEST(CheckPathCacheTest, testRoundingAroundZero)
+{
+  CheckPathCache cache(0.001, 0.01);
+  cache.insert(pose2D(-0.0004, 0.0004, -0.004), pose2D(0.0, 0.0, 0.0), RLLErrorCode::PROJECT_SPECIFIC_INVALID_1);
+
+  // values on both sides of zero are rounded to the same cell
+  RLLErrorCode error_code;
+  ASSERT_TRUE(cache.lookup(pose2D(0.0004, -0.0004, 0.004), pose2D(-0.0, 0.0001, -0.0001), &error_code));
+  EXPECT_EQ(error_code.value(), RLLErrorCode::PROJECT_SPECIFIC_INVALID_1);
+
+  // negative values are rounded to the nearest cell and not towards zero
+  cache.insert(pose2D(-0.0016, 0.0, 0.0), pose2D(0.0, 0.0, 0.0), RLLErrorCode::SUCCESS);
+  EXPECT_FALSE(cache.lookup(pose2D(-0.001, 0.0, 0.0), pose2D(0.0, 0.0, 0.0), &error_code));
+  EXPECT_TRUE(cache.lookup(pose2D(-0.002, 0.0, 0.0), pose2D(0.0, 0.0, 0.0), &error_code));
+}
+
+TEST(CheckPathCacheTest, testUpdateAndCriticalFailures)
+{
+  CheckPathCache cache;
+  geometry_msgs::Pose2D start = pose2D(0.1, 0.2, 0.0);
+  geometry_msgs::Pose2D goal = pose2D(0.3, 0.2, 0.0);
+
+  // critical failures depend on the state of the interface and are never cached
+  cache.insert(start, goal, RLLErrorCode::INTERNAL_ERROR);
+  RLLErrorCode error_code;
+  EXPECT_FALSE(cache.lookup(start, goal, &error_code));
+  EXPECT_EQ(cache.size(), 0u);
+
+  cache.insert(start, goal, RLLErrorCode::SUCCESS);
+  cache.insert(start, goal, RLLErrorCode::PROJECT_SPECIFIC_INVALID_1);
+  EXPECT_EQ(cache.size(), 1u);
+  ASSERT_TRUE(cache.lookup(start, goal, &error_code));
+  EXPECT_EQ(error_code.value(), RLLErrorCode::PROJECT_SPECIFIC_INVALID_1);
+
+  cache.clear();
+  EXPECT_FALSE(cache.lookup(start, goal, &error_code));
+}
+
+TEST(CheckPathCacheTest, testSetResolution)
+{
+  CheckPathCache cache(0.001, 0.01);
+  geometry_msgs::Pose2D start = pose2D(0.1, 0.2, 0.0);
+  cache.insert(start, pose2D(0.3, 0.2, 0.0), RLLErrorCode::SUCCESS);
+
+  // changing the resolution invalidates all keys
+  cache.setResolution(0.01, 0.1);
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_DOUBLE_EQ(cache.resolutionTrans(), 0.01);
+  EXPECT_DOUBLE_EQ(cache.resolutionRot(), 0.1);
+
+  cache.insert(start, pose2D(0.3, 0.2, 0.0), RLLErrorCode::SUCCESS);
+  RLLErrorCode error_code;
+  EXPECT_TRUE(cache.lookup(start, pose2D(0.304, 0.2, 0.04), &error_code));
+}
@@ -0,0 +1,187 @@
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+#include <rll_planning_project/lattice_planner.h>
+
+namespace
+{
+geometry_msgs::Pose2D pose2D(double x, double y, double theta)
+{
+  geometry_msgs::Pose2D pose;
+  pose.x = x;
+  pose.y = y;
+  pose.theta = theta;
+  return pose;
+}
+
+void acceptAll(const std::vector<LatticePlanner::Edge>& edges, std::vector<bool>* valid)
+{
+  valid->assign(edges.size(), true);
+}
+
+bool isGoalEdge(const LatticePlanner::Edge& edge, const geometry_msgs::Pose2D& goal)
+{
+  return std::fabs(edge.goal.x - goal.x) < 1E-09 && std::fabs(edge.goal.y - goal.y) < 1E-09;
+}
+}  // namespace
+
+TEST(LatticePlannerTest, testNegativeIndices)
+{
+  // the node keys pack negative lattice indices with an offset, they have to survive the round trip
+  LatticePlanner planner(acceptAll, LatticePlanner::Options());
+  std::vector<geometry_msgs::Pose2D> path;
+  ASSERT_TRUE(planner.plan(pose2D(0.0, 0.0, 0.0), pose2D(-0.15, -0.1, 0.0), &path));
+  ASSERT_FALSE(path.empty());
+  EXPECT_NEAR(path.back().x, -0.15, 1E-09);
+  EXPECT_NEAR(path.back().y, -0.1, 1E-09);
+  EXPECT_NEAR(path.back().theta, 0.0, 1E-09);
+
+  for (const auto& pose : path)
+  {
+    EXPECT_LE(pose.x, 1E-09);
+    EXPECT_LE(pose.y, 1E-09);
+  }
+}
+
+TEST(LatticePlannerTest, testRotations)
+{
+  LatticePlanner planner(acceptAll, LatticePlanner::Options());
+  std::vector<geometry_msgs::Pose2D> path;
+  ASSERT_TRUE(planner.plan(pose2D(0.1, -0.2, 0.0), pose2D(0.1, -0.2, M_PI), &path));
+
+  // two rotations by 90 degrees on the spot, rotations are never merged
+  ASSERT_EQ(path.size(), 2u);
+  EXPECT_NEAR(std::fabs(std::remainder(path[0].theta, M_PI)), M_PI / 2, 1E-09);
+  EXPECT_NEAR(path[1].theta, M_PI, 1E-09);
+  for (const auto& pose : path)
+  {
+    EXPECT_NEAR(pose.x, 0.1, 1E-09);
+    EXPECT_NEAR(pose.y, -0.2, 1E-09);
+  }
+}
+
+TEST(LatticePlannerTest, testGoalConnection)
+{
+  // the goal is off the lattice, it is reached with an additional edge from a nearby node
+  geometry_msgs::Pose2D goal = pose2D(0.12, 0.03, -0.3);
+  std::vector<LatticePlanner::Edge> goal_edges;
+  auto edge_checker = [&](const std::vector<LatticePlanner::Edge>& edges, std::vector<bool>* valid) {
+    ASSERT_EQ(valid->size(), edges.size());
+    valid->assign(edges.size(), true);
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+      if (isGoalEdge(edges[i], goal))
+      {
+        // the goal connection is always the first edge of a batch
+        EXPECT_EQ(i, 0u);
+        goal_edges.push_back(edges[i]);
+      }
+    }
+  };
+
+  LatticePlanner planner(edge_checker, LatticePlanner::Options());
+  std::vector<geometry_msgs::Pose2D> path;
+  ASSERT_TRUE(planner.plan(pose2D(0.0, 0.0, 0.0), goal, &path));
+  ASSERT_FALSE(path.empty());
+  EXPECT_DOUBLE_EQ(path.back().x, 0.12);
+  EXPECT_DOUBLE_EQ(path.back().y, 0.03);
+  // the returned goal orientation is normalized
+  EXPECT_NEAR(path.back().theta, 2 * M_PI - 0.3, 1E-09);
+
+  // the goal edge rotates along the shorter direction
+  ASSERT_EQ(goal_edges.size(), 1u);
+  EXPECT_NEAR(goal_edges[0].goal.theta - goal_edges[0].start.theta, -0.3, 1E-09);
+}
+
+TEST(LatticePlannerTest, testRejectedGoalConnection)
+{
+  geometry_msgs::Pose2D goal = pose2D(0.12, 0.03, 0.0);
+  size_t num_goal_edges = 0;
+  auto edge_checker = [&](const std::vector<LatticePlanner::Edge>& edges, std::vector<bool>* valid) {
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+      bool goal_edge = isGoalEdge(edges[i], goal);
+      num_goal_edges += goal_edge ? 1 : 0;
+      (*valid)[i] = !goal_edge;
+    }
+  };
+
+  LatticePlanner::Options options;
+  options.x_min = -0.1;
+  options.x_max = 0.25;
+  options.y_min = -0.1;
+  options.y_max = 0.2;
+  LatticePlanner planner(edge_checker, options);
+  std::vector<geometry_msgs::Pose2D> path;
+
+  // every node near the goal tries to connect, the bounded lattice is exhausted afterwards
+  EXPECT_FALSE(planner.plan(pose2D(0.0, 0.0, 0.0), goal, &path));
+  EXPECT_TRUE(path.empty());
+  EXPECT_GT(num_goal_edges, 1u);
+  EXPECT_LT(planner.numExpansions(), options.max_expansions);
+}
+
+TEST(LatticePlannerTest, testMergeCollinearTranslations)
+{
+  // a wall at x = 0.1 for y < 0.1 forces a detour
+  auto edge_checker = [](const std::vector<LatticePlanner::Edge>& edges, std::vector<bool>* valid) {
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+      const auto& edge = edges[i];
+      bool crosses_wall = (edge.start.x < 0.1 - 1E-09) != (edge.goal.x < 0.1 - 1E-09) ||
+                          std::fabs(edge.goal.x - 0.1) < 1E-09;
+      (*valid)[i] = !(crosses_wall && edge.goal.y < 0.1 - 1E-09);
+    }
+  };
+
+  LatticePlanner planner(edge_checker, LatticePlanner::Options());
+  std::vector<geometry_msgs::Pose2D> path;
+  ASSERT_TRUE(planner.plan(pose2D(0.0, 0.0, 0.0), pose2D(0.2, 0.0, 0.0), &path));
+  ASSERT_GE(path.size(), 2u);
+  EXPECT_NEAR(path.back().x, 0.2, 1E-09);
+  EXPECT_NEAR(path.back().y, 0.0, 1E-09);
+
+  // the detour has more lattice steps than the merged path has poses
+  EXPECT_LT(path.size(), 8u);
+  for (size_t i = 1; i + 1 < path.size(); ++i)
+  {
+    double dx_1 = path[i].x - path[i - 1].x, dy_1 = path[i].y - path[i - 1].y;
+    double dx_2 = path[i + 1].x - path[i].x, dy_2 = path[i + 1].y - path[i].y;
+    bool collinear = std::fabs(dx_1 * dy_2 - dy_1 * dx_2) < 1E-09 && dx_1 * dx_2 + dy_1 * dy_2 > 0;
+    EXPECT_FALSE(collinear) << "poses " << i - 1 << " to " << i + 1 << " were not merged";
+  }
+}
+
+TEST(LatticePlannerTest, testNoMergeAcrossRotation)
+{
+  LatticePlanner::Options options;
+  options.rotation_cost = 0.01;
+  LatticePlanner planner(acceptAll, options);
+  std::vector<geometry_msgs::Pose2D> path;
+  geometry_msgs::Pose2D start = pose2D(0.0, 0.0, 0.0);
+  ASSERT_TRUE(planner.plan(start, pose2D(0.2, 0.0, M_PI / 2), &path));
+  EXPECT_NEAR(path.back().x, 0.2, 1E-09);
+  EXPECT_NEAR(path.back().theta, M_PI / 2, 1E-09);
+
+  // the rotation can be the first motion, so the start pose is included, it has to stay a separate motion
+  path.insert(path.begin(), start);
+  size_t num_rotations = 0;
+  for (size_t i = 1; i < path.size(); ++i)
+  {
+    bool rotated = std::fabs(std::remainder(path[i].theta - path[i - 1].theta, 2 * M_PI)) > 1E-09;
+    bool translated = std::hypot(path[i].x - path[i - 1].x, path[i].y - path[i - 1].y) > 1E-09;
+    EXPECT_FALSE(rotated && translated);
+    num_rotations += rotated ? 1 : 0;
+  }
+  EXPECT_EQ(num_rotations, 1u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "planning_project_tester");
+  return RUN_ALL_TESTS();
+}
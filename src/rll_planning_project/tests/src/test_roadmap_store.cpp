@@ -0,0 +1,190 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <rll_planning_project/roadmap_store.h>
+
+namespace
+{
+const double RESOLUTION_TRANS = 0.001;
+const double RESOLUTION_ROT = 0.01;
+
+std::string tempFileName()
+{
+  char file_name[] = "/tmp/rll_roadmap_store_XXXXXX";
+  int fd = mkstemp(file_name);
+  ::close(fd);
+  return file_name;
+}
+
+geometry_msgs::Pose2D pose2D(double x, double y, double theta)
+{
+  geometry_msgs::Pose2D pose;
+  pose.x = x;
+  pose.y = y;
+  pose.theta = theta;
+  return pose;
+}
+
+bool openStore(RoadmapStore* store, const std::string& file_name, uint64_t scene_hash, size_t capacity = 64)
+{
+  return store->open(file_name, scene_hash, RESOLUTION_TRANS, RESOLUTION_ROT, capacity);
+}
+}  // namespace
+
+TEST(RoadmapStoreTest, testReopen)
+{
+  std::string file_name = tempFileName();
+  RoadmapStore store;
+  EXPECT_FALSE(store.isOpen());
+  ASSERT_TRUE(openStore(&store, file_name, 42));
+  EXPECT_TRUE(store.isOpen());
+  EXPECT_EQ(store.size(), 0u);
+
+  store.insert(pose2D(0.1, 0.2, 0.0), pose2D(0.3, 0.2, 0.0), RLLErrorCode::SUCCESS);
+  store.insert(pose2D(0.3, 0.2, 0.0), pose2D(0.3, -0.1, 1.5), RLLErrorCode::PROJECT_SPECIFIC_INVALID_1);
+  // critical failures are never stored
+  store.insert(pose2D(0.3, 0.2, 0.0), pose2D(0.5, 0.2, 0.0), RLLErrorCode::INTERNAL_ERROR);
+  EXPECT_EQ(store.size(), 2u);
+  store.close();
+  EXPECT_FALSE(store.isOpen());
+
+  // nothing is read or written while the store is closed
+  RLLErrorCode error_code;
+  EXPECT_FALSE(store.lookup(pose2D(0.1, 0.2, 0.0), pose2D(0.3, 0.2, 0.0), &error_code));
+  store.insert(pose2D(0.0, 0.0, 0.0), pose2D(0.1, 0.0, 0.0), RLLErrorCode::SUCCESS);
+
+  ASSERT_TRUE(openStore(&store, file_name, 42));
+  EXPECT_EQ(store.size(), 2u);
+  ASSERT_TRUE(store.lookup(pose2D(0.1, 0.2, 0.0), pose2D(0.3, 0.2, 0.0), &error_code));
+  EXPECT_EQ(error_code.value(), RLLErrorCode::SUCCESS);
+  // the poses are quantized like in the check_path cache
+  ASSERT_TRUE(store.lookup(pose2D(0.3003, 0.2, 0.0), pose2D(0.3, -0.0997, 1.504), &error_code));
+  EXPECT_EQ(error_code.value(), RLLErrorCode::PROJECT_SPECIFIC_INVALID_1);
+  EXPECT_FALSE(store.lookup(pose2D(0.3, 0.2, 0.0), pose2D(0.5, 0.2, 0.0), &error_code));
+  EXPECT_FALSE(store.lookup(pose2D(0.0, 0.0, 0.0), pose2D(0.1, 0.0, 0.0), &error_code));
+  EXPECT_EQ(store.hits(), 2u);
+  store.resetCounters();
+  EXPECT_EQ(store.hits(), 0u);
+
+  std::vector<RoadmapStore::Edge> edges;
+  store.edges(&edges);
+  ASSERT_EQ(edges.size(), 2u);
+  for (const auto& edge : edges)
+  {
+    if (edge.error_code == RLLErrorCode::SUCCESS)
+    {
+      EXPECT_NEAR(edge.start.x, 0.1, 1E-09);
+      EXPECT_NEAR(edge.goal.x, 0.3, 1E-09);
+    }
+    else
+    {
+      EXPECT_EQ(edge.error_code, RLLErrorCode::PROJECT_SPECIFIC_INVALID_1);
+      EXPECT_NEAR(edge.goal.y, -0.1, 1E-09);
+      EXPECT_NEAR(edge.goal.theta, 1.5, 1E-09);
+    }
+  }
+
+  store.close();
+  std::remove(file_name.c_str());
+}
+
+TEST(RoadmapStoreTest, testReuseOnlyMatchingHeader)
+{
+  std::string file_name = tempFileName();
+  geometry_msgs::Pose2D start = pose2D(0.1, 0.2, 0.0);
+  geometry_msgs::Pose2D goal = pose2D(0.3, 0.2, 0.0);
+  RLLErrorCode error_code;
+
+  RoadmapStore store;
+  ASSERT_TRUE(openStore(&store, file_name, 42));
+  store.insert(start, goal, RLLErrorCode::SUCCESS);
+  store.close();
+
+  // a different resolution starts an empty roadmap, the outdated edges are discarded
+  ASSERT_TRUE(store.open(file_name, 42, RESOLUTION_TRANS / 2, RESOLUTION_ROT, 64));
+  EXPECT_EQ(store.size(), 0u);
+  EXPECT_FALSE(store.lookup(start, goal, &error_code));
+  store.close();
+
+  ASSERT_TRUE(openStore(&store, file_name, 42));
+  EXPECT_EQ(store.size(), 0u);
+  store.insert(start, goal, RLLErrorCode::SUCCESS);
+  store.close();
+
+  // so does a different scene
+  ASSERT_TRUE(openStore(&store, file_name, 43));
+  EXPECT_EQ(store.size(), 0u);
+  EXPECT_FALSE(store.lookup(start, goal, &error_code));
+  store.close();
+
+  // an existing file keeps its capacity
+  ASSERT_TRUE(openStore(&store, file_name, 43, 128));
+  store.insert(start, goal, RLLErrorCode::SUCCESS);
+  store.close();
+  ASSERT_TRUE(openStore(&store, file_name, 43, 4));
+  EXPECT_EQ(store.size(), 1u);
+  store.close();
+
+  // a file that is not a roadmap is overwritten
+  FILE* file = std::fopen(file_name.c_str(), "w");
+  ASSERT_TRUE(file != nullptr);
+  // longer than the header, so that it is rejected by its magic and not by its size
+  std::fputs("this is not a roadmap, even though it is long enough to hold its header", file);
+  std::fclose(file);
+  ASSERT_TRUE(openStore(&store, file_name, 43));
+  EXPECT_EQ(store.size(), 0u);
+  store.insert(start, goal, RLLErrorCode::SUCCESS);
+  EXPECT_TRUE(store.lookup(start, goal, &error_code));
+
+  store.close();
+  std::remove(file_name.c_str());
+}
+
+TEST(RoadmapStoreTest, testFull)
+{
+  std::string file_name = tempFileName();
+  RoadmapStore store;
+  ASSERT_TRUE(openStore(&store, file_name, 42, 4));
+
+  // the load factor limits a table with four slots to three edges
+  for (int i = 0; i < 4; ++i)
+  {
+    store.insert(pose2D(0.0, 0.0, 0.0), pose2D(0.1 * (i + 1), 0.0, 0.0), RLLErrorCode::SUCCESS);
+  }
+  EXPECT_EQ(store.size(), 3u);
+
+  RLLErrorCode error_code;
+  EXPECT_FALSE(store.lookup(pose2D(0.0, 0.0, 0.0), pose2D(0.4, 0.0, 0.0), &error_code));
+
+  // stored edges can still be updated
+  store.insert(pose2D(0.0, 0.0, 0.0), pose2D(0.1, 0.0, 0.0), RLLErrorCode::PROJECT_SPECIFIC_INVALID_1);
+  EXPECT_EQ(store.size(), 3u);
+  ASSERT_TRUE(store.lookup(pose2D(0.0, 0.0, 0.0), pose2D(0.1, 0.0, 0.0), &error_code));
+  EXPECT_EQ(error_code.value(), RLLErrorCode::PROJECT_SPECIFIC_INVALID_1);
+
+  store.close();
+  std::remove(file_name.c_str());
+}
+
+TEST(RoadmapStoreTest, testLockedWhileOpen)
+{
+  std::string file_name = tempFileName();
+  RoadmapStore store;
+  ASSERT_TRUE(openStore(&store, file_name, 42));
+
+  RoadmapStore other_store;
+  EXPECT_FALSE(openStore(&other_store, file_name, 42));
+  EXPECT_FALSE(other_store.isOpen());
+
+  // closing releases the lock
+  store.close();
+  EXPECT_TRUE(openStore(&other_store, file_name, 42));
+
+  other_store.close();
+  std::remove(file_name.c_str());
+}
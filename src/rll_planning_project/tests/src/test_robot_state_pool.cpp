@@ -0,0 +1,150 @@
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <srdfdom/model.h>
+#include <urdf/model.h>
+
+#include <rll_planning_project/robot_state_pool.h>
+
+namespace
+{
+const std::string URDF = R"(<?xml version="1.0"?>
+<robot name="test_arm">
+  <link name="base"/>
+  <link name="link_1"/>
+  <link name="link_2"/>
+  <joint name="joint_1" type="revolute">
+    <parent link="base"/>
+    <child link="link_1"/>
+    <axis xyz="0 0 1"/>
+    <limit lower="-3.0" upper="3.0" effort="1.0" velocity="1.0"/>
+  </joint>
+  <joint name="joint_2" type="revolute">
+    <parent link="link_1"/>
+    <child link="link_2"/>
+    <origin xyz="0 0 0.5"/>
+    <axis xyz="0 1 0"/>
+    <limit lower="-2.0" upper="2.0" effort="1.0" velocity="1.0"/>
+  </joint>
+</robot>)";
+
+const std::string SRDF = R"(<?xml version="1.0"?>
+<robot name="test_arm">
+  <group name="arm">
+    <chain base_link="base" tip_link="link_2"/>
+  </group>
+</robot>)";
+
+robot_model::RobotModelPtr loadRobotModel()
+{
+  urdf::ModelSharedPtr urdf_model(new urdf::Model());
+  if (!urdf_model->initString(URDF))
+  {
+    return nullptr;
+  }
+
+  srdf::ModelSharedPtr srdf_model(new srdf::Model());
+  if (!srdf_model->initString(*urdf_model, SRDF))
+  {
+    return nullptr;
+  }
+
+  return robot_model::RobotModelPtr(new robot_model::RobotModel(urdf_model, srdf_model));
+}
+
+robot_state::RobotState referenceState(const robot_model::RobotModelPtr& robot_model)
+{
+  robot_state::RobotState state(robot_model);
+  state.setToDefaultValues();
+  state.setVariablePosition("joint_1", 0.4);
+  state.setVariablePosition("joint_2", -0.7);
+  state.update();
+  return state;
+}
+
+void expectSeeded(const robot_state::RobotState& state)
+{
+  EXPECT_DOUBLE_EQ(state.getVariablePosition("joint_1"), 0.4);
+  EXPECT_DOUBLE_EQ(state.getVariablePosition("joint_2"), -0.7);
+  EXPECT_FALSE(state.dirty());
+}
+}  // namespace
+
+TEST(RobotStatePoolTest, testAcquireIsSeeded)
+{
+  robot_model::RobotModelPtr robot_model = loadRobotModel();
+  ASSERT_TRUE(robot_model != nullptr);
+
+  RobotStatePool pool;
+  EXPECT_FALSE(pool.isSet());
+  pool.reset(referenceState(robot_model), 2);
+  ASSERT_TRUE(pool.isSet());
+  EXPECT_DOUBLE_EQ(pool.reference().getVariablePosition("joint_1"), 0.4);
+
+  const robot_state::RobotState* released_state = nullptr;
+  {
+    RobotStatePool::Handle handle = pool.acquire();
+    expectSeeded(*handle);
+    released_state = handle.get();
+
+    // seeding an acquired state discards the changes of its user
+    handle->setVariablePosition("joint_1", -1.0);
+    handle.seed();
+    expectSeeded(*handle);
+    handle->setVariablePosition("joint_2", 1.5);
+  }
+
+  // the released state is reused first and seeded again
+  RobotStatePool::Handle handle = pool.acquire();
+  EXPECT_EQ(handle.get(), released_state);
+  expectSeeded(*handle);
+}
+
+TEST(RobotStatePoolTest, testGrowsWhenExhausted)
+{
+  robot_model::RobotModelPtr robot_model = loadRobotModel();
+  ASSERT_TRUE(robot_model != nullptr);
+
+  RobotStatePool pool;
+  pool.reset(referenceState(robot_model), 1);
+
+  std::set<const robot_state::RobotState*> states;
+  {
+    std::vector<RobotStatePool::Handle> handles;
+    for (int i = 0; i < 3; ++i)
+    {
+      handles.push_back(pool.acquire());
+      expectSeeded(*handles.back());
+      states.insert(handles.back().get());
+    }
+    // every thread gets its own state
+    EXPECT_EQ(states.size(), 3u);
+  }
+
+  // the grown pool keeps all released states
+  std::vector<RobotStatePool::Handle> handles;
+  for (int i = 0; i < 3; ++i)
+  {
+    handles.push_back(pool.acquire());
+    EXPECT_EQ(states.count(handles.back().get()), 1u);
+  }
+}
+
+TEST(RobotStatePoolTest, testResetReplacesReference)
+{
+  robot_model::RobotModelPtr robot_model = loadRobotModel();
+  ASSERT_TRUE(robot_model != nullptr);
+
+  RobotStatePool pool;
+  pool.reset(referenceState(robot_model), 1);
+
+  robot_state::RobotState reference = referenceState(robot_model);
+  reference.setVariablePosition("joint_1", -0.2);
+  pool.reset(reference, 1);
+
+  RobotStatePool::Handle handle = pool.acquire();
+  EXPECT_DOUBLE_EQ(handle->getVariablePosition("joint_1"), -0.2);
+  EXPECT_DOUBLE_EQ(handle->getVariablePosition("joint_2"), -0.7);
+}
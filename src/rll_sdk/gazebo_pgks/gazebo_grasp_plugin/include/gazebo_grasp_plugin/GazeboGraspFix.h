@@ -7,6 +7,8 @@
 #include <gazebo/common/common.hh>
 #include <gazebo/transport/TransportTypes.hh>
 #include <stdio.h>
+#include <atomic>
+#include <unordered_map>
 #include <gazebo_grasp_plugin/GazeboGraspGripper.h>
 
 namespace gazebo
@@ -27,6 +29,7 @@ namespace gazebo
  *              <gripper_link> finger_index_link_1 </gripper_link>
  *              <gripper_link> finger_index_link_2 </gripper_link>
  *              <gripper_link> ... </gripper_link>
+ *              <update_rate>4</update_rate>
  *           </arm>
  *           <forces_angle_tolerance>100</forces_angle_tolerance>
  *           <update_rate>4</update_rate>
@@ -48,7 +51,9 @@ namespace gazebo
  *        - ``<gripper_link>`` tags have to include -all- link names of the gripper/hand which are used to
  *              actively grasp objects (these are the links which determine whether a "grasp" exists according to
  *              above described criterion).
- *    - ``<update_rate>`` is the rate at which all contact points are checked against the "gripping criterion".
+ *        - ``<update_rate>`` (optional) overrides the global ``<update_rate>`` for the objects this arm grasps.
+ *    - ``<update_rate>`` is the rate (in simulation time) at which all contact points are checked against the
+ *          "gripping criterion".
  *          Note that in-between such updates, existing contact points may be collected at
  *          a higher rate (the Gazebo world update rate). The ``update_rate`` is only the rate at
  *          which they are processed, which takes a bit of computation time, and therefore
@@ -152,11 +157,17 @@ private:
    */
   void OnContact(const ConstContactsPtr& ptr);
 
-  //    bool CheckGrip(const std::vector<GzVector3> &forces, float minAngleDiff,
+  //    bool CheckGrip(const GripForces &forces, float minAngleDiff,
   //                   float lengthRatio);
 
   bool IsGripperLink(const std::string& linkName, std::string& gripperName) const;
 
+  /**
+   * Returns the interned id of the object collision \e collisionName and sets \e collision,
+   * or -1 if there is no such collision in the world. Only to be called by OnContact().
+   */
+  int GetObjectId(const std::string& collisionName, physics::CollisionPtr& collision);
+
   /**
    * return objects (key) and the gripper (value) to which it is attached
    */
@@ -197,21 +208,51 @@ private:
   // robot still keeps wobbling.
   bool disableCollisionsOnAttach;
 
-  // all collisions per gazebo collision link (each entry
-  // belongs to a physics::CollisionPtr element). The key
-  // is the collision link name, the value is the gripper name
-  // this collision link belongs to.
-  std::map<std::string, std::string> collisions;
+  // all collisions of the gripper links, resolved in Load(). The index in these
+  // vectors is the interned id of the collision link, \e collisionLinkIds maps
+  // the scoped name of the collision link to its id.
+  std::vector<physics::CollisionPtr> collisionLinks;
+  std::vector<std::string> collisionLinkNames;
+  // the gripper name each collision link belongs to
+  std::vector<std::string> collisionLinkGrippers;
+  std::unordered_map<std::string, int> collisionLinkIds;
+
+  // collisions of the objects the gripper links collided with, interned at the first
+  // contact by OnContact() and only used there. The index is the interned id of the object.
+  std::vector<boost::weak_ptr<physics::Collision> > objectCollisions;
+  std::unordered_map<std::string, int> objectIds;
+
+  // names of the interned objects for OnUpdate(), new objects are passed along with the contact frames
+  std::vector<std::string> objectNames;
 
   /**
    * Helper class to encapsulate a collision information. Forward declaration here.
    */
   class CollidingPoint;
 
-  // Contact forces sorted by object name the gripper collides with (first key)
-  // and the link colliding (second key).
-  std::map<std::string, std::map<std::string, CollidingPoint> > contacts;
-  boost::mutex mutexContacts;  // mutex protects contacts
+  /**
+   * Helper class with the contacts collected between two updates. Forward declaration here.
+   */
+  class ContactFrame;
+
+  /**
+   * Returns the processed contact frame \e ready (-1 for the empty frame) to OnContact()
+   * and records \e now as the time of the last update.
+   */
+  void FinishUpdate(int ready, ContactFrame& frame, const common::Time& now);
+
+  // Contact forces per object and colliding link, double buffered without locks:
+  // OnContact() fills the frame at \e producerFrame. Once OnUpdate() sets \e swapRequested,
+  // it publishes this frame in \e readyFrame and continues with the frame in \e spareFrame,
+  // which OnUpdate() returns after processing. Frame indices are -1 if the slot is empty.
+  // The third frame stays empty and is processed if no contact message arrives after a request.
+  std::vector<ContactFrame> contactFrames;
+  int producerFrame;
+  std::atomic<int> readyFrame;
+  std::atomic<int> spareFrame;
+  std::atomic<bool> swapRequested;
+  // when OnUpdate() last set \e swapRequested
+  common::Time swapRequestTime;
 
   // when an object was first attached, it had these colliding points.
   // First key is object name, second is the link colliding, as in \e contacts.
@@ -225,7 +266,18 @@ private:
   // as "holding". Every loop, if a grip is not recorded, this number decreases.
   // When it reaches \e grip_count_threshold, it will be attached.
   // The number won't increase above max_grip_count once it has reached that number.
-  std::map<std::string, int> gripCounts;
+  // Objects are removed once the count is back at zero and they are not attached, so
+  // that idle grippers cost nothing in OnUpdate().
+  struct GripCount
+  {
+    GripCount() : count(0)
+    {
+    }
+    int count;
+    // the gripper which recorded the grip, its schedule applies to the object
+    std::string gripper;
+  };
+  std::map<std::string, GripCount> gripCounts;
 
   // *maximum* number in \e gripCounts to be recorded.
   int maxGripCount;
@@ -239,12 +291,20 @@ private:
   // the object is released.
   float releaseTolerance;
 
-  // nano seconds between two updates
+  // simulation time between two updates, the smallest one of all grippers
   common::Time updateRate;
 
-  // last time OnUpdate() was called
+  // simulation time of the last update in OnUpdate()
   common::Time prevUpdateTime;
 
+  // simulation time between the updates of the objects of a gripper, and when they are due next
+  struct GripperSchedule
+  {
+    common::Time updateRate;
+    common::Time nextUpdate;
+  };
+  std::map<std::string, GripperSchedule> gripperSchedules;
+
   // ContactManager filter to be removed in destructor
   std::string filter_name;
 };
@@ -5,6 +5,7 @@
 #include <gazebo/physics/Contact.hh>
 #include <gazebo/common/common.hh>
 #include <stdio.h>
+#include <algorithm>
 
 #include <gazebo_grasp_plugin/GazeboGraspFix.h>
 #include <gazebo_version_helpers/GazeboVersionHelpers.h>
@@ -53,7 +54,7 @@ GazeboGraspFix::~GazeboGraspFix()
 ////////////////////////////////////////////////////////////////////////////////
 void GazeboGraspFix::Init()
 {
-  this->prevUpdateTime = common::Time::GetWallTime();
+  this->prevUpdateTime = gazebo::GetSimTime(this->world);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -66,11 +67,15 @@ void GazeboGraspFix::InitValues()
   // float timeDiff=0.25;
   // this->releaseTolerance=0.005;
   // this->updateRate = common::Time(0, common::Time::SecToNano(timeDiff));
-  this->prevUpdateTime = common::Time::GetWallTime();
+  this->prevUpdateTime = common::Time();
   // float graspedSecs=2;
   // this->maxGripCount=floor(graspedSecs/timeDiff);
   // this->gripCountThreshold=floor(this->maxGripCount/2);
   this->node = transport::NodePtr(new transport::Node());
+  this->producerFrame = 0;
+  this->readyFrame.store(-1);
+  this->spareFrame.store(1);
+  this->swapRequested.store(false);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -195,6 +200,22 @@ void GazeboGraspFix::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
     std::string armName = armNameElem->Get<std::string>();
     std::string palmName = handLinkElem->Get<std::string>();
 
+    GripperSchedule schedule;
+    schedule.updateRate = this->updateRate;
+    if (armElem->HasElement("update_rate"))
+    {
+      int _rate = armElem->GetElement("update_rate")->Get<int>();
+      if (_rate > 0)
+      {
+        schedule.updateRate = common::Time(0, common::Time::SecToNano(1.0 / _rate));
+        gzmsg << "GazeboGraspFix: Using update rate " << _rate << " for arm " << armName << std::endl;
+      }
+      else
+      {
+        gzerr << "GazeboGraspFix: Ignoring invalid update rate " << _rate << " for arm " << armName << std::endl;
+      }
+    }
+
     // collect all finger names:
     std::vector<std::string> fingerLinkNames;
     for (; fingerLinkElem != NULL; fingerLinkElem = fingerLinkElem->GetNextElement("gripper_link"))
@@ -216,25 +237,35 @@ void GazeboGraspFix::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
       grippers.erase(armName);
       continue;
     }
+    this->gripperSchedules[armName] = schedule;
     // add all the grippers's collision elements
     for (std::map<std::string, physics::CollisionPtr>::iterator collIt = _collisions.begin();
          collIt != _collisions.end(); ++collIt)
     {
       const std::string& collName = collIt->first;
-      // physics::CollisionPtr& coll=collIt->second;
-      std::map<std::string, std::string>::iterator collIter = this->collisions.find(collName);
-      if (collIter != this->collisions.end())  // this collision was already added before
+      if (this->collisionLinkIds.find(collName) != this->collisionLinkIds.end())  // this collision was already added
       {
         gzwarn << "GazeboGraspFix: Adding Gazebo collision link element " << collName
                << " multiple times, the grasp plugin may not work properly" << std::endl;
         continue;
       }
       gzmsg << "GazeboGraspFix: Adding collision scoped name " << collName << std::endl;
-      this->collisions[collName] = armName;
+      this->collisionLinkIds[collName] = this->collisionLinks.size();
+      this->collisionLinks.push_back(collIt->second);
+      this->collisionLinkNames.push_back(collName);
+      this->collisionLinkGrippers.push_back(armName);
       collisionNames.push_back(collName);
     }
   }
 
+  // contacts are collected at the rate of the fastest gripper
+  for (std::map<std::string, GripperSchedule>::const_iterator it = this->gripperSchedules.begin();
+       it != this->gripperSchedules.end(); ++it)
+  {
+    if (it->second.updateRate < this->updateRate)
+      this->updateRate = it->second.updateRate;
+  }
+
   if (grippers.empty())
   {
     gzerr << "ERROR: GazeboGraspFix: Cannot use a GazeboGraspFix because "
@@ -242,6 +273,12 @@ void GazeboGraspFix::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
     return;
   }
 
+  // reserve the bookkeeping of the contact frames, so that OnContact() only needs to
+  // allocate when it interns a new object
+  this->contactFrames.resize(3);
+  for (std::vector<ContactFrame>::iterator it = this->contactFrames.begin(); it != this->contactFrames.end(); ++it)
+    it->touched.reserve(this->collisionLinks.size() * 8);
+
   // ++++++++++++ start up things +++++++++++++++
 
   physics::PhysicsEnginePtr physics = GetPhysics(this->world);
@@ -261,12 +298,40 @@ void GazeboGraspFix::Load(physics::ModelPtr _parent, sdf::ElementPtr _sdf)
   update_connection = event::Events::ConnectWorldUpdateEnd(boost::bind(&GazeboGraspFix::OnUpdate, this));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * Forces for CheckGrip() as structure of arrays: the normalized directions and the lengths.
+ * Forces that are too short to have a direction are not added.
+ */
+class GripForces
+{
+public:
+  void Add(const GzVector3& force)
+  {
+    float l = gazebo::GetLength(force);
+    if (l < 1e-04)
+      return;
+    x.push_back(gazebo::GetX(force) / l);
+    y.push_back(gazebo::GetY(force) / l);
+    z.push_back(gazebo::GetZ(force) / l);
+    len.push_back(l);
+  }
+
+  size_t Size() const
+  {
+    return len.size();
+  }
+
+  std::vector<float> x, y, z;
+  std::vector<float> len;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 class GazeboGraspFix::ObjectContactInfo
 {
 public:
   // all forces effecting on the object
-  std::vector<GzVector3> appliedForces;
+  GripForces appliedForces;
 
   // all grippers involved in the process, along with
   // a number counting the number of contact points with the
@@ -279,6 +344,9 @@ public:
 
   // the gripper for maxGripperContactCnt
   std::string maxContactGripper;
+
+  // indices of all contact points with the object in the processed ContactFrame
+  std::vector<size_t> contactPoints;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -403,20 +471,47 @@ public:
 };
 
 ////////////////////////////////////////////////////////////////////////////////
-double AngularDistance(const GzVector3& _v1, const GzVector3& _v2)
+/**
+ * Helper class with the contacts collected between two updates.
+ * There is one CollidingPoint for each pair of object and collision link, stored
+ * contiguously at index objectId * number of collision links + linkId.
+ * Only the points in \e touched have been accumulated since the last Clear(),
+ * so that the frame can be processed and cleared without visiting all pairs.
+ */
+class GazeboGraspFix::ContactFrame
 {
-  GzVector3 v1 = _v1;
-  GzVector3 v2 = _v2;
-  v1.Normalize();
-  v2.Normalize();
-  return acos(v1.Dot(v2));
-}
+public:
+  // returns the point at \e index, grows the frame if the object is new
+  CollidingPoint& Get(size_t index)
+  {
+    if (index >= points.size())
+      points.resize(index + 1);
+    CollidingPoint& p = points[index];
+    if (p.sum == 0)
+      touched.push_back(index);
+    return p;
+  }
+
+  void Clear()
+  {
+    for (std::vector<size_t>::const_iterator it = touched.begin(); it != touched.end(); ++it)
+      points[*it] = CollidingPoint();
+    touched.clear();
+    newObjects.clear();
+  }
+
+  std::vector<CollidingPoint> points;
+  std::vector<size_t> touched;
+
+  // objects interned while this frame was filled, by id
+  std::vector<std::pair<int, std::string> > newObjects;
+};
 
 ////////////////////////////////////////////////////////////////////////////////
 // Checks whether any two vectors in the set have an angle greater
 // than minAngleDiff (in rad), and one is at least
 // lengthRatio (0..1) of the other in it's length.
-bool CheckGrip(const std::vector<GzVector3>& forces, float minAngleDiff, float lengthRatio)
+bool CheckGrip(const GripForces& forces, float minAngleDiff, float lengthRatio)
 {
   if (((lengthRatio > 1) || (lengthRatio < 0)) && (lengthRatio > 1e-04 && (fabs(lengthRatio - 1) > 1e-04)))
   {
@@ -428,39 +523,31 @@ bool CheckGrip(const std::vector<GzVector3>& forces, float minAngleDiff, float l
     std::cerr << "ERROR: CheckGrip: min angle must be at least 90 degrees (PI/2)" << std::endl;
     return false;
   }
-  std::vector<GzVector3>::const_iterator it1, it2;
-  for (it1 = forces.begin(); it1 != forces.end(); ++it1)
+
+  // the angle exceeds minAngleDiff if the cosine, i.e. the dot product of the
+  // directions, is below the cosine of minAngleDiff. This avoids acos() per pair.
+  const float maxCos = cos(minAngleDiff);
+  const size_t n = forces.Size();
+  const float* x = forces.x.data();
+  const float* y = forces.y.data();
+  const float* z = forces.z.data();
+  const float* len = forces.len.data();
+  for (size_t i = 0; i + 1 < n; ++i)
   {
-    GzVector3 v1 = *it1;
-    for (it2 = it1 + 1; it2 != forces.end(); ++it2)
+    const float xi = x[i], yi = y[i], zi = z[i], li = len[i];
+    // no branches in the sweep over the remaining vectors, so that it can be vectorized
+    int found = 0;
+    for (size_t j = i + 1; j < n; ++j)
     {
-      GzVector3 v2 = *it2;
-      float l1 = gazebo::GetLength(v1);
-      float l2 = gazebo::GetLength(v2);
-      if ((l1 < 1e-04) || (l2 < 1e-04))
-        continue;
-      /*GzVector3 _v1=v1;
-      GzVector3 _v2=v2;
-      _v1/=l1;
-      _v2/=l2;
-      float angle=acos(_v1.Dot(_v2));*/
-      float angle = AngularDistance(v1, v2);
-      // gzmsg<<"Angular distance between v1.len="<<v1.GetLength()<<" and v2.len="<<v2.GetLength()<<":
-      // "<<angle*180/M_PI<<std::endl;
-      if (angle > minAngleDiff)
-      {
-        float ratio;
-        if (l1 > l2)
-          ratio = l2 / l1;
-        else
-          ratio = l1 / l2;
-        // gzmsg<<"Got angle "<<angle<<", ratio "<<ratio<<std::endl;
-        if (ratio >= lengthRatio)
-        {
-          // gzmsg<<"CheckGrip() is true"<<std::endl;
-          return true;
-        }
-      }
+      const float dot = xi * x[j] + yi * y[j] + zi * z[j];
+      const float lMin = std::min(li, len[j]);
+      const float lMax = std::max(li, len[j]);
+      found |= (dot < maxCos) & (lMin >= lengthRatio * lMax);
+    }
+    if (found)
+    {
+      // gzmsg<<"CheckGrip() is true"<<std::endl;
+      return true;
     }
   }
   return false;
@@ -469,50 +556,90 @@ bool CheckGrip(const std::vector<GzVector3>& forces, float minAngleDiff, float l
 ////////////////////////////////////////////////////////////////////////////////
 void GazeboGraspFix::OnUpdate()
 {
-  if ((common::Time::GetWallTime() - this->prevUpdateTime) < this->updateRate)
+  // The contact frame is requested at the update rate and processed as soon as OnContact()
+  // handed it over. Don't do the complex grip check (CheckGrip) in OnContact(), because that
+  // slows down the contact callback. Everything is timed in simulation time, so that the
+  // checks run at the same rate relative to the physics in faster or slower than real time
+  // simulations.
+  common::Time now = gazebo::GetSimTime(this->world);
+  if (now < this->prevUpdateTime)
+  {
+    // the world was reset
+    this->prevUpdateTime = now;
+    this->swapRequestTime = now;
+    for (std::map<std::string, GripperSchedule>::iterator it = this->gripperSchedules.begin();
+         it != this->gripperSchedules.end(); ++it)
+      it->second.nextUpdate = now;
+  }
+  int ready = this->readyFrame.exchange(-1, std::memory_order_acquire);
+  if (ready < 0)
+  {
+    if ((now - this->prevUpdateTime) < this->updateRate)
+      return;
+    if (!this->swapRequested.load(std::memory_order_relaxed))
+    {
+      this->swapRequestTime = now;
+      this->swapRequested.store(true, std::memory_order_release);
+      return;
+    }
+    if ((now - this->swapRequestTime) < this->updateRate)
+      return;
+    // there was no contact message since the request, so there are no contacts to process
+  }
+  ContactFrame& frame = ready < 0 ? this->contactFrames[2] : this->contactFrames[ready];
+  for (std::vector<std::pair<int, std::string> >::const_iterator it = frame.newObjects.begin();
+       it != frame.newObjects.end(); ++it)
+  {
+    if (it->first >= static_cast<int>(this->objectNames.size()))
+      this->objectNames.resize(it->first + 1);
+    this->objectNames[it->first] = it->second;
+  }
+
+  // nothing to do if no gripper touches or counts any object
+  if (frame.touched.empty() && this->gripCounts.empty())
+  {
+    FinishUpdate(ready, frame, now);
     return;
+  }
+
+  // the grippers whose objects are updated this time
+  std::set<std::string> dueGrippers;
+  for (std::map<std::string, GripperSchedule>::iterator it = this->gripperSchedules.begin();
+       it != this->gripperSchedules.end(); ++it)
+  {
+    if (now < it->second.nextUpdate)
+      continue;
+    dueGrippers.insert(it->first);
+    // updates happen every updateRate, so the next one within updateRate of the due time is taken
+    it->second.nextUpdate = now + it->second.updateRate - this->updateRate;
+  }
 
-  // first, copy all contact data into local struct. Don't do the complex grip check (CheckGrip)
-  // within the mutex, because that slows down OnContact().
-  this->mutexContacts.lock();
-  std::map<std::string, std::map<std::string, CollidingPoint> > contPoints(this->contacts);
-  this->contacts.clear();  // clear so it can be filled anew by OnContact().
-  this->mutexContacts.unlock();
+  const size_t numCollisionLinks = this->collisionLinks.size();
 
-  // contPoints now contains CollidingPoint objects for each *object* and *link*.
+  // frame now contains CollidingPoint objects for each *object* and *link*.
 
   // Iterate through all contact points to gather all summed forces
   // (and other useful information) for all the objects (so we have all forces on one object).
-  std::map<std::string, std::map<std::string, CollidingPoint> >::iterator objIt;
-  std::map<std::string, ObjectContactInfo> objectContactInfo;
+  std::map<int, ObjectContactInfo> objectContactInfo;
 
-  for (objIt = contPoints.begin(); objIt != contPoints.end(); ++objIt)
+  for (std::vector<size_t>::const_iterator pIt = frame.touched.begin(); pIt != frame.touched.end(); ++pIt)
   {
-    std::string objName = objIt->first;
-    // gzmsg<<"Examining object collisions with "<<objName<<std::endl;
-
     // create new entry in accumulated results map and get reference to fill in:
-    ObjectContactInfo& objContInfo = objectContactInfo[objName];
-
-    // for all links colliding with this object...
-    std::map<std::string, CollidingPoint>::iterator lIt;
-    for (lIt = objIt->second.begin(); lIt != objIt->second.end(); ++lIt)
-    {
-      std::string linkName = lIt->first;
-      CollidingPoint& collP = lIt->second;
-      GzVector3 avgForce = collP.force / collP.sum;
-      // gzmsg << "Found collision with "<<linkName<<": "<<avgForce.x<<", "<<avgForce.y<<", "<<avgForce.z<<" (avg over
-      // "<<collP.sum<<")"<<std::endl;
-      objContInfo.appliedForces.push_back(avgForce);
-      // insert the gripper (if it doesn't exist yet) and increase contact counter
-      int& gContactCnt = objContInfo.grippersInvolved[collP.gripperName];
-      gContactCnt++;
-      int& _maxGripperContactCnt = objContInfo.maxGripperContactCnt;
-      if (gContactCnt > _maxGripperContactCnt)
-      {
-        _maxGripperContactCnt = gContactCnt;
-        objContInfo.maxContactGripper = collP.gripperName;
-      }
+    ObjectContactInfo& objContInfo = objectContactInfo[*pIt / numCollisionLinks];
+    objContInfo.contactPoints.push_back(*pIt);
+
+    CollidingPoint& collP = frame.points[*pIt];
+    collP.gripperName = this->collisionLinkGrippers[*pIt % numCollisionLinks];
+    GzVector3 avgForce = collP.force / collP.sum;
+    objContInfo.appliedForces.Add(avgForce);
+    // insert the gripper (if it doesn't exist yet) and increase contact counter
+    int& gContactCnt = objContInfo.grippersInvolved[collP.gripperName];
+    gContactCnt++;
+    int& _maxGripperContactCnt = objContInfo.maxGripperContactCnt;
+    if (gContactCnt > _maxGripperContactCnt)
+    {
+      _maxGripperContactCnt = gContactCnt;
+      objContInfo.maxContactGripper = collP.gripperName;
     }
   }
 
@@ -523,13 +650,13 @@ void GazeboGraspFix::OnUpdate()
   // threshold, attach the object to the gripper which has most contact points with the
   // object.
   std::set<std::string> grippedObjects;
-  for (std::map<std::string, ObjectContactInfo>::iterator ocIt = objectContactInfo.begin();
-       ocIt != objectContactInfo.end(); ++ocIt)
+  for (std::map<int, ObjectContactInfo>::iterator ocIt = objectContactInfo.begin(); ocIt != objectContactInfo.end();
+       ++ocIt)
   {
-    const std::string& objName = ocIt->first;
+    const std::string& objName = this->objectNames[ocIt->first];
     const ObjectContactInfo& objContInfo = ocIt->second;
 
-    // gzmsg<<"Number applied forces on "<<objName<<": "<<objContInfo.appliedForces.size()<<std::endl;
+    // gzmsg<<"Number applied forces on "<<objName<<": "<<objContInfo.appliedForces.Size()<<std::endl;
 
     // TODO: remove this test print, for issue #26 -------------------
 #if 0
@@ -545,6 +672,13 @@ void GazeboGraspFix::OnUpdate()
 #endif
     // -------------------
 
+    // objects of grippers which are not due keep their grip count until the next update
+    if (dueGrippers.find(objContInfo.maxContactGripper) == dueGrippers.end())
+    {
+      grippedObjects.insert(objName);
+      continue;
+    }
+
     float minAngleDiff = this->forcesAngleTolerance;  // 120 * M_PI/180;
     if (!CheckGrip(objContInfo.appliedForces, minAngleDiff, 0.3))
       continue;
@@ -552,11 +686,13 @@ void GazeboGraspFix::OnUpdate()
     // add to "gripped objects"
     grippedObjects.insert(objName);
 
-    // gzmsg<<"Grasp Held: "<<objName<<" grip count: "<<this->gripCounts[objName]<<std::endl;
+    // gzmsg<<"Grasp Held: "<<objName<<" grip count: "<<this->gripCounts[objName].count<<std::endl;
 
-    int& counts = this->gripCounts[objName];
+    GripCount& gripCount = this->gripCounts[objName];
+    int& counts = gripCount.count;
     if (counts < this->maxGripCount)
       ++counts;
+    gripCount.gripper = objContInfo.maxContactGripper;
 
     // only need to attach object if the grip count threshold is exceeded
     if (counts <= this->gripCountThreshold)
@@ -602,20 +738,18 @@ void GazeboGraspFix::OnUpdate()
     // away, this is going to trigger the release condition.
     // XXX this does not consider full support for an object being gripped by two grippers (e.g.
     // one left, one right).
-    // this->attachGripContacts[objName]=contPoints[objName];
-    const std::map<std::string, CollidingPoint>& contPointsTmp = contPoints[objName];
     std::map<std::string, CollidingPoint>& attGripConts = this->attachGripContacts[objName];
     attGripConts.clear();
-    std::map<std::string, CollidingPoint>::const_iterator contPointsIt;
-    for (contPointsIt = contPointsTmp.begin(); contPointsIt != contPointsTmp.end(); ++contPointsIt)
+    std::vector<size_t>::const_iterator contPointsIt;
+    for (contPointsIt = objContInfo.contactPoints.begin(); contPointsIt != objContInfo.contactPoints.end();
+         ++contPointsIt)
     {
-      const std::string& collidingLink = contPointsIt->first;
-      const CollidingPoint& collidingPoint = contPointsIt->second;
+      const std::string& collidingLink = this->collisionLinkNames[*contPointsIt % numCollisionLinks];
       // gzmsg<<"Checking initial contact with "<<collidingLink<<" and "<<graspingGripperName<<std::endl;
       if (graspingGripper.hasCollisionLink(collidingLink))
       {
         // gzmsg<<"Insert initial contact with "<<collidingLink<<std::endl;
-        attGripConts[collidingLink] = collidingPoint;
+        attGripConts[collidingLink] = frame.points[*contPointsIt];
       }
     }
 
@@ -632,9 +766,12 @@ void GazeboGraspFix::OnUpdate()
 
   // now, for all objects that are not currently gripped,
   // decrease grip counter, and possibly release object.
-  std::map<std::string, int>::iterator gripCntIt;
-  for (gripCntIt = this->gripCounts.begin(); gripCntIt != this->gripCounts.end(); ++gripCntIt)
+  std::map<std::string, GripCount>::iterator gripCntIt;
+  std::map<std::string, GripCount>::iterator nextGripCntIt;
+  for (gripCntIt = this->gripCounts.begin(); gripCntIt != this->gripCounts.end(); gripCntIt = nextGripCntIt)
   {
+    nextGripCntIt = gripCntIt;
+    ++nextGripCntIt;
     const std::string& objName = gripCntIt->first;
 
     if (grippedObjects.find(objName) != grippedObjects.end())
@@ -644,20 +781,29 @@ void GazeboGraspFix::OnUpdate()
       continue;
     }
 
+    std::map<std::string, std::string>::iterator attIt = attachedObjects.find(objName);
+    bool isAttached = (attIt != attachedObjects.end());
+    const std::string& countingGripper = isAttached ? attIt->second : gripCntIt->second.gripper;
+    if (dueGrippers.find(countingGripper) == dueGrippers.end())
+      continue;
+
     // the object does not satisfy "gripped" criteria, so potentially has to be released.
 
-    // gzmsg<<"NOT-GRIPPING "<<objName<<", grip count "<<gripCntIt->second<<" (threshold
+    // gzmsg<<"NOT-GRIPPING "<<objName<<", grip count "<<gripCntIt->second.count<<" (threshold
     // "<<this->gripCountThreshold<<")"<<std::endl;
 
-    if (gripCntIt->second > 0)
-      --(gripCntIt->second);
-
-    std::map<std::string, std::string>::iterator attIt = attachedObjects.find(objName);
-    bool isAttached = (attIt != attachedObjects.end());
+    if (gripCntIt->second.count > 0)
+      --(gripCntIt->second.count);
 
     // gzmsg<<"is attached: "<<isAttached<<std::endl;
 
-    if (!isAttached || (gripCntIt->second > this->gripCountThreshold))
+    if (!isAttached && gripCntIt->second.count == 0)
+    {
+      this->gripCounts.erase(gripCntIt);
+      continue;
+    }
+
+    if (!isAttached || (gripCntIt->second.count > this->gripCountThreshold))
       continue;
 
     const std::string& graspingGripperName = attIt->second;
@@ -756,155 +902,171 @@ void GazeboGraspFix::OnUpdate()
       gzmsg << "GazeboGraspFix: Detaching " << objName << " from gripper " << graspingGripperName << "." << std::endl;
       graspingGripper.HandleDetach(objName);
       this->OnDetach(objName, graspingGripperName);
-      gripCntIt->second = 0;
       this->attachGripContacts.erase(initCollIt);
+      this->gripCounts.erase(gripCntIt);
     }
   }
 
-  this->prevUpdateTime = common::Time::GetWallTime();
+  FinishUpdate(ready, frame, now);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void GazeboGraspFix::OnContact(const ConstContactsPtr& _msg)
+void GazeboGraspFix::FinishUpdate(int ready, ContactFrame& frame, const common::Time& now)
 {
-  // gzmsg<<"CONTACT! "<<std::endl;//<<_contact<<std::endl;
-  // for all contacts...
-  for (int i = 0; i < _msg->contact_size(); ++i)
+  if (ready >= 0)
   {
-    physics::CollisionPtr collision1 = boost::dynamic_pointer_cast<physics::Collision>(
-        gazebo::GetEntityByName(this->world, _msg->contact(i).collision1()));
-    physics::CollisionPtr collision2 = boost::dynamic_pointer_cast<physics::Collision>(
-        gazebo::GetEntityByName(this->world, _msg->contact(i).collision2()));
-
-    if ((collision1 && !collision1->IsStatic()) && (collision2 && !collision2->IsStatic()))
-    {
-      std::string name1 = collision1->GetScopedName();
-      std::string name2 = collision2->GetScopedName();
+    frame.Clear();
+    this->spareFrame.store(ready, std::memory_order_release);
+  }
+  this->prevUpdateTime = now;
+}
 
-      // gzmsg<<"OBJ CONTACT! "<<name1<<" / "<<name2<<std::endl;
-      int count = _msg->contact(i).position_size();
+////////////////////////////////////////////////////////////////////////////////
+int GazeboGraspFix::GetObjectId(const std::string& collisionName, physics::CollisionPtr& collision)
+{
+  std::unordered_map<std::string, int>::const_iterator idIt = this->objectIds.find(collisionName);
+  if (idIt != this->objectIds.end())
+  {
+    collision = this->objectCollisions[idIt->second].lock();
+    if (collision)
+      return idIt->second;
+  }
 
-      // Check to see if the contact arrays all have the same size.
-      if ((count != _msg->contact(i).normal_size()) || (count != _msg->contact(i).wrench_size()) ||
-          (count != _msg->contact(i).depth_size()))
-      {
-        gzerr << "GazeboGraspFix: Contact message has invalid array sizes\n" << std::endl;
-        continue;
-      }
+  // first contact with this object, or the object was removed from the world and a new one
+  // with the same name may have been spawned.
+  collision = boost::dynamic_pointer_cast<physics::Collision>(gazebo::GetEntityByName(this->world, collisionName));
+  if (!collision)
+    return -1;
 
-      std::string collidingObjName, collidingLink, gripperOfCollidingLink;
-      physics::CollisionPtr linkCollision;
-      physics::CollisionPtr objCollision;
+  if (idIt != this->objectIds.end())
+  {
+    this->objectCollisions[idIt->second] = collision;
+    return idIt->second;
+  }
 
-      physics::Contact contact;
-      contact = _msg->contact(i);
+  int id = this->objectCollisions.size();
+  this->objectIds[collisionName] = id;
+  this->objectCollisions.push_back(collision);
+  this->contactFrames[this->producerFrame].newObjects.push_back(std::make_pair(id, collisionName));
+  return id;
+}
 
-      if (contact.count < 1)
-      {
-        std::cerr << "ERROR: GazeboGraspFix: Not enough forces given for contact of ." << name1 << " / " << name2
-                  << std::endl;
-        continue;
-      }
+////////////////////////////////////////////////////////////////////////////////
+void GazeboGraspFix::OnContact(const ConstContactsPtr& _msg)
+{
+  // for all contacts...
+  for (int i = 0; i < _msg->contact_size(); ++i)
+  {
+    const msgs::Contact& contactMsg = _msg->contact(i);
 
-      // all force vectors which are part of this contact
-      std::vector<GzVector3> force;
+    // find out which part of the colliding entities is the object, *not* the gripper.
+    int linkId;
+    bool objectIsFirst;
+    std::unordered_map<std::string, int>::const_iterator linkIt = this->collisionLinkIds.find(contactMsg.collision2());
+    if (linkIt != this->collisionLinkIds.end())
+    {
+      // collision 1 is the object
+      objectIsFirst = true;
+    }
+    else if ((linkIt = this->collisionLinkIds.find(contactMsg.collision1())) != this->collisionLinkIds.end())
+    {
+      // collision 2 is the object
+      objectIsFirst = false;
+    }
+    else
+    {
+      continue;
+    }
+    linkId = linkIt->second;
 
-      // find out which part of the colliding entities is the object, *not* the gripper,
-      // and copy all the forces applied to it into the vector 'force'.
-      std::map<std::string, std::string>::const_iterator gripperCollIt = this->collisions.find(name2);
-      if (gripperCollIt != this->collisions.end())
-      {
-        // collision 1 is the object
-        collidingObjName = name1;
-        collidingLink = name2;
-        linkCollision = collision2;
-        objCollision = collision1;
-        gripperOfCollidingLink = gripperCollIt->second;
-        for (int k = 0; k < contact.count; ++k)
-          force.push_back(contact.wrench[k].body1Force);
-      }
-      else if ((gripperCollIt = this->collisions.find(name1)) != this->collisions.end())
-      {
-        // collision 2 is the object
-        collidingObjName = name2;
-        collidingLink = name1;
-        linkCollision = collision1;
-        objCollision = collision2;
-        gripperOfCollidingLink = gripperCollIt->second;
-        for (int k = 0; k < contact.count; ++k)
-          force.push_back(contact.wrench[k].body2Force);
-      }
+    const physics::CollisionPtr& linkCollision = this->collisionLinks[linkId];
+    if (!linkCollision || linkCollision->IsStatic())
+      continue;
 
-      GzVector3 avgForce;
-      // compute average/sum of the forces applied on the object
-      for (int k = 0; k < force.size(); ++k)
-      {
-        avgForce += force[k];
-      }
-      avgForce /= force.size();
+    int count = contactMsg.position_size();
 
-      GzVector3 avgPos;
-      // compute center point (average pose) of all the origin positions of the forces appied
-      for (int k = 0; k < contact.count; ++k)
-        avgPos += contact.positions[k];
-      avgPos /= contact.count;
+    // Check to see if the contact arrays all have the same size.
+    if ((count != contactMsg.normal_size()) || (count != contactMsg.wrench_size()) ||
+        (count != contactMsg.depth_size()))
+    {
+      gzerr << "GazeboGraspFix: Contact message has invalid array sizes\n" << std::endl;
+      continue;
+    }
 
-      // now, get average pose relative to the colliding link
-      GzPose3 linkWorldPose = gazebo::GetWorldPose(linkCollision->GetLink());
+    if (count < 1)
+    {
+      std::cerr << "ERROR: GazeboGraspFix: Not enough forces given for contact of ." << contactMsg.collision1()
+                << " / " << contactMsg.collision2() << std::endl;
+      continue;
+    }
 
-      // To find out the collision point relative to the Link's local coordinate system, first get the Poses as 4x4
-      // matrices
-      GzMatrix4 worldToLink = gazebo::GetMatrix(linkWorldPose);
+    // compute average/sum of the forces applied on the object, and the center point (average pose)
+    // of all the origin positions of the forces applied
+    GzVector3 avgForce;
+    GzVector3 avgPos;
+    for (int k = 0; k < count; ++k)
+    {
+      const msgs::JointWrench& wrench = contactMsg.wrench(k);
+      const msgs::Vector3d& force = objectIsFirst ? wrench.body_1_wrench().force() : wrench.body_2_wrench().force();
+      const msgs::Vector3d& position = contactMsg.position(k);
+      avgForce += gazebo::GetVector(force.x(), force.y(), force.z());
+      avgPos += gazebo::GetVector(position.x(), position.y(), position.z());
+    }
+    avgForce /= count;
+    avgPos /= count;
 
-      // We can assume that the contact has identity rotation because we don't care about its orientation.
-      // We could always set another rotation here too.
-      GzMatrix4 worldToContact = gazebo::GetMatrix(avgPos);
+    physics::CollisionPtr objCollision;
+    int objectId = GetObjectId(objectIsFirst ? contactMsg.collision1() : contactMsg.collision2(), objCollision);
+    if (objectId < 0 || objCollision->IsStatic())
+      continue;
 
-      // now, worldToLink * contactInLocal = worldToContact
-      // hence, contactInLocal = worldToLink.Inv * worldToContact
-      GzMatrix4 worldToLinkInv = worldToLink.Inverse();
-      GzMatrix4 contactInLocal = worldToLinkInv * worldToContact;
-      GzVector3 contactPosInLocal = gazebo::GetPos(contactInLocal);
+    // now, get average pose relative to the colliding link
+    GzPose3 linkWorldPose = gazebo::GetWorldPose(linkCollision->GetLink());
 
-      // gzmsg<<"---------"<<std::endl;
-      // gzmsg<<"CNT in loc: "<<contactPosInLocal.x<<","<<contactPosInLocal.y<<","<<contactPosInLocal.z<<std::endl;
+    // To find out the collision point relative to the Link's local coordinate system, first get the Poses as 4x4
+    // matrices
+    GzMatrix4 worldToLink = gazebo::GetMatrix(linkWorldPose);
 
-      /*GzVector3 sDiff=avgPos-linkWorldPose.pos;
-      gzmsg<<"SIMPLE trans: "<<sDiff.x<<","<<sDiff.y<<","<<sDiff.z<<std::endl;
-      gzmsg<<"coll world pose: "<<linkWorldPose.pos.x<<", "<<linkWorldPose.pos.y<<", "<<linkWorldPose.pos.z<<std::endl;
-      gzmsg<<"contact avg pose: "<<avgPos.x<<", "<<avgPos.y<<", "<<avgPos.z<<std::endl;
+    // We can assume that the contact has identity rotation because we don't care about its orientation.
+    // We could always set another rotation here too.
+    GzMatrix4 worldToContact = gazebo::GetMatrix(avgPos);
 
-      GzVector3 lX=linkWorldPose.rot.GetXAxis();
-      GzVector3 lY=linkWorldPose.rot.GetYAxis();
-      GzVector3 lZ=linkWorldPose.rot.GetZAxis();
+    // now, worldToLink * contactInLocal = worldToContact
+    // hence, contactInLocal = worldToLink.Inv * worldToContact
+    GzMatrix4 worldToLinkInv = worldToLink.Inverse();
+    GzMatrix4 contactInLocal = worldToLinkInv * worldToContact;
+    GzVector3 contactPosInLocal = gazebo::GetPos(contactInLocal);
 
-      gzmsg<<"World ori:
-      "<<linkWorldPose.rot.x<<","<<linkWorldPose.rot.y<<","<<linkWorldPose.rot.z<<","<<linkWorldPose.rot.w<<std::endl;
-      gzmsg<<"x axis: "<<lX.x<<","<<lX.y<<","<<lX.z<<std::endl;
-      gzmsg<<"y axis: "<<lY.x<<","<<lY.y<<","<<lY.z<<std::endl;
-      gzmsg<<"z axis: "<<lZ.x<<","<<lZ.y<<","<<lZ.z<<std::endl;*/
+    // Get the pose of the object and compute it's relative position to
+    // the collision surface.
+    GzPose3 objWorldPose = gazebo::GetWorldPose(objCollision->GetLink());
+    GzMatrix4 worldToObj = gazebo::GetMatrix(objWorldPose);
 
-      // Get the pose of the object and compute it's relative position to
-      // the collision surface.
-      GzPose3 objWorldPose = gazebo::GetWorldPose(objCollision->GetLink());
-      GzMatrix4 worldToObj = gazebo::GetMatrix(objWorldPose);
+    GzMatrix4 objInLocal = worldToLinkInv * worldToObj;
+    GzVector3 objPosInLocal = gazebo::GetPos(objInLocal);
 
-      GzMatrix4 objInLocal = worldToLinkInv * worldToObj;
-      GzVector3 objPosInLocal = gazebo::GetPos(objInLocal);
+    // inserts a new entry if it doesn't exist
+    CollidingPoint& p = this->contactFrames[this->producerFrame].Get(objectId * this->collisionLinks.size() + linkId);
+    if (p.sum == 0)
+    {
+      p.collLink = linkCollision;
+      p.collObj = objCollision;
+    }
+    p.force += avgForce;
+    p.pos += contactPosInLocal;
+    p.objPos += objPosInLocal;
+    p.sum++;
+  }
 
-      {
-        boost::mutex::scoped_lock lock(this->mutexContacts);
-        CollidingPoint& p = this->contacts[collidingObjName][collidingLink];  // inserts new entry if doesn't exist
-        p.gripperName = gripperOfCollidingLink;
-        p.collLink = linkCollision;
-        p.collObj = objCollision;
-        p.force += avgForce;
-        p.pos += contactPosInLocal;
-        p.objPos += objPosInLocal;
-        p.sum++;
-      }
-      // gzmsg<<"Average force of contact= "<<avgForce.x<<", "<<avgForce.y<<", "<<avgForce.z<<" out of
-      // "<<force.size()<<" vectors."<<std::endl;
+  // hand the collected contacts over to OnUpdate() if it asked for them
+  if (this->swapRequested.load(std::memory_order_acquire))
+  {
+    int spare = this->spareFrame.exchange(-1, std::memory_order_acq_rel);
+    if (spare >= 0)
+    {
+      this->swapRequested.store(false, std::memory_order_relaxed);
+      this->readyFrame.store(this->producerFrame, std::memory_order_release);
+      this->producerFrame = spare;
     }
   }
 }
@@ -86,6 +86,9 @@ gazebo::physics::ModelPtr GetModelByName(const gazebo::physics::WorldPtr& world,
 ///////////////////////////////////////////////////////////////////////////////
 gazebo::physics::Model_V GetModels(const gazebo::physics::WorldPtr& world);
 
+///////////////////////////////////////////////////////////////////////////////
+gazebo::common::Time GetSimTime(const gazebo::physics::WorldPtr& world);
+
 ///////////////////////////////////////////////////////////////////////////////
 template <typename T>
 GzVector3 GetSize3(const T& t)
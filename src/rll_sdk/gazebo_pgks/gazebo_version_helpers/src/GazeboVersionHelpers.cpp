@@ -307,6 +307,16 @@ gazebo::physics::Model_V gazebo::GetModels(const gazebo::physics::WorldPtr& worl
 #endif
 }
 
+///////////////////////////////////////////////////////////////////////////////
+gazebo::common::Time gazebo::GetSimTime(const gazebo::physics::WorldPtr& world)
+{
+#if GAZEBO_MAJOR_VERSION >= 8
+  return world->SimTime();
+#else
+  return world->GetSimTime();
+#endif
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 gazebo::GzVector3 gazebo::GetBoundingBoxDimensions(const gz_math::Box& box)
 {
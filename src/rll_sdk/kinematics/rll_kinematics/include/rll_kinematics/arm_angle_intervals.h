@@ -96,14 +96,52 @@ private:
   bool overlap_ = false;  // determines if interval is overlapping from Pi to -Pi
 };
 
+// Joint limit crossings in the null space of the previous waypoint of a path. The crossings of consecutive waypoints
+// are close, so the arm angle candidates that crossed a limit before are expected to cross it again as long as the
+// limit is still reached in the null space. Checking this expectation is cheaper than verifying every candidate from
+// scratch, see RLLInvKinNsIntervals::mapLimitToArmAngle().
+class RLLInvKinLimitCrossings
+{
+public:
+  void reset()
+  {
+    valid_ = false;
+  }
+
+  // number of joint limits that started or stopped being reached with the last update, the feasible intervals
+  // changed their structure if this is not zero
+  size_t numChangedLimits() const
+  {
+    return num_changed_limits_;
+  }
+
+private:
+  friend class RLLInvKinNsIntervals;
+
+  // otherwise, the bits store which of the two arm angle candidates of a limit crossed the joint limit
+  static const uint8_t NOT_REACHED = 0xFF;
+  static const uint8_t CANDIDATE_LOWER = 1 << 0;
+  static const uint8_t CANDIDATE_UPPER = 1 << 1;
+
+  // lower and upper limit of the pivot joints first, then of the hinge joints
+  std::array<uint8_t, 2 * (RLL_NUM_JOINTS_P + RLL_NUM_JOINTS_H)> limits_;
+  size_t num_changed_limits_ = 0;
+  bool valid_ = false;
+};
+
 class RLLInvKinNsIntervals : public RLLKinematicsBase
 {
 public:
-  explicit RLLInvKinNsIntervals(RLLInvKinCoeffs coeffs) : coeffs_(std::move(coeffs))
+  // the coefficients are referenced, not copied, and have to outlive the intervals
+  explicit RLLInvKinNsIntervals(const RLLInvKinCoeffs& coeffs) : coeffs_(coeffs)
   {
   }
+  explicit RLLInvKinNsIntervals(RLLInvKinCoeffs&& coeffs) = delete;
 
-  RLLKinMsg computeFeasibleIntervals(const RLLKinJoints& lower_joint_limits, const RLLKinJoints& upper_joint_limits);
+  // If crossings are given, they are updated incrementally from the previous waypoint where possible. They are valid
+  // for the next waypoint afterwards.
+  RLLKinMsg computeFeasibleIntervals(const RLLKinJoints& lower_joint_limits, const RLLKinJoints& upper_joint_limits,
+                                     RLLInvKinLimitCrossings* crossings = nullptr);
   RLLKinMsg intervalForArmAngle(double* query_arm_angle, RLLKinArmAngleInterval* current_interval,
                                 double* fallback_arm_angle) const;
 
@@ -112,15 +150,17 @@ private:
   void feasibleIntervalsFromBlocked();
 
   void mapLimitsToArmAngle(RLLInvKinCoeffs::JointType type, double lower_joint_limit, double upper_joint_limit,
-                           int index);
+                           int index, uint8_t* crossings = nullptr, bool track_crossings = false);
+  uint8_t mapLimitToArmAngle(RLLInvKinIntervalLimits* interval_limits, RLLInvKinCoeffs::JointType type,
+                             double joint_limit, int index, uint8_t previous_crossing) const;
   void determineBlockedIntervals(const RLLInvKinIntervalLimits& interval_limits);
-  void insertLimit(RLLInvKinIntervalLimits* interval_limits, RLLInvKinCoeffs::JointType type, double joint_angle,
-                   double arm_angle, int index);
+  bool insertLimit(RLLInvKinIntervalLimits* interval_limits, RLLInvKinCoeffs::JointType type, double joint_angle,
+                   double arm_angle, int index) const;
 
   // used when query arm angle is in a blocked interval, sets fallback arm angle to middle of closest feasible interval
   RLLKinMsg closestFeasibleArmAngle(int index, double query_arm_angle, double* fallback_arm_angle) const;
 
-  RLLInvKinCoeffs coeffs_;
+  const RLLInvKinCoeffs& coeffs_;
   RLLKinJoints lower_joint_limits_;
   RLLKinJoints upper_joint_limits_;
 
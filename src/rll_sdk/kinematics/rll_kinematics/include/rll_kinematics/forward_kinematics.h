@@ -30,6 +30,17 @@ struct RLLKinJointLimits
   RLLKinJoints upper;
 };
 
+// linear velocities in the top rows, unaligned so that it can be stored in std containers
+using RLLKinJacobian = Eigen::Matrix<double, 6, RLL_NUM_JOINTS, Eigen::DontAlign>;
+
+struct RLLKinLinkFrames
+{
+  // frame i is the DH frame that moves with joint i + 1, the last one is the flange
+  std::array<RLLKinFrame, RLL_NUM_JOINTS> frames;
+  // geometric Jacobian of the flange
+  RLLKinJacobian jacobian;
+};
+
 struct RLLKinShoulderWristVec
 {
   Eigen::Vector3d xsw_n;  // vector from shoulder to wrist, normalized
@@ -49,6 +60,16 @@ public:
                        const RLLKinJoints& joint_velocity_limits, const RLLKinJoints& joint_acceleration_limits);
 
   RLLKinMsg fk(const RLLKinJoints& joint_angles, RLLKinPoseConfig* eef_pose) const;
+  // All link frames and the flange Jacobian of num_states joint vectors, e.g. the waypoints of a trajectory. Joint
+  // limits are not checked. Always evaluates the sparse chain.
+  RLLKinMsg linkFrames(const RLLKinJoints* joint_angles, size_t num_states, RLLKinLinkFrames* link_frames) const;
+
+  // Evaluate the fixed iiwa DH chain with sparse rotation products instead of full DH frame products. The results
+  // only differ in rounding. Must not be changed while the solver is queried.
+  void useSparseChain(bool sparse_chain)
+  {
+    sparse_chain_ = sparse_chain;
+  }
 
 protected:
   RLLKinMsg armAngle(const RLLKinJoints& joint_angles, const RLLKinGlobalConfig& config, double* arm_angle) const;
@@ -107,12 +128,19 @@ private:
   RLLKinMsg armAngle(const RLLKinJoints& joint_angles, const RLLKinGlobalConfig& config, double* arm_angle,
                      RLLKinFrame* flange_pose, RLLKinShoulderWristVec* sw) const;
 
+  RLLKinFrame shoulderPose(double joint_angle_1, double joint_angle_2) const;
+  void linkFrames(const RLLKinJoints& joint_angles, RLLKinLinkFrames* link_frames) const;
+  // shoulder, elbow, wrist and flange pose in base coordinates
+  void chainPoses(const RLLKinJoints& joint_angles, RLLKinFrame* mbs, RLLKinFrame* mbe, RLLKinFrame* mbw,
+                  RLLKinFrame* mbf) const;
+
   // Robot properties
   RLLKinLimbs limb_lengths_;
   RLLKinJointLimits joint_position_limits_;
   RLLKinJoints joint_velocity_limits_;
   RLLKinJoints joint_acceleration_limits_;
   bool dynamic_limits_set_ = false;  // are joint velocity and acceleration limits set?
+  bool sparse_chain_ = false;
 
   bool initialized_ = false;
 };
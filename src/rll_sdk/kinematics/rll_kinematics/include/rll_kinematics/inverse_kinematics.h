@@ -37,7 +37,8 @@ protected:
   RLLKinMsg ikFixedArmAngleFixedConfig(const RLLKinJoints& seed_state, RLLKinPoseConfig* eef_pose,
                                        RLLKinSolutions* solutions) const;
 
-  RLLKinMsg computeFeasibleIntervals(RLLInvKinNsIntervals* intervals) const;
+  RLLKinMsg computeFeasibleIntervals(RLLInvKinNsIntervals* intervals,
+                                     RLLInvKinLimitCrossings* crossings = nullptr) const;
   RLLKinMsg jointAnglesFromFixedArmAngle(double arm_angle, const RLLInvKinCoeffs& coeffs,
                                          RLLKinJoints* joint_angles) const;
   RLLKinMsg jointAnglesFromArmAngle(double arm_angle, const RLLInvKinCoeffs& coeffs, RLLKinJoints* joint_angles,
@@ -97,6 +97,15 @@ public:
     return joint_angle_4_;
   }
 
+  // joint angles for a batch of arm angles, column j holds joint j for all arm angles
+  using ArmAngleArray = Eigen::Array<double, Eigen::Dynamic, 1>;
+  using JointAnglesArray = Eigen::Array<double, Eigen::Dynamic, RLL_NUM_JOINTS>;
+
+  // Evaluate all joint angles at once, sine and cosine of an arm angle are only computed once and the joints are
+  // evaluated with packet operations over the batch. The elbow joint is set to jointAngle4().
+  void jointAngles(const ArmAngleArray& arm_angles, JointAnglesArray* joint_angles) const;
+  void jointAngles(double arm_angle, RLLKinJoints* joint_angles) const;
+
   double jointAngle(JointType type, uint8_t i, double arm_angle) const;
   double jointAnglePivot(uint8_t i, double arm_angle) const;
   double jointAngleHinge(uint8_t i, double arm_angle) const;
@@ -106,6 +115,11 @@ public:
   bool armAngleForJointLimit(JointType type, uint8_t i, double joint_angle, double* arm_angle_lower,
                              double* arm_angle_upper) const;
   bool armAnglePivot(uint8_t i, double joint_angle, double* arm_angle_lower, double* arm_angle_upper) const;
+  // Both candidates of armAnglePivot() solve tan(joint) = tan(joint_angle), the signs of the atan2() arguments decide
+  // whether the joint angle or the joint angle +-pi is reached. Cheaper than comparing with jointAnglePivot(), the
+  // derivative is computed along the way.
+  bool pivotCandidateReachesAngle(uint8_t i, double arm_angle, double sin_joint_angle, double cos_joint_angle,
+                                  double* joint_derivative) const;
   bool armAngleHinge(uint8_t i, double joint_angle, double* arm_angle_lower, double* arm_angle_upper) const;
 
   bool pivotSingularity(uint8_t i, double* value) const;
@@ -0,0 +1,146 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_KINEMATICS_REACHABILITY_MAP_H
+#define RLL_KINEMATICS_REACHABILITY_MAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rll_kinematics/forward_kinematics.h>
+
+// Layout of a reachability map file. The header is directly followed by one byte per cell, the cells are ordered by
+// voxel x, y, z and orientation bin. Each byte is a bitmask of the arm angle sectors in which the cell was reached, so
+// zero marks a cell that is unreachable.
+struct RLLKinReachabilityGrid
+{
+  static const uint32_t FILE_VERSION = 1;
+  static const int NUM_ARM_ANGLE_SECTORS = 8;
+  static const uint8_t ALL_ARM_ANGLE_SECTORS = 0xFF;
+
+  // the orientation is binned by the direction of the flange z-axis on a cube map with bins_per_face^2 bins per face
+  uint32_t numOrientationBins() const
+  {
+    return 6 * bins_per_face * bins_per_face;
+  }
+
+  size_t numCells() const
+  {
+    return static_cast<size_t>(num_voxels[0]) * num_voxels[1] * num_voxels[2] * numOrientationBins();
+  }
+
+  // returns false if the position is outside of the grid
+  bool cellIndex(const RLLKinFrame& pose, size_t* index) const;
+  uint32_t orientationBin(const Eigen::Vector3d& direction) const;
+
+  static int armAngleSector(double arm_angle);
+
+  bool matches(const RLLKinLimbs& limbs, const RLLKinJointLimits& joint_position_limits) const;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t bins_per_face;
+  uint32_t num_voxels[3];
+  uint32_t reserved;
+  double origin[3];  // lower corner of the grid
+  double voxel_size;
+  // the map is only valid for the robot it was generated for
+  double limb_lengths[4];
+  double lower_joint_limits[RLL_NUM_JOINTS];
+  double upper_joint_limits[RLL_NUM_JOINTS];
+  uint64_t num_samples;
+};
+
+// Read-only lookup into a precomputed reachability map, the map file is memory-mapped.
+//
+// The map is generated offline by sampling the forward kinematics, so it only knows about cells that have been reached
+// by at least one sample. It is meant as a cheap pre-check before the IK: a pose is only reported unreachable if
+// nothing was reached in its cell and the neighboring cells.
+class RLLKinReachabilityMap
+{
+public:
+  RLLKinReachabilityMap() = default;
+  ~RLLKinReachabilityMap();
+
+  RLLKinReachabilityMap(const RLLKinReachabilityMap&) = delete;
+  RLLKinReachabilityMap& operator=(const RLLKinReachabilityMap&) = delete;
+
+  // returns false if the file cannot be mapped or is not a valid map
+  bool load(const std::string& file_name);
+  void unload();
+
+  bool loaded() const
+  {
+    return grid_ != nullptr;
+  }
+
+  const RLLKinReachabilityGrid* grid() const
+  {
+    return grid_;
+  }
+
+  // bitmask of the arm angle sectors in which the pose can be reached, the sector of an arm angle is given by
+  // RLLKinReachabilityGrid::armAngleSector(), all sectors are returned if no map is loaded
+  uint8_t armAngleSectors(const RLLKinFrame& pose) const;
+
+  bool reachable(const RLLKinFrame& pose) const
+  {
+    return armAngleSectors(pose) != 0;
+  }
+
+  bool reachable(const RLLKinFrame& pose, double arm_angle) const
+  {
+    return (armAngleSectors(pose) & (1U << RLLKinReachabilityGrid::armAngleSector(arm_angle))) != 0;
+  }
+
+private:
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  const RLLKinReachabilityGrid* grid_ = nullptr;
+  const uint8_t* cells_ = nullptr;
+};
+
+// Accumulates forward kinematics samples into a reachability map and writes the map file.
+class RLLKinReachabilityMapBuilder
+{
+public:
+  RLLKinReachabilityMapBuilder(const RLLKinLimbs& limbs, const RLLKinJointLimits& joint_position_limits,
+                               double voxel_size, uint32_t bins_per_face);
+
+  // eef_pose as computed by RLLForwardKinematics::fk()
+  void addSample(const RLLKinPoseConfig& eef_pose, bool singular);
+
+  // Extends every reached cell to its neighboring voxels and arm angle sectors, so that the map does not reject poses
+  // that lie between samples. Call once after all samples were added.
+  void dilate();
+
+  bool save(const std::string& file_name) const;
+
+  const RLLKinReachabilityGrid& grid() const
+  {
+    return grid_;
+  }
+
+  size_t numReachedCells() const;
+
+private:
+  RLLKinReachabilityGrid grid_;
+  std::vector<uint8_t> cells_;
+};
+
+#endif  // RLL_KINEMATICS_REACHABILITY_MAP_H
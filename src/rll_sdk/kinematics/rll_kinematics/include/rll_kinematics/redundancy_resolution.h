@@ -60,6 +60,16 @@ struct RLLInvKinOptions
   double joint_acceleration_scaling_factor = 1.0;
   bool minimize_acceleration = true;
   bool use_numerical_solver = false;
+
+  // Evaluate the global configurations concurrently on a small pool of helper threads. With
+  // SELECT_NEAREST_GLOBAL_CONFIG, the remaining configurations are skipped once a solution within
+  // GLOBAL_CONFIG_DISTANCE_TOL of the seed state is found.
+  bool parallel_global_configs = false;
+
+  // ikPath() stops before the first pose whose arm angle leaves the feasible interval of the previous pose and returns
+  // ARMANGLE_NOT_IN_SAME_INTERVAL, the joints would jump there
+  bool stop_at_arm_angle_jump = false;
+
   double d_v = 1.0;
   double d_a = 1.0;
   double d_l = 1.0;
@@ -69,6 +79,26 @@ struct RLLInvKinOptions
 
 std::ostream& operator<<(std::ostream& output, const RLLInvKinOptions& rll_inv_kin_opt);
 
+// State of the numerical multi-objective optimization at the previous waypoint of a path. The cost functions of
+// consecutive waypoints are close, so the curvature at the previous optimum is a good first Newton step for the next
+// one, see RLLKinMultiObjOptimization::optimalArmAngleNumerical().
+class RLLKinArmAngleWarmStart
+{
+public:
+  void reset()
+  {
+    valid_ = false;
+  }
+
+private:
+  friend class RLLKinMultiObjOptimization;
+
+  double curvature_ = 0.0;
+  bool valid_ = false;
+};
+
+// The solver has no mutable state, all intermediate results of a query live on the caller's stack. After
+// initialize() returned, the const member functions can be called concurrently on the same instance.
 class RLLRedundancyResolution : public RLLInverseKinematics
 {
 public:
@@ -77,6 +107,22 @@ public:
   RLLKinMsg ik(const RLLKinSeedState& seed_state, RLLKinPoseConfig* ik_pose, RLLKinSolutions* solution,
                const RLLInvKinOptions& options) const;
 
+  // Solve the IK for a sequence of poses, e.g. the waypoints of a linear motion. The global configuration of the seed
+  // state is kept and each solution becomes part of the seed state for the next pose. The solutions array needs room
+  // for num_poses entries. Stops at the first pose without a solution, num_solved is the number of solved poses.
+  // The feasible arm angle intervals are updated incrementally from one pose to the next. See stop_at_arm_angle_jump
+  // to detect discontinuities of the path.
+  RLLKinMsg ikPath(const RLLKinSeedState& seed_state, const RLLKinFrame* poses, size_t num_poses,
+                   RLLKinJoints* solutions, size_t* num_solved, const RLLInvKinOptions& options) const;
+
+  // Solve the IK for one pose at a sequence of fixed arm angles, e.g. the waypoints of an arm angle motion. The global
+  // configuration of the seed state is kept, so the coefficients and the feasible arm angle intervals of the pose are
+  // only computed once. Stops at the first arm angle without a solution. If two consecutive arm angles lie in
+  // different feasible intervals, the joint limits are violated in between and ARMANGLE_NOT_IN_SAME_INTERVAL is
+  // returned.
+  RLLKinMsg ikArmAngles(const RLLKinSeedState& seed_state, const RLLKinFrame& pose, const double* arm_angles,
+                        size_t num_arm_angles, RLLKinJoints* solutions, size_t* num_solved) const;
+
 protected:
   // redundancy resolution using fixed arm angle and variable global config
   RLLKinMsg ikFixedArmAngle(const RLLKinSeedState& seed_state, RLLKinPoseConfig* ik_pose, RLLKinSolutions* solution,
@@ -88,20 +134,33 @@ protected:
   // get closest solution to seed-state using optimization of arm angle defined in optimize()
   RLLKinMsg ikClosestConfig(const RLLKinSeedState& seed_state, RLLKinPoseConfig* ik_pose, RLLKinSolutions* solution,
                             const RLLInvKinOptions& options) const;
-  // actual redundancy resolution
+  RLLKinMsg ikClosestConfigParallel(const RLLKinSeedState& seed_state, double seed_arm_angle,
+                                    RLLKinGlobalConfigs* configs, RLLKinPoseConfig* ik_pose,
+                                    RLLKinSolutions* solutions, const RLLInvKinOptions& options) const;
+  // actual redundancy resolution, the crossings and the optimizer state of the previous waypoint can be passed along
+  // a path
   RLLKinMsg redundancyResolution(const RLLInvKinCoeffs& coeffs, const RLLInvKinOptions& options, double arm_angle_seed,
-                                 double* arm_angle_new, RLLKinJoints* solution) const;
+                                 double* arm_angle_new, RLLKinJoints* solution,
+                                 RLLInvKinLimitCrossings* crossings = nullptr,
+                                 RLLKinArmAngleWarmStart* warm_start = nullptr) const;
   // redundancy resolution using multi-objective optimization
   RLLKinMsg optimizationMultiObjective(const RLLInvKinCoeffs& coeffs, const RLLInvKinOptions& options,
-                                       double arm_angle_seed, double* arm_angle_new, RLLKinJoints* solution) const;
+                                       double arm_angle_seed, double* arm_angle_new, RLLKinJoints* solution,
+                                       RLLInvKinLimitCrossings* crossings = nullptr,
+                                       RLLKinArmAngleWarmStart* warm_start = nullptr) const;
   // redundancy resolution using exponential function
   RLLKinMsg optimizationPositionExp(const RLLInvKinCoeffs& coeffs, const RLLInvKinOptions& options,
-                                    double arm_angle_seed, double* arm_angle_new, RLLKinJoints* solution) const;
+                                    double arm_angle_seed, double* arm_angle_new, RLLKinJoints* solution,
+                                    RLLInvKinLimitCrossings* crossings = nullptr) const;
   RLLKinMsg optimizationFixedArmAngle(const RLLInvKinCoeffs& coeffs, const RLLInvKinOptions& options,
                                       double arm_angle_seed, double* arm_angle_new, RLLKinJoints* solution) const;
+  // used if the seed arm angle is not feasible, keeps ARMANGLE_NOT_IN_SAME_INTERVAL if the fallback succeeds
+  RLLKinMsg fallbackResolution(RLLKinMsg interval_result, double fallback_arm_angle, const RLLInvKinCoeffs& coeffs,
+                               double* arm_angle_new, RLLKinJoints* solution) const;
 
   double multiObjectiveResolution(const RLLInvKinCoeffs& coeffs, const RLLInvKinOptions& options, double arm_angle_old,
-                                  const RLLKinArmAngleInterval& current_interval) const;
+                                  const RLLKinArmAngleInterval& current_interval,
+                                  RLLKinArmAngleWarmStart* warm_start = nullptr) const;
   static double expResolution(const RLLInvKinOptions& options, double arm_angle_old, double lower_limit,
                               double upper_limit);
 
@@ -148,25 +207,34 @@ protected:
 class RLLKinMultiObjOptimization : public RLLKinematicsBase
 {
 public:
-  RLLKinMultiObjOptimization(RLLInvKinCoeffs coeffs, const RLLInvKinOptions& options, const double arm_angle_old,
+  // coefficients and options are referenced, not copied, and have to outlive the optimization
+  RLLKinMultiObjOptimization(const RLLInvKinCoeffs& coeffs, const RLLInvKinOptions& options, const double arm_angle_old,
                              const RLLKinArmAngleInterval& arm_angle_interval)
-    : coeffs_(std::move(coeffs))
-    , options_(options)
-    , arm_angle_old_(arm_angle_old)
-    , arm_angle_interval_(arm_angle_interval)
+    : coeffs_(coeffs), options_(options), arm_angle_old_(arm_angle_old), arm_angle_interval_(arm_angle_interval)
   {
   }
+  RLLKinMultiObjOptimization(RLLInvKinCoeffs&& coeffs, const RLLInvKinOptions& options, double arm_angle_old,
+                             const RLLKinArmAngleInterval& arm_angle_interval) = delete;
 
-  double optimalArmAngle(const RLLKinJoints& joint_velocity_limits, const RLLKinJoints& joint_acceleration_limits);
+  // the warm start is only used and updated by the numerical solver
+  double optimalArmAngle(const RLLKinJoints& joint_velocity_limits, const RLLKinJoints& joint_acceleration_limits,
+                         RLLKinArmAngleWarmStart* warm_start = nullptr);
 
 protected:
+  // Newton iterations are stopped if the step is smaller, the Brent search is the fallback if they do not converge
+  static const double NEWTON_ARM_ANGLE_TOL;
+  static const int NEWTON_MAX_ITERATIONS = 30;
+
   double optimalArmAngleClosedForm() const;
-  double optimalArmAngleNumerical() const;
+  // safeguarded Newton's method on the analytic derivative of the cost function
+  double optimalArmAngleNumerical(RLLKinArmAngleWarmStart* warm_start) const;
+  double optimalArmAngleBrent() const;
   void limitWeightsArmAngle(double* w_dis, double* w_tilde_l, double* arm_angle_l) const;
   void dynamicWeights(double w_dis, double* w_v, double* w_a) const;
   void closedFormArmAngleVelAccel(double* arm_angle_v_n, double* arm_angle_v_d, double* arm_angle_a_n,
                                   double* arm_angle_a_d) const;
   double costFunction(double arm_angle) const;
+  double costFunctionDerivative(double arm_angle) const;
   void deltaT(double arm_angle_v, double arm_angle_a, double* delta_t_v, double* delta_t_a) const;
 
   double maxVelocity(size_t index) const
@@ -197,8 +265,8 @@ protected:
   };
 
 private:
-  RLLInvKinCoeffs coeffs_;
-  RLLInvKinOptions options_;
+  const RLLInvKinCoeffs& coeffs_;
+  const RLLInvKinOptions& options_;
   double arm_angle_old_;
   RLLKinArmAngleInterval arm_angle_interval_;
 
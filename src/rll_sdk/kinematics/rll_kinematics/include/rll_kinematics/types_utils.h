@@ -166,6 +166,8 @@ class RLLKinFrame : public RLLKinematicsBase
 public:
   RLLKinFrame() = default;
   RLLKinFrame(double d, double theta, double a, double alpha);  // construct frame from DH-parameters
+  // declared together with the user-provided copy assignment, which would deprecate the implicit copy constructor
+  RLLKinFrame(const RLLKinFrame&) = default;
 
   Eigen::Matrix3d const& ori() const
   {
@@ -190,7 +192,12 @@ public:
   RLLKinFrame& operator=(const RLLKinFrame& rhs);
   friend std::ostream& operator<<(std::ostream& out, const RLLKinFrame& pose);
 
-  bool allFinite()
+  // In-place *this = *this * RLLKinFrame(d, theta, 0.0, alpha) for alpha = SinAlpha * pi/2 with SinAlpha -1, 0 or 1.
+  // Only the non-zero entries of the DH rotation are multiplied, the sine and cosine of theta are passed in.
+  template <int SinAlpha>
+  void appendDHFrame(double d, double cos_theta, double sin_theta);
+
+  bool allFinite() const
   {
     return pos_.allFinite() && ori_.allFinite();
   }
@@ -202,6 +209,26 @@ private:
 
 std::ostream& operator<<(std::ostream& out, const RLLKinFrame& pose);
 
+template <int SinAlpha>
+void RLLKinFrame::appendDHFrame(const double d, const double cos_theta, const double sin_theta)
+{
+  static_assert(SinAlpha >= -1 && SinAlpha <= 1, "alpha has to be -pi/2, 0 or pi/2");
+
+  pos_.noalias() += d * ori_.col(2);
+  Eigen::Vector3d x = cos_theta * ori_.col(0) + sin_theta * ori_.col(1);
+  Eigen::Vector3d y = cos_theta * ori_.col(1) - sin_theta * ori_.col(0);
+  ori_.col(0) = x;
+  if (SinAlpha == 0)
+  {
+    ori_.col(1) = y;
+  }
+  else
+  {
+    ori_.col(1) = SinAlpha * ori_.col(2);
+    ori_.col(2) = -SinAlpha * y;
+  }
+}
+
 class RLLKinGlobalConfig
 {
 public:
@@ -19,6 +19,10 @@
 
 #include <rll_kinematics/arm_angle_intervals.h>
 
+const uint8_t RLLInvKinLimitCrossings::NOT_REACHED;
+const uint8_t RLLInvKinLimitCrossings::CANDIDATE_LOWER;
+const uint8_t RLLInvKinLimitCrossings::CANDIDATE_UPPER;
+
 void RLLKinArmAngleInterval::setLimits(const double lower, const double upper)
 {
   setLowerLimit(lower);
@@ -148,8 +152,8 @@ void RLLInvKinNsIntervals::determineBlockedIntervals(const RLLInvKinIntervalLimi
   }
 }
 
-void RLLInvKinNsIntervals::insertLimit(RLLInvKinIntervalLimits* interval_limits, const RLLInvKinCoeffs::JointType type,
-                                       const double joint_angle, const double arm_angle, const int index)
+bool RLLInvKinNsIntervals::insertLimit(RLLInvKinIntervalLimits* interval_limits, const RLLInvKinCoeffs::JointType type,
+                                       const double joint_angle, const double arm_angle, const int index) const
 {
   // check if calculated arm angle limit is matching to limit in joint-space
   // if this is not the case, the joint angle does not coincide with the joint limits for any arm angle in the [−pi, pi]
@@ -160,27 +164,97 @@ void RLLInvKinNsIntervals::insertLimit(RLLInvKinIntervalLimits* interval_limits,
     double joint_derivative = coeffs_.jointDerivative(type, index, arm_angle, joint_angle);
 
     interval_limits->emplace_back(arm_angle, joint_angle, joint_derivative);
+    return true;
   }
+
+  return false;
 }
 
-void RLLInvKinNsIntervals::mapLimitsToArmAngle(const RLLInvKinCoeffs::JointType type, const double lower_joint_limit,
-                                               const double upper_joint_limit, const int index)
+uint8_t RLLInvKinNsIntervals::mapLimitToArmAngle(RLLInvKinIntervalLimits* interval_limits,
+                                                 const RLLInvKinCoeffs::JointType type, const double joint_limit,
+                                                 const int index, const uint8_t previous_crossing) const
 {
-  RLLInvKinIntervalLimits interval_limits;
   double arm_angle_lower, arm_angle_upper;
+  if (!coeffs_.armAngleForJointLimit(type, index, joint_limit, &arm_angle_lower, &arm_angle_upper))
+  {
+    return RLLInvKinLimitCrossings::NOT_REACHED;
+  }
+
+  bool lower = (previous_crossing & RLLInvKinLimitCrossings::CANDIDATE_LOWER) != 0;
+  bool upper = (previous_crossing & RLLInvKinLimitCrossings::CANDIDATE_UPPER) != 0;
+  if (previous_crossing != RLLInvKinLimitCrossings::NOT_REACHED && type == RLLInvKinCoeffs::HINGE_JOINT)
+  {
+    // The candidates solve cos(joint) = cos(joint_limit) and the sign of the hinge joint is set by the global config,
+    // so the candidates that crossed the limit before still do.
+    if (lower)
+    {
+      double derivative = coeffs_.jointDerivative(type, index, arm_angle_lower, joint_limit);
+      interval_limits->emplace_back(arm_angle_lower, joint_limit, derivative);
+    }
+    if (upper)
+    {
+      double derivative = coeffs_.jointDerivative(type, index, arm_angle_upper, joint_limit);
+      interval_limits->emplace_back(arm_angle_upper, joint_limit, derivative);
+    }
+
+    return previous_crossing;
+  }
+
+  if (previous_crossing != RLLInvKinLimitCrossings::NOT_REACHED)
+  {
+    double sin_limit = sin(joint_limit);
+    double cos_limit = cos(joint_limit);
+    double derivative_lower, derivative_upper;
+    bool reaches_lower =
+        coeffs_.pivotCandidateReachesAngle(index, arm_angle_lower, sin_limit, cos_limit, &derivative_lower);
+    bool reaches_upper =
+        coeffs_.pivotCandidateReachesAngle(index, arm_angle_upper, sin_limit, cos_limit, &derivative_upper);
+
+    // Otherwise, a candidate switched between the limit and the limit +-pi, e.g. the path passes close to a
+    // singularity. A full verification is needed then.
+    if (reaches_lower == lower && reaches_upper == upper)
+    {
+      if (lower)
+      {
+        interval_limits->emplace_back(arm_angle_lower, joint_limit, derivative_lower);
+      }
+      if (upper)
+      {
+        interval_limits->emplace_back(arm_angle_upper, joint_limit, derivative_upper);
+      }
 
-  // map lower joint limits to arm angle
-  if (coeffs_.armAngleForJointLimit(type, index, lower_joint_limit, &arm_angle_lower, &arm_angle_upper))
+      return previous_crossing;
+    }
+  }
+
+  uint8_t crossing = 0;
+  if (insertLimit(interval_limits, type, joint_limit, arm_angle_lower, index))
   {
-    insertLimit(&interval_limits, type, lower_joint_limit, arm_angle_lower, index);
-    insertLimit(&interval_limits, type, lower_joint_limit, arm_angle_upper, index);
+    crossing |= RLLInvKinLimitCrossings::CANDIDATE_LOWER;
   }
+  if (insertLimit(interval_limits, type, joint_limit, arm_angle_upper, index))
+  {
+    crossing |= RLLInvKinLimitCrossings::CANDIDATE_UPPER;
+  }
+
+  return crossing;
+}
+
+void RLLInvKinNsIntervals::mapLimitsToArmAngle(const RLLInvKinCoeffs::JointType type, const double lower_joint_limit,
+                                               const double upper_joint_limit, const int index, uint8_t* crossings,
+                                               const bool track_crossings)
+{
+  RLLInvKinIntervalLimits interval_limits;
 
-  // map upper joint limits to arm angle
-  if (coeffs_.armAngleForJointLimit(type, index, upper_joint_limit, &arm_angle_lower, &arm_angle_upper))
+  // map lower and upper joint limits to arm angle
+  uint8_t previous_lower = track_crossings ? crossings[0] : RLLInvKinLimitCrossings::NOT_REACHED;
+  uint8_t previous_upper = track_crossings ? crossings[1] : RLLInvKinLimitCrossings::NOT_REACHED;
+  uint8_t crossing_lower = mapLimitToArmAngle(&interval_limits, type, lower_joint_limit, index, previous_lower);
+  uint8_t crossing_upper = mapLimitToArmAngle(&interval_limits, type, upper_joint_limit, index, previous_upper);
+  if (crossings != nullptr)
   {
-    insertLimit(&interval_limits, type, upper_joint_limit, arm_angle_lower, index);
-    insertLimit(&interval_limits, type, upper_joint_limit, arm_angle_upper, index);
+    crossings[0] = crossing_lower;
+    crossings[1] = crossing_upper;
   }
 
   if (interval_limits.empty())
@@ -323,25 +397,54 @@ RLLKinMsg RLLInvKinNsIntervals::intervalForArmAngle(double* query_arm_angle, RLL
 }
 
 RLLKinMsg RLLInvKinNsIntervals::computeFeasibleIntervals(const RLLKinJoints& lower_joint_limits,
-                                                         const RLLKinJoints& upper_joint_limits)
+                                                         const RLLKinJoints& upper_joint_limits,
+                                                         RLLInvKinLimitCrossings* crossings)
 {
   const double MARGIN_SINGULARITY = 10 * ZERO_ROUNDING_TOL;
 
+  RLLInvKinLimitCrossings previous;
+  bool track_crossings = false;
+  if (crossings != nullptr)
+  {
+    previous = *crossings;
+    track_crossings = crossings->valid_;
+  }
+
   for (uint8_t i = 0; i < RLL_NUM_JOINTS_P; ++i)
   {
     double psi_singular;
-    if (coeffs_.pivotSingularity(i, &psi_singular))
+    bool singular = coeffs_.pivotSingularity(i, &psi_singular);
+    if (singular)
     {
       // blocked interval due to singularity at psi_singular
       blocked_intervals_.emplace_back(psi_singular - MARGIN_SINGULARITY, psi_singular + MARGIN_SINGULARITY);
     }
 
-    mapLimitsToArmAngle(RLLInvKinCoeffs::PIVOT_JOINT, lower_joint_limits(2 * i), upper_joint_limits(2 * i), i);
+    // close to a singularity, the candidates can switch between crossing the limit and not, so they are verified
+    uint8_t* joint_crossings = crossings != nullptr ? &crossings->limits_[2 * i] : nullptr;
+    mapLimitsToArmAngle(RLLInvKinCoeffs::PIVOT_JOINT, lower_joint_limits(2 * i), upper_joint_limits(2 * i), i,
+                        joint_crossings, track_crossings && !singular);
   }
 
   for (uint8_t i = 0; i < RLL_NUM_JOINTS_H; ++i)
   {
-    mapLimitsToArmAngle(RLLInvKinCoeffs::HINGE_JOINT, lower_joint_limits(4 * i + 1), upper_joint_limits(4 * i + 1), i);
+    uint8_t* joint_crossings = crossings != nullptr ? &crossings->limits_[2 * (RLL_NUM_JOINTS_P + i)] : nullptr;
+    mapLimitsToArmAngle(RLLInvKinCoeffs::HINGE_JOINT, lower_joint_limits(4 * i + 1), upper_joint_limits(4 * i + 1), i,
+                        joint_crossings, track_crossings);
+  }
+
+  if (crossings != nullptr)
+  {
+    crossings->num_changed_limits_ = 0;
+    for (size_t i = 0; track_crossings && i < crossings->limits_.size(); ++i)
+    {
+      if ((previous.limits_[i] == RLLInvKinLimitCrossings::NOT_REACHED) !=
+          (crossings->limits_[i] == RLLInvKinLimitCrossings::NOT_REACHED))
+      {
+        ++crossings->num_changed_limits_;
+      }
+    }
+    crossings->valid_ = true;
   }
 
   std::sort(blocked_intervals_.begin(), blocked_intervals_.end());
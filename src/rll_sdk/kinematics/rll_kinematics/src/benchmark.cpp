@@ -0,0 +1,283 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <rll_kinematics/redundancy_resolution.h>
+
+// Microbenchmarks for the kinematics solver. The samples are generated from reproducible random joint angles across
+// the workspace, so that results of different builds are comparable.
+//
+// usage: rll_kinematics_benchmark [num_samples] [repetitions] [random_seed]
+
+namespace
+{
+std::atomic<size_t> num_allocations{ 0 };
+}  // namespace
+
+void* operator new(size_t size)
+{
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*unused*/) noexcept
+{
+  std::free(ptr);
+}
+
+namespace
+{
+// exposes the internal stages of the solver
+class RLLKinBenchmarkSolver : public RLLRedundancyResolution
+{
+public:
+  using RLLForwardKinematics::jointAccelerationLimits;
+  using RLLForwardKinematics::jointVelocityLimits;
+  using RLLInverseKinematics::computeFeasibleIntervals;
+  using RLLInverseKinematics::setCoeffsWithInitCheck;
+
+  RLLKinMsg seedArmAngle(const RLLKinJoints& joint_angles, const RLLKinGlobalConfig& config, double* arm_angle) const
+  {
+    return armAngle(joint_angles, config, arm_angle);
+  }
+};
+
+struct BenchmarkSample
+{
+  RLLKinSeedState seed_state;
+  RLLKinPoseConfig pose;
+  RLLInvKinCoeffs coeffs;
+  double seed_arm_angle;
+};
+
+const RLLKinLimbs LIMB_LENGTHS = { 0.34, 0.4, 0.4, 0.126 };
+const double SEED_NOISE = 0.05;
+
+std::vector<BenchmarkSample> generateSamples(const RLLKinBenchmarkSolver& solver, const RLLKinJointLimits& limits,
+                                            size_t num_samples, unsigned int random_seed)
+{
+  std::mt19937 generator(random_seed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::uniform_real_distribution<double> noise(-SEED_NOISE, SEED_NOISE);
+
+  std::vector<BenchmarkSample> samples;
+  while (samples.size() < num_samples)
+  {
+    BenchmarkSample sample;
+    RLLKinJoints joint_angles, seed;
+    for (int i = 0; i < RLL_NUM_JOINTS; ++i)
+    {
+      // stay away from the joint limits, the seed state is sampled around the goal
+      double lower = 0.9 * limits.lower(i) + SEED_NOISE;
+      double upper = 0.9 * limits.upper(i) - SEED_NOISE;
+      joint_angles[i] = lower + unit(generator) * (upper - lower);
+      seed[i] = joint_angles(i) + noise(generator);
+    }
+
+    if (solver.fk(joint_angles, &sample.pose).error())
+    {
+      continue;
+    }
+
+    sample.seed_state.push_back(seed);
+    sample.seed_state.push_back(seed);
+
+    if (solver.seedArmAngle(seed, sample.pose.config, &sample.seed_arm_angle).error())
+    {
+      continue;
+    }
+
+    double joint_angle_4;
+    sample.coeffs.setSeedState(sample.seed_state);
+    if (solver.setCoeffsWithInitCheck(sample.pose, &sample.coeffs, &joint_angle_4).error())
+    {
+      continue;
+    }
+
+    samples.push_back(sample);
+  }
+
+  return samples;
+}
+
+template <typename Call>
+void runBenchmark(const std::string& name, const std::vector<BenchmarkSample>& samples, size_t repetitions,
+                  Call call)
+{
+  // warm up caches and lazily initialized state
+  for (const auto& sample : samples)
+  {
+    call(sample);
+  }
+
+  size_t num_successful = 0;
+  size_t allocations_before = num_allocations.load();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t r = 0; r < repetitions; ++r)
+  {
+    for (const auto& sample : samples)
+    {
+      if (call(sample))
+      {
+        ++num_successful;
+      }
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  size_t allocations = num_allocations.load() - allocations_before;
+
+  double num_calls = static_cast<double>(samples.size() * repetitions);
+  double seconds = std::chrono::duration<double>(end - start).count();
+  std::printf("%-56s %10.0f %14.0f %12.2f %9.1f\n", name.c_str(), seconds * 1E09 / num_calls,
+              num_successful / seconds, allocations / num_calls, 100.0 * num_successful / num_calls);
+}
+
+const char* methodName(RLLInvKinOptions::Method method)
+{
+  switch (method)
+  {
+    case RLLInvKinOptions::POSITION_RESOLUTION_EXP:
+      return "POSITION_RESOLUTION_EXP";
+    case RLLInvKinOptions::RESOLUTION_MULTI_OBJECTIVE:
+      return "RESOLUTION_MULTI_OBJECTIVE";
+    case RLLInvKinOptions::ARM_ANGLE_FIXED:
+      return "ARM_ANGLE_FIXED";
+  }
+  return "";
+}
+
+const char* modeName(RLLInvKinOptions::GlobalConfigurationControl mode)
+{
+  switch (mode)
+  {
+    case RLLInvKinOptions::SELECT_NEAREST_GLOBAL_CONFIG:
+      return "nearest";
+    case RLLInvKinOptions::KEEP_CURRENT_GLOBAL_CONFIG:
+      return "keep";
+    case RLLInvKinOptions::RETURN_ALL_GLOBAL_CONFIGS:
+      return "all";
+  }
+  return "";
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  size_t num_samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  size_t repetitions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+  unsigned int random_seed = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 42;
+
+  RLLKinBenchmarkSolver solver;
+  RLLKinJointLimits joint_position_limits;
+  RLLKinJoints joint_velocity_limits, joint_acceleration_limits;
+  joint_position_limits.lower = { -2.93215, -2.05949, -2.93215, -2.05949, -2.93215, -2.05949, -3.01942 };
+  joint_position_limits.upper = { 2.93215, 2.05949, 2.93215, 2.05949, 2.93215, 2.05949, 3.01942 };
+  joint_velocity_limits = { 1.7104, 1.7104, 1.7453, 2.2689, 2.4434, 3.1415, 3.1415 };
+  joint_acceleration_limits = { 5.4444, 5.4444, 5.5555, 7.2222, 7.7777, 10.0, 10.0 };
+
+  if (solver.initialize(LIMB_LENGTHS, joint_position_limits, joint_velocity_limits, joint_acceleration_limits).error())
+  {
+    std::cout << "error: failed to initialize the kinematics solver" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<BenchmarkSample> samples = generateSamples(solver, joint_position_limits, num_samples, random_seed);
+  std::cout << samples.size() << " samples, " << repetitions << " repetitions, random seed " << random_seed
+            << std::endl;
+  std::printf("%-56s %10s %14s %12s %9s\n", "benchmark", "ns/call", "solutions/s", "allocs/call", "success%");
+
+  runBenchmark("fk", samples, repetitions, [&](const BenchmarkSample& sample) {
+    RLLKinPoseConfig pose;
+    return solver.fk(sample.seed_state.front(), &pose).success();
+  });
+
+  runBenchmark("computeFeasibleIntervals", samples, repetitions, [&](const BenchmarkSample& sample) {
+    RLLInvKinNsIntervals intervals(sample.coeffs);
+    return solver.computeFeasibleIntervals(&intervals).success();
+  });
+
+  for (bool numerical : { false, true })
+  {
+    RLLInvKinOptions options;
+    options.use_numerical_solver = numerical;
+    std::string name = numerical ? "optimalArmAngleNumerical" : "optimalArmAngleClosedForm";
+
+    runBenchmark(name, samples, repetitions, [&](const BenchmarkSample& sample) {
+      RLLInvKinNsIntervals intervals(sample.coeffs);
+      solver.computeFeasibleIntervals(&intervals);
+      RLLKinArmAngleInterval interval;
+      double arm_angle = sample.seed_arm_angle, fallback_arm_angle;
+      RLLKinMsg result = intervals.intervalForArmAngle(&arm_angle, &interval, &fallback_arm_angle);
+      if (result.error() || result.val() == RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL)
+      {
+        return false;
+      }
+
+      RLLKinMultiObjOptimization optimization(sample.coeffs, options, arm_angle, interval);
+      return std::isfinite(optimization.optimalArmAngle(solver.jointVelocityLimits(),
+                                                        solver.jointAccelerationLimits()));
+    });
+  }
+
+  for (auto method : { RLLInvKinOptions::POSITION_RESOLUTION_EXP, RLLInvKinOptions::RESOLUTION_MULTI_OBJECTIVE,
+                       RLLInvKinOptions::ARM_ANGLE_FIXED })
+  {
+    for (bool numerical : { false, true })
+    {
+      if (numerical && method != RLLInvKinOptions::RESOLUTION_MULTI_OBJECTIVE)
+      {
+        continue;
+      }
+
+      for (auto mode : { RLLInvKinOptions::SELECT_NEAREST_GLOBAL_CONFIG, RLLInvKinOptions::KEEP_CURRENT_GLOBAL_CONFIG,
+                         RLLInvKinOptions::RETURN_ALL_GLOBAL_CONFIGS })
+      {
+        RLLInvKinOptions options;
+        options.method = method;
+        options.use_numerical_solver = numerical;
+        options.global_configuration_mode = mode;
+        std::string name = std::string("ik ") + methodName(method) + (numerical ? " numerical" : "") + " " +
+                           modeName(mode);
+
+        runBenchmark(name, samples, repetitions, [&](const BenchmarkSample& sample) {
+          RLLKinPoseConfig pose = sample.pose;
+          RLLKinSolutions solutions;
+          return solver.ik(sample.seed_state, &pose, &solutions, options).success();
+        });
+      }
+    }
+  }
+
+  exit(EXIT_SUCCESS);
+}
@@ -99,6 +99,68 @@ RLLKinMsg RLLForwardKinematics::fk(const RLLKinJoints& joint_angles, RLLKinPoseC
   return checkSingularities(joint_angles, sw);
 }
 
+RLLKinMsg RLLForwardKinematics::linkFrames(const RLLKinJoints* joint_angles, const size_t num_states,
+                                           RLLKinLinkFrames* link_frames) const
+{
+  if (!initialized())
+  {
+    return RLLKinMsg::NOT_INITIALIZED;
+  }
+
+  for (size_t i = 0; i < num_states; ++i)
+  {
+    if (!joint_angles[i].allFinite())
+    {
+      return RLLKinMsg::INVALID_INPUT;
+    }
+  }
+
+  for (size_t i = 0; i < num_states; ++i)
+  {
+    linkFrames(joint_angles[i], &link_frames[i]);
+  }
+
+  return RLLKinMsg::SUCCESS;
+}
+
+void RLLForwardKinematics::linkFrames(const RLLKinJoints& joint_angles, RLLKinLinkFrames* link_frames) const
+{
+  double cos_q[RLL_NUM_JOINTS], sin_q[RLL_NUM_JOINTS];
+  for (int i = 0; i < RLL_NUM_JOINTS; ++i)
+  {
+    cos_q[i] = cos(joint_angles(i));
+    sin_q[i] = sin(joint_angles(i));
+  }
+
+  std::array<RLLKinFrame, RLL_NUM_JOINTS>& frames = link_frames->frames;
+  RLLKinFrame frame;
+  frame.appendDHFrame<-1>(limb_lengths_[0], cos_q[0], sin_q[0]);
+  frames[0] = frame;
+  frame.appendDHFrame<1>(0.0, cos_q[1], sin_q[1]);
+  frames[1] = frame;
+  frame.appendDHFrame<1>(limb_lengths_[1], cos_q[2], sin_q[2]);
+  frames[2] = frame;
+  frame.appendDHFrame<-1>(0.0, cos_q[3], sin_q[3]);
+  frames[3] = frame;
+  frame.appendDHFrame<-1>(limb_lengths_[2], cos_q[4], sin_q[4]);
+  frames[4] = frame;
+  frame.appendDHFrame<1>(0.0, cos_q[5], sin_q[5]);
+  frames[5] = frame;
+  frame.appendDHFrame<0>(limb_lengths_[3], cos_q[6], sin_q[6]);
+  frames[6] = frame;
+
+  // joint i rotates around the z-axis of the previous frame
+  const Eigen::Vector3d& flange = frames[RLL_NUM_JOINTS - 1].pos();
+  link_frames->jacobian.block<3, 1>(0, 0) = Eigen::Vector3d::UnitZ().cross(flange);
+  link_frames->jacobian.block<3, 1>(3, 0) = Eigen::Vector3d::UnitZ();
+  for (int i = 1; i < RLL_NUM_JOINTS; ++i)
+  {
+    Eigen::Vector3d axis = frames[i - 1].ori().col(2);
+    link_frames->jacobian.block<3, 1>(0, i) = axis.cross(flange - frames[i - 1].pos());
+    link_frames->jacobian.block<3, 1>(3, i) = axis;
+  }
+}
+
 RLLKinMsg RLLForwardKinematics::armAngle(const RLLKinJoints& joint_angles, const RLLKinGlobalConfig& config,
                                          double* arm_angle) const
 {
@@ -118,19 +180,8 @@ RLLKinMsg RLLForwardKinematics::armAngle(const RLLKinJoints& joint_angles, const
     return RLLKinMsg::JOINT_LIMIT_VIOLATED;
   }
 
-  // TODO(wolfgang): This code can be optimized to avoid a few sincos and matrix operations
-
-  // shoulder pose
-  RLLKinFrame mbs = RLLKinFrame(limb_lengths_[0], joint_angles(0), 0.0, -M_PI / 2.0) *
-                    RLLKinFrame(0.0, joint_angles(1), 0.0, M_PI / 2.0);
-  // elbow pose
-  RLLKinFrame mbe = mbs * RLLKinFrame(limb_lengths_[1], joint_angles(2), 0.0, M_PI / 2.0) *
-                    RLLKinFrame(0.0, joint_angles(3), 0.0, -M_PI / 2.0);
-  // wrist pose
-  RLLKinFrame mbw = mbe * RLLKinFrame(limb_lengths_[2], joint_angles(4), 0.0, -M_PI / 2.0) *
-                    RLLKinFrame(0.0, joint_angles(5), 0.0, M_PI / 2.0);
-  // flange pose
-  RLLKinFrame mbf = mbw * RLLKinFrame(limb_lengths_[3], joint_angles(6), 0.0, 0.0);
+  RLLKinFrame mbs, mbe, mbw, mbf;
+  chainPoses(joint_angles, &mbs, &mbe, &mbw, &mbf);
   *flange_pose = mbf;
 
   // reference plane and arm angle
@@ -145,8 +196,7 @@ RLLKinMsg RLLForwardKinematics::armAngle(const RLLKinJoints& joint_angles, const
   double joint_angle_2_v = jointAngle2Virtual(xsw, lsw, config);
 
   // virtual shoulder pose
-  RLLKinFrame mbs_v = RLLKinFrame(limb_lengths_[0], joint_angle_1_v, 0.0, -M_PI / 2.0) *
-                      RLLKinFrame(0.0, joint_angle_2_v, 0.0, M_PI / 2.0);
+  RLLKinFrame mbs_v = shoulderPose(joint_angle_1_v, joint_angle_2_v);
   // virtual shoulder to elbow vector
   Eigen::Vector3d xse_v(0.0, 0.0, limb_lengths_[1]);
   // virtual shoulder to elbow vector in base coordinates
@@ -166,6 +216,56 @@ RLLKinMsg RLLForwardKinematics::armAngle(const RLLKinJoints& joint_angles, const
   return RLLKinMsg::SUCCESS;
 }
 
+RLLKinFrame RLLForwardKinematics::shoulderPose(const double joint_angle_1, const double joint_angle_2) const
+{
+  if (!sparse_chain_)
+  {
+    return RLLKinFrame(limb_lengths_[0], joint_angle_1, 0.0, -M_PI / 2.0) *
+           RLLKinFrame(0.0, joint_angle_2, 0.0, M_PI / 2.0);
+  }
+
+  RLLKinFrame mbs;
+  mbs.appendDHFrame<-1>(limb_lengths_[0], cos(joint_angle_1), sin(joint_angle_1));
+  mbs.appendDHFrame<1>(0.0, cos(joint_angle_2), sin(joint_angle_2));
+  return mbs;
+}
+
+void RLLForwardKinematics::chainPoses(const RLLKinJoints& joint_angles, RLLKinFrame* mbs, RLLKinFrame* mbe,
+                                      RLLKinFrame* mbw, RLLKinFrame* mbf) const
+{
+  if (!sparse_chain_)
+  {
+    *mbs = RLLKinFrame(limb_lengths_[0], joint_angles(0), 0.0, -M_PI / 2.0) *
+           RLLKinFrame(0.0, joint_angles(1), 0.0, M_PI / 2.0);
+    *mbe = *mbs * RLLKinFrame(limb_lengths_[1], joint_angles(2), 0.0, M_PI / 2.0) *
+           RLLKinFrame(0.0, joint_angles(3), 0.0, -M_PI / 2.0);
+    *mbw = *mbe * RLLKinFrame(limb_lengths_[2], joint_angles(4), 0.0, -M_PI / 2.0) *
+           RLLKinFrame(0.0, joint_angles(5), 0.0, M_PI / 2.0);
+    *mbf = *mbw * RLLKinFrame(limb_lengths_[3], joint_angles(6), 0.0, 0.0);
+    return;
+  }
+
+  // the alternating alphas of the iiwa chain are known, so each frame only needs two column updates
+  double cos_q[RLL_NUM_JOINTS], sin_q[RLL_NUM_JOINTS];
+  for (int i = 0; i < RLL_NUM_JOINTS; ++i)
+  {
+    cos_q[i] = cos(joint_angles(i));
+    sin_q[i] = sin(joint_angles(i));
+  }
+
+  *mbs = RLLKinFrame();
+  mbs->appendDHFrame<-1>(limb_lengths_[0], cos_q[0], sin_q[0]);
+  mbs->appendDHFrame<1>(0.0, cos_q[1], sin_q[1]);
+  *mbe = *mbs;
+  mbe->appendDHFrame<1>(limb_lengths_[1], cos_q[2], sin_q[2]);
+  mbe->appendDHFrame<-1>(0.0, cos_q[3], sin_q[3]);
+  *mbw = *mbe;
+  mbw->appendDHFrame<-1>(limb_lengths_[2], cos_q[4], sin_q[4]);
+  mbw->appendDHFrame<1>(0.0, cos_q[5], sin_q[5]);
+  *mbf = *mbw;
+  mbf->appendDHFrame<0>(limb_lengths_[3], cos_q[6], sin_q[6]);
+}
+
 RLLKinMsg RLLForwardKinematics::shoulderWristVec(const RLLKinFrame& eef_pose, Eigen::Vector3d* xsw,
                                                  Eigen::Vector3d* xwf_n, double* lsw) const
 {
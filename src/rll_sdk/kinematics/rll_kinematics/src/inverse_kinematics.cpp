@@ -65,15 +65,7 @@ RLLKinMsg RLLInverseKinematics::jointAnglesFromArmAngle(const double arm_angle,
 {
   RLLKinJoints& joint_angles_ref = *joint_angles;
 
-  for (uint8_t i = 0; i < RLL_NUM_JOINTS_P; ++i)
-  {
-    joint_angles_ref[i * 2] = coeffs.jointAnglePivot(i, arm_angle);
-  }
-
-  for (uint8_t i = 0; i < RLL_NUM_JOINTS_H; ++i)
-  {
-    joint_angles_ref[i * 4 + 1] = coeffs.jointAngleHinge(i, arm_angle);
-  }
+  coeffs.jointAngles(arm_angle, joint_angles);
 
   if (assert_limits)
   {
@@ -175,9 +167,10 @@ RLLKinMsg RLLInverseKinematics::setHelperMatrices(const RLLKinPoseConfig& eef_po
   return RLLKinMsg::SUCCESS;
 }
 
-RLLKinMsg RLLInverseKinematics::computeFeasibleIntervals(RLLInvKinNsIntervals* intervals) const
+RLLKinMsg RLLInverseKinematics::computeFeasibleIntervals(RLLInvKinNsIntervals* intervals,
+                                                         RLLInvKinLimitCrossings* crossings) const
 {
-  return intervals->computeFeasibleIntervals(lowerJointPositionLimits(), upperJointPositionLimits());
+  return intervals->computeFeasibleIntervals(lowerJointPositionLimits(), upperJointPositionLimits(), crossings);
 }
 
 void RLLInverseKinematics::addRemainingConfigs(const size_t it, const double dist_from_seed,
@@ -88,6 +88,61 @@ void RLLInvKinCoeffs::preparePivotDerivatives()
   }
 }
 
+void RLLInvKinCoeffs::jointAngles(const ArmAngleArray& arm_angles, JointAnglesArray* joint_angles) const
+{
+  const ArmAngleArray sin_arm_angles = arm_angles.sin();
+  const ArmAngleArray cos_arm_angles = arm_angles.cos();
+  ArmAngleArray denominator(arm_angles.size());
+
+  joint_angles->resize(arm_angles.size(), RLL_NUM_JOINTS);
+
+  for (uint8_t i = 0; i < RLL_NUM_JOINTS_P; ++i)
+  {
+    auto joint = joint_angles->col(i * 2);
+    joint = gc_p_[i] * (an_[i] * sin_arm_angles + bn_[i] * cos_arm_angles + cn_[i]);
+    denominator = gc_p_[i] * (ad_[i] * sin_arm_angles + bd_[i] * cos_arm_angles + cd_[i]);
+    joint = joint.binaryExpr(denominator, [](double y, double x) { return atan2(y, x); });
+  }
+
+  for (uint8_t i = 0; i < RLL_NUM_JOINTS_H; ++i)
+  {
+    auto joint = joint_angles->col(i * 4 + 1);
+    joint = a_[i] * sin_arm_angles + b_[i] * cos_arm_angles + c_[i];
+    joint = gc_h_[i] * joint.unaryExpr([](double f) { return kAcos(f); });
+  }
+
+  joint_angles->col(3).setConstant(joint_angle_4_);
+}
+
+void RLLInvKinCoeffs::jointAngles(const double arm_angle, RLLKinJoints* joint_angles) const
+{
+  using PivotArray = Eigen::Array<double, RLL_NUM_JOINTS_P, 1>;
+  using PivotCoeffs = Eigen::Map<const PivotArray>;
+
+  const double sin_arm_angle = sin(arm_angle);
+  const double cos_arm_angle = cos(arm_angle);
+
+  // all pivot joints in one go, the coefficients are already stored joint-wise
+  PivotCoeffs an(an_.data()), bn(bn_.data()), cn(cn_.data());
+  PivotCoeffs ad(ad_.data()), bd(bd_.data()), cd(cd_.data());
+  PivotCoeffs gc_p(gc_p_.data());
+  PivotArray numerator = gc_p * (an * sin_arm_angle + bn * cos_arm_angle + cn);
+  PivotArray denominator = gc_p * (ad * sin_arm_angle + bd * cos_arm_angle + cd);
+
+  RLLKinJoints& joint_angles_ref = *joint_angles;
+  for (uint8_t i = 0; i < RLL_NUM_JOINTS_P; ++i)
+  {
+    joint_angles_ref[i * 2] = atan2(numerator[i], denominator[i]);
+  }
+
+  for (uint8_t i = 0; i < RLL_NUM_JOINTS_H; ++i)
+  {
+    joint_angles_ref[i * 4 + 1] = gc_h_[i] * kAcos(a_[i] * sin_arm_angle + b_[i] * cos_arm_angle + c_[i]);
+  }
+
+  joint_angles_ref[3] = joint_angle_4_;
+}
+
 double RLLInvKinCoeffs::jointAngle(const JointType type, const uint8_t i, const double arm_angle) const
 {
   switch (type)
@@ -187,6 +242,20 @@ bool RLLInvKinCoeffs::armAnglePivot(const uint8_t i, const double joint_angle, d
   return true;
 }
 
+bool RLLInvKinCoeffs::pivotCandidateReachesAngle(const uint8_t i, const double arm_angle, const double sin_joint_angle,
+                                                 const double cos_joint_angle, double* joint_derivative) const
+{
+  double sin_arm_angle = sin(arm_angle);
+  double cos_arm_angle = cos(arm_angle);
+  double u = (an_[i] * sin_arm_angle + bn_[i] * cos_arm_angle + cn_[i]);
+  double v = (ad_[i] * sin_arm_angle + bd_[i] * cos_arm_angle + cd_[i]);
+
+  // same as jointDerivativePivot()
+  *joint_derivative = (at_[i] * sin_arm_angle + bt_[i] * cos_arm_angle + ct_[i]) / (pow(u, 2) + pow(v, 2));
+
+  return gc_p_[i] * (u * sin_joint_angle + v * cos_joint_angle) > 0.0;
+}
+
 bool RLLInvKinCoeffs::armAngleHinge(const uint8_t i, const double joint_angle, double* arm_angle_lower,
                                     double* arm_angle_upper) const
 {
@@ -0,0 +1,303 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <rll_kinematics/reachability_map.h>
+
+namespace
+{
+const char MAP_MAGIC[8] = "RLLRMAP";
+const double LIMITS_MATCH_TOL = 1E-06;
+}  // namespace
+
+const uint32_t RLLKinReachabilityGrid::FILE_VERSION;
+const int RLLKinReachabilityGrid::NUM_ARM_ANGLE_SECTORS;
+const uint8_t RLLKinReachabilityGrid::ALL_ARM_ANGLE_SECTORS;
+
+bool RLLKinReachabilityGrid::cellIndex(const RLLKinFrame& pose, size_t* index) const
+{
+  size_t voxel = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    double offset = (pose.pos()(i) - origin[i]) / voxel_size;
+    // also catches NaN
+    if (!(offset >= 0.0 && offset < num_voxels[i]))
+    {
+      return false;
+    }
+    voxel = voxel * num_voxels[i] + static_cast<size_t>(offset);
+  }
+
+  *index = voxel * numOrientationBins() + orientationBin(pose.ori().col(2));
+  return true;
+}
+
+uint32_t RLLKinReachabilityGrid::orientationBin(const Eigen::Vector3d& direction) const
+{
+  Eigen::Vector3d::Index axis;
+  double max_coeff = direction.cwiseAbs().maxCoeff(&axis);
+  if (!(max_coeff > 0.0))
+  {
+    return 0;
+  }
+
+  uint32_t face = 2 * static_cast<uint32_t>(axis) + (direction(axis) < 0.0 ? 1 : 0);
+  uint32_t bin = face;
+  for (int k = 1; k <= 2; ++k)
+  {
+    // projected onto the face: [-1, 1] -> [0, bins_per_face[
+    double u = (direction((axis + k) % 3) / max_coeff + 1.0) / 2.0 * bins_per_face;
+    bin = bin * bins_per_face + std::min(static_cast<uint32_t>(std::max(u, 0.0)), bins_per_face - 1);
+  }
+
+  return bin;
+}
+
+int RLLKinReachabilityGrid::armAngleSector(const double arm_angle)
+{
+  double sector = (arm_angle + M_PI) / (2 * M_PI) * NUM_ARM_ANGLE_SECTORS;
+  return std::min(std::max(static_cast<int>(sector), 0), NUM_ARM_ANGLE_SECTORS - 1);
+}
+
+bool RLLKinReachabilityGrid::matches(const RLLKinLimbs& limbs, const RLLKinJointLimits& joint_position_limits) const
+{
+  for (size_t i = 0; i < limbs.size(); ++i)
+  {
+    if (std::fabs(limb_lengths[i] - limbs[i]) > LIMITS_MATCH_TOL)
+    {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < RLL_NUM_JOINTS; ++i)
+  {
+    if (std::fabs(lower_joint_limits[i] - joint_position_limits.lower(i)) > LIMITS_MATCH_TOL ||
+        std::fabs(upper_joint_limits[i] - joint_position_limits.upper(i)) > LIMITS_MATCH_TOL)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+RLLKinReachabilityMap::~RLLKinReachabilityMap()
+{
+  unload();
+}
+
+bool RLLKinReachabilityMap::load(const std::string& file_name)
+{
+  unload();
+
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(RLLKinReachabilityGrid))
+  {
+    close(fd);
+    return false;
+  }
+
+  size_t size = file_stat.st_size;
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);  // the mapping stays valid
+  if (mapping == MAP_FAILED)
+  {
+    return false;
+  }
+
+  const auto* grid = static_cast<const RLLKinReachabilityGrid*>(mapping);
+  if (std::memcmp(grid->magic, MAP_MAGIC, sizeof(MAP_MAGIC)) != 0 ||
+      grid->version != RLLKinReachabilityGrid::FILE_VERSION || grid->bins_per_face == 0 ||
+      !(grid->voxel_size > 0.0) || size != sizeof(RLLKinReachabilityGrid) + grid->numCells())
+  {
+    munmap(mapping, size);
+    return false;
+  }
+
+  mapping_ = mapping;
+  mapping_size_ = size;
+  grid_ = grid;
+  cells_ = static_cast<const uint8_t*>(mapping) + sizeof(RLLKinReachabilityGrid);
+
+  return true;
+}
+
+void RLLKinReachabilityMap::unload()
+{
+  if (mapping_ != nullptr)
+  {
+    munmap(mapping_, mapping_size_);
+  }
+
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  grid_ = nullptr;
+  cells_ = nullptr;
+}
+
+uint8_t RLLKinReachabilityMap::armAngleSectors(const RLLKinFrame& pose) const
+{
+  if (!loaded())
+  {
+    return RLLKinReachabilityGrid::ALL_ARM_ANGLE_SECTORS;
+  }
+
+  size_t index;
+  if (!grid_->cellIndex(pose, &index))
+  {
+    // the grid covers the whole workspace
+    return 0;
+  }
+
+  return cells_[index];
+}
+
+RLLKinReachabilityMapBuilder::RLLKinReachabilityMapBuilder(const RLLKinLimbs& limbs,
+                                                           const RLLKinJointLimits& joint_position_limits,
+                                                           const double voxel_size, const uint32_t bins_per_face)
+{
+  std::memset(&grid_, 0, sizeof(grid_));
+  std::memcpy(grid_.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+  grid_.version = RLLKinReachabilityGrid::FILE_VERSION;
+  grid_.bins_per_face = std::max<uint32_t>(bins_per_face, 1);
+  grid_.voxel_size = voxel_size;
+
+  std::copy(limbs.begin(), limbs.end(), grid_.limb_lengths);
+  std::copy(joint_position_limits.lower.begin(), joint_position_limits.lower.end(), grid_.lower_joint_limits);
+  std::copy(joint_position_limits.upper.begin(), joint_position_limits.upper.end(), grid_.upper_joint_limits);
+
+  // a sphere around the shoulder with the distance from shoulder to flange as radius, plus one voxel for the dilation
+  double radius = limbs[1] + limbs[2] + limbs[3] + voxel_size;
+  const double center[3] = { 0.0, 0.0, limbs[0] };
+  for (int i = 0; i < 3; ++i)
+  {
+    grid_.origin[i] = center[i] - radius;
+    grid_.num_voxels[i] = static_cast<uint32_t>(std::ceil(2 * radius / voxel_size));
+  }
+
+  cells_.assign(grid_.numCells(), 0);
+}
+
+void RLLKinReachabilityMapBuilder::addSample(const RLLKinPoseConfig& eef_pose, const bool singular)
+{
+  // the arm angle is not defined in a singularity
+  uint8_t sectors = singular ? RLLKinReachabilityGrid::ALL_ARM_ANGLE_SECTORS :
+                               1U << RLLKinReachabilityGrid::armAngleSector(eef_pose.arm_angle);
+
+  size_t index;
+  if (!grid_.cellIndex(eef_pose.pose, &index))
+  {
+    return;
+  }
+
+  ++grid_.num_samples;
+  uint32_t num_bins = grid_.numOrientationBins();
+  size_t voxel_offset = index - index % num_bins;
+  cells_[index] |= sectors;
+
+  // also mark the surrounding orientation bins, tilting the direction by roughly one bin width
+  const Eigen::Vector3d direction = eef_pose.pose.ori().col(2);
+  double tilt = 2.0 / grid_.bins_per_face;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    for (double sign : { -1.0, 1.0 })
+    {
+      Eigen::Vector3d tilted = direction;
+      tilted(axis) += sign * tilt;
+      cells_[voxel_offset + grid_.orientationBin(tilted)] |= sectors;
+    }
+  }
+}
+
+void RLLKinReachabilityMapBuilder::dilate()
+{
+  const uint32_t* n = grid_.num_voxels;
+  uint32_t num_bins = grid_.numOrientationBins();
+  std::vector<uint8_t> dilated(cells_.size(), 0);
+
+  auto voxelOffset = [&](uint32_t x, uint32_t y, uint32_t z) {
+    return ((static_cast<size_t>(x) * n[1] + y) * n[2] + z) * num_bins;
+  };
+
+  for (uint32_t x = 0; x < n[0]; ++x)
+  {
+    for (uint32_t y = 0; y < n[1]; ++y)
+    {
+      for (uint32_t z = 0; z < n[2]; ++z)
+      {
+        uint8_t* target = &dilated[voxelOffset(x, y, z)];
+        for (uint32_t nx = std::max(x, 1U) - 1; nx <= std::min(x + 1, n[0] - 1); ++nx)
+        {
+          for (uint32_t ny = std::max(y, 1U) - 1; ny <= std::min(y + 1, n[1] - 1); ++ny)
+          {
+            for (uint32_t nz = std::max(z, 1U) - 1; nz <= std::min(z + 1, n[2] - 1); ++nz)
+            {
+              const uint8_t* source = &cells_[voxelOffset(nx, ny, nz)];
+              for (uint32_t b = 0; b < num_bins; ++b)
+              {
+                target[b] |= source[b];
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // neighboring arm angle sectors, the arm angle wraps around at +-pi
+  for (auto& cell : dilated)
+  {
+    cell = cell | static_cast<uint8_t>(cell << 1) | static_cast<uint8_t>(cell >> 1) |
+           static_cast<uint8_t>(cell << (RLLKinReachabilityGrid::NUM_ARM_ANGLE_SECTORS - 1)) |
+           static_cast<uint8_t>(cell >> (RLLKinReachabilityGrid::NUM_ARM_ANGLE_SECTORS - 1));
+  }
+
+  cells_.swap(dilated);
+}
+
+bool RLLKinReachabilityMapBuilder::save(const std::string& file_name) const
+{
+  FILE* file = std::fopen(file_name.c_str(), "wb");
+  if (file == nullptr)
+  {
+    return false;
+  }
+
+  bool success = std::fwrite(&grid_, sizeof(grid_), 1, file) == 1 &&
+                 std::fwrite(cells_.data(), 1, cells_.size(), file) == cells_.size();
+
+  return std::fclose(file) == 0 && success;
+}
+
+size_t RLLKinReachabilityMapBuilder::numReachedCells() const
+{
+  return cells_.size() - std::count(cells_.begin(), cells_.end(), 0);
+}
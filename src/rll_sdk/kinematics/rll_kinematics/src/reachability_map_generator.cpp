@@ -0,0 +1,103 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <random>
+
+#include <rll_kinematics/reachability_map.h>
+
+// Generates a reachability map for the RLLMoveItKinematicsPlugin by sampling random joint angles. The limb length from
+// wrist to flange depends on the end effector and has to match the one that the plugin derives from the URDF.
+//
+// usage: rll_kinematics_reachability_map <output_file> [num_samples] [voxel_size] [bins_per_face]
+//                                        [wrist_flange_length] [random_seed]
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cout << "usage: " << argv[0]
+              << " <output_file> [num_samples] [voxel_size] [bins_per_face] [wrist_flange_length] [random_seed]"
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::string output_file = argv[1];
+  size_t num_samples = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000000;
+  double voxel_size = argc > 3 ? std::strtod(argv[3], nullptr) : 0.05;
+  uint32_t bins_per_face = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 4;
+  double wrist_flange_length = argc > 5 ? std::strtod(argv[5], nullptr) : 0.126;
+  unsigned int random_seed = argc > 6 ? std::strtoul(argv[6], nullptr, 10) : 42;
+
+  if (!(voxel_size > 0.0) || bins_per_face == 0)
+  {
+    std::cout << "error: invalid voxel size or number of bins" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  RLLForwardKinematics solver;
+  RLLKinLimbs limb_lengths = { 0.34, 0.4, 0.4, wrist_flange_length };
+  RLLKinJointLimits joint_position_limits;
+  joint_position_limits.lower = { -2.93215, -2.05949, -2.93215, -2.05949, -2.93215, -2.05949, -3.01942 };
+  joint_position_limits.upper = { 2.93215, 2.05949, 2.93215, 2.05949, 2.93215, 2.05949, 3.01942 };
+
+  if (solver.initialize(limb_lengths, joint_position_limits).error())
+  {
+    std::cout << "error: failed to initialize the kinematics solver" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  RLLKinReachabilityMapBuilder builder(limb_lengths, joint_position_limits, voxel_size, bins_per_face);
+  const RLLKinReachabilityGrid& grid = builder.grid();
+  std::cout << "grid of " << grid.num_voxels[0] << "x" << grid.num_voxels[1] << "x" << grid.num_voxels[2]
+            << " voxels with " << grid.numOrientationBins() << " orientation bins each, " << grid.numCells()
+            << " cells" << std::endl;
+
+  std::mt19937 generator(random_seed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  for (size_t s = 0; s < num_samples; ++s)
+  {
+    RLLKinJoints joint_angles;
+    for (int i = 0; i < RLL_NUM_JOINTS; ++i)
+    {
+      double lower = joint_position_limits.lower(i);
+      double upper = joint_position_limits.upper(i);
+      joint_angles[i] = lower + unit(generator) * (upper - lower);
+    }
+
+    RLLKinPoseConfig eef_pose;
+    RLLKinMsg result = solver.fk(joint_angles, &eef_pose);
+    if (result.error())
+    {
+      continue;
+    }
+
+    builder.addSample(eef_pose, result.val() == RLLKinMsg::SINGULARITY);
+  }
+
+  builder.dilate();
+  std::cout << builder.numReachedCells() << " of " << grid.numCells() << " cells reachable" << std::endl;
+
+  if (!builder.save(output_file))
+  {
+    std::cout << "error: failed to write " << output_file << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::cout << "reachability map written to " << output_file << std::endl;
+  exit(EXIT_SUCCESS);
+}
@@ -17,10 +17,147 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include <boost/math/tools/minima.hpp>  // one dimensional minimization
 
 #include <rll_kinematics/redundancy_resolution.h>
 
+namespace
+{
+// Helper threads shared by all solver instances. The submitting thread always takes part in the work, so a query
+// never waits for a busy helper and concurrent queries cannot dead-lock each other.
+class RLLKinHelperThreads
+{
+public:
+  static RLLKinHelperThreads& instance()
+  {
+    static RLLKinHelperThreads helper_threads;
+    return helper_threads;
+  }
+
+  size_t size() const
+  {
+    return threads_.size();
+  }
+
+  void submit(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+  RLLKinHelperThreads(const RLLKinHelperThreads&) = delete;
+  RLLKinHelperThreads& operator=(const RLLKinHelperThreads&) = delete;
+
+private:
+  RLLKinHelperThreads()
+  {
+    // one thread less, the submitting thread is the remaining one
+    size_t num_threads = std::min<size_t>(std::thread::hardware_concurrency(), RLL_NUM_GLOBAL_CONFIGS);
+    for (size_t i = 1; i < num_threads; ++i)
+    {
+      threads_.emplace_back(&RLLKinHelperThreads::run, this);
+    }
+  }
+
+  ~RLLKinHelperThreads()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      shutdown_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_)
+    {
+      thread.join();
+    }
+  }
+
+  void run()
+  {
+    while (true)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return shutdown_ || !tasks_.empty(); });
+        if (tasks_.empty())
+        {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool shutdown_ = false;
+};
+
+// Items of one query are claimed with an atomic counter, no locks are taken while the items are evaluated. Helpers
+// that start after all items are claimed return without touching the data of the query, so the query only has to wait
+// until all claimed items are done.
+struct RLLKinParallelItems
+{
+  std::function<void(size_t)> evaluate;
+  size_t num_items = 0;
+  std::atomic<size_t> next{ 0 };
+  std::atomic<size_t> num_done{ 0 };
+  std::atomic<bool> stop{ false };
+
+  void run()
+  {
+    for (size_t i = next++; i < num_items; i = next++)
+    {
+      if (!stop.load(std::memory_order_relaxed))
+      {
+        evaluate(i);
+      }
+      num_done.fetch_add(1, std::memory_order_release);
+    }
+  }
+};
+
+void runParallel(size_t num_items, const std::function<void(size_t, std::atomic<bool>*)>& evaluate)
+{
+  auto items = std::make_shared<RLLKinParallelItems>();
+  RLLKinParallelItems* items_ptr = items.get();
+  items->evaluate = [&evaluate, items_ptr](size_t i) { evaluate(i, &items_ptr->stop); };
+  items->num_items = num_items;
+
+  RLLKinHelperThreads& helper_threads = RLLKinHelperThreads::instance();
+  size_t num_helpers = std::min(helper_threads.size(), num_items - 1);
+  for (size_t i = 0; i < num_helpers; ++i)
+  {
+    helper_threads.submit([items] { items->run(); });
+  }
+
+  items->run();
+  while (items->num_done.load(std::memory_order_acquire) < num_items)
+  {
+    std::this_thread::yield();
+  }
+}
+}  // namespace
+
+const double RLLKinMultiObjOptimization::NEWTON_ARM_ANGLE_TOL = 1E-08;
+
 RLLKinMsg RLLRedundancyResolution::ik(const RLLKinSeedState& seed_state, RLLKinPoseConfig* ik_pose,
                                       RLLKinSolutions* solutions, const RLLInvKinOptions& options) const
 {
@@ -71,6 +208,160 @@ RLLKinMsg RLLRedundancyResolution::ik(const RLLKinSeedState& seed_state, RLLKinP
 
   return RLLKinMsg::INVALID_INPUT;
 }
+
+RLLKinMsg RLLRedundancyResolution::ikPath(const RLLKinSeedState& seed_state, const RLLKinFrame* poses,
+                                          const size_t num_poses, RLLKinJoints* solutions, size_t* num_solved,
+                                          const RLLInvKinOptions& options) const
+{
+  *num_solved = 0;
+
+  if (!initialized())
+  {
+    return RLLKinMsg::NOT_INITIALIZED;
+  }
+
+  // the arm angle would have to be given for each pose
+  if (seed_state.empty() || options.method == RLLInvKinOptions::ARM_ANGLE_FIXED)
+  {
+    return RLLKinMsg::INVALID_INPUT;
+  }
+
+  for (size_t i = 0; i < seed_state.size(); ++i)
+  {
+    if (!seed_state[i].allFinite())
+    {
+      return RLLKinMsg::INVALID_INPUT;
+    }
+  }
+
+  // same as ikFixedConfig(), but the seed history is shifted in place
+  RLLKinSeedState seed = seed_state;
+  RLLKinPoseConfig ik_pose;
+  RLLInvKinLimitCrossings crossings;
+  RLLKinArmAngleWarmStart warm_start;
+  RLLKinMsg result = RLLKinMsg::SUCCESS;
+  for (size_t i = 0; i < num_poses; ++i)
+  {
+    if (!poses[i].allFinite())
+    {
+      return RLLKinMsg::INVALID_INPUT;
+    }
+
+    ik_pose.pose = poses[i];
+    ik_pose.config.set(seed.front());
+
+    double seed_arm_angle;
+    result = armAngle(seed.front(), ik_pose.config, &seed_arm_angle);
+    if (result.error())
+    {
+      return result;
+    }
+
+    RLLKinJoints& solution = solutions[i];
+    RLLInvKinCoeffs coeffs(seed);
+    result = setCoeffsWithInitCheck(ik_pose, &coeffs, &solution[3]);
+    if (result.error())
+    {
+      return result;
+    }
+
+    result = redundancyResolution(coeffs, options, seed_arm_angle, &ik_pose.arm_angle, &solution, &crossings,
+                                  &warm_start);
+    if (result.error() ||
+        (options.stop_at_arm_angle_jump && result.val() == RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL))
+    {
+      return result;
+    }
+
+    ++*num_solved;
+    if (seed.size() < RLL_MAX_NUM_SEED_TIME_STEPS)
+    {
+      seed.insert(seed.begin(), solution);
+    }
+    else
+    {
+      std::copy_backward(seed.begin(), seed.end() - 1, seed.end());
+      seed.front() = solution;
+    }
+  }
+
+  return result;
+}
+
+RLLKinMsg RLLRedundancyResolution::ikArmAngles(const RLLKinSeedState& seed_state, const RLLKinFrame& pose,
+                                               const double* arm_angles, const size_t num_arm_angles,
+                                               RLLKinJoints* solutions, size_t* num_solved) const
+{
+  *num_solved = 0;
+
+  if (!initialized())
+  {
+    return RLLKinMsg::NOT_INITIALIZED;
+  }
+
+  if (seed_state.empty() || !seed_state.front().allFinite() || !pose.allFinite())
+  {
+    return RLLKinMsg::INVALID_INPUT;
+  }
+
+  RLLKinPoseConfig ik_pose;
+  ik_pose.pose = pose;
+  ik_pose.config.set(seed_state.front());
+
+  RLLInvKinCoeffs coeffs(seed_state);
+  double joint_angle_4;
+  RLLKinMsg result = setCoeffsWithInitCheck(ik_pose, &coeffs, &joint_angle_4);
+  if (result.error())
+  {
+    return result;
+  }
+
+  // the intervals are not defined for a singular pose and the arm angle may be remapped if the elbow is stretched, the
+  // joint angles are still checked against the limits in both cases
+  RLLInvKinNsIntervals feasible_intervals(coeffs);
+  bool check_intervals = !kZero(joint_angle_4) && computeFeasibleIntervals(&feasible_intervals).success();
+  RLLKinArmAngleInterval previous_interval;
+
+  for (size_t i = 0; i < num_arm_angles; ++i)
+  {
+    if (!std::isfinite(arm_angles[i]))
+    {
+      return RLLKinMsg::INVALID_INPUT;
+    }
+
+    double arm_angle = mapAngleInPiRange(arm_angles[i]);
+    if (check_intervals)
+    {
+      double query_arm_angle = arm_angle, fallback_arm_angle;
+      RLLKinArmAngleInterval current_interval;
+      result = feasible_intervals.intervalForArmAngle(&query_arm_angle, &current_interval, &fallback_arm_angle);
+      if (result.error() || result.val() == RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL)
+      {
+        return result;
+      }
+
+      if (i > 0 && (!kIsEqual(current_interval.lowerLimit(), previous_interval.lowerLimit()) ||
+                    !kIsEqual(current_interval.upperLimit(), previous_interval.upperLimit())))
+      {
+        return RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL;
+      }
+      previous_interval = current_interval;
+    }
+
+    RLLKinJoints& solution = solutions[i];
+    solution[3] = joint_angle_4;
+    result = jointAnglesFromFixedArmAngle(arm_angle, coeffs, &solution);
+    if (result.error())
+    {
+      return result;
+    }
+
+    ++*num_solved;
+  }
+
+  return result;
+}
+
 std::ostream& operator<<(std::ostream& output, const RLLInvKinOptions& rll_inv_kin_opt)
 {
   output << "(method:";
@@ -148,7 +439,8 @@ RLLKinMsg RLLRedundancyResolution::ikFixedConfig(const RLLKinSeedState& seed_sta
 
 RLLKinMsg RLLRedundancyResolution::redundancyResolution(const RLLInvKinCoeffs& coeffs, const RLLInvKinOptions& options,
                                                         double arm_angle_seed, double* arm_angle_new,
-                                                        RLLKinJoints* solution) const
+                                                        RLLKinJoints* solution, RLLInvKinLimitCrossings* crossings,
+                                                        RLLKinArmAngleWarmStart* warm_start) const
 {
   switch (options.method)
   {
@@ -158,9 +450,10 @@ RLLKinMsg RLLRedundancyResolution::redundancyResolution(const RLLInvKinCoeffs& c
         return RLLKinMsg::INVALID_INPUT;
       }
 
-      return optimizationMultiObjective(coeffs, options, arm_angle_seed, arm_angle_new, solution);
+      return optimizationMultiObjective(coeffs, options, arm_angle_seed, arm_angle_new, solution, crossings,
+                                        warm_start);
     case RLLInvKinOptions::POSITION_RESOLUTION_EXP:
-      return optimizationPositionExp(coeffs, options, arm_angle_seed, arm_angle_new, solution);
+      return optimizationPositionExp(coeffs, options, arm_angle_seed, arm_angle_new, solution, crossings);
     case RLLInvKinOptions::ARM_ANGLE_FIXED:
       return optimizationFixedArmAngle(coeffs, options, arm_angle_seed, arm_angle_new, solution);
   }
@@ -170,28 +463,30 @@ RLLKinMsg RLLRedundancyResolution::redundancyResolution(const RLLInvKinCoeffs& c
 
 double RLLRedundancyResolution::multiObjectiveResolution(const RLLInvKinCoeffs& coeffs, const RLLInvKinOptions& options,
                                                          const double arm_angle_old,
-                                                         const RLLKinArmAngleInterval& current_interval) const
+                                                         const RLLKinArmAngleInterval& current_interval,
+                                                         RLLKinArmAngleWarmStart* warm_start) const
 {
   RLLKinMultiObjOptimization optimization(coeffs, options, arm_angle_old, current_interval);
 
-  return optimization.optimalArmAngle(jointVelocityLimits(), jointAccelerationLimits());
+  return optimization.optimalArmAngle(jointVelocityLimits(), jointAccelerationLimits(), warm_start);
 }
 
 RLLKinMsg RLLRedundancyResolution::optimizationMultiObjective(const RLLInvKinCoeffs& coeffs,
                                                               const RLLInvKinOptions& options, double arm_angle_seed,
-                                                              double* arm_angle_new, RLLKinJoints* solution) const
+                                                              double* arm_angle_new, RLLKinJoints* solution,
+                                                              RLLInvKinLimitCrossings* crossings,
+                                                              RLLKinArmAngleWarmStart* warm_start) const
 {
   RLLKinArmAngleInterval current_interval;
   double fallback_arm_angle;
 
   RLLInvKinNsIntervals feasible_intervals(coeffs);
-  computeFeasibleIntervals(&feasible_intervals);
+  computeFeasibleIntervals(&feasible_intervals, crossings);
 
   RLLKinMsg result = feasible_intervals.intervalForArmAngle(&arm_angle_seed, &current_interval, &fallback_arm_angle);
   if (result.error() || result.val() == RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL)
   {
-    *arm_angle_new = fallback_arm_angle;
-    return jointAnglesFromFixedArmAngle(fallback_arm_angle, coeffs, solution);
+    return fallbackResolution(result, fallback_arm_angle, coeffs, arm_angle_new, solution);
   }
 
   if (!dynamicLimitsSet())
@@ -205,13 +500,29 @@ RLLKinMsg RLLRedundancyResolution::optimizationMultiObjective(const RLLInvKinCoe
     return RLLKinMsg::INVALID_INPUT;
   }
 
-  *arm_angle_new = multiObjectiveResolution(coeffs, options, arm_angle_seed, current_interval);
+  *arm_angle_new = multiObjectiveResolution(coeffs, options, arm_angle_seed, current_interval, warm_start);
 
   *arm_angle_new = mapAngleInPiRange(*arm_angle_new);
 
   return jointAnglesFromArmAngle(*arm_angle_new, coeffs, solution, true);
 }
 
+RLLKinMsg RLLRedundancyResolution::fallbackResolution(const RLLKinMsg interval_result, const double fallback_arm_angle,
+                                                      const RLLInvKinCoeffs& coeffs, double* arm_angle_new,
+                                                      RLLKinJoints* solution) const
+{
+  *arm_angle_new = fallback_arm_angle;
+  RLLKinMsg result = jointAnglesFromFixedArmAngle(fallback_arm_angle, coeffs, solution);
+
+  // report the jump to another interval, the solution is still valid
+  if (result.success() && interval_result.val() == RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL)
+  {
+    return interval_result;
+  }
+
+  return result;
+}
+
 double RLLRedundancyResolution::expResolution(const RLLInvKinOptions& options, const double arm_angle_old,
                                               const double lower_limit, const double upper_limit)
 {
@@ -225,19 +536,19 @@ double RLLRedundancyResolution::expResolution(const RLLInvKinOptions& options, c
 
 RLLKinMsg RLLRedundancyResolution::optimizationPositionExp(const RLLInvKinCoeffs& coeffs,
                                                            const RLLInvKinOptions& options, double arm_angle_seed,
-                                                           double* arm_angle_new, RLLKinJoints* solution) const
+                                                           double* arm_angle_new, RLLKinJoints* solution,
+                                                           RLLInvKinLimitCrossings* crossings) const
 {
   RLLKinArmAngleInterval current_interval;
   double fallback_arm_angle;
 
   RLLInvKinNsIntervals feasible_intervals(coeffs);
-  computeFeasibleIntervals(&feasible_intervals);
+  computeFeasibleIntervals(&feasible_intervals, crossings);
 
   RLLKinMsg result = feasible_intervals.intervalForArmAngle(&arm_angle_seed, &current_interval, &fallback_arm_angle);
   if (result.error() || result.val() == RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL)
   {
-    *arm_angle_new = fallback_arm_angle;
-    return jointAnglesFromFixedArmAngle(fallback_arm_angle, coeffs, solution);
+    return fallbackResolution(result, fallback_arm_angle, coeffs, arm_angle_new, solution);
   }
 
   if (kIsEqual(current_interval.lowerLimit(), -M_PI) && kIsEqual(current_interval.upperLimit(), M_PI) &&
@@ -285,6 +596,11 @@ RLLKinMsg RLLRedundancyResolution::ikClosestConfig(const RLLKinSeedState& seed_s
     return result;
   }
 
+  if (options.parallel_global_configs && configs.size() > 1)
+  {
+    return ikClosestConfigParallel(seed_state, seed_arm_angle, &configs, ik_pose, solutions, options);
+  }
+
   double dist_from_seed = std::numeric_limits<double>::infinity();
   boost::container::static_vector<ClosestConfigsSolution, RLL_NUM_GLOBAL_CONFIGS> solutions_data;
 
@@ -331,6 +647,103 @@ RLLKinMsg RLLRedundancyResolution::ikClosestConfig(const RLLKinSeedState& seed_s
   return result;
 }
 
+RLLKinMsg RLLRedundancyResolution::ikClosestConfigParallel(const RLLKinSeedState& seed_state,
+                                                           const double seed_arm_angle, RLLKinGlobalConfigs* configs,
+                                                           RLLKinPoseConfig* ik_pose, RLLKinSolutions* solutions,
+                                                           const RLLInvKinOptions& options) const
+{
+  RLLKinGlobalConfigs& configs_ref = *configs;
+  std::array<RLLInvKinCoeffs, 2> coeffs;
+  coeffs.front().setSeedState(seed_state);
+  coeffs.back().setSeedState(seed_state);
+  std::array<double, 2> joint_angle_4;
+
+  // results in the order of the configs, unsolved configs keep an unset result
+  std::array<ClosestConfigsSolution, RLL_NUM_GLOBAL_CONFIGS> candidates;
+  bool found_solution = false;
+  size_t first = 0;
+
+  while (first < configs_ref.size())
+  {
+    // The coefficients only depend on GC4 and are computed upfront, so that the threads only need to update the
+    // config of their copy.
+    for (size_t i = first; i < configs_ref.size(); ++i)
+    {
+      RLLKinPoseConfig pose = *ik_pose;
+      pose.config.set(configs_ref[i].val());
+      int index = configs_ref[i].indexGC4();
+      RLLKinMsg result = setCoeffsWithInitCheck(pose, &coeffs[index], &joint_angle_4[index]);
+      if (result.error())
+      {
+        candidates[i] = ClosestConfigsSolution(RLLKinJoints(), std::numeric_limits<double>::infinity(), pose, result);
+      }
+    }
+
+    runParallel(configs_ref.size() - first, [&](size_t item, std::atomic<bool>* stop) {
+      size_t i = first + item;
+      int index = configs_ref[i].indexGC4();
+      if (coeffs[index].initError().error())
+      {
+        return;
+      }
+
+      RLLKinPoseConfig pose = *ik_pose;
+      pose.config.set(configs_ref[i].val());
+      RLLInvKinCoeffs config_coeffs = coeffs[index];
+      config_coeffs.setGC(pose.config);
+      double arm_angle_start = mapArmAngleForGC4(configs_ref[0], configs_ref[i], seed_arm_angle);
+
+      RLLKinJoints solution;
+      solution[3] = joint_angle_4[index];
+      RLLKinMsg result = redundancyResolution(config_coeffs, options, arm_angle_start, &pose.arm_angle, &solution);
+
+      double dist_from_seed = std::numeric_limits<double>::infinity();
+      if (result.success())
+      {
+        dist_from_seed = 0.0;
+        for (size_t j = 0; j < RLL_NUM_JOINTS; ++j)
+        {
+          dist_from_seed += fabs(solution[j] - seed_state.front()(j));
+        }
+
+        if (dist_from_seed < GLOBAL_CONFIG_DISTANCE_TOL &&
+            options.global_configuration_mode == RLLInvKinOptions::SELECT_NEAREST_GLOBAL_CONFIG)
+        {
+          stop->store(true, std::memory_order_relaxed);
+        }
+      }
+
+      candidates[i] = ClosestConfigsSolution(solution, dist_from_seed, pose, result);
+    });
+
+    for (size_t i = first; i < configs_ref.size(); ++i)
+    {
+      found_solution = found_solution || candidates[i].result().success();
+    }
+
+    // same fallback as the sequential search: try all remaining configs if none of the closest ones has a solution
+    first = configs_ref.size();
+    addRemainingConfigs(first - 1, found_solution ? 0.0 : std::numeric_limits<double>::infinity(), configs);
+  }
+
+  boost::container::static_vector<ClosestConfigsSolution, RLL_NUM_GLOBAL_CONFIGS> solutions_data;
+  std::copy_if(candidates.begin(), candidates.begin() + configs_ref.size(), std::back_inserter(solutions_data),
+               [](ClosestConfigsSolution const& ccs) { return ccs.result().success(); });
+  std::sort(solutions_data.begin(), solutions_data.end());
+
+  if (!solutions_data.empty())
+  {
+    std::transform(solutions_data.begin(), solutions_data.end(), std::back_inserter(*solutions),
+                   [](ClosestConfigsSolution const& ccs) { return ccs.solution(); });
+    *ik_pose = solutions_data.front().pose();
+    return solutions_data.front().result();
+  }
+
+  // like the sequential search, report the result of the last config and leave the pose in its state
+  *ik_pose = candidates[configs_ref.size() - 1].pose();
+  return candidates[configs_ref.size() - 1].result();
+}
+
 void RLLRedundancyResolution::determineClosestConfigs(const RLLKinJoints& joint_angles, RLLKinGlobalConfigs* configs,
                                                       const RLLInvKinOptions& options)
 {
@@ -378,7 +791,8 @@ void RLLRedundancyResolution::determineClosestConfigs(const RLLKinJoints& joint_
 }
 
 double RLLKinMultiObjOptimization::optimalArmAngle(const RLLKinJoints& joint_velocity_limits,
-                                                   const RLLKinJoints& joint_acceleration_limits)
+                                                   const RLLKinJoints& joint_acceleration_limits,
+                                                   RLLKinArmAngleWarmStart* warm_start)
 {
   double arm_angle;
   joint_velocity_limits_ = joint_velocity_limits;
@@ -386,7 +800,7 @@ double RLLKinMultiObjOptimization::optimalArmAngle(const RLLKinJoints& joint_vel
 
   if (options_.use_numerical_solver)
   {
-    arm_angle = optimalArmAngleNumerical();
+    arm_angle = optimalArmAngleNumerical(warm_start);
   }
   else
   {
@@ -425,7 +839,82 @@ double RLLKinMultiObjOptimization::optimalArmAngleClosedForm() const
          (w_tilde_v * arm_angle_v_d + w_tilde_a * arm_angle_a_d + w_tilde_l);
 }
 
-double RLLKinMultiObjOptimization::optimalArmAngleNumerical() const
+double RLLKinMultiObjOptimization::optimalArmAngleNumerical(RLLKinArmAngleWarmStart* warm_start) const
+{
+  // the minimum is bracketed by the arm angles at which the derivative changed its sign
+  double lower = arm_angle_interval_.lowerLimit();
+  double upper = arm_angle_interval_.upperLimit();
+
+  // the optimum of the previous waypoint, the seed arm angle, is close to the new one
+  double arm_angle = std::min(std::max(arm_angle_old_, lower), upper);
+  double derivative = costFunctionDerivative(arm_angle);
+
+  double curvature;
+  if (warm_start != nullptr && warm_start->valid_)
+  {
+    curvature = warm_start->curvature_;
+  }
+  else
+  {
+    const double step = 1E-06;
+    double probe = arm_angle + (arm_angle + step < upper ? step : -step);
+    curvature = (costFunctionDerivative(probe) - derivative) / (probe - arm_angle);
+  }
+
+  for (int i = 0; i < NEWTON_MAX_ITERATIONS && std::isfinite(derivative); ++i)
+  {
+    if (derivative > 0.0)
+    {
+      upper = arm_angle;
+    }
+    else
+    {
+      lower = arm_angle;
+    }
+
+    // bisect if the cost is not convex here or the step leaves the bracket
+    double arm_angle_next = (lower + upper) / 2.0;
+    if (curvature > 0.0)
+    {
+      double newton_arm_angle = arm_angle - derivative / curvature;
+      if (newton_arm_angle > lower && newton_arm_angle < upper)
+      {
+        arm_angle_next = newton_arm_angle;
+      }
+    }
+
+    double derivative_next = costFunctionDerivative(arm_angle_next);
+    double secant = (derivative_next - derivative) / (arm_angle_next - arm_angle);
+    if (secant > 0.0 && std::isfinite(secant))
+    {
+      curvature = secant;
+    }
+
+    if (fabs(arm_angle_next - arm_angle) < NEWTON_ARM_ANGLE_TOL)
+    {
+      if (warm_start != nullptr)
+      {
+        warm_start->curvature_ = curvature;
+        warm_start->valid_ = curvature > 0.0;
+      }
+
+      return arm_angle_next;
+    }
+
+    arm_angle = arm_angle_next;
+    derivative = derivative_next;
+  }
+
+  // e.g. the derivative is not defined at a hinge joint singularity
+  if (warm_start != nullptr)
+  {
+    warm_start->reset();
+  }
+
+  return optimalArmAngleBrent();
+}
+
+double RLLKinMultiObjOptimization::optimalArmAngleBrent() const
 {
   CostFunctionNumericalSolverFunctor functor(*this);
 
@@ -554,18 +1043,16 @@ double RLLKinMultiObjOptimization::costFunction(double arm_angle) const
   double f_l =
       pow((arm_angle - arm_angle_l) / ((arm_angle_interval_.upperLimit() - arm_angle_interval_.lowerLimit()) / 2), 2);
 
-  std::array<double, RLL_NUM_JOINTS> delta_psi;
-  for (uint8_t i = 0; i < RLL_NUM_JOINTS_P; ++i)
-  {
-    double joint_angle = coeffs_.jointAnglePivot(i, arm_angle);
-    delta_psi[i * 2] = joint_angle - coeffs_.seedState().front()(i * 2);
-  }
+  RLLKinJoints joint_angles;
+  coeffs_.jointAngles(arm_angle, &joint_angles);
 
-  for (uint8_t i = 0; i < RLL_NUM_JOINTS_H; ++i)
+  std::array<double, RLL_NUM_JOINTS> delta_psi;
+  for (size_t i = 0; i < RLL_NUM_JOINTS; ++i)
   {
-    double joint_angle = coeffs_.jointAngleHinge(i, arm_angle);
-    delta_psi[i * 4 + 1] = joint_angle - coeffs_.seedState().front()(i * 4 + 1);
+    delta_psi[i] = joint_angles(i) - coeffs_.seedState().front()(i);
   }
+  // no change for elbow joint angle in variation of arm angle
+  delta_psi[3] = 0.0;
 
   double delta_t = options_.delta_t_desired;
 
@@ -588,6 +1075,58 @@ double RLLKinMultiObjOptimization::costFunction(double arm_angle) const
   return w_v * f_v + w_a * f_a + w_l * f_l;
 }
 
+double RLLKinMultiObjOptimization::costFunctionDerivative(double arm_angle) const
+{
+  double w_dis, w_tilde_l, arm_angle_l;
+  limitWeightsArmAngle(&w_dis, &w_tilde_l, &arm_angle_l);
+  double w_l = w_dis;
+
+  double w_v, w_a;
+  dynamicWeights(w_dis, &w_v, &w_a);
+
+  double d_f_l = 2 * (arm_angle - arm_angle_l) /
+                 pow((arm_angle_interval_.upperLimit() - arm_angle_interval_.lowerLimit()) / 2, 2);
+
+  RLLKinJoints joint_angles;
+  coeffs_.jointAngles(arm_angle, &joint_angles);
+
+  std::array<double, RLL_NUM_JOINTS> delta_psi, deriv_theta_psi;
+  for (uint8_t i = 0; i < RLL_NUM_JOINTS_P; ++i)
+  {
+    deriv_theta_psi[i * 2] = coeffs_.jointDerivativePivot(i, arm_angle);
+  }
+  for (uint8_t i = 0; i < RLL_NUM_JOINTS_H; ++i)
+  {
+    deriv_theta_psi[i * 4 + 1] = coeffs_.jointDerivativeHinge(i, arm_angle, joint_angles(i * 4 + 1));
+  }
+  for (size_t i = 0; i < RLL_NUM_JOINTS; ++i)
+  {
+    delta_psi[i] = joint_angles(i) - coeffs_.seedState().front()(i);
+  }
+  // no change for elbow joint angle in variation of arm angle
+  deriv_theta_psi[3] = 0.0;
+  delta_psi[3] = 0.0;
+
+  double delta_t = options_.delta_t_desired;
+
+  double d_f_v = 0.0;
+  for (size_t i = 0; i < RLL_NUM_JOINTS; ++i)
+  {
+    d_f_v += delta_psi[i] * deriv_theta_psi[i] / pow(maxVelocity(i) * delta_t, 2);
+  }
+  d_f_v *= 2.0 / 7.0;
+
+  double d_f_a = 0.0;
+  for (size_t i = 0; i < RLL_NUM_JOINTS; ++i)
+  {
+    d_f_a += (delta_psi[i] - coeffs_.seedState().front()(i) + coeffs_.seedState()[1](i)) * deriv_theta_psi[i] /
+             pow(maxAcceleration(i) * pow(delta_t, 2), 2);
+  }
+  d_f_a *= 2.0 / 7.0;
+
+  return w_v * d_f_v + w_a * d_f_a + w_l * d_f_l;
+}
+
 void RLLKinMultiObjOptimization::deltaT(const double arm_angle_v, const double arm_angle_a, double* delta_t_v,
                                         double* delta_t_a) const
 {
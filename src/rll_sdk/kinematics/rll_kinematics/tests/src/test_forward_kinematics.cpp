@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <rll_kinematics/redundancy_resolution.h>
+
+namespace
+{
+const size_t NUM_SAMPLES = 2000;
+const double TOLERANCE = 1E-12;
+}  // namespace
+
+class ForwardKinematicsTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    joint_position_limits_.lower = { -2.93215, -2.05949, -2.93215, -2.05949, -2.93215, -2.05949, -3.01942 };
+    joint_position_limits_.upper = { 2.93215, 2.05949, 2.93215, 2.05949, 2.93215, 2.05949, 3.01942 };
+    RLLKinJoints joint_velocity_limits = { 1.7104, 1.7104, 1.7453, 2.2689, 2.4434, 3.1415, 3.1415 };
+    RLLKinJoints joint_acceleration_limits = { 5.4444, 5.4444, 5.5555, 7.2222, 7.7777, 10.0, 10.0 };
+    RLLKinLimbs limb_lengths = { 0.34, 0.4, 0.4, 0.126 };
+
+    ASSERT_TRUE(
+        generic_.initialize(limb_lengths, joint_position_limits_, joint_velocity_limits, joint_acceleration_limits)
+            .success());
+    ASSERT_TRUE(
+        sparse_.initialize(limb_lengths, joint_position_limits_, joint_velocity_limits, joint_acceleration_limits)
+            .success());
+    sparse_.useSparseChain(true);
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t s = 0; s < NUM_SAMPLES; ++s)
+    {
+      RLLKinJoints joint_angles;
+      for (int i = 0; i < RLL_NUM_JOINTS; ++i)
+      {
+        double lower = joint_position_limits_.lower(i);
+        joint_angles[i] = lower + unit(generator) * (joint_position_limits_.upper(i) - lower);
+      }
+      samples_.push_back(joint_angles);
+    }
+  }
+
+  RLLRedundancyResolution generic_, sparse_;
+  RLLKinJointLimits joint_position_limits_;
+  std::vector<RLLKinJoints> samples_;
+};
+
+TEST_F(ForwardKinematicsTest, testSparseChainMatchesDHProducts)
+{
+  for (const auto& joint_angles : samples_)
+  {
+    RLLKinPoseConfig expected, pose;
+    RLLKinMsg expected_result = generic_.fk(joint_angles, &expected);
+    EXPECT_EQ(sparse_.fk(joint_angles, &pose).val(), expected_result.val());
+    if (expected_result.error())
+    {
+      continue;
+    }
+
+    EXPECT_TRUE(pose.pose.pos().isApprox(expected.pose.pos(), TOLERANCE));
+    EXPECT_TRUE(pose.pose.ori().isApprox(expected.pose.ori(), TOLERANCE));
+    EXPECT_NEAR(pose.arm_angle, expected.arm_angle, TOLERANCE);
+    EXPECT_EQ(pose.config.val(), expected.config.val());
+  }
+}
+
+TEST_F(ForwardKinematicsTest, testSparseChainIK)
+{
+  // IK solutions of the sparse solver have to reproduce the goal poses with its own FK
+  size_t num_solved = 0;
+  for (const auto& joint_angles : samples_)
+  {
+    RLLKinPoseConfig goal;
+    if (sparse_.fk(joint_angles, &goal).error())
+    {
+      continue;
+    }
+
+    RLLKinSeedState seed_state;
+    seed_state.push_back(joint_angles);
+    seed_state.push_back(joint_angles);
+    RLLKinSolutions solutions;
+    RLLKinPoseConfig ik_pose = goal;
+    if (sparse_.ik(seed_state, &ik_pose, &solutions, RLLInvKinOptions()).error())
+    {
+      continue;
+    }
+
+    ++num_solved;
+    RLLKinPoseConfig pose;
+    sparse_.fk(solutions.front(), &pose);
+    EXPECT_TRUE(pose.pose.pos().isApprox(goal.pose.pos(), 1E-06));
+  }
+
+  EXPECT_GT(num_solved, NUM_SAMPLES / 2);
+}
+
+TEST_F(ForwardKinematicsTest, testLinkFramesMatchFK)
+{
+  std::vector<RLLKinLinkFrames> link_frames(samples_.size());
+  ASSERT_TRUE(generic_.linkFrames(samples_.data(), samples_.size(), link_frames.data()).success());
+
+  for (size_t s = 0; s < samples_.size(); ++s)
+  {
+    RLLKinPoseConfig pose;
+    if (generic_.fk(samples_[s], &pose).error())
+    {
+      continue;
+    }
+
+    const RLLKinFrame& flange = link_frames[s].frames[RLL_NUM_JOINTS - 1];
+    EXPECT_TRUE(flange.pos().isApprox(pose.pose.pos(), TOLERANCE));
+    EXPECT_TRUE(flange.ori().isApprox(pose.pose.ori(), TOLERANCE));
+  }
+}
+
+TEST_F(ForwardKinematicsTest, testLinkFramesJacobian)
+{
+  const double step = 1E-07;
+  for (size_t s = 0; s < NUM_SAMPLES; s += 10)
+  {
+    RLLKinLinkFrames link_frames;
+    ASSERT_TRUE(generic_.linkFrames(&samples_[s], 1, &link_frames).success());
+    const RLLKinFrame& flange = link_frames.frames[RLL_NUM_JOINTS - 1];
+
+    for (int i = 0; i < RLL_NUM_JOINTS; ++i)
+    {
+      RLLKinJoints joint_angles = samples_[s];
+      joint_angles[i] += step;
+      RLLKinLinkFrames moved;
+      generic_.linkFrames(&joint_angles, 1, &moved);
+      const RLLKinFrame& moved_flange = moved.frames[RLL_NUM_JOINTS - 1];
+
+      Eigen::Vector3d linear = (moved_flange.pos() - flange.pos()) / step;
+      Eigen::AngleAxisd rotation(moved_flange.ori() * flange.ori().transpose());
+      Eigen::Vector3d angular = rotation.angle() * rotation.axis() / step;
+
+      EXPECT_TRUE(linear.isApprox(link_frames.jacobian.block<3, 1>(0, i), 1E-05) || linear.norm() < 1E-05);
+      EXPECT_TRUE(angular.isApprox(link_frames.jacobian.block<3, 1>(3, i), 1E-05));
+    }
+  }
+}
+
+TEST_F(ForwardKinematicsTest, testLinkFramesInvalidInput)
+{
+  RLLKinJoints joint_angles = samples_.front();
+  joint_angles[3] = std::numeric_limits<double>::quiet_NaN();
+  RLLKinLinkFrames link_frames;
+  EXPECT_EQ(generic_.linkFrames(&joint_angles, 1, &link_frames).val(), RLLKinMsg::INVALID_INPUT);
+
+  RLLForwardKinematics uninitialized;
+  EXPECT_EQ(uninitialized.linkFrames(&samples_.front(), 1, &link_frames).val(), RLLKinMsg::NOT_INITIALIZED);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <rll_kinematics/redundancy_resolution.h>
+
+namespace
+{
+const size_t NUM_PATHS = 400;
+const size_t NUM_PATH_POSES = 200;
+}  // namespace
+
+class IKPathTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    RLLKinJoints joint_velocity_limits = { 1.7104, 1.7104, 1.7453, 2.2689, 2.4434, 3.1415, 3.1415 };
+    RLLKinJoints joint_acceleration_limits = { 5.4444, 5.4444, 5.5555, 7.2222, 7.7777, 10.0, 10.0 };
+    RLLKinJointLimits joint_position_limits;
+    joint_position_limits.lower = { -2.93215, -2.05949, -2.93215, -2.05949, -2.93215, -2.05949, -3.01942 };
+    joint_position_limits.upper = { 2.93215, 2.05949, 2.93215, 2.05949, 2.93215, 2.05949, 3.01942 };
+
+    ASSERT_TRUE(solver_
+                    .initialize({ 0.34, 0.4, 0.4, 0.126 }, joint_position_limits, joint_velocity_limits,
+                                joint_acceleration_limits)
+                    .success());
+
+    // linear paths of 20 cm in random directions
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    while (seeds_.size() < NUM_PATHS)
+    {
+      RLLKinJoints seed;
+      for (int i = 0; i < RLL_NUM_JOINTS; ++i)
+      {
+        double range = joint_position_limits.upper(i) - joint_position_limits.lower(i);
+        seed[i] = joint_position_limits.lower(i) + unit(generator) * range;
+      }
+
+      RLLKinPoseConfig start;
+      if (solver_.fk(seed, &start).error())
+      {
+        continue;
+      }
+
+      Eigen::Vector3d direction(normal(generator), normal(generator), normal(generator));
+      direction *= 0.2 / direction.norm();
+      std::vector<RLLKinFrame> path;
+      for (size_t k = 1; k <= NUM_PATH_POSES; ++k)
+      {
+        RLLKinFrame pose = start.pose;
+        Eigen::Vector3d position = start.pose.pos() + direction * k / NUM_PATH_POSES;
+        pose.setPosition(position.x(), position.y(), position.z());
+        path.push_back(pose);
+      }
+
+      seeds_.push_back(seed);
+      paths_.push_back(path);
+    }
+  }
+
+  RLLKinMsg solvePath(size_t i, const RLLInvKinOptions& options, std::vector<RLLKinJoints>* solutions,
+                      size_t* num_solved) const
+  {
+    RLLKinSeedState seed_state;
+    seed_state.push_back(seeds_[i]);
+    seed_state.push_back(seeds_[i]);
+    solutions->resize(NUM_PATH_POSES);
+    return solver_.ikPath(seed_state, paths_[i].data(), NUM_PATH_POSES, solutions->data(), num_solved, options);
+  }
+
+  RLLRedundancyResolution solver_;
+  std::vector<RLLKinJoints> seeds_;
+  std::vector<std::vector<RLLKinFrame>> paths_;
+};
+
+TEST_F(IKPathTest, testStopAtArmAngleJump)
+{
+  RLLInvKinOptions options;
+  options.global_configuration_mode = RLLInvKinOptions::KEEP_CURRENT_GLOBAL_CONFIG;
+  RLLInvKinOptions stop_options = options;
+  stop_options.stop_at_arm_angle_jump = true;
+
+  size_t num_jumps = 0;
+  for (size_t i = 0; i < NUM_PATHS; ++i)
+  {
+    std::vector<RLLKinJoints> solutions, stop_solutions;
+    size_t num_solved, stop_num_solved;
+    RLLKinMsg result = solvePath(i, options, &solutions, &num_solved);
+    RLLKinMsg stop_result = solvePath(i, stop_options, &stop_solutions, &stop_num_solved);
+
+    // the path is the same up to the jump
+    ASSERT_LE(stop_num_solved, num_solved);
+    EXPECT_EQ(std::memcmp(solutions.data(), stop_solutions.data(), stop_num_solved * sizeof(RLLKinJoints)), 0);
+
+    if (stop_result.val() == RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL)
+    {
+      ++num_jumps;
+      EXPECT_LT(stop_num_solved, NUM_PATH_POSES);
+    }
+    else
+    {
+      EXPECT_EQ(stop_result.val(), result.val());
+      EXPECT_EQ(stop_num_solved, num_solved);
+    }
+  }
+
+  EXPECT_GT(num_jumps, 0u);
+}
+
+TEST_F(IKPathTest, testNumericalSolverWarmStart)
+{
+  // The optimizer state carried along the path only saves iterations, the waypoints are the same as with cold starts.
+  // Only if the cost function has several minima close to the seed, the first steps may end up in different ones.
+  RLLInvKinOptions options;
+  options.global_configuration_mode = RLLInvKinOptions::KEEP_CURRENT_GLOBAL_CONFIG;
+  options.use_numerical_solver = true;
+
+  size_t num_compared = 0, num_mismatches = 0;
+  for (size_t i = 0; i < NUM_PATHS; ++i)
+  {
+    std::vector<RLLKinJoints> solutions;
+    size_t num_solved;
+    solvePath(i, options, &solutions, &num_solved);
+
+    RLLKinSeedState seed_state;
+    seed_state.push_back(seeds_[i]);
+    seed_state.push_back(seeds_[i]);
+    for (size_t k = 0; k < num_solved; ++k)
+    {
+      RLLKinPoseConfig ik_pose;
+      ik_pose.pose = paths_[i][k];
+      RLLKinSolutions ik_solutions;
+      ASSERT_FALSE(solver_.ik(seed_state, &ik_pose, &ik_solutions, options).error());
+      bool same = true;
+      for (int j = 0; j < RLL_NUM_JOINTS; ++j)
+      {
+        same = same && std::fabs(ik_solutions.front()(j) - solutions[k](j)) < 1E-06;
+      }
+      num_mismatches += same ? 0 : 1;
+
+      seed_state.back() = seed_state.front();
+      seed_state.front() = solutions[k];
+      ++num_compared;
+    }
+  }
+
+  EXPECT_GT(num_compared, NUM_PATHS * NUM_PATH_POSES / 2);
+  EXPECT_LT(num_mismatches, num_compared / 1000);
+}
+
+TEST_F(IKPathTest, testArmAngleSweep)
+{
+  // full turns of the arm angle at the start pose of each path
+  const size_t num_arm_angles = 360;
+  RLLInvKinOptions options;
+  options.method = RLLInvKinOptions::ARM_ANGLE_FIXED;
+  options.global_configuration_mode = RLLInvKinOptions::KEEP_CURRENT_GLOBAL_CONFIG;
+
+  size_t num_interrupted = 0;
+  for (size_t i = 0; i < NUM_PATHS; ++i)
+  {
+    RLLKinPoseConfig start;
+    ASSERT_FALSE(solver_.fk(seeds_[i], &start).error());
+    std::vector<double> arm_angles;
+    for (size_t k = 1; k <= num_arm_angles; ++k)
+    {
+      arm_angles.push_back(start.arm_angle + 2 * M_PI * k / num_arm_angles);
+    }
+
+    RLLKinSeedState seed_state;
+    seed_state.push_back(seeds_[i]);
+    std::vector<RLLKinJoints> solutions(num_arm_angles);
+    size_t num_solved;
+    RLLKinMsg result =
+        solver_.ikArmAngles(seed_state, start.pose, arm_angles.data(), num_arm_angles, solutions.data(), &num_solved);
+
+    // same solutions as separate queries with the coefficients computed from scratch
+    for (size_t k = 0; k < num_solved; ++k)
+    {
+      RLLKinPoseConfig ik_pose = start;
+      ik_pose.arm_angle = arm_angles[k];
+      RLLKinSolutions ik_solutions;
+      ASSERT_FALSE(solver_.ik(seed_state, &ik_pose, &ik_solutions, options).error());
+      EXPECT_EQ(std::memcmp(&ik_solutions.front(), &solutions[k], sizeof(RLLKinJoints)), 0);
+    }
+
+    if (num_solved < num_arm_angles)
+    {
+      ++num_interrupted;
+      EXPECT_TRUE(result.error() || result.val() == RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL);
+    }
+  }
+
+  // full turns usually cross a blocked interval
+  EXPECT_GT(num_interrupted, 0u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <rll_kinematics/redundancy_resolution.h>
+
+// Concurrent queries on one shared solver instance have to return exactly the results of sequential queries.
+
+namespace
+{
+const size_t NUM_THREADS = 8;
+const size_t NUM_SAMPLES = 400;
+const size_t NUM_PATH_POSES = 20;
+
+struct IKResult
+{
+  RLLKinMsg::Msg result;
+  RLLKinSolutions solutions;
+  double arm_angle;
+};
+
+bool sameResult(const IKResult& lhs, const IKResult& rhs)
+{
+  if (lhs.result != rhs.result || lhs.solutions.size() != rhs.solutions.size() ||
+      std::memcmp(&lhs.arm_angle, &rhs.arm_angle, sizeof(double)) != 0)
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < lhs.solutions.size(); ++i)
+  {
+    for (int j = 0; j < RLL_NUM_JOINTS; ++j)
+    {
+      double a = lhs.solutions[i](j);
+      double b = rhs.solutions[i](j);
+      if (std::memcmp(&a, &b, sizeof(double)) != 0)
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// runs query(i) for all samples on several threads, each thread starts at a different sample
+template <typename Query>
+size_t countConcurrentMismatches(size_t num_samples, Query query)
+{
+  std::atomic<size_t> mismatches{ 0 };
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < NUM_THREADS; ++t)
+  {
+    threads.emplace_back([&, t] {
+      for (size_t k = 0; k < num_samples; ++k)
+      {
+        if (!query((k + t * num_samples / NUM_THREADS) % num_samples))
+        {
+          mismatches.fetch_add(1);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  return mismatches.load();
+}
+}  // namespace
+
+class ThreadSafetyTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    RLLKinJoints joint_velocity_limits = { 1.7104, 1.7104, 1.7453, 2.2689, 2.4434, 3.1415, 3.1415 };
+    RLLKinJoints joint_acceleration_limits = { 5.4444, 5.4444, 5.5555, 7.2222, 7.7777, 10.0, 10.0 };
+    joint_position_limits_.lower = { -2.93215, -2.05949, -2.93215, -2.05949, -2.93215, -2.05949, -3.01942 };
+    joint_position_limits_.upper = { 2.93215, 2.05949, 2.93215, 2.05949, 2.93215, 2.05949, 3.01942 };
+
+    ASSERT_TRUE(solver_
+                    .initialize({ 0.34, 0.4, 0.4, 0.126 }, joint_position_limits_, joint_velocity_limits,
+                                joint_acceleration_limits)
+                    .success());
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_real_distribution<double> noise(-0.1, 0.1);
+    while (goals_.size() < NUM_SAMPLES)
+    {
+      RLLKinJoints joint_angles, seed;
+      for (int i = 0; i < RLL_NUM_JOINTS; ++i)
+      {
+        double range = 0.9 * (joint_position_limits_.upper(i) - joint_position_limits_.lower(i));
+        joint_angles[i] = 0.9 * joint_position_limits_.lower(i) + unit(generator) * range;
+        seed[i] = joint_angles(i) + noise(generator);
+      }
+
+      RLLKinPoseConfig goal;
+      if (solver_.fk(joint_angles, &goal).success())
+      {
+        goals_.push_back(goal);
+        seeds_.push_back(seed);
+      }
+    }
+  }
+
+  IKResult solve(size_t sample, const RLLInvKinOptions& options) const
+  {
+    RLLKinSeedState seed_state;
+    seed_state.push_back(seeds_[sample]);
+    seed_state.push_back(seeds_[sample]);
+
+    IKResult ik_result;
+    RLLKinPoseConfig pose = goals_[sample];
+    ik_result.result = solver_.ik(seed_state, &pose, &ik_result.solutions, options).val();
+    ik_result.arm_angle = pose.arm_angle;
+    return ik_result;
+  }
+
+  RLLRedundancyResolution solver_;
+  RLLKinJointLimits joint_position_limits_;
+  std::vector<RLLKinPoseConfig> goals_;
+  std::vector<RLLKinJoints> seeds_;
+};
+
+TEST_F(ThreadSafetyTest, testConcurrentFK)
+{
+  std::vector<RLLKinPoseConfig> reference(NUM_SAMPLES);
+  for (size_t i = 0; i < NUM_SAMPLES; ++i)
+  {
+    solver_.fk(seeds_[i], &reference[i]);
+  }
+
+  size_t mismatches = countConcurrentMismatches(NUM_SAMPLES, [&](size_t i) {
+    RLLKinPoseConfig pose;
+    solver_.fk(seeds_[i], &pose);
+    return pose.pose.pos() == reference[i].pose.pos() && pose.pose.ori() == reference[i].pose.ori() &&
+           std::memcmp(&pose.arm_angle, &reference[i].arm_angle, sizeof(double)) == 0 &&
+           pose.config.val() == reference[i].config.val();
+  });
+
+  EXPECT_EQ(mismatches, 0u);
+}
+
+TEST_F(ThreadSafetyTest, testConcurrentIK)
+{
+  std::vector<RLLInvKinOptions> all_options;
+  for (auto method : { RLLInvKinOptions::POSITION_RESOLUTION_EXP, RLLInvKinOptions::RESOLUTION_MULTI_OBJECTIVE,
+                       RLLInvKinOptions::ARM_ANGLE_FIXED })
+  {
+    for (auto mode : { RLLInvKinOptions::SELECT_NEAREST_GLOBAL_CONFIG, RLLInvKinOptions::KEEP_CURRENT_GLOBAL_CONFIG,
+                       RLLInvKinOptions::RETURN_ALL_GLOBAL_CONFIGS })
+    {
+      RLLInvKinOptions options;
+      options.method = method;
+      options.global_configuration_mode = mode;
+      all_options.push_back(options);
+    }
+  }
+
+  // the helper threads of the solver are shared between all callers
+  RLLInvKinOptions parallel_options;
+  parallel_options.parallel_global_configs = true;
+  all_options.push_back(parallel_options);
+  parallel_options.global_configuration_mode = RLLInvKinOptions::RETURN_ALL_GLOBAL_CONFIGS;
+  all_options.push_back(parallel_options);
+
+  RLLInvKinOptions numerical_options;
+  numerical_options.use_numerical_solver = true;
+  all_options.push_back(numerical_options);
+
+  for (const auto& options : all_options)
+  {
+    std::vector<IKResult> reference;
+    size_t num_solved = 0;
+    for (size_t i = 0; i < NUM_SAMPLES; ++i)
+    {
+      reference.push_back(solve(i, options));
+      num_solved += RLLKinMsg(reference.back().result).success() ? 1 : 0;
+    }
+    EXPECT_GT(num_solved, NUM_SAMPLES / 2) << options;
+
+    size_t mismatches =
+        countConcurrentMismatches(NUM_SAMPLES, [&](size_t i) { return sameResult(solve(i, options), reference[i]); });
+    EXPECT_EQ(mismatches, 0u) << options;
+  }
+}
+
+TEST_F(ThreadSafetyTest, testConcurrentIKPath)
+{
+  // short linear paths from the seed state towards the goal position
+  std::vector<std::vector<RLLKinFrame>> paths(NUM_SAMPLES);
+  for (size_t i = 0; i < NUM_SAMPLES; ++i)
+  {
+    RLLKinPoseConfig start;
+    solver_.fk(seeds_[i], &start);
+    Eigen::Vector3d offset = 0.1 * (goals_[i].pose.pos() - start.pose.pos()).normalized();
+    for (size_t k = 1; k <= NUM_PATH_POSES; ++k)
+    {
+      RLLKinFrame pose = start.pose;
+      Eigen::Vector3d position = start.pose.pos() + offset * k / NUM_PATH_POSES;
+      pose.setPosition(position.x(), position.y(), position.z());
+      paths[i].push_back(pose);
+    }
+  }
+
+  RLLInvKinOptions options;
+  auto solvePath = [&](size_t i, std::vector<RLLKinJoints>* solutions, size_t* num_solved) {
+    RLLKinSeedState seed_state;
+    seed_state.push_back(seeds_[i]);
+    seed_state.push_back(seeds_[i]);
+    solutions->resize(NUM_PATH_POSES);
+    return solver_.ikPath(seed_state, paths[i].data(), NUM_PATH_POSES, solutions->data(), num_solved, options).val();
+  };
+
+  std::vector<std::vector<RLLKinJoints>> reference(NUM_SAMPLES);
+  std::vector<size_t> reference_solved(NUM_SAMPLES);
+  std::vector<RLLKinMsg::Msg> reference_result(NUM_SAMPLES);
+  for (size_t i = 0; i < NUM_SAMPLES; ++i)
+  {
+    reference_result[i] = solvePath(i, &reference[i], &reference_solved[i]);
+  }
+
+  size_t mismatches = countConcurrentMismatches(NUM_SAMPLES, [&](size_t i) {
+    std::vector<RLLKinJoints> solutions;
+    size_t num_solved;
+    if (solvePath(i, &solutions, &num_solved) != reference_result[i] || num_solved != reference_solved[i])
+    {
+      return false;
+    }
+
+    return std::memcmp(solutions.data(), reference[i].data(), num_solved * sizeof(RLLKinJoints)) == 0;
+  });
+
+  EXPECT_EQ(mismatches, 0u);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -22,6 +22,8 @@
 #define RLL_MOVEIT_KINEMATICS_PLUGIN_MOVEIT_KINEMATICS_PLUGIN_H
 
 // ros
+#include <map>
+
 #include <pluginlib/class_list_macros.h>
 #include <ros/ros.h>
 #include <tf/transform_datatypes.h>
@@ -31,10 +33,13 @@
 #include <moveit/kinematics_base/kinematics_base.h>
 #include <moveit/robot_state/robot_state.h>
 
+#include <rll_kinematics/reachability_map.h>
 #include <rll_kinematics/redundancy_resolution.h>
 
 namespace rll_moveit_kinematics
 {
+// All const member functions are thread-safe once initialize() returned, so a single instance can be shared by
+// parallel callers.
 class RLLMoveItKinematicsPlugin : public kinematics::KinematicsBase
 {
 public:
@@ -67,6 +72,7 @@ public:
       const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
       const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
 
+  // supports the base frame and all links returned by getLinkNames()
   bool getPositionFK(const std::vector<std::string>& link_names, const std::vector<double>& joint_angles,
                      std::vector<geometry_msgs::Pose>& poses) const override;
 
@@ -93,23 +99,54 @@ public:
   bool getPositionIKarmangle(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state,
                              std::vector<double>* solution, moveit_msgs::MoveItErrorCodes* error_code,
                              const double& arm_angle) const;
+  // solve IK for several arm angles of the same pose, the global configuration of the seed state is kept and the
+  // coefficients of the pose are reused, see RLLRedundancyResolution::ikArmAngles()
+  // returns the solutions up to the first arm angle without a solution
+  bool getPositionIKarmangles(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state,
+                              const std::vector<double>& arm_angles, std::vector<std::vector<double>>* solutions) const;
   // solve forward kinematics and get arm angle and global configuration
   bool getPositionFK(const std::vector<double>& joint_angles, geometry_msgs::Pose* pose, double* arm_angle,
                      int* config) const;
 
+  // the DH frames and flange Jacobians of all joint vectors in one call, e.g. for all waypoints of a trajectory
+  bool getLinkFramesBatch(const std::vector<RLLKinJoints>& joint_angles,
+                          std::vector<RLLKinLinkFrames>* link_frames) const;
+
   RLLKinMsg callRLLIK(const geometry_msgs::Pose& ros_pose, const RLLKinSeedState& ik_seed_state,
                       RLLKinSolutions* solutions, RLLInvKinOptions ik_options) const;
   RLLKinMsg callRLLIK(const RLLKinSeedState& ik_seed_state, RLLKinPoseConfig* ik_pose, RLLKinSolutions* solutions,
                       RLLInvKinOptions ik_options) const;
+  // solve the IK for ros_poses[first], ros_poses[first + 1], ... in one call, see RLLRedundancyResolution::ikPath()
+  RLLKinMsg callRLLIKPath(const std::vector<geometry_msgs::Pose>& ros_poses, size_t first,
+                          const RLLKinSeedState& ik_seed_state, std::vector<RLLKinJoints>* solutions,
+                          RLLInvKinOptions ik_options) const;
+
+  // O(1) check against the precomputed reachability map, false only if the pose is known to be unreachable
+  bool mayBeReachable(const geometry_msgs::Pose& ros_pose) const;
 
   static void transformPose(const geometry_msgs::Pose& ros_pose, RLLKinPoseConfig* ik_pose);
 
 private:
   bool setLimbLengthsJointLimits();
+  void loadReachabilityMap(const RLLKinLimbs& limb_lengths, const RLLKinJointLimits& joint_position_limits);
+  void initLinkOffsets();
+  // an empty consistency_limits vector is always satisfied
+  static bool withinConsistencyLimits(const RLLKinJoints& joint_angles, const std::vector<double>& seed_state,
+                                      const std::vector<double>& consistency_limits);
 
   RLLRedundancyResolution solver_;
+  RLLKinReachabilityMap reachability_map_;
   std::vector<std::string> joint_names_;
   std::vector<std::string> link_names_;
+
+  // a link is rigidly attached to the DH frame of the last joint before it, a negative index attaches it to the base
+  struct LinkOffset
+  {
+    int joint_index;
+    Eigen::Matrix3d ori;
+    Eigen::Vector3d pos;
+  };
+  std::map<std::string, LinkOffset> link_offsets_;
 #if ROS_VERSION_MINIMUM(1, 14, 3)  // Melodic
 #else
   moveit::core::RobotModelConstPtr robot_model_;  // add member for Kinetic
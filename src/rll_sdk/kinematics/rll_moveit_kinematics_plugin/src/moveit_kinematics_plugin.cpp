@@ -18,17 +18,41 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <map>
+#include <mutex>
+
 #include <moveit/robot_model_loader/robot_model_loader.h>
 
 #include <rll_moveit_kinematics_plugin/moveit_kinematics_plugin.h>
 
 namespace rll_moveit_kinematics
 {
+// arm angles that are tried by searchPositionIK(), a step of 10 degrees
+const int ARM_ANGLE_SEARCH_SAMPLES = 36;
+
 #if ROS_VERSION_MINIMUM(1, 14, 3)  // Melodic
 #else
 static void noDeleter(const moveit::core::RobotModel* /*unused*/)
 {
 }
+
+// the plugin instances of all groups and robot model loaders in a process share one model per robot description
+static moveit::core::RobotModelConstPtr sharedRobotModel(const std::string& robot_description)
+{
+  static std::mutex mutex;
+  static std::map<std::string, moveit::core::RobotModelConstWeakPtr> models;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  moveit::core::RobotModelConstPtr robot_model = models[robot_description].lock();
+  if (!robot_model)
+  {
+    robot_model_loader::RobotModelLoader robot_model_loader(robot_description, false);
+    robot_model = robot_model_loader.getModel();
+    models[robot_description] = robot_model;
+  }
+
+  return robot_model;
+}
 #endif
 
 bool RLLMoveItKinematicsPlugin::initialize(
@@ -66,8 +90,7 @@ bool RLLMoveItKinematicsPlugin::initialize(
 
   setValues(robot_description, group_name, base_frame, tip_frame, search_discretization);
 
-  robot_model_loader::RobotModelLoader robot_model_loader(robot_description_, false);
-  robot_model_ = robot_model_loader.getModel();
+  robot_model_ = sharedRobotModel(robot_description_);
 #endif
 
   const moveit::core::JointModelGroup* jmg = robot_model_->getJointModelGroup(group_name);
@@ -84,6 +107,12 @@ bool RLLMoveItKinematicsPlugin::getPositionIK(  // NOLINT google-default-argumen
     const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, std::vector<double>& solution,
     moveit_msgs::MoveItErrorCodes& error_code, const kinematics::KinematicsQueryOptions& /*options*/) const
 {
+  if (!mayBeReachable(ik_pose))
+  {
+    error_code.val = error_code.NO_IK_SOLUTION;
+    return false;
+  }
+
   RLLInvKinOptions ik_options;
   RLLKinSolutions ik_solutions;
   RLLKinSeedState seed_state;
@@ -105,82 +134,206 @@ bool RLLMoveItKinematicsPlugin::getPositionIK(  // NOLINT google-default-argumen
 }
 
 bool RLLMoveItKinematicsPlugin::searchPositionIK(  // NOLINT google-default-arguments
-    const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double /*timeout*/,
+    const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
     std::vector<double>& solution, moveit_msgs::MoveItErrorCodes& error_code,
     const kinematics::KinematicsQueryOptions& options) const
 {
-  return getPositionIK(ik_pose, ik_seed_state, solution, error_code, options);
+  return searchPositionIK(ik_pose, ik_seed_state, timeout, std::vector<double>(), solution, IKCallbackFn(), error_code,
+                          options);
 }
 
 bool RLLMoveItKinematicsPlugin::searchPositionIK(  // NOLINT google-default-arguments
-    const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double /*timeout*/,
-    const std::vector<double>& /*consistency_limits*/, std::vector<double>& solution,
+    const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+    const std::vector<double>& consistency_limits, std::vector<double>& solution,
     moveit_msgs::MoveItErrorCodes& error_code, const kinematics::KinematicsQueryOptions& options) const
 {
-  return getPositionIK(ik_pose, ik_seed_state, solution, error_code, options);
+  return searchPositionIK(ik_pose, ik_seed_state, timeout, consistency_limits, solution, IKCallbackFn(), error_code,
+                          options);
 }
 
 bool RLLMoveItKinematicsPlugin::searchPositionIK(  // NOLINT google-default-arguments
-    const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double /*timeout*/,
+    const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
     std::vector<double>& solution, const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
+    const kinematics::KinematicsQueryOptions& options) const
+{
+  return searchPositionIK(ik_pose, ik_seed_state, timeout, std::vector<double>(), solution, solution_callback,
+                          error_code, options);
+}
+
+bool RLLMoveItKinematicsPlugin::searchPositionIK(  // NOLINT google-default-arguments
+    const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+    const std::vector<double>& consistency_limits, std::vector<double>& solution,
+    const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
     const kinematics::KinematicsQueryOptions& /*options*/) const
 {
-  RLLInvKinOptions ik_options;
-  RLLKinSolutions ik_solutions;
-  RLLKinSeedState seed_state;
+  ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(std::max(timeout, 0.0));
 
-  seed_state.emplace_back(ik_seed_state);
-  seed_state.emplace_back(ik_seed_state);
+  if (ik_seed_state.size() != RLL_NUM_JOINTS ||
+      (!consistency_limits.empty() && consistency_limits.size() != RLL_NUM_JOINTS))
+  {
+    ROS_ERROR_STREAM("Seed state or consistency limits do not have " << RLL_NUM_JOINTS << " values");
+    error_code.val = error_code.NO_IK_SOLUTION;
+    return false;
+  }
 
-  RLLKinMsg result = callRLLIK(ik_pose, seed_state, &ik_solutions, ik_options);
-  if (result.error())
+  if (!mayBeReachable(ik_pose))
   {
     error_code.val = error_code.NO_IK_SOLUTION;
     return false;
   }
 
-  if (solution_callback.empty())
+  RLLKinSeedState seed_state;
+  seed_state.emplace_back(ik_seed_state);
+  seed_state.emplace_back(ik_seed_state);
+
+  RLLKinPoseConfig goal_pose;
+  transformPose(ik_pose, &goal_pose);
+
+  bool found_consistent = false;
+  auto accept = [&](const RLLKinSolutions& ik_solutions) {
+    for (const auto& ik_solution : ik_solutions)
+    {
+      if (!withinConsistencyLimits(ik_solution, ik_seed_state, consistency_limits))
+      {
+        continue;
+      }
+      found_consistent = true;
+
+      ik_solution.getJoints(&solution);
+      if (solution_callback.empty())
+      {
+        error_code.val = error_code.SUCCESS;
+        return true;
+      }
+
+      // check for collisions
+      solution_callback(ik_pose, solution, error_code);
+      if (error_code.val == error_code.SUCCESS)
+      {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  RLLInvKinOptions ik_options;
+  RLLKinSolutions ik_solutions;
+  RLLKinPoseConfig search_pose = goal_pose;
+
+  // same solution as getPositionIK(), it is usually accepted
+  if (callRLLIK(seed_state, &search_pose, &ik_solutions, ik_options).success() && accept(ik_solutions))
   {
-    ik_solutions.front().getJoints(&solution);
-    error_code.val = error_code.SUCCESS;
+    return true;
+  }
 
+  // the optimal solutions in all other global configurations
+  ik_options.global_configuration_mode = RLLInvKinOptions::RETURN_ALL_GLOBAL_CONFIGS;
+  search_pose = goal_pose;
+  if (ros::WallTime::now() < deadline && callRLLIK(seed_state, &search_pose, &ik_solutions, ik_options).success() &&
+      accept(ik_solutions))
+  {
     return true;
   }
 
-  for (size_t i = 0; i < ik_solutions.size(); ++i)
+  // sample fixed arm angles with increasing distance from the arm angle of the seed state
+  geometry_msgs::Pose seed_pose;
+  double seed_arm_angle;
+  int seed_config;
+  if (!getPositionFK(ik_seed_state, &seed_pose, &seed_arm_angle, &seed_config))
   {
-    ik_solutions[i].getJoints(&solution);
+    seed_arm_angle = 0.0;
+  }
 
-    // check for collisions
-    solution_callback(ik_pose, solution, error_code);
-    if (error_code.val == error_code.SUCCESS)
+  ik_options.method = RLLInvKinOptions::ARM_ANGLE_FIXED;
+  const double step = 2 * M_PI / ARM_ANGLE_SEARCH_SAMPLES;
+  bool timed_out = false;
+  for (int i = 1; i < ARM_ANGLE_SEARCH_SAMPLES; ++i)
+  {
+    if (ros::WallTime::now() >= deadline)
+    {
+      timed_out = true;
+      break;
+    }
+
+    // alternate between both sides of the seed arm angle
+    double offset = (i % 2 == 1 ? 1 : -1) * ((i + 1) / 2) * step;
+    double arm_angle = std::remainder(seed_arm_angle + offset, 2 * M_PI);
+    if (!reachability_map_.reachable(goal_pose.pose, arm_angle))
+    {
+      continue;
+    }
+
+    search_pose = goal_pose;
+    search_pose.arm_angle = arm_angle;
+    if (callRLLIK(seed_state, &search_pose, &ik_solutions, ik_options).success() && accept(ik_solutions))
     {
       return true;
     }
   }
 
-  error_code.val = error_code.GOAL_IN_COLLISION;
+  if (found_consistent && !solution_callback.empty())
+  {
+    error_code.val = error_code.GOAL_IN_COLLISION;
+  }
+  else
+  {
+    error_code.val = timed_out ? error_code.TIMED_OUT : error_code.NO_IK_SOLUTION;
+  }
 
   return false;
 }
 
-bool RLLMoveItKinematicsPlugin::searchPositionIK(  // NOLINT google-default-arguments
-    const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
-    const std::vector<double>& /*consistency_limits*/, std::vector<double>& solution,
-    const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
-    const kinematics::KinematicsQueryOptions& options) const
-{
-  return searchPositionIK(ik_pose, ik_seed_state, timeout, solution, solution_callback, error_code, options);
-}
-
-bool RLLMoveItKinematicsPlugin::getPositionFK(const std::vector<std::string>& /* link_names */,
+bool RLLMoveItKinematicsPlugin::getPositionFK(const std::vector<std::string>& link_names,
                                               const std::vector<double>& joint_angles,
                                               std::vector<geometry_msgs::Pose>& poses) const
 {
-  double arm_angle;
-  int config;
+  RLLKinJoints rll_joint_angles;
+  rll_joint_angles.setJoints(joint_angles);
+  RLLKinLinkFrames link_frames;
+  if (solver_.linkFrames(&rll_joint_angles, 1, &link_frames).error())
+  {
+    return false;
+  }
+
+  poses.resize(link_names.size());
+  for (size_t i = 0; i < link_names.size(); ++i)
+  {
+    auto it = link_offsets_.find(link_names[i]);
+    if (it == link_offsets_.end())
+    {
+      ROS_ERROR_STREAM("Link " << link_names[i] << " is not part of the kinematic chain");
+      return false;
+    }
+
+    const LinkOffset& offset = it->second;
+    Eigen::Matrix3d ori = offset.ori;
+    Eigen::Vector3d pos = offset.pos;
+    if (offset.joint_index >= 0)
+    {
+      const RLLKinFrame& frame = link_frames.frames[offset.joint_index];
+      ori = frame.ori() * offset.ori;
+      pos = frame.pos() + frame.ori() * offset.pos;
+    }
+
+    Eigen::Quaterniond quaternion(ori);
+    poses[i].position.x = pos.x();
+    poses[i].position.y = pos.y();
+    poses[i].position.z = pos.z();
+    poses[i].orientation.w = quaternion.w();
+    poses[i].orientation.x = quaternion.x();
+    poses[i].orientation.y = quaternion.y();
+    poses[i].orientation.z = quaternion.z();
+  }
 
-  return getPositionFK(joint_angles, &poses[0], &arm_angle, &config);
+  return true;
+}
+
+bool RLLMoveItKinematicsPlugin::getLinkFramesBatch(const std::vector<RLLKinJoints>& joint_angles,
+                                                   std::vector<RLLKinLinkFrames>* link_frames) const
+{
+  link_frames->resize(joint_angles.size());
+  return solver_.linkFrames(joint_angles.data(), joint_angles.size(), link_frames->data()).success();
 }
 
 bool RLLMoveItKinematicsPlugin::getPositionIKarmangle(const geometry_msgs::Pose& ik_pose,
@@ -198,6 +351,12 @@ bool RLLMoveItKinematicsPlugin::getPositionIKarmangle(const geometry_msgs::Pose&
   cart_pose.pose.setPosition(ik_pose.position.x, ik_pose.position.y, ik_pose.position.z);
   cart_pose.pose.setQuaternion(ik_pose.orientation.w, ik_pose.orientation.x, ik_pose.orientation.y,
                                ik_pose.orientation.z);
+  if (!reachability_map_.reachable(cart_pose.pose, arm_angle))
+  {
+    error_code->val = error_code->NO_IK_SOLUTION;
+    return false;
+  }
+
   seed_state.emplace_back(ik_seed_state);
 
   ik_options.method = RLLInvKinOptions::ARM_ANGLE_FIXED;
@@ -214,6 +373,37 @@ bool RLLMoveItKinematicsPlugin::getPositionIKarmangle(const geometry_msgs::Pose&
   return true;
 }
 
+bool RLLMoveItKinematicsPlugin::getPositionIKarmangles(const geometry_msgs::Pose& ik_pose,
+                                                       const std::vector<double>& ik_seed_state,
+                                                       const std::vector<double>& arm_angles,
+                                                       std::vector<std::vector<double>>* solutions) const
+{
+  RLLKinPoseConfig cart_pose;
+  transformPose(ik_pose, &cart_pose);
+
+  // a single lookup for all arm angles, the solver checks the joint limits of each arm angle anyway
+  solutions->clear();
+  if (!reachability_map_.reachable(cart_pose.pose))
+  {
+    return false;
+  }
+
+  RLLKinSeedState seed_state;
+  seed_state.emplace_back(ik_seed_state);
+  std::vector<RLLKinJoints> ik_solutions(arm_angles.size());
+  size_t num_solved;
+  solver_.ikArmAngles(seed_state, cart_pose.pose, arm_angles.data(), arm_angles.size(), ik_solutions.data(),
+                      &num_solved);
+
+  solutions->resize(num_solved);
+  for (size_t i = 0; i < num_solved; ++i)
+  {
+    ik_solutions[i].getJoints(&(*solutions)[i]);
+  }
+
+  return num_solved == arm_angles.size();
+}
+
 bool RLLMoveItKinematicsPlugin::getPositionFK(const std::vector<double>& joint_angles, geometry_msgs::Pose* pose,
                                               double* arm_angle, int* config) const
 {
@@ -316,7 +506,98 @@ bool RLLMoveItKinematicsPlugin::setLimbLengthsJointLimits()
 
   RLLKinMsg result =
       solver_.initialize(limb_lengths, rllkin_joint_limits, rllkin_velocity_limits, rllkin_acceleration_limits);
-  return !result.error();
+  if (result.error())
+  {
+    return false;
+  }
+
+  bool sparse_fk_chain;
+  lookupParam("sparse_fk_chain", sparse_fk_chain, false);
+  solver_.useSparseChain(sparse_fk_chain);
+
+  loadReachabilityMap(limb_lengths, rllkin_joint_limits);
+  initLinkOffsets();
+  return true;
+}
+
+void RLLMoveItKinematicsPlugin::initLinkOffsets()
+{
+  // the offsets are constant, so they are taken from the default state
+  moveit::core::RobotState state(robot_model_);
+  state.setToDefaultValues();
+  state.update();
+
+  RLLKinJoints joint_angles;
+  for (size_t i = 0; i < RLL_NUM_JOINTS; ++i)
+  {
+    joint_angles[i] = state.getVariablePosition(joint_names_[i]);
+  }
+  RLLKinLinkFrames link_frames;
+  solver_.linkFrames(&joint_angles, 1, &link_frames);
+
+  const auto base_inverse = state.getGlobalLinkTransform(base_frame_).inverse();
+  int joint_index = -1;
+  link_offsets_.clear();
+  link_offsets_[base_frame_] = { -1, Eigen::Matrix3d::Identity(), Eigen::Vector3d::Zero() };
+  for (const auto& link_name : link_names_)
+  {
+    const moveit::core::LinkModel* link = robot_model_->getLinkModel(link_name);
+    auto joint = std::find(joint_names_.begin(), joint_names_.end(), link->getParentJointModel()->getName());
+    if (joint != joint_names_.end())
+    {
+      joint_index = static_cast<int>(joint - joint_names_.begin());
+    }
+
+    auto link_pose = base_inverse * state.getGlobalLinkTransform(link);
+    LinkOffset offset = { joint_index, link_pose.rotation(), link_pose.translation() };
+    if (joint_index >= 0)
+    {
+      const RLLKinFrame& frame = link_frames.frames[joint_index];
+      offset.ori = frame.ori().transpose() * offset.ori;
+      offset.pos = frame.ori().transpose() * (offset.pos - frame.pos());
+    }
+    link_offsets_[link_name] = offset;
+  }
+}
+
+void RLLMoveItKinematicsPlugin::loadReachabilityMap(const RLLKinLimbs& limb_lengths,
+                                                    const RLLKinJointLimits& joint_position_limits)
+{
+  // optional, generated with rll_kinematics_reachability_map
+  std::string file_name;
+  lookupParam("reachability_map", file_name, std::string());
+  if (file_name.empty())
+  {
+    return;
+  }
+
+  if (!reachability_map_.load(file_name))
+  {
+    ROS_WARN_STREAM("Failed to load the reachability map " << file_name << ", IK requests are not pre-checked");
+    return;
+  }
+
+  if (!reachability_map_.grid()->matches(limb_lengths, joint_position_limits))
+  {
+    ROS_WARN_STREAM("Ignoring the reachability map " << file_name << ", it does not match the robot");
+    reachability_map_.unload();
+    return;
+  }
+
+  ROS_INFO_STREAM("Loaded reachability map " << file_name << " with " << reachability_map_.grid()->numCells()
+                                             << " cells");
+}
+
+bool RLLMoveItKinematicsPlugin::mayBeReachable(const geometry_msgs::Pose& ros_pose) const
+{
+  if (!reachability_map_.loaded())
+  {
+    return true;
+  }
+
+  RLLKinPoseConfig ik_pose;
+  transformPose(ros_pose, &ik_pose);
+  return reachability_map_.reachable(ik_pose.pose);
 }
 
 RLLKinMsg RLLMoveItKinematicsPlugin::callRLLIK(const geometry_msgs::Pose& ros_pose,
@@ -335,6 +616,43 @@ RLLKinMsg RLLMoveItKinematicsPlugin::callRLLIK(const RLLKinSeedState& ik_seed_st
   return solver_.ik(ik_seed_state, ik_pose, solutions, ik_options);
 }
 
+RLLKinMsg RLLMoveItKinematicsPlugin::callRLLIKPath(const std::vector<geometry_msgs::Pose>& ros_poses, size_t first,
+                                                   const RLLKinSeedState& ik_seed_state,
+                                                   std::vector<RLLKinJoints>* solutions,
+                                                   RLLInvKinOptions ik_options) const
+{
+  size_t num_poses = first < ros_poses.size() ? ros_poses.size() - first : 0;
+  std::vector<RLLKinFrame> poses(num_poses);
+  RLLKinPoseConfig ik_pose;
+  for (size_t i = 0; i < num_poses; ++i)
+  {
+    transformPose(ros_poses[first + i], &ik_pose);
+    poses[i] = ik_pose.pose;
+  }
+
+  size_t num_solved;
+  solutions->resize(num_poses);
+  RLLKinMsg result = solver_.ikPath(ik_seed_state, poses.data(), num_poses, solutions->data(), &num_solved, ik_options);
+  solutions->resize(num_solved);
+
+  return result;
+}
+
+bool RLLMoveItKinematicsPlugin::withinConsistencyLimits(const RLLKinJoints& joint_angles,
+                                                        const std::vector<double>& seed_state,
+                                                        const std::vector<double>& consistency_limits)
+{
+  for (size_t i = 0; i < consistency_limits.size(); ++i)
+  {
+    if (std::fabs(joint_angles(i) - seed_state[i]) > consistency_limits[i])
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 void RLLMoveItKinematicsPlugin::transformPose(const geometry_msgs::Pose& ros_pose, RLLKinPoseConfig* ik_pose)
 {
   ik_pose->pose.setPosition(ros_pose.position.x, ros_pose.position.y, ros_pose.position.z);
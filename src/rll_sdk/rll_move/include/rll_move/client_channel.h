@@ -0,0 +1,76 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_CLIENT_CHANNEL_H
+#define RLL_MOVE_CLIENT_CHANNEL_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Messages of the control channel between the interface and the client listener.
+ *
+ * The interface keeps one TCP connection to the listener open across jobs. Every message is a line
+ * "<command> <job id>\n" and the listener answers each start command with a response that carries the same job id,
+ * so that responses to earlier requests are never mistaken for the current one.
+ */
+struct RLLClientMessage
+{
+  static const char* START_CMD;
+  static const char* OK_RESP;
+  static const char* ERROR_RESP;
+  // longer lines are discarded, the commands are only a few bytes long
+  static const size_t MAX_LINE_LENGTH = 64;
+
+  std::string command;
+  uint32_t job_id = 0;
+
+  std::string format() const;
+  bool parse(const std::string& line);
+};
+
+// sets the receive and send timeouts of a connection
+bool setClientSocketTimeouts(int socket, int timeout_seconds);
+
+// sends the whole message, returns false if the connection is broken or the send timeout expired
+bool sendClientMessage(int socket, const RLLClientMessage& msg);
+
+/**
+ * Splits the byte stream of a connection into messages, malformed lines are skipped.
+ */
+class RLLClientMessageReader
+{
+public:
+  enum class Status
+  {
+    MESSAGE,
+    TIMEOUT,
+    CLOSED
+  };
+
+  void append(const char* data, size_t size);
+  // extracts the next complete message that was already received
+  bool next(RLLClientMessage* msg);
+  // blocks until a complete message is received, the receive timeout of the socket expired or the peer disconnected
+  Status receive(int socket, RLLClientMessage* msg);
+  void clear();
+
+private:
+  std::string buffer_;
+};
+
+#endif  // RLL_MOVE_CLIENT_CHANNEL_H
@@ -0,0 +1,78 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RLL_MOVE_CONSERVATIVE_ADVANCEMENT_H
+#define RLL_MOVE_CONSERVATIVE_ADVANCEMENT_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+/**
+ * Collision checking of a densely interpolated path by conservative advancement.
+ *
+ * A waypoint with a clearance of d certifies all following waypoints as collision free whose robot geometry moved less
+ * than d from it, so only these waypoints need no discrete collision check. Close to obstacles, the clearance does not
+ * certify any further waypoints and a few waypoints are checked discretely before the clearance is queried again.
+ */
+class RLLConservativeAdvancement
+{
+public:
+  // discrete checks in a row once a clearance query did not certify the next waypoint
+  static const size_t DEFAULT_DISCRETE_RUN = 8;
+
+  // returns true if the waypoint is in collision
+  using CollisionCheck = std::function<bool(size_t)>;
+  // conservative lower bound of the distance of the waypoint to any collision
+  using Clearance = std::function<double(size_t)>;
+  // upper bound of the distance that any point of the robot geometry moved between two waypoints
+  using Displacement = std::function<double(size_t, size_t)>;
+
+  RLLConservativeAdvancement(CollisionCheck collision_check, Clearance clearance, Displacement displacement)
+    : collision_check_(std::move(collision_check))
+    , clearance_(std::move(clearance))
+    , displacement_(std::move(displacement))
+  {
+  }
+
+  void setDiscreteRun(size_t discrete_run)
+  {
+    discrete_run_ = discrete_run;
+  }
+
+  bool isPathValid(size_t num_waypoints);
+
+  size_t numCollisionChecks() const
+  {
+    return num_collision_checks_;
+  }
+  size_t numClearanceQueries() const
+  {
+    return num_clearance_queries_;
+  }
+
+private:
+  CollisionCheck collision_check_;
+  Clearance clearance_;
+  Displacement displacement_;
+  size_t discrete_run_ = DEFAULT_DISCRETE_RUN;
+  size_t num_collision_checks_ = 0;
+  size_t num_clearance_queries_ = 0;
+};
+
+#endif  // RLL_MOVE_CONSERVATIVE_ADVANCEMENT_H
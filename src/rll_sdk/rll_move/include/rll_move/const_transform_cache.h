@@ -0,0 +1,53 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_CONST_TRANSFORM_CACHE_H
+#define RLL_MOVE_CONST_TRANSFORM_CACHE_H
+
+#include <array>
+#include <map>
+#include <string>
+
+// Keeps constant transforms on disk across restarts of the interface, so that startup does not have to wait for tf.
+// A cache file is only used if it was written with the same key, which should identify everything the transforms
+// depend on, e.g. the robot description and the frame names. Cached transforms are revalidated against tf whenever
+// tf provides them and updated if they changed.
+class RLLConstTransformCache
+{
+public:
+  // translation x, y, z followed by the rotation quaternion x, y, z, w
+  using Transform = std::array<double, 7>;
+
+  static const double TOLERANCE;
+
+  RLLConstTransformCache(std::string file_name, std::string key);
+
+  // false if there is no cache file, it is malformed or was written for another key
+  bool load();
+  bool save() const;
+
+  bool lookup(const std::string& name, Transform* transform) const;
+  // returns true if the transform was not cached yet or differed from the cached one
+  bool update(const std::string& name, const Transform& transform);
+
+private:
+  std::string file_name_;
+  std::string key_;
+  std::map<std::string, Transform> transforms_;
+};
+
+#endif  // RLL_MOVE_CONST_TRANSFORM_CACHE_H
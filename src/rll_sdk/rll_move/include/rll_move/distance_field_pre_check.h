@@ -0,0 +1,116 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RLL_MOVE_DISTANCE_FIELD_PRE_CHECK_H
+#define RLL_MOVE_DISTANCE_FIELD_PRE_CHECK_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <moveit/distance_field/propagation_distance_field.h>
+#include <moveit/planning_scene/planning_scene.h>
+
+/**
+ * Constant time rejection of goal states that are obviously in collision with the static environment.
+ *
+ * A signed distance field is built from the world objects and the robot links that do not move with the group, e.g.
+ * the cell. Obstacles that are allowed to collide with any of the moving links are left out. Each moving link is
+ * represented by spheres that lie inside its collision geometry, a state is rejected if one of these spheres
+ * penetrates the field deeper than its discretization error. All other states still need the full collision check.
+ *
+ * The field is rebuilt lazily once the world objects changed or after invalidate(), e.g. if the ACM was modified. A
+ * rebuild replaces the field, so a field returned by field() stays valid and can be read concurrently.
+ */
+class RLLDistanceFieldPreCheck
+{
+public:
+  static const double RESOLUTION;
+  static const double MAX_DISTANCE;
+  static const size_t MAX_SPHERES_PER_SHAPE;
+  // upper bound of the error introduced by voxelizing the obstacles and the query point
+  static const double DISCRETIZATION_ERROR;
+
+  struct Sphere
+  {
+    const moveit::core::LinkModel* link;
+    Eigen::Vector3d center;  // in the link frame
+    double radius;
+  };
+
+  // inner spheres lie inside the collision geometry of the link, outer spheres cover it
+  struct LinkSpheres
+  {
+    const moveit::core::LinkModel* link;
+    std::vector<Sphere> inner;
+    std::vector<Sphere> outer;
+    bool covered;  // false if a shape of the link could not be covered by outer spheres
+  };
+
+  struct Field
+  {
+    std::unique_ptr<distance_field::PropagationDistanceField> distances;
+    // collision names of the obstacles in the field, neither of them is allowed to collide with a moving link
+    std::vector<std::string> obstacles;
+  };
+
+  // max_distance limits the distances stored in the field, larger values allow to clear larger spheres
+  explicit RLLDistanceFieldPreCheck(const moveit::core::JointModelGroup* group, double max_distance = MAX_DISTANCE);
+
+  static void addInnerSpheres(const moveit::core::LinkModel* link, const shapes::Shape& shape,
+                              const Eigen::Isometry3d& origin, std::vector<Sphere>* spheres);
+  // returns false if the shape type is not supported
+  static bool addOuterSpheres(const moveit::core::LinkModel* link, const shapes::Shape& shape,
+                              const Eigen::Isometry3d& origin, std::vector<Sphere>* spheres);
+
+  // true if the state is certainly in collision, in that case link_name is set to the colliding link
+  bool inCollision(const planning_scene::PlanningScene& planning_scene,
+                   const collision_detection::AllowedCollisionMatrix& acm, const robot_state::RobotState& state,
+                   std::string* link_name = nullptr);
+  void invalidate();
+
+  // the field for the current world objects, rebuilt if needed, nullptr if there are no static obstacles within reach
+  std::shared_ptr<const Field> field(const planning_scene::PlanningScene& planning_scene,
+                                     const collision_detection::AllowedCollisionMatrix& acm,
+                                     const robot_state::RobotState& state);
+  const std::vector<LinkSpheres>& linkSpheres() const
+  {
+    return link_spheres_;
+  }
+
+private:
+  static size_t worldSignature(const collision_detection::World& world);
+  bool allowedToCollide(const collision_detection::AllowedCollisionMatrix& acm, const std::string& name) const;
+  std::shared_ptr<const Field> build(const planning_scene::PlanningScene& planning_scene,
+                                     const collision_detection::AllowedCollisionMatrix& acm,
+                                     const robot_state::RobotState& state) const;
+
+  const moveit::core::LinkModel* base_link_;
+  std::vector<const moveit::core::LinkModel*> moving_links_;
+  std::vector<LinkSpheres> link_spheres_;
+  double max_distance_;
+  double reach_ = 0.0;
+
+  std::mutex mutex_;
+  std::shared_ptr<const Field> field_;
+  size_t world_signature_ = 0;
+  bool up_to_date_ = false;
+};
+
+#endif  // RLL_MOVE_DISTANCE_FIELD_PRE_CHECK_H
@@ -103,8 +103,21 @@ public:
    */
   virtual const fcl::CollisionGeometry* getBoundingCollisionGeometry() const = 0;
 
+  /**
+   * A point is in collision if a sphere of radius QUERY_RADIUS around it touches the bounding collision geometry.
+   */
+  static const double QUERY_RADIUS;
+
   bool pointInCollisionGeometry(const geometry_msgs::Pose& obj_target_pose, const geometry_msgs::Point& point) const;
 
+  /**
+   * Batched version of pointInCollisionGeometry() that transforms the object pose only once. Marks the points that are
+   * in collision and returns their number.
+   */
+  size_t pointsInCollisionGeometry(const geometry_msgs::Pose& obj_target_pose,
+                                   const std::vector<geometry_msgs::Point>& points,
+                                   std::vector<bool>* in_collision) const;
+
   // TODO(mark): could be automatically retrieved from the collision geometry
   /**
    * Dimensions of the bounding box for this GraspObject.
@@ -149,6 +162,15 @@ public:
     return !id_.empty();
   }
 
+protected:
+  /**
+   * Collision check for a point relative to the center pose. Uses a FCL query, primitives override it with an analytic
+   * test.
+   */
+  virtual bool localPointInCollisionGeometry(const tf::Vector3& point) const;
+
+  static bool localPointInBox(const tf::Vector3& point, const fcl::Vec3f& side);
+
 private:
   std::string id_;
   GraspPose last_placement_, initial_placement_;
@@ -216,6 +238,12 @@ public:
     return &box_;
   }
 
+protected:
+  bool localPointInCollisionGeometry(const tf::Vector3& point) const override
+  {
+    return localPointInBox(point, box_.side);
+  }
+
 private:
   void onUpdateDataFromCollisionObject(const moveit_msgs::CollisionObject& collision_object) override;
 
@@ -242,11 +270,15 @@ public:
 
   const fcl::CollisionGeometry* getBoundingCollisionGeometry() const override
   {
-    ROS_INFO_STREAM("FCL_Box: side=" << fcl_box_.side);
-
     return &fcl_box_;
   }
 
+protected:
+  bool localPointInCollisionGeometry(const tf::Vector3& point) const override
+  {
+    return localPointInBox(point, fcl_box_.side);
+  }
+
 private:
   fcl::Box fcl_box_;
 
@@ -262,10 +294,12 @@ public:
 
   const fcl::CollisionGeometry* getBoundingCollisionGeometry() const override
   {
-    ROS_INFO("FCL_Cylinder: r=%.3f, lz=%.3f", fcl_cylinder_.radius, fcl_cylinder_.lz);
     return &fcl_cylinder_;
   }
 
+protected:
+  bool localPointInCollisionGeometry(const tf::Vector3& point) const override;
+
 private:
   float radius_ = 0, height_ = 0;
   fcl::Cylinder fcl_cylinder_;
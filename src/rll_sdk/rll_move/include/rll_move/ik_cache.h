@@ -0,0 +1,56 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RLL_MOVE_IK_CACHE_H
+#define RLL_MOVE_IK_CACHE_H
+
+#include <array>
+#include <map>
+#include <mutex>
+
+#include <geometry_msgs/Pose.h>
+#include <rll_kinematics/inverse_kinematics.h>
+
+// Thread-safe cache of the IK solutions of goal poses that are reached repeatedly, e.g. fixed poses in the cell.
+//
+// Entries are keyed by the goal pose and the global configuration of the seed state. A cached entry ignores the rest
+// of the seed, so its solutions may e.g. have a slightly different arm angle than a fresh solve. Callers still have to
+// check the solutions against the current planning scene.
+class RLLIKCache
+{
+public:
+  static const size_t MAX_ENTRIES = 256;
+  // poses that differ by less than this in every component share an entry
+  static const double RESOLUTION;
+
+  bool lookup(const geometry_msgs::Pose& pose, const RLLKinGlobalConfig& seed_config, RLLKinSolutions* solutions) const;
+  // the cache is cleared once it is full
+  void insert(const geometry_msgs::Pose& pose, const RLLKinGlobalConfig& seed_config, const RLLKinSolutions& solutions);
+  void clear();
+  size_t size() const;
+
+private:
+  using Key = std::array<int64_t, 8>;
+
+  static Key key(const geometry_msgs::Pose& pose, const RLLKinGlobalConfig& seed_config);
+
+  mutable std::mutex mutex_;
+  std::map<Key, RLLKinSolutions> entries_;
+};
+
+#endif  // RLL_MOVE_IK_CACHE_H
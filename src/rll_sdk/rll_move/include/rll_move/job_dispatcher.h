@@ -0,0 +1,75 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_JOB_DISPATCHER_H
+#define RLL_MOVE_JOB_DISPATCHER_H
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <actionlib/client/simple_action_client.h>
+#include <actionlib/server/action_server.h>
+#include <ros/ros.h>
+#include <rll_msgs/JobEnvAction.h>
+
+// Spreads the goals of its job_env action across several isolated cell instances on one host. Each instance runs in
+// its own namespace with its own client port and Gazebo world, see setup_moveit_and_move_iface.launch. A job is
+// forwarded to an instance that is idle and the instance is reset with its job_idle action afterwards, before it
+// receives the next job. Jobs are queued while all instances are busy.
+//
+// All callbacks have to be processed by a single thread.
+class RLLJobDispatcher
+{
+public:
+  RLLJobDispatcher(ros::NodeHandle* nh, const std::vector<std::string>& instance_namespaces);
+
+  // returns false if the actions of an instance are not available
+  bool waitForInstances(const ros::Duration& timeout);
+  void start();
+
+private:
+  using JobServer = actionlib::ActionServer<rll_msgs::JobEnvAction>;
+  using JobClient = actionlib::SimpleActionClient<rll_msgs::JobEnvAction>;
+
+  struct Instance
+  {
+    std::string ns;
+    std::unique_ptr<JobClient> job_client;
+    std::unique_ptr<JobClient> idle_client;
+    bool busy = false;
+    // set after an internal error, the instance does not receive any further jobs
+    bool failed = false;
+    JobServer::GoalHandle job;
+  };
+
+  JobServer server_;
+  std::vector<std::unique_ptr<Instance>> instances_;
+  std::deque<JobServer::GoalHandle> pending_jobs_;
+
+  void goalCallback(JobServer::GoalHandle job);
+  void cancelCallback(JobServer::GoalHandle job);
+  void dispatchJobs();
+  void jobDone(Instance* instance, const actionlib::SimpleClientGoalState& state,
+               const rll_msgs::JobEnvResultConstPtr& result);
+  void idleDone(Instance* instance, const actionlib::SimpleClientGoalState& state,
+                const rll_msgs::JobEnvResultConstPtr& result);
+  bool allInstancesFailed() const;
+};
+
+#endif  // RLL_MOVE_JOB_DISPATCHER_H
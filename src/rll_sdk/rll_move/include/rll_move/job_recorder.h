@@ -0,0 +1,176 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_JOB_RECORDER_H
+#define RLL_MOVE_JOB_RECORDER_H
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <moveit_msgs/PlanningScene.h>
+#include <ros/serialization.h>
+#include <ros/time.h>
+
+#include <rll_kinematics/types_utils.h>
+
+enum class RLLJobLogRecordType : uint32_t
+{
+  JOB_START = 0,  // the request holds the planning scene, the joint values are the start state of the job
+  SERVICE_CALL,   // the name is the data type of the request, e.g. rll_msgs/MoveLinRequest
+  JOB_END         // the error code holds the job status
+};
+
+// Fixed size part of a record. It is followed by the name, the request and the response in ROS serialization, the
+// record is padded to a multiple of eight bytes so that the headers can be read in place from a memory mapping.
+struct RLLJobLogRecordHeader
+{
+  RLLJobLogRecordType type;
+  uint32_t name_size;
+  uint32_t request_size;
+  uint32_t response_size;
+  int64_t start_ns;  // wall time
+  int64_t duration_ns;
+  int32_t error_code;
+  uint32_t num_joints;
+  double joint_values[RLL_NUM_JOINTS];  // manipulator joint values at the start of the call
+};
+
+// Records the service calls of a job into a binary log, see RLLJobLogReader. Service calls may be recorded
+// concurrently, the records are written in the order in which the calls finished.
+class RLLJobRecorder
+{
+public:
+  static const char MAGIC[8];
+  static const uint32_t VERSION = 1;
+
+  ~RLLJobRecorder();
+
+  // replaces an existing file
+  bool open(const std::string& file_name);
+  void close();
+  bool recording() const
+  {
+    return recording_;
+  }
+
+  void recordJobStart(const moveit_msgs::PlanningScene& planning_scene, const std::vector<double>& joint_values);
+  void recordJobEnd(int32_t job_status);
+  template <class Request, class Response>
+  void recordServiceCall(const Request& req, const Response& resp, ros::WallTime start, ros::WallDuration duration,
+                         int32_t error_code, const std::vector<double>& joint_values);
+
+private:
+  template <class M>
+  static void serialize(const M& msg, std::vector<uint8_t>* buffer);
+  void write(RLLJobLogRecordType type, const std::string& name, const std::vector<uint8_t>& request,
+             const std::vector<uint8_t>& response, ros::WallTime start, ros::WallDuration duration, int32_t error_code,
+             const std::vector<double>& joint_values);
+
+  std::mutex mutex_;
+  FILE* file_ = nullptr;
+  std::atomic<bool> recording_{ false };
+};
+
+// Read-only view of a job log, the file is memory-mapped and the records point into the mapping.
+class RLLJobLogReader
+{
+public:
+  struct Record
+  {
+    const RLLJobLogRecordHeader* header;
+    std::string name;
+    const uint8_t* request;
+    const uint8_t* response;
+  };
+
+  RLLJobLogReader() = default;
+  RLLJobLogReader(const RLLJobLogReader&) = delete;
+  RLLJobLogReader& operator=(const RLLJobLogReader&) = delete;
+  ~RLLJobLogReader();
+
+  // fails on a foreign file or version, a truncated last record, e.g. of a crashed recording, is skipped
+  bool open(const std::string& file_name);
+  void close();
+  const std::vector<Record>& records() const
+  {
+    return records_;
+  }
+
+  template <class M>
+  static bool deserialize(const uint8_t* data, uint32_t size, M* msg);
+  template <class M>
+  static bool deserializeRequest(const Record& record, M* msg)
+  {
+    return deserialize(record.request, record.header->request_size, msg);
+  }
+  template <class M>
+  static bool deserializeResponse(const Record& record, M* msg)
+  {
+    return deserialize(record.response, record.header->response_size, msg);
+  }
+
+private:
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  std::vector<Record> records_;
+};
+
+template <class Request, class Response>
+void RLLJobRecorder::recordServiceCall(const Request& req, const Response& resp, ros::WallTime start,
+                                       ros::WallDuration duration, int32_t error_code,
+                                       const std::vector<double>& joint_values)
+{
+  if (!recording_)
+  {
+    return;
+  }
+
+  std::vector<uint8_t> request, response;
+  serialize(req, &request);
+  serialize(resp, &response);
+  write(RLLJobLogRecordType::SERVICE_CALL, ros::message_traits::DataType<Request>::value(), request, response, start,
+        duration, error_code, joint_values);
+}
+
+template <class M>
+void RLLJobRecorder::serialize(const M& msg, std::vector<uint8_t>* buffer)
+{
+  buffer->resize(ros::serialization::serializationLength(msg));
+  ros::serialization::OStream stream(buffer->data(), buffer->size());
+  ros::serialization::serialize(stream, msg);
+}
+
+template <class M>
+bool RLLJobLogReader::deserialize(const uint8_t* data, uint32_t size, M* msg)
+{
+  // the stream only reads from the mapping
+  ros::serialization::IStream stream(const_cast<uint8_t*>(data), size);  // NOLINT cppcoreguidelines-pro-type-const-cast
+  try
+  {
+    ros::serialization::deserialize(stream, *msg);
+  }
+  catch (const ros::serialization::StreamOverrunException& e)
+  {
+    return false;
+  }
+  return true;
+}
+
+#endif  // RLL_MOVE_JOB_RECORDER_H
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_JOB_REPLAY_H
+#define RLL_MOVE_JOB_REPLAY_H
+
+#include <string>
+#include <vector>
+
+#include <rll_move/move_iface_base.h>
+
+// Main of the job replay tools: replays the job logs given as arguments with a freshly constructed interface, which
+// requires a running move group. Returns the exit code of the tool, which is nonzero if the logs cannot be read or a
+// replayed planning result differs from the recorded one.
+template <class Iface>
+int runJobReplay(int argc, char** argv)
+{
+  std::vector<std::string> job_logs(argv + 1, argv + argc);
+  if (job_logs.empty())
+  {
+    ROS_FATAL("usage: %s JOB_LOG...", argv[0]);
+    return 1;
+  }
+
+  ros::NodeHandle nh;
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+  if (!waitForMoveGroupAction())
+  {
+    return 1;
+  }
+
+  Iface iface(nh);
+  RLLJobReplayStats stats;
+  ros::WallTime start = ros::WallTime::now();
+  for (const auto& file_name : job_logs)
+  {
+    RLLJobLogReader log;
+    if (!log.open(file_name))
+    {
+      return 1;
+    }
+    iface.replayJobLog(log, &stats);
+  }
+
+  ROS_INFO("replayed %zu logs in %.3f s", job_logs.size(), (ros::WallTime::now() - start).toSec());
+  stats.print();
+  return stats.mismatches() == 0 ? 0 : 2;
+}
+
+#endif  // RLL_MOVE_JOB_REPLAY_H
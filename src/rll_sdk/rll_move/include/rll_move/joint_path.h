@@ -0,0 +1,97 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_JOINT_PATH_H
+#define RLL_MOVE_JOINT_PATH_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * Joint values of the waypoints of a path, stored contiguously in one buffer.
+ *
+ * Paths of linear motions have a waypoint per millimetre, keeping a full RobotState for each of them while the IK is
+ * solved and checked for jumps is needlessly expensive. The path is converted to a RobotTrajectory only once it is
+ * known to be complete.
+ */
+class RLLJointPath
+{
+public:
+  using Distance = std::function<double(const double*, const double*)>;
+
+  // the minimum number of waypoints for a meaningful jump test, as in RobotState::testRelativeJointSpaceJump()
+  static const size_t MIN_STEPS_FOR_JUMP_THRESH = 10;
+
+  explicit RLLJointPath(size_t num_joints = 0) : num_joints_(num_joints)
+  {
+  }
+
+  void clear(size_t num_joints)
+  {
+    num_joints_ = num_joints;
+    values_.clear();
+  }
+  void reserve(size_t num_waypoints)
+  {
+    values_.reserve(num_waypoints * num_joints_);
+  }
+  // joint_values must hold num_joints() values
+  void push_back(const double* joint_values)
+  {
+    values_.insert(values_.end(), joint_values, joint_values + num_joints_);
+  }
+  void push_back(const std::vector<double>& joint_values)
+  {
+    push_back(joint_values.data());
+  }
+  void resize(size_t num_waypoints)
+  {
+    values_.resize(num_waypoints * num_joints_);
+  }
+
+  size_t size() const
+  {
+    return num_joints_ == 0 ? 0 : values_.size() / num_joints_;
+  }
+  bool empty() const
+  {
+    return values_.empty();
+  }
+  size_t numJoints() const
+  {
+    return num_joints_;
+  }
+  const double* operator[](size_t i) const
+  {
+    return &values_[i * num_joints_];
+  }
+  const double* back() const
+  {
+    return (*this)[size() - 1];
+  }
+
+  // Same semantics as RobotState::testRelativeJointSpaceJump(): truncates the path at the first step that is larger
+  // than jump_threshold_factor times the mean step and returns the fraction of the path that remains valid.
+  double testRelativeJointSpaceJump(const Distance& distance, double jump_threshold_factor);
+
+private:
+  size_t num_joints_;
+  std::vector<double> values_;
+};
+
+#endif  // RLL_MOVE_JOINT_PATH_H
@@ -0,0 +1,90 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_JOINT_STATE_MONITOR_H
+#define RLL_MOVE_JOINT_STATE_MONITOR_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <sensor_msgs/JointState.h>
+
+// Keeps the latest joint positions from the joint states and wakes up waiting threads as soon as new positions
+// arrive, so that the end of a motion is detected without polling the planning scene.
+//
+// The positions of a fixed set of tracked joints, e.g. those of the manipulator, are additionally published in a
+// seqlock-protected snapshot. Reading the snapshot takes no lock and never blocks the joint states callback.
+class RLLJointStateMonitor
+{
+public:
+  using Duration = std::chrono::steady_clock::duration;
+
+  static const size_t MAX_TRACKED_JOINTS = 16;
+
+  RLLJointStateMonitor() = default;
+
+  // must be called before the first update, returns false if there are too many joints
+  bool trackJoints(const std::vector<std::string>& joint_names);
+  // Measure the timeouts and settle times of waitForGoal() in ROS time instead of the steady clock, i.e. in simulation
+  // time with use_sim_time. Waits then take as long as the motion in a simulation that runs faster than real time.
+  void useRosTime(bool use_ros_time);
+  void subscribe(ros::NodeHandle* nh, const std::string& topic = "joint_states");
+  void update(const sensor_msgs::JointState& msg);
+
+  // Waits until all joints are within tolerance of the goal. If settle_time is positive, waiting also ends once the
+  // joints did not move for settle_time, e.g. when a gripper is blocked by a grasped object. Returns false on timeout.
+  bool waitForGoal(const std::vector<std::string>& joint_names, const std::vector<double>& goal, double tolerance,
+                   Duration timeout, Duration settle_time = Duration::zero());
+
+  bool positions(const std::vector<std::string>& joint_names, std::vector<double>* joint_positions);
+
+  // lock-free, in the order passed to trackJoints(), false if no positions for all of them were received yet
+  bool trackedPositions(std::vector<double>* joint_positions) const;
+
+private:
+  // wall time between two checks of the ROS time while waiting without joint state updates
+  static const Duration ROS_TIME_POLL_PERIOD;
+
+  void jointStatesCallback(const sensor_msgs::JointStateConstPtr& msg);
+  std::chrono::steady_clock::time_point now() const;
+  // must be called with the mutex held
+  bool positionsLocked(const std::vector<std::string>& joint_names, std::vector<double>* joint_positions) const;
+  // single writer, must be called with the mutex held
+  void publishTrackedPositions();
+
+  std::mutex mutex_;
+  std::condition_variable updated_;
+  std::map<std::string, double> positions_;
+  uint64_t num_updates_ = 0;
+  std::atomic<bool> use_ros_time_{ false };
+  ros::Subscriber joint_states_sub_;
+
+  std::vector<std::string> tracked_names_;
+  std::vector<double> tracked_scratch_;
+  // odd while the snapshot is written, zero until the first snapshot is complete
+  std::atomic<uint64_t> tracked_sequence_{ 0 };
+  std::array<std::atomic<double>, MAX_TRACKED_JOINTS> tracked_positions_;
+};
+
+#endif  // RLL_MOVE_JOINT_STATE_MONITOR_H
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_MESH_CACHE_H
+#define RLL_MOVE_MESH_CACHE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <fcl/BVH/BVH_model.h>
+#include <fcl/BV/OBBRSS.h>
+#include <shape_msgs/Mesh.h>
+
+// A mesh resource that has been loaded and scaled once. Both representations are immutable and shared by all users.
+struct RLLCachedMesh
+{
+  using BVHModel = fcl::BVHModel<fcl::OBBRSS>;
+
+  shape_msgs::Mesh msg;
+  std::shared_ptr<const BVHModel> bvh;
+};
+
+// Process-wide cache of mesh resources, keyed by resource path and scale, so that e.g. collision objects that are
+// rebuilt for every job do not parse the .stl or .dae files again. The cache keeps a reference to every loaded mesh
+// until it is pruned, meshes that are still in use stay valid afterwards.
+class RLLMeshCache
+{
+public:
+  using MeshPtr = std::shared_ptr<const RLLCachedMesh>;
+
+  static RLLMeshCache& instance();
+
+  // nullptr if the resource cannot be loaded, failures are not cached
+  MeshPtr get(const std::string& resource, double scale);
+  // drops the meshes that are not referenced outside of the cache
+  void prune();
+  size_t size() const;
+
+private:
+  RLLMeshCache() = default;
+
+  static MeshPtr load(const std::string& resource, double scale);
+
+  mutable std::mutex mutex_;
+  std::map<std::pair<std::string, double>, MeshPtr> meshes_;
+};
+
+#endif  // RLL_MOVE_MESH_CACHE_H
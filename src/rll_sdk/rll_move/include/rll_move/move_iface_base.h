@@ -24,42 +24,78 @@
 #include <arpa/inet.h>
 #include <sys/socket.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
 #include <actionlib/server/simple_action_server.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <geometry_msgs/Pose.h>
 #include <geometry_msgs/Pose2D.h>
 #include <rll_move/authentication.h>
+#include <rll_move/client_channel.h>
+#include <rll_move/job_recorder.h>
 #include <rll_move/move_iface_services.h>
 #include <rll_msgs/JobEnvAction.h>
 
+// Thread safe, the job finished service reports the result while the job action waits for it.
 class RLLJobResult
 {
 public:
   void setResult(bool result)
   {
-    success_ = result;
-    result_reported_ = true;
-    time_job_finished_ = ros::Time::now();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      success_ = result;
+      result_reported_ = true;
+      time_job_finished_ = ros::Time::now();
+    }
+    changed_.notify_all();
   }
 
   void jobStarted()
   {
+    std::lock_guard<std::mutex> lock(mutex_);
     time_job_started_ = ros::Time::now();
   }
 
   void reset()
   {
+    std::lock_guard<std::mutex> lock(mutex_);
     success_ = false;
     result_reported_ = false;
+    interrupted_ = false;
+  }
+
+  // wakes up waitForResult() without a result, e.g. if the interface entered the INTERNAL_ERROR state
+  void interrupt()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      interrupted_ = true;
+    }
+    changed_.notify_all();
+  }
+
+  // blocks until the result is reported, the timeout expires or interrupt() is called
+  bool waitForResult(std::chrono::steady_clock::duration timeout)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait_for(lock, timeout, [this] { return result_reported_ || interrupted_; });
+    return result_reported_;
   }
 
   bool isSet()
   {
+    std::lock_guard<std::mutex> lock(mutex_);
     return result_reported_;
   }
 
   // returns as RLL job status code
   uint8_t getResult()
   {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (result_reported_ && success_)
     {
       return rll_msgs::JobStatus::SUCCESS;
@@ -70,6 +106,7 @@ public:
 
   ros::Duration getJobDuration()
   {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (result_reported_)
     {
       return time_job_finished_ - time_job_started_;
@@ -79,28 +116,47 @@ public:
   }
 
 protected:
+  std::mutex mutex_;
+  std::condition_variable changed_;
   bool success_ = false;
   bool result_reported_ = false;
+  bool interrupted_ = false;
   ros::Time time_job_started_;
   ros::Time time_job_finished_;
 };
 
+// Results of replaying job logs, per request type
+struct RLLJobReplayStats
+{
+  struct Service
+  {
+    size_t calls = 0;
+    // the replayed planning result differs from the recorded one
+    size_t mismatches = 0;
+    double recorded_seconds = 0;
+    double replayed_seconds = 0;
+  };
+
+  size_t jobs = 0;
+  std::map<std::string, Service> services;
+
+  size_t mismatches() const;
+  void print() const;
+};
+
 // TODO(wolfgang): rename this into a project base class
 // RLLMoveIfaceBase should be used as the base class for custom interfaces.
 class RLLMoveIfaceBase : public virtual RLLMoveIfaceServices
 {
 public:
   explicit RLLMoveIfaceBase(const ros::NodeHandle& nh);
+  ~RLLMoveIfaceBase() override;
 
   static const std::string IDLE_JOB_SRV_NAME;
   static const std::string RUN_JOB_SRV_NAME;
   static const std::string JOB_FINISHED_SRV_NAME;
 
   static const int DEFAULT_CLIENT_SERVER_PORT = 5005;
-  static const int CLIENT_SERVER_BUFFER_SIZE = 10;
-  static const char* CLIENT_SERVER_START_CMD_;
-  static const char* CLIENT_SERVER_OK_RESP_;
-  static const char* CLIENT_SERVER_ERROR_RESP_;
 
   // since there will be a sim/real version, setup the services in here und make sure to call spin()
   // or use global service objects to keep them alive
@@ -112,27 +168,54 @@ public:
   // NOLINTNEXTLINE google-runtime-references
   bool jobFinishedSrv(std_srvs::SetBool::Request& req, std_srvs::SetBool::Response& resp);
 
+  // Re-runs the planning of the recorded service calls as fast as possible against the recorded planning scenes,
+  // nothing is executed. Calls without a planning-only counterpart are skipped.
+  void replayJobLog(const RLLJobLogReader& log, RLLJobReplayStats* stats);
+
 protected:
   ros::NodeHandle nh_;
   RLLJobResult job_result_;
 
+  // returns false if the request type cannot be replayed, matches is set to whether the recorded response agrees
+  virtual bool replayServiceCall(const RLLJobLogReader::Record& record,
+                                 const planning_scene::PlanningScene& planning_scene,
+                                 const robot_state::RobotState& start_state,
+                                 const robot_state::RobotState& job_start_state, bool* matches);
+  // only failures that depend on the request and the planning scene alone are compared, e.g. a failed execution
+  // cannot be reproduced by the replay
+  static bool replayMatches(const RLLErrorCode& recorded, const RLLErrorCode& replayed);
+
   virtual void runJob(const rll_msgs::JobEnvGoalConstPtr& goal, rll_msgs::JobEnvResult* result);
   virtual bool runClient(const rll_msgs::JobEnvGoalConstPtr& goal, rll_msgs::JobEnvResult* result);
   virtual RLLErrorCode idle();
 
 private:
+  // stays connected to the client listener across jobs
   int client_socket_ = -1;
   struct sockaddr_in client_serv_addr_;
+  RLLClientMessageReader client_reader_;
+  uint32_t last_job_id_ = 0;
 
   Authentication authentication_;
+  Permissions::ServiceId job_finished_srv_;
 
   int job_execution_timeout_seconds_ = 600;  // default is ten minutes
+  // one log per job is written into this directory, empty if recording is disabled
+  std::string job_log_directory_;
+  // the metrics are periodically published as diagnostics and, if set, written for a Prometheus textfile collector
+  std::string metrics_textfile_;
+  ros::Publisher diagnostics_pub_;
+  ros::WallTimer metrics_timer_;
 
   bool initClientSocket(const std::string& client_ip_addr);
+  bool connectClient();
+  void closeClientSocket();
   bool callClient();
 
   bool beforeActionExecution(RLLMoveIfaceState state, const std::string& secret, rll_msgs::JobEnvResult* result);
   bool afterActionExecution(rll_msgs::JobEnvResult* result);
+  void startJobRecording();
+  void exportMetrics(const ros::WallTimerEvent& event);
 
   void abortDueToCriticalFailure() override
   {
@@ -0,0 +1,27 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_MOVE_IFACE_DEFAULT_KINEMATIC_H
+#define RLL_MOVE_MOVE_IFACE_DEFAULT_KINEMATIC_H
+
+#include <rll_move/move_iface_default.h>
+#include <rll_move/move_iface_kinematic.h>
+
+// same as RLLDefaultMoveIface, but without Gazebo, see RLLKinematicMoveIface
+using RLLDefaultKinematicMoveIface = RLLCombinedMoveIface<RLLDefaultMoveIfaceBase, RLLKinematicMoveIface>;
+
+#endif  // RLL_MOVE_MOVE_IFACE_DEFAULT_KINEMATIC_H
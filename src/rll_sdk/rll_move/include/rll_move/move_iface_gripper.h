@@ -59,6 +59,8 @@ public:
   // These functions are invoked by the corresponding service calls, they are part of the public interface
   RLLErrorCode moveGripper(const rll_msgs::MoveGripper::Request& req, rll_msgs::MoveGripper::Response* resp);
   RLLErrorCode pickPlace(const rll_msgs::PickPlace::Request& req, rll_msgs::PickPlace::Response* resp);
+  // replays cached approach, grip and retreat motions with use_trajectory_cache, unless they are planned up front
+  RLLErrorCode runPickPlace(const rll_msgs::PickPlace::Request& req, bool use_trajectory_cache);
   RLLErrorCode pickPlaceHere(const rll_msgs::PickPlaceHere::Request& req, rll_msgs::PickPlaceHere::Response* /*resp*/);
   RLLErrorCode validatePickPlace(const rll_msgs::ValidatePickPlace::Request& req,
                                  rll_msgs::ValidatePickPlace::Response* /*resp*/);
@@ -73,6 +75,9 @@ public:
 
 protected:
   Permissions::Index pick_place_permission_;
+  Permissions::ServiceId pick_place_srv_;
+  Permissions::ServiceId pick_place_here_srv_;
+  Permissions::ServiceId move_gripper_srv_;
 
   RLLErrorCode isGripperOperationConsistent(bool close_gripper);
 
@@ -100,6 +105,8 @@ private:
   static const std::string GRIPPER_CLOSE_TARGET_NAME;
   moveit::planning_interface::MoveGroupInterface gripper_move_group_;
   bool is_gripper_closed_ = false;
+  // plan approach, grip and retreat of pickPlace() up front instead of before each motion
+  bool planned_pick_place_ = false;
 
   ros::ServiceServer pick_place_service_, validate_pick_place_service_, pick_place_here_service_, move_gripper_service_;
 
@@ -123,9 +130,31 @@ private:
    */
   RLLErrorCode validatePickPlaceGripPose(const std::string& object_id, geometry_msgs::Pose grip_pose,
                                          bool close_gripper, GraspObject** grasp_object_ptr);
-  RLLErrorCode approachPickPlaceGripPose(const geometry_msgs::Pose& approach_pose,
-                                         const geometry_msgs::Pose& grip_pose);
-  RLLErrorCode retreatFromPickPlaceGripPose(const geometry_msgs::Pose& retreat_pose);
+  RLLErrorCode approachPickPlaceGripPose(const geometry_msgs::Pose& approach_pose, const geometry_msgs::Pose& grip_pose,
+                                         bool use_trajectory_cache = false);
+  RLLErrorCode retreatFromPickPlaceGripPose(const geometry_msgs::Pose& retreat_pose, bool use_trajectory_cache = false);
+
+  struct PickPlacePlans
+  {
+    // false if the robot is already at the approach pose
+    bool approach_required = false;
+    moveit::planning_interface::MoveGroupInterface::Plan approach;
+    moveit::planning_interface::MoveGroupInterface::Plan grip;
+    moveit::planning_interface::MoveGroupInterface::Plan retreat;
+  };
+
+  /**
+   * Plans and time parameterizes all motions of a pick place operation before the robot moves. The retreat is planned
+   * with the gripper state and the grasp object attachment that result from the gripping operation.
+   */
+  RLLErrorCode planPickPlace(const rll_msgs::PickPlace::Request& req, bool close_gripper,
+                             const GraspObject& grasp_object, PickPlacePlans* plans);
+  RLLErrorCode planPickPlaceSegment(const planning_scene::PlanningScene& planning_scene,
+                                    const geometry_msgs::Pose& goal, robot_state::RobotState* state,
+                                    moveit::planning_interface::MoveGroupInterface::Plan* plan);
+  RLLErrorCode pickPlacePlanned(const rll_msgs::PickPlace::Request& req, bool close_gripper,
+                                GraspObject* grasp_object_ptr);
+  std::vector<std::string> fingerLinks();
 
   /**
    * Closes the gripper.
@@ -133,29 +162,33 @@ private:
   RLLErrorCode closeGripper();
 
   /**
-   * Opens the gripper
+   * Opens the gripper, without wait_for_gripper it returns before the fingers came to rest.
    */
-  RLLErrorCode openGripper();
+  RLLErrorCode openGripper(bool wait_for_gripper = true);
 
   /**
-   * Close the gripper and attach the GraspObject to the EEF.
+   * Close the gripper and attach the GraspObject to the EEF. With retreat_planned the following motion is already
+   * planned, so there is no need to wait for the planning scene update.
    */
-  RLLErrorCode closeGripperAndAttach(GraspObject* grasp_object_ptr);
+  RLLErrorCode closeGripperAndAttach(GraspObject* grasp_object_ptr, bool retreat_planned = false);
 
   /**
-   * Open the gripper and release the currently attached GrapObject.
+   * Open the gripper and release the currently attached GrapObject. With retreat_planned the following motion is
+   * already planned and starts as soon as the gripper controller is done, without waiting for the fingers to settle.
    */
-  RLLErrorCode openGripperAndDetach();
+  RLLErrorCode openGripperAndDetach(bool retreat_planned = false);
 
   /**
    * Remove a CollisionObject from the world and attach it to the EEF.
    */
-  bool attachCollisionObject(const moveit_msgs::CollisionObject& collision_object);
+  bool attachCollisionObject(const moveit_msgs::CollisionObject& collision_object,
+                             bool wait_for_scene_update = true);
 
   /**
    * Remove a CollisionObject from the EEF and add it back to the world.
    */
-  bool detachAttachedCollisionObject(const moveit_msgs::CollisionObject& collision_object);
+  bool detachAttachedCollisionObject(const moveit_msgs::CollisionObject& collision_object,
+                                     bool wait_for_scene_update = true);
 
   /**
    * Find a GraspObject by the specified id of the underlying CollisionObject.
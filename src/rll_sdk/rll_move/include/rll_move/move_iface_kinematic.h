@@ -0,0 +1,43 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_MOVE_IFACE_KINEMATIC_H
+#define RLL_MOVE_MOVE_IFACE_KINEMATIC_H
+
+#include <rll_move/move_iface_simulation.h>
+
+// Kinematic-only environment without Gazebo: trajectories are checked for collisions and then executed by publishing
+// their last waypoint as joint state, which the joint_state_publisher of fake_state.launch merges into the robot state.
+// Grasp objects stay attached to the end effector in the planning scene, so they move along with the robot.
+class RLLKinematicMoveIface : public RLLSimulationMoveIface
+{
+public:
+  static const std::string JOINT_STATES_TOPIC;
+
+  explicit RLLKinematicMoveIface();
+  ~RLLKinematicMoveIface() override = default;
+
+protected:
+  moveit::planning_interface::MoveItErrorCode
+  executeTrajectory(moveit::planning_interface::MoveGroupInterface* move_group,
+                    const moveit::planning_interface::MoveGroupInterface::Plan& plan) override;
+
+private:
+  ros::Publisher joint_states_pub_;
+};
+
+#endif  // RLL_MOVE_MOVE_IFACE_KINEMATIC_H
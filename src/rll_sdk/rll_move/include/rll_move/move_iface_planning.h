@@ -26,9 +26,23 @@
 #include <moveit/move_group_interface/move_group_interface.h>
 #include <moveit/planning_scene_interface/planning_scene_interface.h>
 #include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <tf2_ros/buffer.h>
 
+#include <rll_move/conservative_advancement.h>
+#include <rll_move/const_transform_cache.h>
+#include <rll_move/distance_field_pre_check.h>
+#include <rll_move/ik_cache.h>
+#include <rll_move/joint_path.h>
+#include <rll_move/joint_state_monitor.h>
 #include <rll_move/log_util.h>
 #include <rll_move/move_iface_error.h>
+#include <rll_move/phase_timers.h>
+#include <rll_move/planning_scene_diff.h>
+#include <rll_move/shared_robot_model.h>
+#include <rll_move/sphere_proxy_check.h>
+#include <rll_move/service_metrics.h>
+#include <rll_move/trajectory_cache.h>
+#include <rll_move/trajectory_compression.h>
 #include <rll_moveit_kinematics_plugin/moveit_kinematics_plugin.h>
 
 class RLLMoveIfacePlanning
@@ -47,41 +61,89 @@ protected:
   static const double DEFAULT_ROTATION_EEF_STEP;
   static const double DEFAULT_LINEAR_JUMP_THRESHOLD;
   static const size_t LINEAR_MIN_STEPS_FOR_JUMP_THRESH;
+  static const double CONTINUOUS_COLLISION_SAFETY_MARGIN;
+  static const size_t ADAPTIVE_MAX_STRIDE;
+  static const double ADAPTIVE_MAX_JOINT_STEP;
+  static const size_t STREAMING_FIRST_SEGMENT_WAYPOINTS;
+  static const size_t STREAMING_MIN_WAYPOINTS;
+  static const double COMPRESSION_JOINT_TOLERANCE;
+  static const double COMPRESSION_CARTESIAN_TOLERANCE;
 
   // TODO(wolfgang): make these private
   std::string node_name_;
+  // shared by all move groups and the planning scene monitor of the process, declared first to outlive them
+  robot_model_loader::RobotModelLoaderPtr robot_model_loader_;
   moveit::planning_interface::MoveGroupInterface manip_move_group_;
   const robot_state::JointModelGroup* manip_joint_model_group_;
   std::shared_ptr<const rll_moveit_kinematics::RLLMoveItKinematicsPlugin> kinematics_plugin_;
   planning_scene::PlanningSceneConstPtr planning_scene_;
   moveit::planning_interface::PlanningSceneInterface planning_scene_interface_;
+  // collision object changes are batched here and sent with applyPlanningSceneDiff()
+  RLLPlanningSceneDiff scene_diff_;
   moveit::core::RobotModelConstPtr manip_model_;
+  // timings of the hot path, safe to record from concurrent computeLinearPath() calls
+  RLLPhaseTimers phase_timers_;
+  // cumulative over all jobs, exported for monitoring
+  RLLServiceMetrics metrics_;
   const std::string& getNamespace();
 
   const std::string& getEEFType();
-  RLLErrorCode runPTPTrajectory(moveit::planning_interface::MoveGroupInterface* move_group, bool for_gripper = false);
-  RLLErrorCode moveToGoalLinear(const geometry_msgs::Pose& goal, bool cartesian_time_parametrization = false);
+  // With use_trajectory_cache, the trajectory of a manipulator transition that was executed before is replayed if it is
+  // still valid, e.g. for the fixed transitions when resetting the robot. Without wait_for_gripper a gripper motion
+  // returns as soon as the controller is done, without waiting for the fingers to come to rest.
+  RLLErrorCode runPTPTrajectory(moveit::planning_interface::MoveGroupInterface* move_group, bool for_gripper = false,
+                                bool use_trajectory_cache = false, bool wait_for_gripper = true);
+  // With use_trajectory_cache, a linear motion that was executed before from the same start to the same goal pose is
+  // replayed if it is still valid, it is then planned as a whole also with streaming_linear_execution.
+  RLLErrorCode moveToGoalLinear(const geometry_msgs::Pose& goal, bool cartesian_time_parametrization = false,
+                                bool use_trajectory_cache = false);
+  RLLErrorCode moveToGoalPTP(const geometry_msgs::Pose& goal, bool use_trajectory_cache = false);
   RLLErrorCode runLinearTrajectory(const moveit_msgs::RobotTrajectory& trajectory,
                                    bool cartesian_time_parametrization = false);
+  // checks and time parameterizes a linear trajectory, so that it can be executed without further planning
+  RLLErrorCode prepareLinearTrajectory(const moveit_msgs::RobotTrajectory& trajectory,
+                                       bool cartesian_time_parametrization,
+                                       moveit::planning_interface::MoveGroupInterface::Plan* plan);
+  RLLErrorCode execute(moveit::planning_interface::MoveGroupInterface* move_group,
+                       const moveit::planning_interface::MoveGroupInterface::Plan& plan, bool wait_for_gripper = true);
+  // fallback for execute() if no joint states are received, polls the current state of the planning scene
+  bool waitForGoalFromPlanningScene(const std::vector<double>& last_point);
 
   RLLErrorCode computeLinearPathArmangle(const std::vector<geometry_msgs::Pose>& waypoints_pose,
                                          const std::vector<double>& waypoints_arm_angles,
-                                         const std::vector<double>& ik_seed_state,
-                                         std::vector<robot_state::RobotStatePtr>* path);
+                                         const std::vector<double>& ik_seed_state, RLLJointPath* path);
+  // adds a waypoint to the trajectory for each point of the path, the other joints are taken from the template
+  void jointPathToTrajectory(const RLLJointPath& path, const robot_state::RobotState& state_template,
+                             robot_trajectory::RobotTrajectory* trajectory);
   RLLErrorCode computeLinearPath(const std::vector<double>& start, const geometry_msgs::Pose& goal,
                                  moveit_msgs::RobotTrajectory* trajectory);
   RLLErrorCode computeLinearPath(const geometry_msgs::Pose& goal, moveit_msgs::RobotTrajectory* trajectory);
+  // in-process variant that neither queries the current state nor the move group, safe to call concurrently
+  RLLErrorCode computeLinearPath(const robot_state::RobotState& start_state, const geometry_msgs::Pose& goal,
+                                 const planning_scene::PlanningScene& planning_scene,
+                                 robot_trajectory::RobotTrajectory* trajectory);
+  // discrete check of every waypoint or, if enabled, conservative advancement between waypoints with enough clearance,
+  // the sphere proxies, if enabled, decide the states that are clearly free or in collision with the static obstacles
+  bool isPathValid(const planning_scene::PlanningScene& planning_scene,
+                   const robot_trajectory::RobotTrajectory& trajectory);
   void transformPoseForIK(geometry_msgs::Pose* pose);
   void transformPoseFromFK(geometry_msgs::Pose* pose);
   RLLErrorCode interpolatePosesLinear(const geometry_msgs::Pose& start, const geometry_msgs::Pose& end,
                                       std::vector<geometry_msgs::Pose>* waypoints, size_t steps_arm_angle = 0);
   void interpolateArmangleLinear(double start, double end, int dir, int n, std::vector<double>* arm_angles);
+  // in the order of the manipulator joints, cached after the first call
   std::vector<double> getJointValuesFromNamedTarget(const std::string& name);
   bool armangleInRange(double arm_angle);
   size_t numStepsArmAngle(double start, double end);
 
   bool manipCurrentStateAvailable();
+  // latest manipulator joint values from the joint states, neither copies a RobotState nor locks the planning scene
+  std::vector<double> getCurrentManipJointValues();
+  // end effector pose from the local FK of the latest joint values, neither queries the move group nor TF
+  geometry_msgs::Pose getCurrentManipPose(double* arm_angle = nullptr, int* config = nullptr);
   robot_state::RobotState getCurrentRobotState(bool wait_for_state = false);
+  // private copy of the current planning scene, e.g. for collision checks that run concurrently
+  planning_scene::PlanningScenePtr clonePlanningScene();
   bool jointsGoalTooClose(const std::vector<double>& start, const std::vector<double>& goal);
   bool poseGoalTooClose(const geometry_msgs::Pose& goal);
   bool tooCloseForLinearMovement(const geometry_msgs::Pose& goal);
@@ -93,19 +155,45 @@ protected:
     updateCollisionEntry(link_1, link_2, true);
   }
   double distanceToCurrentPosition(const geometry_msgs::Pose& pose);
-  geometry_msgs::Pose getCurrentPoseFromPlanningScene();
 
   RLLErrorCode poseGoalInCollision(const geometry_msgs::Pose& goal);
   RLLErrorCode poseGoalInCollision(const geometry_msgs::Pose& goal, std::vector<double>* goal_joint_values);
+  RLLErrorCode poseGoalInCollision(const geometry_msgs::Pose& goal, const robot_state::RobotState& current_state,
+                                   const planning_scene::PlanningScene& planning_scene,
+                                   std::vector<double>* goal_joint_values, bool use_ik_cache);
+
+  struct RandomGoal
+  {
+    geometry_msgs::Pose pose;
+    std::vector<double> joint_values;
+  };
+  // Samples and validates the candidates concurrently, each with its own copy of the current state. The goals that
+  // are neither too close to the current pose nor in collision are returned in the order they were sampled.
+  void sampleRandomGoals(size_t num_candidates, std::vector<RandomGoal>* goals);
 
   virtual bool modifyLinTrajectory(moveit_msgs::RobotTrajectory* trajectory);
 
   // this method can be used to handle critical failures, e.g. set error state in the state machine
   virtual void abortDueToCriticalFailure() = 0;
 
+  // sends the batched changes of scene_diff_ in one planning scene diff
+  bool applyPlanningSceneDiff();
+
+  // called after the iface modified the planning scene, e.g. to invalidate results that depend on it
+  virtual void planningSceneModified()
+  {
+  }
+
   // the following methods depend on whether we run in simulation or on the real robot
   // the actual implementation is implemented in a subclass, e.g. RLLMoveIfaceSimulation
   virtual bool modifyPtpTrajectory(moveit_msgs::RobotTrajectory* trajectory) = 0;
+  // executes the plan with the controllers of the move group by default
+  virtual moveit::planning_interface::MoveItErrorCode
+  executeTrajectory(moveit::planning_interface::MoveGroupInterface* move_group,
+                    const moveit::planning_interface::MoveGroupInterface::Plan& plan)
+  {
+    return move_group->execute(plan);
+  }
 
 private:
   static const std::string MANIP_PLANNING_GROUP;
@@ -116,25 +204,75 @@ private:
   tf::Transform ee_to_tip_;
   planning_scene_monitor::PlanningSceneMonitorPtr planning_scene_monitor_;
   collision_detection::AllowedCollisionMatrix acm_;
+  RLLJointStateMonitor joint_state_monitor_;
   bool no_gripper_attached_;
   double allowed_start_tolerance_ = 0.01;
+  bool continuous_collision_checking_ = false;
+  bool adaptive_interpolation_ = false;
+  bool streaming_linear_execution_ = false;
+  bool trajectory_compression_ = false;
+  bool fast_sim_ = false;
+  bool fast_startup_ = false;
+  // the distance field is shared by the goal pre-check and the sphere proxy check
+  std::unique_ptr<RLLDistanceFieldPreCheck> collision_pre_check_;
+  bool goal_pre_check_ = false;
+  bool sphere_proxy_check_ = false;
+  RLLIKCache goal_ik_cache_;
+  RLLTrajectoryCache trajectory_cache_;
+  // prepared linear trajectories, kept apart from the PTP trajectories that may share their start and goal
+  RLLTrajectoryCache linear_trajectory_cache_;
+  std::map<std::string, std::vector<double>> named_target_joint_values_;
 
-  RLLErrorCode execute(moveit::planning_interface::MoveGroupInterface* move_group,
-                       const moveit::planning_interface::MoveGroupInterface::Plan& plan);
+  // Executes a long linear path in segments that end at rest, the robot stops and settles at each segment boundary. The
+  // next segment is planned against a copy of the scene while the previous one is executed, a segment that fails to
+  // plan is never started and the robot stops at the end of the previous one.
+  RLLErrorCode runLinearTrajectoryStreaming(const geometry_msgs::Pose& goal);
+  // last waypoint of each segment, the first segment is the shortest and each following one is twice as long
+  static void streamingSegmentEnds(size_t num_waypoints, std::vector<size_t>* segment_ends);
+  RLLErrorCode planLinearSegment(const robot_state::RobotState& start_state, const geometry_msgs::Pose& goal,
+                                 const planning_scene::PlanningScene& planning_scene,
+                                 robot_state::RobotState* end_state,
+                                 moveit::planning_interface::MoveGroupInterface::Plan* plan);
+
+  // drops the points of a time parameterized linear trajectory that the controller interpolates within tolerance
+  void compressTrajectory(moveit_msgs::RobotTrajectory* trajectory);
 
   RLLErrorCode checkTrajectory(const moveit_msgs::RobotTrajectory& trajectory);
+  bool cachedTrajectoryValid(const moveit_msgs::RobotTrajectory& trajectory);
+  bool lookupLinearTrajectory(const geometry_msgs::Pose& goal, moveit_msgs::RobotTrajectory* trajectory);
   bool stateInCollision(robot_state::RobotState* state);
+  bool stateInCollision(const planning_scene::PlanningScene& planning_scene, robot_state::RobotState* state);
 
+  static RLLInvKinOptions pathIKOptions();
   void getPathIK(const std::vector<geometry_msgs::Pose>& waypoints_pose, const std::vector<double>& ik_seed_state,
-                 std::vector<robot_state::RobotStatePtr>* path, double* last_valid_percentage);
+                 RLLJointPath* path, double* last_valid_percentage);
+  // Solves only every ADAPTIVE_MAX_STRIDE-th waypoint and all waypoints of the segments in between where the joints
+  // move too much or the robot comes close to obstacles.
+  void getPathIKAdaptive(const robot_state::RobotState& state_template,
+                         const std::vector<geometry_msgs::Pose>& waypoints_pose,
+                         const std::vector<double>& ik_seed_state, const planning_scene::PlanningScene& planning_scene,
+                         RLLJointPath* path, double* last_valid_percentage);
+  static void logPathIKFailure(const RLLKinMsg& result, size_t waypoint);
   void getPathIK(const std::vector<geometry_msgs::Pose>& waypoints_pose,
                  const std::vector<double>& waypoints_arm_angles, const std::vector<double>& ik_seed_state,
-                 std::vector<robot_state::RobotStatePtr>* path, double* last_valid_percentage);
+                 RLLJointPath* path, double* last_valid_percentage);
+  double testJointSpaceJump(RLLJointPath* path);
+
+  using LinkRadii = std::map<const moveit::core::LinkModel*, double>;
+  static bool collisionRadii(const planning_scene::PlanningScene& planning_scene,
+                             const robot_state::RobotState& state, LinkRadii* radii);
+  // conservative distance to any collision, halved for self-collisions
+  static double clearance(const planning_scene::PlanningScene& planning_scene, const robot_state::RobotState& state);
+  // upper bound of the distance that any point of the link geometry moved between the states
+  static double maxDisplacement(const LinkRadii& radii, const robot_state::RobotState& start,
+                                const robot_state::RobotState& end);
 
+  // the tf based checks run concurrently and share one buffer
   bool getKinematicsSolver();
-  bool initConstTransforms();  // init members base_to_world_ ee_to_tip_
-  bool isCollisionLinkAvailable();
+  bool initConstTransforms(const tf2_ros::Buffer& tf_buffer);  // init members base_to_world_ ee_to_tip_
+  bool isCollisionLinkAvailable(const tf2_ros::Buffer& tf_buffer);
   bool isInitialStateInCollision();
+  RLLConstTransformCache constTransformCache();
 };
 
 #endif  // RLL_MOVE_MOVE_IFACE_PLANNING_H
@@ -24,6 +24,7 @@
 #include <std_srvs/SetBool.h>
 #include <std_srvs/Trigger.h>
 
+#include <rll_move/job_recorder.h>
 #include <rll_move/move_iface_planning.h>
 #include <rll_move/move_iface_state_machine.h>
 #include <rll_move/permissions.h>
@@ -86,6 +87,19 @@ protected:
   Permissions::Index move_permission_;
   Permissions::Index only_during_job_run_permission_;
 
+  // the permission requirements of the services are resolved once, see Permissions::registerService()
+  Permissions::ServiceId robot_ready_srv_;
+  Permissions::ServiceId move_ptp_srv_;
+  Permissions::ServiceId move_ptp_armangle_srv_;
+  Permissions::ServiceId move_lin_srv_;
+  Permissions::ServiceId move_lin_armangle_srv_;
+  Permissions::ServiceId move_joints_srv_;
+  Permissions::ServiceId move_random_srv_;
+  Permissions::ServiceId get_pose_srv_;
+  Permissions::ServiceId get_joint_values_srv_;
+  // records the calls of controlledMovementExecution() while a job log is open
+  RLLJobRecorder job_recorder_;
+
   void setupPermissions();
 
   void abortDueToCriticalFailure() override;
@@ -102,21 +116,42 @@ protected:
   RLLErrorCode getCurrentJointValues(const rll_msgs::GetJointValues::Request& req,
                                      rll_msgs::GetJointValues::Response* resp);
 
+  virtual RLLErrorCode beforeServiceCall(Permissions::ServiceId srv);
+  virtual RLLErrorCode afterServiceCall(Permissions::ServiceId srv, const RLLErrorCode& previous_error_code);
+  // looks up the requirements on every call, prefer the overloads taking a service id
   virtual RLLErrorCode beforeServiceCall(const std::string& srv_name);
   virtual RLLErrorCode afterServiceCall(const std::string& srv_name, const RLLErrorCode& previous_error_code);
+  // read-only services bypass the service call tracking and may run concurrently with other service calls
+  RLLErrorCode beforeQueryCall(Permissions::ServiceId srv);
+  RLLErrorCode afterQueryCall(Permissions::ServiceId srv, const RLLErrorCode& previous_error_code);
 
-  template <class Request, class Response, class BaseClass>
-  bool controlledMovementExecution(const Request& req, Response* resp, const std::string& srv_name,
+  // the service is either identified by its service id or, as a fallback for unregistered services, by its name
+  template <class Request, class Response, class BaseClass, class Service>
+  bool controlledMovementExecution(const Request& req, Response* resp, const Service& srv,
                                    RLLErrorCode (BaseClass::*move_func)(const Request&, Response*));
 
   void handleFailureSeverity(const RLLErrorCode& error_code);
+
+private:
+  RLLErrorCode beginServiceCall(const std::string& srv_name, Permissions::Group requirements);
+  RLLErrorCode endServiceCall(const std::string& srv_name, Permissions::Group requirements,
+                              const RLLErrorCode& previous_error_code);
+  void beginServiceMetrics(const std::string& srv_name);
+  void endServiceMetrics(const std::string& srv_name, const RLLErrorCode& error_code);
 };
 
-template <class Request, class Response, class BaseClass>
-bool RLLMoveIfaceServices::controlledMovementExecution(const Request& req, Response* resp, const std::string& srv_name,
+template <class Request, class Response, class BaseClass, class Service>
+bool RLLMoveIfaceServices::controlledMovementExecution(const Request& req, Response* resp, const Service& srv,
                                                        RLLErrorCode (BaseClass::*move_func)(const Request&, Response*))
 {
-  RLLErrorCode error_code = beforeServiceCall(srv_name);
+  ros::WallTime start = ros::WallTime::now();
+  std::vector<double> start_joint_values;
+  if (job_recorder_.recording())
+  {
+    start_joint_values = getCurrentManipJointValues();
+  }
+
+  RLLErrorCode error_code = beforeServiceCall(srv);
 
   // only execute the move_func if the prior check succeeded
   if (error_code.succeeded())
@@ -135,11 +170,17 @@ bool RLLMoveIfaceServices::controlledMovementExecution(const Request& req, Respo
     }
   }
 
-  error_code = afterServiceCall(srv_name, error_code);
+  error_code = afterServiceCall(srv, error_code);
 
   resp->error_code = error_code.value();
   resp->success = error_code.succeeded();
 
+  if (job_recorder_.recording())
+  {
+    job_recorder_.recordServiceCall(req, *resp, start, ros::WallTime::now() - start, error_code.value(),
+                                    start_joint_values);
+  }
+
   return true;
 }
 
@@ -22,6 +22,7 @@
 #define RLL_MOVE_MOVE_IFACE_SIMULATION_H
 
 #include <rll_move/move_iface_planning.h>
+#include <rll_move/time_parameterization_cache.h>
 
 class RLLSimulationMoveIface : public virtual RLLMoveIfacePlanning
 {
@@ -31,6 +32,10 @@ public:
 
 protected:
   bool modifyPtpTrajectory(moveit_msgs::RobotTrajectory* trajectory) override;
+
+private:
+  // the same fixed paths are parameterized again and again
+  RLLTimeParameterizationCache time_parameterization_cache_;
 };
 
 #endif  // RLL_MOVE_MOVE_IFACE_SIMULATION_H
@@ -20,6 +20,10 @@
 #ifndef RLL_MOVE_MOVE_IFACE_STATE_MACHINE_H
 #define RLL_MOVE_MOVE_IFACE_STATE_MACHINE_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <rll_move/move_iface_error.h>
 #include <rll_move/permissions.h>
@@ -50,6 +54,9 @@ enum class RLLMoveIfaceState
  * If a service call fails its return value indicates the reason but INTERNAL_ERROR
  * is not automatically entered you will need to do this manually.
  *
+ * Read-only queries, e.g. of the current pose, are not counted as service calls. They only check the state, which is
+ * kept in an atomic word and read without taking the lock, so they can run concurrently with a move in progress.
+ *
  */
 class RLLMoveIfaceStateMachine
 {
@@ -83,6 +90,13 @@ public:
    */
   virtual RLLErrorCode endServiceCall(const std::string& srv_name, bool only_allowed_during_job_run);
 
+  /**
+   * \brief Check if a read-only query is allowed in the current state, lock-free.
+   *
+   * Unlike beginServiceCall() the query is not tracked and does not need to be ended.
+   */
+  RLLErrorCode checkQueryAllowed(const std::string& srv_name, bool only_allowed_during_job_run) const;
+
   /**
    * \brief Indicates if a service call is currently in execution.
    */
@@ -92,24 +106,39 @@ public:
     return concurrent_service_calls_counter_ > 0;
   }
 
+  /**
+   * \brief Blocks until no service call is in execution anymore.
+   */
+  void waitForServiceCallsToEnd();
+
+  /**
+   * \brief Blocks until no service call is in execution or the timeout expires, returns false on timeout.
+   */
+  bool waitForServiceCallsToEnd(std::chrono::steady_clock::duration timeout);
+
+  /**
+   * \brief Register a callback that is invoked once the INTERNAL_ERROR state is entered.
+   *
+   * The callback is invoked with the state lock held and must not call back into the state machine.
+   */
+  void setInternalErrorCallback(std::function<void()> callback);
+
   /**
    * \brief Override the result of a service call if one is currently in execution.
    */
   bool setCurrentServiceCallResult(RLLErrorCode error_code);
 
-  bool isInInternalErrorState()
+  bool isInInternalErrorState() const
   {
-    std::lock_guard<std::mutex> service_call_lock(mutex_);
-    return state_ == RLLMoveIfaceState::INTERNAL_ERROR;
+    return state_.load() == RLLMoveIfaceState::INTERNAL_ERROR;
   }
 
-  bool isJobRunning()
+  bool isJobRunning() const
   {
-    std::lock_guard<std::mutex> service_call_lock(mutex_);
-    return state_ == RLLMoveIfaceState::RUNNING_JOB;
+    return state_.load() == RLLMoveIfaceState::RUNNING_JOB;
   }
 
-  const char* stateToString(RLLMoveIfaceState state)
+  static const char* stateToString(RLLMoveIfaceState state)
   {
     switch (state)
     {
@@ -131,13 +160,16 @@ protected:
   // only one is service call is allowed but this way we can
   // track if there are the same amount of begin()/end() calls
   unsigned int concurrent_service_calls_counter_ = 0;
-  RLLMoveIfaceState state_{ RLLMoveIfaceState::WAITING };
+  // only changed with the mutex held, but can be read without it
+  std::atomic<RLLMoveIfaceState> state_{ RLLMoveIfaceState::WAITING };
   std::mutex mutex_;
+  std::condition_variable service_calls_ended_;
 
 private:
   void setStateToInternalError();
   bool setState(RLLMoveIfaceState new_state);
   RLLErrorCode override_service_call_result_;
+  std::function<void()> internal_error_callback_;
 };
 
 #endif  // RLL_MOVE_MOVE_IFACE_STATE_MACHINE_H
@@ -43,12 +43,17 @@
  * To avoid having to register every possible operation, default requirements can
  * be specified which will need to met for every unregistered operation.
  *
+ * Looking up the requirements by name is a map lookup. Frequently checked operations, e.g. services, should be
+ * registered once to obtain a service id instead. The requirements of a registered service are resolved up front, and
+ * again whenever requirements change, so a check by id is a single bitmask compare.
+ *
  */
 class Permissions
 {
 public:
   using Group = uint32_t;
   using Index = uint32_t;
+  using ServiceId = uint32_t;
   static const uint8_t MAX_PERMISSION_INDICES = 32 - 1;
   static const Group NO_PERMISSION_REQUIRED = 0;
   // since the zeroth bit cannot be set this permission will never be granted
@@ -179,6 +184,41 @@ public:
   {
     default_requirements_ = requirements;
     ROS_DEBUG("Update default requirements=%u", default_requirements_);
+    resolveServiceRequirements();
+  }
+
+  // returns the id of an already registered service with the same name
+  ServiceId registerService(const std::string& name)
+  {
+    const auto ITER = std::find(service_names_.begin(), service_names_.end(), name);
+    if (ITER != service_names_.end())
+    {
+      return std::distance(service_names_.begin(), ITER);
+    }
+
+    service_names_.push_back(name);
+    resolved_requirements_.push_back(getRequiredPermissionsFor(name));
+    return service_names_.size() - 1;
+  }
+
+  const std::string& getServiceName(ServiceId id) const
+  {
+    return service_names_[id];
+  }
+
+  Group getRequiredPermissionsFor(ServiceId id) const
+  {
+    return resolved_requirements_[id];
+  }
+
+  bool isPermissionRequiredFor(ServiceId id, Index requirement) const
+  {
+    return (resolved_requirements_[id] & requirement) == requirement;
+  }
+
+  bool areAllRequiredPermissionsSetFor(ServiceId id) const
+  {
+    return arePermissionsCurrentlySet(resolved_requirements_[id]);
   }
 
   void setRequiredPermissionsFor(const std::string& name, Group requirements, bool require_default_permissions = false)
@@ -189,6 +229,7 @@ public:
                                            // getRequiredPermissionsFor
     }
     requirements_by_name_[name] = requirements;
+    resolveServiceRequirements();
   }
 
   bool isPermissionRequiredFor(const std::string& name, Index requirement)
@@ -261,6 +302,18 @@ private:
   std::map<std::string, Group> requirements_by_name_;
   // push/pop the current set permissions
   std::stack<Group> stored_permissions_;
+
+  // indexed by service id
+  std::vector<std::string> service_names_;
+  std::vector<Group> resolved_requirements_;
+
+  void resolveServiceRequirements()
+  {
+    for (size_t i = 0; i < service_names_.size(); ++i)
+    {
+      resolved_requirements_[i] = getRequiredPermissionsFor(service_names_[i]);
+    }
+  }
 };
 
 #endif  // RLL_MOVE_PERMISSIONS_H
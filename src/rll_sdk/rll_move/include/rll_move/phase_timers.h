@@ -0,0 +1,141 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_PHASE_TIMERS_H
+#define RLL_MOVE_PHASE_TIMERS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+enum class RLLTimedPhase : uint8_t
+{
+  PTP_PLANNING = 0,
+  LINEAR_PATH,
+  PATH_IK,
+  PATH_VALIDITY_CHECK,
+  TRAJECTORY_MODIFICATION,
+  EXECUTION,
+  NUM_PHASES
+};
+
+enum class RLLPhaseCounter : uint8_t
+{
+  IK_WAYPOINTS = 0,
+  EXECUTED_WAYPOINTS,
+  CACHED_TRAJECTORIES,
+  NUM_COUNTERS
+};
+
+/**
+ * Always-on timing of the hot path phases of the interface.
+ *
+ * Recording is lock-free and can happen from any thread: every sample is packed into a single 64-bit word and written
+ * into a ring buffer that keeps the most recent samples for percentiles. The totals per phase are accumulated in atomic
+ * counters, so they stay exact even if the ring buffer wrapped around. A summary is usually dumped when a job ends.
+ */
+class RLLPhaseTimers
+{
+public:
+  static const size_t RING_BUFFER_SIZE = 4096;
+
+  class ScopedTimer
+  {
+  public:
+    ScopedTimer(RLLPhaseTimers* timers, RLLTimedPhase phase)
+      : timers_(timers), phase_(phase), start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer()
+    {
+      timers_->record(phase_, std::chrono::steady_clock::now() - start_);
+    }
+
+  private:
+    RLLPhaseTimers* timers_;
+    RLLTimedPhase phase_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  RLLPhaseTimers();
+
+  void record(RLLTimedPhase phase, std::chrono::steady_clock::duration duration);
+
+  void count(RLLPhaseCounter counter, uint64_t value = 1)
+  {
+    counters_[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t numSamples(RLLTimedPhase phase) const
+  {
+    return phases_[static_cast<size_t>(phase)].num_samples.load(std::memory_order_relaxed);
+  }
+
+  uint64_t totalNanoseconds(RLLTimedPhase phase) const
+  {
+    return phases_[static_cast<size_t>(phase)].total_ns.load(std::memory_order_relaxed);
+  }
+
+  uint64_t maxNanoseconds(RLLTimedPhase phase) const
+  {
+    return phases_[static_cast<size_t>(phase)].max_ns.load(std::memory_order_relaxed);
+  }
+
+  uint64_t counter(RLLPhaseCounter counter) const
+  {
+    return counters_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+  }
+
+  // percentile in [0, 100] of the samples of a phase that are still in the ring buffer, zero if there are none
+  uint64_t percentileNanoseconds(RLLTimedPhase phase, double percentile) const;
+
+  // multi-line summary of all phases and counters, phases without samples are omitted
+  std::string summary() const;
+
+  // must not be called concurrently with record()
+  void reset();
+
+  static const char* phaseName(RLLTimedPhase phase);
+  static const char* counterName(RLLPhaseCounter counter);
+
+private:
+  static const size_t NUM_PHASES = static_cast<size_t>(RLLTimedPhase::NUM_PHASES);
+  static const size_t NUM_COUNTERS = static_cast<size_t>(RLLPhaseCounter::NUM_COUNTERS);
+  // the upper byte of a ring buffer entry holds the phase + 1, so that zero marks an empty entry
+  static const int PHASE_SHIFT = 56;
+  static const uint64_t DURATION_MASK = (uint64_t(1) << PHASE_SHIFT) - 1;
+
+  struct PhaseTotals
+  {
+    std::atomic<uint64_t> num_samples{ 0 };
+    std::atomic<uint64_t> total_ns{ 0 };
+    std::atomic<uint64_t> max_ns{ 0 };
+  };
+
+  std::array<PhaseTotals, NUM_PHASES> phases_;
+  std::array<std::atomic<uint64_t>, NUM_COUNTERS> counters_;
+  std::array<std::atomic<uint64_t>, RING_BUFFER_SIZE> ring_buffer_;
+  std::atomic<uint64_t> write_index_{ 0 };
+};
+
+#endif  // RLL_MOVE_PHASE_TIMERS_H
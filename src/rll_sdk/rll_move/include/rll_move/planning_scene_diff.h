@@ -0,0 +1,68 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_PLANNING_SCENE_DIFF_H
+#define RLL_MOVE_PLANNING_SCENE_DIFF_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <moveit_msgs/PlanningScene.h>
+
+// Batches collision object changes into one planning scene diff. Objects whose geometry was already sent are only
+// moved, i.e. the diff contains their new poses but no shapes, so that move_group does not have to process the full
+// geometry again. Attaching and detaching reuses the geometry that move_group already knows as well.
+class RLLPlanningSceneDiff
+{
+public:
+  // an ADD for unknown objects or objects with changed geometry, a MOVE otherwise
+  void addOrMove(const moveit_msgs::CollisionObject& object);
+  void remove(const std::string& id);
+  // moves the world object to the link keeping its current pose, the geometry is only sent for unknown objects
+  void attach(const moveit_msgs::CollisionObject& object, const std::string& link_name,
+              const std::vector<std::string>& touch_links);
+  // moves an attached object back to the world, keeping its current pose
+  void detach(const std::string& id, const std::string& link_name);
+
+  bool empty() const
+  {
+    return diff_.world.collision_objects.empty() && diff_.robot_state.attached_collision_objects.empty();
+  }
+
+  // the batched changes, they are considered to be sent afterwards
+  moveit_msgs::PlanningScene take();
+
+  // forget which geometries were sent, e.g. after a failed update, the next changes then send full objects
+  void reset();
+
+  bool isKnown(const std::string& id) const
+  {
+    return known_geometries_.find(id) != known_geometries_.end();
+  }
+
+private:
+  static bool sameGeometry(const moveit_msgs::CollisionObject& lhs, const moveit_msgs::CollisionObject& rhs);
+
+  static moveit_msgs::CollisionObject geometryOf(const moveit_msgs::CollisionObject& object);
+
+  moveit_msgs::PlanningScene diff_;
+  // the sent world and attached objects without their poses
+  std::map<std::string, moveit_msgs::CollisionObject> known_geometries_, attached_geometries_;
+};
+
+#endif  // RLL_MOVE_PLANNING_SCENE_DIFF_H
@@ -0,0 +1,157 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_SERVICE_METRICS_H
+#define RLL_MOVE_SERVICE_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <rll_move/phase_timers.h>
+
+/**
+ * Cumulative metrics of the interface for monitoring the live cell.
+ *
+ * Per service the calls, the calls currently in execution, a histogram of the returned error codes and a latency
+ * histogram are kept, in addition to the job durations and statuses and the IK success rate. Like RLLPhaseTimers
+ * everything is recorded with relaxed atomics from any thread, only the first call of a service takes a lock to create
+ * its entry. Unlike the phase timers the metrics are never reset, so they can be scraped as monotonic counters.
+ */
+class RLLServiceMetrics
+{
+public:
+  static const size_t NUM_LATENCY_BUCKETS = 14;
+  // upper bounds of the latency buckets in seconds, slower samples are only contained in the count
+  static const std::array<double, NUM_LATENCY_BUCKETS> LATENCY_BUCKET_BOUNDS;
+  static const size_t NUM_ERROR_CODES = 256;
+  static const size_t NUM_JOB_STATUSES = 3;
+
+  class LatencyHistogram
+  {
+  public:
+    void record(std::chrono::steady_clock::duration duration);
+
+    uint64_t count() const
+    {
+      return count_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t totalNanoseconds() const
+    {
+      return total_ns_.load(std::memory_order_relaxed);
+    }
+
+    // samples in the bucket, not cumulative
+    uint64_t bucket(size_t i) const
+    {
+      return buckets_[i].load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::array<std::atomic<uint64_t>, NUM_LATENCY_BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> total_ns_{ 0 };
+  };
+
+  class Service
+  {
+  public:
+    void begin()
+    {
+      in_flight_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void end(uint8_t error_code, std::chrono::steady_clock::duration duration);
+
+    uint64_t calls() const
+    {
+      return latency_.count();
+    }
+
+    int64_t inFlight() const
+    {
+      return in_flight_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t errorCodeCount(uint8_t error_code) const
+    {
+      return error_codes_[error_code].load(std::memory_order_relaxed);
+    }
+
+    const LatencyHistogram& latency() const
+    {
+      return latency_;
+    }
+
+  private:
+    std::atomic<int64_t> in_flight_{ 0 };
+    std::array<std::atomic<uint64_t>, NUM_ERROR_CODES> error_codes_{};
+    LatencyHistogram latency_;
+  };
+
+  // the entry is created on first use and stays valid for the lifetime of the metrics
+  Service* service(const std::string& name);
+
+  void recordJob(uint8_t job_status, std::chrono::steady_clock::duration duration);
+
+  void countIK(bool solved)
+  {
+    ik_requests_.fetch_add(1, std::memory_order_relaxed);
+    if (!solved)
+    {
+      ik_failures_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t ikRequests() const
+  {
+    return ik_requests_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t ikFailures() const
+  {
+    return ik_failures_.load(std::memory_order_relaxed);
+  }
+
+  // service calls currently in execution over all services
+  int64_t inFlight() const;
+
+  // Prometheus text exposition format, the phase timers of the current job are added as summaries
+  std::string prometheusText(const RLLPhaseTimers& phase_timers) const;
+
+  // short key-value pairs, e.g. for a diagnostics status
+  std::vector<std::pair<std::string, std::string>> summaryValues() const;
+
+private:
+  mutable std::mutex services_mutex_;
+  std::map<std::string, std::unique_ptr<Service>> services_;
+
+  std::array<std::atomic<uint64_t>, NUM_JOB_STATUSES> job_statuses_{};
+  LatencyHistogram job_duration_;
+  std::atomic<uint64_t> ik_requests_{ 0 };
+  std::atomic<uint64_t> ik_failures_{ 0 };
+};
+
+#endif  // RLL_MOVE_SERVICE_METRICS_H
@@ -0,0 +1,41 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_SHARED_ROBOT_MODEL_H
+#define RLL_MOVE_SHARED_ROBOT_MODEL_H
+
+#include <string>
+
+#include <moveit/move_group_interface/move_group_interface.h>
+#include <moveit/planning_scene_monitor/planning_scene_monitor.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+
+// Process-wide robot model and planning scene monitor. Otherwise every move group interface and planning scene
+// monitor of a process loads its own copy of the robot model, including the collision geometry and the kinematics
+// solvers. All users of the same robot description get the same instances, which live as long as one user keeps a
+// reference. The loader owns the kinematics plugins, so it has to be kept as long as the model is used.
+robot_model_loader::RobotModelLoaderPtr getSharedRobotModelLoader(const std::string& robot_description =
+                                                                      "robot_description");
+planning_scene_monitor::PlanningSceneMonitorPtr getSharedPlanningSceneMonitor(const std::string& robot_description =
+                                                                                  "robot_description");
+
+// options for a move group interface that uses the shared robot model instead of loading its own
+moveit::planning_interface::MoveGroupInterface::Options
+sharedMoveGroupOptions(const std::string& group_name,
+                       const robot_model_loader::RobotModelLoaderPtr& robot_model_loader);
+
+#endif  // RLL_MOVE_SHARED_ROBOT_MODEL_H
@@ -0,0 +1,96 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RLL_MOVE_SPHERE_PROXY_CHECK_H
+#define RLL_MOVE_SPHERE_PROXY_CHECK_H
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <moveit/planning_scene/planning_scene.h>
+
+#include <rll_move/distance_field_pre_check.h>
+
+/**
+ * Two-tier collision check of the states along one path with a sphere model of the robot.
+ *
+ * The moving links of the distance field pre-check and the bodies attached to the robot, e.g. the grasp object, are
+ * covered by outer spheres and approximated from inside by inner spheres. A state is rejected if an inner sphere
+ * penetrates an obstacle of the field. If all outer spheres of a body keep clear of the field, the body cannot touch
+ * any of its obstacles and these pairs are skipped by the exact collision check. The exact check therefore only runs
+ * for self-collisions and for the bodies with ambiguous distances, its result is the same as without the proxies.
+ *
+ * The field and the attached bodies are taken when the check is created, so it is only valid as long as the planning
+ * scene does not change, i.e. for one path. It is not thread-safe, each path gets its own check.
+ */
+class RLLSphereProxyCheck
+{
+public:
+  // the largest distance stored in the field, outer spheres of the robot links are up to ~0.1 m large
+  static const double MAX_DISTANCE;
+
+  RLLSphereProxyCheck(RLLDistanceFieldPreCheck* pre_check, const planning_scene::PlanningScene& planning_scene,
+                      const robot_state::RobotState& state);
+
+  bool isStateValid(const robot_state::RobotState& state);
+
+  size_t numRejected() const
+  {
+    return num_rejected_;
+  }
+  size_t numCleared() const
+  {
+    return num_cleared_;
+  }
+  size_t numChecked() const
+  {
+    return num_checked_;
+  }
+
+private:
+  struct Body
+  {
+    std::string name;
+    const moveit::core::LinkModel* link;
+    std::vector<RLLDistanceFieldPreCheck::Sphere> inner;
+    std::vector<RLLDistanceFieldPreCheck::Sphere> outer;
+    bool usable;   // covered by outer spheres and not allowed to touch any obstacle of the field
+    bool cleared;  // the collisions with the field obstacles are currently allowed in acm_
+  };
+
+  void addBody(const std::string& name, const moveit::core::LinkModel* link,
+               std::vector<RLLDistanceFieldPreCheck::Sphere> inner, std::vector<RLLDistanceFieldPreCheck::Sphere> outer,
+               bool covered, const std::set<std::string>& touch_links);
+  bool sphereClear(const Eigen::Vector3d& center, double radius) const;
+
+  const planning_scene::PlanningScene& planning_scene_;
+  std::shared_ptr<const RLLDistanceFieldPreCheck::Field> field_;
+  collision_detection::AllowedCollisionMatrix acm_;
+  std::vector<Body> bodies_;
+  Eigen::Vector3d field_min_;
+  Eigen::Vector3d field_max_;
+  double obstacle_padding_ = 0.0;
+
+  size_t num_rejected_ = 0;
+  size_t num_cleared_ = 0;
+  size_t num_checked_ = 0;
+};
+
+#endif  // RLL_MOVE_SPHERE_PROXY_CHECK_H
@@ -0,0 +1,69 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_TIME_PARAMETERIZATION_CACHE_H
+#define RLL_MOVE_TIME_PARAMETERIZATION_CACHE_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <moveit_msgs/RobotTrajectory.h>
+
+// Results of the time parameterization of joint space paths that are executed repeatedly, e.g. the approach and
+// retreat moves of pick-place or the reset moves. Paths are looked up by a hash of their joint names, positions and
+// the scaling factors and have to match exactly. Once full, the oldest result is dropped.
+class RLLTimeParameterizationCache
+{
+public:
+  static const size_t MAX_ENTRIES = 32;
+
+  bool lookup(const moveit_msgs::RobotTrajectory& path, double velocity_scaling, double acceleration_scaling,
+              moveit_msgs::RobotTrajectory* timed_trajectory) const;
+  // replaces the result for an identical path
+  void insert(const moveit_msgs::RobotTrajectory& path, double velocity_scaling, double acceleration_scaling,
+              const moveit_msgs::RobotTrajectory& timed_trajectory);
+  void clear()
+  {
+    entries_.clear();
+  }
+  size_t size() const
+  {
+    return entries_.size();
+  }
+
+  static uint64_t hash(const moveit_msgs::RobotTrajectory& path, double velocity_scaling, double acceleration_scaling);
+
+private:
+  struct Entry
+  {
+    uint64_t hash;
+    double velocity_scaling;
+    double acceleration_scaling;
+    std::vector<std::string> joint_names;
+    std::vector<std::vector<double>> positions;
+    moveit_msgs::RobotTrajectory timed_trajectory;
+  };
+
+  // index of the matching entry, size() if there is none
+  size_t find(uint64_t hash, const moveit_msgs::RobotTrajectory& path, double velocity_scaling,
+              double acceleration_scaling) const;
+
+  std::deque<Entry> entries_;
+};
+
+#endif  // RLL_MOVE_TIME_PARAMETERIZATION_CACHE_H
@@ -0,0 +1,71 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RLL_MOVE_TRAJECTORY_CACHE_H
+#define RLL_MOVE_TRAJECTORY_CACHE_H
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include <moveit_msgs/RobotTrajectory.h>
+
+// Time parameterized trajectories of transitions that are executed repeatedly, e.g. when resetting the robot between
+// jobs. Trajectories are looked up by their first and last joint positions, a replayed trajectory has to be checked
+// against the current planning scene first. A lookup makes the trajectory the newest one, once full, the least recently
+// used trajectory is dropped.
+class RLLTrajectoryCache
+{
+public:
+  static const size_t MAX_ENTRIES = 16;
+  static const double DEFAULT_TOLERANCE;
+
+  explicit RLLTrajectoryCache(double tolerance = DEFAULT_TOLERANCE) : tolerance_(tolerance)
+  {
+  }
+
+  bool lookup(const std::vector<double>& start, const std::vector<double>& goal,
+              moveit_msgs::RobotTrajectory* trajectory);
+  // the goal is matched by a predicate on the last joint positions, e.g. for linear motions to a pose
+  bool lookup(const std::vector<double>& start, const std::function<bool(const std::vector<double>&)>& goal_matches,
+              moveit_msgs::RobotTrajectory* trajectory);
+  // replaces a trajectory with matching start and goal
+  void insert(const moveit_msgs::RobotTrajectory& trajectory);
+  void erase(const std::vector<double>& start, const std::vector<double>& goal);
+  void clear()
+  {
+    entries_.clear();
+  }
+  size_t size() const
+  {
+    return entries_.size();
+  }
+
+private:
+  // index of the matching trajectory, size() if there is none
+  size_t find(const std::vector<double>& start, const std::vector<double>& goal) const;
+  size_t find(const std::vector<double>& start,
+              const std::function<bool(const std::vector<double>&)>& goal_matches) const;
+  bool lookup(size_t i, moveit_msgs::RobotTrajectory* trajectory);
+  bool withinTolerance(const std::vector<double>& lhs, const std::vector<double>& rhs) const;
+
+  double tolerance_;
+  std::deque<moveit_msgs::RobotTrajectory> entries_;
+};
+
+#endif  // RLL_MOVE_TRAJECTORY_CACHE_H
@@ -0,0 +1,72 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_TRAJECTORY_COMPRESSION_H
+#define RLL_MOVE_TRAJECTORY_COMPRESSION_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <trajectory_msgs/JointTrajectory.h>
+
+/**
+ * Removes points of a time parameterized trajectory that the controller reproduces within tolerance by interpolating
+ * between the remaining points.
+ *
+ * Like the joint trajectory controller, points are interpolated by quintic splines if they have accelerations, by cubic
+ * splines if they only have velocities and linearly otherwise. A point is removed if the spline between the remaining
+ * neighbors deviates less than the joint tolerance from it and, if a Cartesian error is given, less than the Cartesian
+ * tolerance.
+ */
+class RLLTrajectoryCompression
+{
+public:
+  // bounds the cost of compressing long trajectories
+  static const size_t MAX_REMOVED_POINTS = 64;
+
+  // Cartesian deviation of the interpolated joint positions from the point with the given index
+  using CartesianError = std::function<double(size_t, const std::vector<double>&)>;
+
+  RLLTrajectoryCompression(double joint_tolerance, double cartesian_tolerance = 0.0,
+                           CartesianError cartesian_error = nullptr)
+    : joint_tolerance_(joint_tolerance)
+    , cartesian_tolerance_(cartesian_tolerance)
+    , cartesian_error_(std::move(cartesian_error))
+  {
+  }
+
+  // returns the number of removed points, the first and last point are always kept
+  size_t compress(trajectory_msgs::JointTrajectory* trajectory) const;
+
+  // positions of the spline between the two points at the given time since the first point
+  static void interpolate(const trajectory_msgs::JointTrajectoryPoint& from,
+                          const trajectory_msgs::JointTrajectoryPoint& to, double duration, double time,
+                          std::vector<double>* positions);
+
+private:
+  // true if the spline from the first to the last point reproduces all points in between
+  bool reproducible(const std::vector<trajectory_msgs::JointTrajectoryPoint>& points, size_t first,
+                    size_t last) const;
+
+  double joint_tolerance_;
+  double cartesian_tolerance_;
+  CartesianError cartesian_error_;
+};
+
+#endif  // RLL_MOVE_TRAJECTORY_COMPRESSION_H
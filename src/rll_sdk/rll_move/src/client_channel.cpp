@@ -0,0 +1,147 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstdlib>
+
+#include <rll_move/client_channel.h>
+
+const char* RLLClientMessage::START_CMD = "start";
+const char* RLLClientMessage::OK_RESP = "ok";
+const char* RLLClientMessage::ERROR_RESP = "error";
+const size_t RLLClientMessage::MAX_LINE_LENGTH;
+
+std::string RLLClientMessage::format() const
+{
+  return command + " " + std::to_string(job_id) + "\n";
+}
+
+bool RLLClientMessage::parse(const std::string& line)
+{
+  size_t separator = line.find(' ');
+  if (separator == 0 || separator == std::string::npos || separator + 1 == line.size())
+  {
+    return false;
+  }
+
+  const char* id_begin = line.c_str() + separator + 1;
+  char* id_end = nullptr;
+  unsigned long id = std::strtoul(id_begin, &id_end, 10);  // NOLINT google-runtime-int
+  if (*id_begin < '0' || *id_begin > '9' || *id_end != '\0' || id > UINT32_MAX)
+  {
+    return false;
+  }
+
+  command = line.substr(0, separator);
+  job_id = static_cast<uint32_t>(id);
+  return true;
+}
+
+bool setClientSocketTimeouts(int socket, int timeout_seconds)
+{
+  struct timeval timeout;
+  timeout.tv_sec = timeout_seconds;
+  timeout.tv_usec = 0;
+
+  if (setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<char*>(&timeout), sizeof(timeout)) < 0)
+  {
+    return false;
+  }
+
+  return setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<char*>(&timeout), sizeof(timeout)) == 0;
+}
+
+bool sendClientMessage(int socket, const RLLClientMessage& msg)
+{
+  std::string data = msg.format();
+  size_t sent = 0;
+  while (sent < data.size())
+  {
+    // a closed connection must not raise SIGPIPE
+    ssize_t result = send(socket, data.c_str() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (result <= 0)
+    {
+      if (result < 0 && errno == EINTR)
+      {
+        continue;
+      }
+      return false;
+    }
+    sent += static_cast<size_t>(result);
+  }
+
+  return true;
+}
+
+void RLLClientMessageReader::append(const char* data, size_t size)
+{
+  buffer_.append(data, size);
+}
+
+bool RLLClientMessageReader::next(RLLClientMessage* msg)
+{
+  while (true)
+  {
+    size_t end = buffer_.find('\n');
+    if (end == std::string::npos)
+    {
+      if (buffer_.size() > RLLClientMessage::MAX_LINE_LENGTH)
+      {
+        buffer_.clear();
+      }
+      return false;
+    }
+
+    std::string line = buffer_.substr(0, end);
+    buffer_.erase(0, end + 1);
+    if (line.size() <= RLLClientMessage::MAX_LINE_LENGTH && msg->parse(line))
+    {
+      return true;
+    }
+  }
+}
+
+RLLClientMessageReader::Status RLLClientMessageReader::receive(int socket, RLLClientMessage* msg)
+{
+  char data[RLLClientMessage::MAX_LINE_LENGTH];
+  while (!next(msg))
+  {
+    ssize_t result = recv(socket, data, sizeof(data), 0);
+    if (result == 0)
+    {
+      return Status::CLOSED;
+    }
+    if (result < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK ? Status::TIMEOUT : Status::CLOSED;
+    }
+    append(data, static_cast<size_t>(result));
+  }
+
+  return Status::MESSAGE;
+}
+
+void RLLClientMessageReader::clear()
+{
+  buffer_.clear();
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <rll_move/conservative_advancement.h>
+
+const size_t RLLConservativeAdvancement::DEFAULT_DISCRETE_RUN;
+
+bool RLLConservativeAdvancement::isPathValid(const size_t num_waypoints)
+{
+  num_collision_checks_ = 0;
+  num_clearance_queries_ = 0;
+
+  size_t i = 0;
+  size_t remaining_discrete = 0;
+  while (i < num_waypoints)
+  {
+    ++num_collision_checks_;
+    if (collision_check_(i))
+    {
+      return false;
+    }
+
+    if (remaining_discrete > 0)
+    {
+      --remaining_discrete;
+      ++i;
+      continue;
+    }
+
+    ++num_clearance_queries_;
+    double clearance = clearance_(i);
+    size_t next = i + 1;
+    while (next < num_waypoints && displacement_(i, next) < clearance)
+    {
+      ++next;
+    }
+
+    if (next == i + 1)
+    {
+      remaining_discrete = discrete_run_;
+    }
+    i = next;
+  }
+
+  return true;
+}
@@ -0,0 +1,125 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+#include <rll_move/const_transform_cache.h>
+
+const double RLLConstTransformCache::TOLERANCE = 1E-09;
+
+RLLConstTransformCache::RLLConstTransformCache(std::string file_name, std::string key)
+  : file_name_(std::move(file_name)), key_(std::move(key))
+{
+}
+
+bool RLLConstTransformCache::load()
+{
+  transforms_.clear();
+
+  std::ifstream file(file_name_);
+  std::string line;
+  if (!std::getline(file, line) || line != key_)
+  {
+    return false;
+  }
+
+  while (std::getline(file, line))
+  {
+    std::istringstream entry(line);
+    std::string name;
+    Transform transform;
+    entry >> name;
+    for (double& value : transform)
+    {
+      entry >> value;
+    }
+
+    if (entry.fail())
+    {
+      transforms_.clear();
+      return false;
+    }
+    transforms_[name] = transform;
+  }
+
+  return true;
+}
+
+bool RLLConstTransformCache::save() const
+{
+  // several interfaces may start at the same time, write to a temporary file and replace the cache file at once
+  std::string tmp_file_name = file_name_ + ".tmp";
+  {
+    std::ofstream file(tmp_file_name);
+    file << key_ << "\n" << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (const auto& entry : transforms_)
+    {
+      file << entry.first;
+      for (double value : entry.second)
+      {
+        file << " " << value;
+      }
+      file << "\n";
+    }
+
+    if (!file.good())
+    {
+      return false;
+    }
+  }
+
+  return std::rename(tmp_file_name.c_str(), file_name_.c_str()) == 0;
+}
+
+bool RLLConstTransformCache::lookup(const std::string& name, Transform* transform) const
+{
+  auto it = transforms_.find(name);
+  if (it == transforms_.end())
+  {
+    return false;
+  }
+
+  *transform = it->second;
+  return true;
+}
+
+bool RLLConstTransformCache::update(const std::string& name, const Transform& transform)
+{
+  auto it = transforms_.find(name);
+  if (it != transforms_.end())
+  {
+    bool changed = false;
+    for (size_t i = 0; i < transform.size(); ++i)
+    {
+      changed = changed || std::fabs(transform[i] - it->second[i]) > TOLERANCE;
+    }
+
+    if (!changed)
+    {
+      return false;
+    }
+  }
+
+  transforms_[name] = transform;
+  return true;
+}
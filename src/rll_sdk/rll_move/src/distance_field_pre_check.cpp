@@ -0,0 +1,410 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include <geometric_shapes/bodies.h>
+#include <geometric_shapes/shape_operations.h>
+#include <ros/ros.h>
+
+#include <rll_move/distance_field_pre_check.h>
+
+namespace
+{
+void hashCombine(size_t* seed, size_t value)
+{
+  *seed ^= value + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+void hashPose(size_t* seed, const Eigen::Isometry3d& pose)
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 4; ++j)
+    {
+      hashCombine(seed, std::hash<double>()(pose(i, j)));
+    }
+  }
+}
+
+// bounding box of the bounding sphere, Melodic bodies cannot compute an AABB
+void extendBounds(const shapes::Shape& shape, const Eigen::Isometry3d& pose, Eigen::Vector3d* min, Eigen::Vector3d* max)
+{
+  std::unique_ptr<bodies::Body> body(bodies::createBodyFromShape(&shape));
+  if (!body)
+  {
+    return;
+  }
+
+  body->setPose(pose);
+  bodies::BoundingSphere sphere;
+  body->computeBoundingSphere(sphere);
+  *min = min->cwiseMin(sphere.center - Eigen::Vector3d::Constant(sphere.radius));
+  *max = max->cwiseMax(sphere.center + Eigen::Vector3d::Constant(sphere.radius));
+}
+}  // namespace
+
+const double RLLDistanceFieldPreCheck::RESOLUTION = 0.025;
+const double RLLDistanceFieldPreCheck::MAX_DISTANCE = 0.15;
+const size_t RLLDistanceFieldPreCheck::MAX_SPHERES_PER_SHAPE = 5;
+const double RLLDistanceFieldPreCheck::DISCRETIZATION_ERROR = std::sqrt(3.0) * RESOLUTION;
+
+RLLDistanceFieldPreCheck::RLLDistanceFieldPreCheck(const moveit::core::JointModelGroup* group, double max_distance)
+  : max_distance_(max_distance)
+{
+  const moveit::core::JointModel* first_joint = group->getActiveJointModels().front();
+  base_link_ = first_joint->getParentLinkModel();
+  moving_links_ = first_joint->getDescendantLinkModels();
+
+  for (const moveit::core::LinkModel* link : moving_links_)
+  {
+    // upper bound of the distance between the link origin and the base link origin
+    double link_reach = 0.0;
+    for (const moveit::core::LinkModel* l = link; l != nullptr && l != base_link_; l = l->getParentLinkModel())
+    {
+      link_reach += l->getJointOriginTransform().translation().norm();
+    }
+
+    const auto& shapes = link->getShapes();
+    if (shapes.empty())
+    {
+      continue;
+    }
+
+    LinkSpheres link_spheres = { link, {}, {}, true };
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+      const Eigen::Isometry3d& origin = link->getCollisionOriginTransforms()[i];
+      double shape_reach = origin.translation().norm() + 0.5 * shapes::computeShapeExtents(shapes[i].get()).norm();
+      reach_ = std::max(reach_, link_reach + shape_reach);
+      addInnerSpheres(link, *shapes[i], origin, &link_spheres.inner);
+      link_spheres.covered = addOuterSpheres(link, *shapes[i], origin, &link_spheres.outer) && link_spheres.covered;
+    }
+    link_spheres_.push_back(std::move(link_spheres));
+  }
+}
+
+void RLLDistanceFieldPreCheck::addInnerSpheres(const moveit::core::LinkModel* link, const shapes::Shape& shape,
+                                               const Eigen::Isometry3d& origin, std::vector<Sphere>* spheres)
+{
+  // spheres of the largest possible radius along the longest axis of the shape, meshes are not covered
+  Eigen::Vector3d axis;
+  double radius, half_length;
+  switch (shape.type)
+  {
+    case shapes::SPHERE:
+      spheres->push_back({ link, origin.translation(), static_cast<const shapes::Sphere&>(shape).radius });
+      return;
+    case shapes::CYLINDER:
+    {
+      const auto& cylinder = static_cast<const shapes::Cylinder&>(shape);
+      axis = Eigen::Vector3d::UnitZ();
+      half_length = 0.5 * cylinder.length;
+      radius = std::min(cylinder.radius, half_length);
+      break;
+    }
+    case shapes::BOX:
+    {
+      Eigen::Vector3d half_size = 0.5 * Eigen::Map<const Eigen::Vector3d>(static_cast<const shapes::Box&>(shape).size);
+      int longest;
+      half_length = half_size.maxCoeff(&longest);
+      axis = Eigen::Vector3d::Unit(longest);
+      radius = half_size.minCoeff();
+      break;
+    }
+    default:
+      return;
+  }
+
+  if (radius <= 0.0)
+  {
+    return;
+  }
+
+  double span = half_length - radius;
+  size_t num_spheres = std::min(MAX_SPHERES_PER_SHAPE, static_cast<size_t>(std::ceil(2.0 * span / radius)) + 1);
+  for (size_t i = 0; i < num_spheres; ++i)
+  {
+    double offset = num_spheres > 1 ? -span + 2.0 * span * i / (num_spheres - 1) : 0.0;
+    spheres->push_back({ link, origin * (offset * axis), radius });
+  }
+}
+
+bool RLLDistanceFieldPreCheck::addOuterSpheres(const moveit::core::LinkModel* link, const shapes::Shape& shape,
+                                               const Eigen::Isometry3d& origin, std::vector<Sphere>* spheres)
+{
+  // the bounding box of the shape is cut into slabs along its longest axis, each slab is covered by one sphere
+  Eigen::Vector3d center = Eigen::Vector3d::Zero();
+  Eigen::Vector3d half_size;
+  bool round = false;
+  switch (shape.type)
+  {
+    case shapes::SPHERE:
+      spheres->push_back({ link, origin.translation(), static_cast<const shapes::Sphere&>(shape).radius });
+      return true;
+    case shapes::CYLINDER:
+    {
+      const auto& cylinder = static_cast<const shapes::Cylinder&>(shape);
+      half_size = Eigen::Vector3d(cylinder.radius, cylinder.radius, 0.5 * cylinder.length);
+      round = true;
+      break;
+    }
+    case shapes::CONE:
+    {
+      const auto& cone = static_cast<const shapes::Cone&>(shape);
+      half_size = Eigen::Vector3d(cone.radius, cone.radius, 0.5 * cone.length);
+      round = true;
+      break;
+    }
+    case shapes::BOX:
+      half_size = 0.5 * Eigen::Map<const Eigen::Vector3d>(static_cast<const shapes::Box&>(shape).size);
+      break;
+    case shapes::MESH:
+    {
+      const auto& mesh = static_cast<const shapes::Mesh&>(shape);
+      if (mesh.vertex_count == 0)
+      {
+        return true;
+      }
+
+      Eigen::Vector3d min = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+      Eigen::Vector3d max = Eigen::Vector3d::Constant(std::numeric_limits<double>::lowest());
+      for (unsigned int i = 0; i < mesh.vertex_count; ++i)
+      {
+        Eigen::Map<const Eigen::Vector3d> vertex(mesh.vertices + 3 * i);
+        min = min.cwiseMin(vertex);
+        max = max.cwiseMax(vertex);
+      }
+      center = 0.5 * (min + max);
+      half_size = 0.5 * (max - min);
+      break;
+    }
+    default:
+      return false;
+  }
+
+  int longest;
+  double half_length = half_size.maxCoeff(&longest);
+  Eigen::Vector3d cross_section = half_size;
+  cross_section[longest] = 0.0;
+  // the cross section of a cylinder along its axis is a circle, not a square
+  double cross_radius = round && longest == 2 ? half_size.x() : cross_section.norm();
+
+  // slabs that are not longer than the cross section is wide keep the spheres tight
+  size_t num_spheres = 1;
+  if (cross_radius > 0.0)
+  {
+    num_spheres = std::min(MAX_SPHERES_PER_SHAPE, static_cast<size_t>(std::ceil(half_length / cross_radius)));
+    num_spheres = std::max<size_t>(num_spheres, 1);
+  }
+
+  double half_slab = half_length / num_spheres;
+  double radius = std::sqrt(half_slab * half_slab + cross_radius * cross_radius);
+  Eigen::Vector3d axis = Eigen::Vector3d::Unit(longest);
+  for (size_t i = 0; i < num_spheres; ++i)
+  {
+    double offset = -half_length + (2 * i + 1) * half_slab;
+    spheres->push_back({ link, origin * (center + offset * axis), radius });
+  }
+  return true;
+}
+
+size_t RLLDistanceFieldPreCheck::worldSignature(const collision_detection::World& world)
+{
+  size_t signature = 0;
+  for (const auto& object : world)
+  {
+    hashCombine(&signature, std::hash<std::string>()(object.first));
+    const auto& shapes = object.second->shapes_;
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+      hashCombine(&signature, shapes[i]->type);
+      Eigen::Vector3d extents = shapes::computeShapeExtents(shapes[i].get());
+      for (int j = 0; j < 3; ++j)
+      {
+        hashCombine(&signature, std::hash<double>()(extents[j]));
+      }
+      hashPose(&signature, object.second->shape_poses_[i]);
+    }
+  }
+
+  return signature;
+}
+
+bool RLLDistanceFieldPreCheck::allowedToCollide(const collision_detection::AllowedCollisionMatrix& acm,
+                                                const std::string& name) const
+{
+  collision_detection::AllowedCollision::Type type;
+  for (const moveit::core::LinkModel* link : moving_links_)
+  {
+    if (acm.getAllowedCollision(name, link->getName(), type) && type != collision_detection::AllowedCollision::NEVER)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void RLLDistanceFieldPreCheck::invalidate()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  up_to_date_ = false;
+}
+
+std::shared_ptr<const RLLDistanceFieldPreCheck::Field>
+RLLDistanceFieldPreCheck::build(const planning_scene::PlanningScene& planning_scene,
+                                const collision_detection::AllowedCollisionMatrix& acm,
+                                const robot_state::RobotState& state) const
+{
+  auto field = std::make_shared<Field>();
+  std::vector<std::pair<const shapes::Shape*, Eigen::Isometry3d>> obstacles;
+  for (const auto& object : *planning_scene.getWorld())
+  {
+    if (allowedToCollide(acm, object.first))
+    {
+      continue;
+    }
+
+    // octrees are not voxelized, the collisions with these objects are never decided by the field
+    bool complete = true;
+    for (size_t i = 0; i < object.second->shapes_.size(); ++i)
+    {
+      if (object.second->shapes_[i]->type != shapes::OCTREE)
+      {
+        obstacles.emplace_back(object.second->shapes_[i].get(), object.second->shape_poses_[i]);
+      }
+      else
+      {
+        complete = false;
+      }
+    }
+    if (complete)
+    {
+      field->obstacles.push_back(object.first);
+    }
+  }
+
+  for (const moveit::core::LinkModel* link : state.getRobotModel()->getLinkModelsWithCollisionGeometry())
+  {
+    if (std::find(moving_links_.begin(), moving_links_.end(), link) != moving_links_.end() ||
+        allowedToCollide(acm, link->getName()))
+    {
+      continue;
+    }
+
+    field->obstacles.push_back(link->getName());
+    for (size_t i = 0; i < link->getShapes().size(); ++i)
+    {
+      obstacles.emplace_back(link->getShapes()[i].get(),
+                             state.getGlobalLinkTransform(link) * link->getCollisionOriginTransforms()[i]);
+    }
+  }
+
+  // the field only covers obstacles within reach, everything outside of it is never rejected
+  Eigen::Vector3d base = state.getGlobalLinkTransform(base_link_).translation();
+  Eigen::Vector3d reach_min = base - Eigen::Vector3d::Constant(reach_ + max_distance_);
+  Eigen::Vector3d reach_max = base + Eigen::Vector3d::Constant(reach_ + max_distance_);
+  Eigen::Vector3d min = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+  Eigen::Vector3d max = Eigen::Vector3d::Constant(std::numeric_limits<double>::lowest());
+  for (const auto& obstacle : obstacles)
+  {
+    extendBounds(*obstacle.first, obstacle.second, &min, &max);
+  }
+  min = min.cwiseMax(reach_min);
+  max = max.cwiseMin(reach_max);
+  if ((min.array() >= max.array()).any())
+  {
+    ROS_INFO("No static obstacles within reach, collision pre-check disabled");
+    return nullptr;
+  }
+
+  Eigen::Vector3d size = max - min;
+  field->distances.reset(new distance_field::PropagationDistanceField(
+      size.x(), size.y(), size.z(), RESOLUTION, min.x(), min.y(), min.z(), max_distance_, true));
+  for (const auto& obstacle : obstacles)
+  {
+    field->distances->addShapeToField(obstacle.first, obstacle.second);
+  }
+
+  ROS_INFO("Built collision pre-check distance field with %d x %d x %d voxels from %zu obstacle shapes",
+           field->distances->getXNumCells(), field->distances->getYNumCells(), field->distances->getZNumCells(),
+           obstacles.size());
+  return field;
+}
+
+std::shared_ptr<const RLLDistanceFieldPreCheck::Field>
+RLLDistanceFieldPreCheck::field(const planning_scene::PlanningScene& planning_scene,
+                                const collision_detection::AllowedCollisionMatrix& acm,
+                                const robot_state::RobotState& state)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t signature = worldSignature(*planning_scene.getWorld());
+  if (!up_to_date_ || signature != world_signature_)
+  {
+    field_ = build(planning_scene, acm, state);
+    world_signature_ = signature;
+    up_to_date_ = true;
+  }
+
+  return field_;
+}
+
+bool RLLDistanceFieldPreCheck::inCollision(const planning_scene::PlanningScene& planning_scene,
+                                           const collision_detection::AllowedCollisionMatrix& acm,
+                                           const robot_state::RobotState& state, std::string* link_name)
+{
+  std::shared_ptr<const Field> current_field = field(planning_scene, acm, state);
+  if (!current_field)
+  {
+    return false;
+  }
+
+  for (const LinkSpheres& link_spheres : link_spheres_)
+  {
+    const Eigen::Isometry3d& link_pose = state.getGlobalLinkTransform(link_spheres.link);
+    for (const Sphere& sphere : link_spheres.inner)
+    {
+      if (sphere.radius <= DISCRETIZATION_ERROR)
+      {
+        continue;
+      }
+
+      Eigen::Vector3d center = link_pose * sphere.center;
+      int x, y, z;
+      if (!current_field->distances->worldToGrid(center.x(), center.y(), center.z(), x, y, z))
+      {
+        continue;
+      }
+
+      if (current_field->distances->getDistance(x, y, z) + DISCRETIZATION_ERROR < sphere.radius)
+      {
+        if (link_name != nullptr)
+        {
+          *link_name = link_spheres.link->getName();
+        }
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
@@ -17,10 +17,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include <eigen_conversions/eigen_msg.h>
 #include <fcl/collision.h>
 #include <rll_move/grasp_object.h>
 
+const double GraspObject::QUERY_RADIUS = .01;
+
 void GraspObject::hasBeenGrasped(const geometry_msgs::Pose& eef_pose, const geometry_msgs::Pose& unattached_object_pose)
 {
   is_currently_attached_ = true;
@@ -57,25 +62,60 @@ bool GraspObject::canBeGrasped(const geometry_msgs::Pose& /*eef_target_pose*/) c
 bool GraspObject::pointInCollisionGeometry(const geometry_msgs::Pose& obj_target_pose,
                                            const geometry_msgs::Point& point) const
 {
-  fcl::Vec3f object_target_pos(obj_target_pose.position.x, obj_target_pose.position.y, obj_target_pose.position.z);
-  fcl::Vec3f test_point(point.x, point.y, point.z);
+  std::vector<bool> in_collision;
+  return pointsInCollisionGeometry(obj_target_pose, { point }, &in_collision) > 0;
+}
+
+size_t GraspObject::pointsInCollisionGeometry(const geometry_msgs::Pose& obj_target_pose,
+                                              const std::vector<geometry_msgs::Point>& points,
+                                              std::vector<bool>* in_collision) const
+{
+  tf::Transform object_tf;
+  tf::poseMsgToTF(obj_target_pose, object_tf);
+  tf::Transform world_to_object = object_tf.inverse();
 
-  fcl::Quaternion3f object_orientation(obj_target_pose.orientation.w, obj_target_pose.orientation.x,
-                                       obj_target_pose.orientation.y, obj_target_pose.orientation.z);
+  size_t collision_points = 0;
+  in_collision->assign(points.size(), false);
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    tf::Vector3 local_point = world_to_object(tf::Vector3(points[i].x, points[i].y, points[i].z));
+    if (localPointInCollisionGeometry(local_point))
+    {
+      (*in_collision)[i] = true;
+      ++collision_points;
+    }
+  }
 
-  fcl::Transform3f object_tf(object_orientation, object_target_pos);
-  fcl::Transform3f point_tf(test_point);
+  return collision_points;
+}
 
-  auto sphere_geometry = fcl::Sphere(.01);
+bool GraspObject::localPointInCollisionGeometry(const tf::Vector3& point) const
+{
+  static const fcl::Sphere QUERY_SPHERE(QUERY_RADIUS);
+  static const fcl::Transform3f OBJECT_TF;
+  static const fcl::CollisionRequest REQUEST(1, false);  // find one collision, don't store details
 
-  fcl::CollisionRequest req(1, false);  // find one collision, don't store details
   fcl::CollisionResult res;
+  fcl::Transform3f point_tf(fcl::Vec3f(point.x(), point.y(), point.z()));
   size_t collision_points =
-      fcl::collide(getBoundingCollisionGeometry(), object_tf, &sphere_geometry, point_tf, req, res);
+      fcl::collide(getBoundingCollisionGeometry(), OBJECT_TF, &QUERY_SPHERE, point_tf, REQUEST, res);
 
   return (collision_points > 0);
 }
 
+bool GraspObject::localPointInBox(const tf::Vector3& point, const fcl::Vec3f& side)
+{
+  // distance to the closest point of the box
+  double distance_squared = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    double outside = std::max(std::fabs(point[i]) - side[i] / 2, 0.0);
+    distance_squared += outside * outside;
+  }
+
+  return distance_squared <= QUERY_RADIUS * QUERY_RADIUS;
+}
+
 geometry_msgs::Pose GraspObject::getObjectPoseForEEFPose(const geometry_msgs::Pose& eef_pose) const
 {
   geometry_msgs::Pose object_pose = getCenterPose();
@@ -140,3 +180,12 @@ void CylinderGraspObject::onUpdateDataFromCollisionObject(const moveit_msgs::Col
   box_dimensions_.y = radius_ * 2;
   box_dimensions_.z = height_;
 }
+
+bool CylinderGraspObject::localPointInCollisionGeometry(const tf::Vector3& point) const
+{
+  // the cylinder axis is the z axis, distance to the closest point of the cylinder
+  double radial_outside = std::max(std::hypot(point.x(), point.y()) - fcl_cylinder_.radius, 0.0);
+  double axial_outside = std::max(std::fabs(point.z()) - fcl_cylinder_.lz / 2, 0.0);
+
+  return radial_outside * radial_outside + axial_outside * axial_outside <= QUERY_RADIUS * QUERY_RADIUS;
+}
@@ -25,9 +25,7 @@
 #include <fcl/shape/geometric_shapes.h>
 #include <tf/tf.h>
 
-// for mesh objects
-#include <geometric_shapes/shape_operations.h>
-#include <geometric_shapes/shapes.h>
+#include <rll_move/mesh_cache.h>
 
 #define ALLOWED_ROTATION_DEVIATION (.01)
 
@@ -48,21 +46,15 @@ CollisionObjectBuilder& CollisionObjectBuilder::begin()
 
 CollisionObjectBuilder& CollisionObjectBuilder::addMesh(const std::string& file_path, double scale)
 {
-  // Path where the .dae or .stl object is located
-  shapes::Mesh* m = shapes::createMeshFromResource(file_path, { scale, scale, scale });
-  if (m == nullptr)
+  // Path where the .dae or .stl object is located, each file is only parsed once per scale
+  RLLMeshCache::MeshPtr mesh = RLLMeshCache::instance().get(file_path, scale);
+  if (mesh == nullptr)
   {
-    ROS_FATAL("Your mesh '%s' failed to loaded", file_path.c_str());
     return *this;
   }
 
-  shape_msgs::Mesh mesh;
-  shapes::ShapeMsg mesh_msg;
-  shapes::constructMsgFromShape(m, mesh_msg);  // TODO(mark): who owns this pointer?! should I delete it?
-  mesh = boost::get<shape_msgs::Mesh>(mesh_msg);
-
-  // TODO(mark): isn't it super expensive to always copy the mesh around?
-  object_.meshes.push_back(mesh);
+  // the collision object message needs its own copy
+  object_.meshes.push_back(mesh->msg);
   is_primitive_ = false;
 
   return *this;
@@ -0,0 +1,70 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cmath>
+
+#include <rll_move/ik_cache.h>
+
+const size_t RLLIKCache::MAX_ENTRIES;
+const double RLLIKCache::RESOLUTION = 1E-06;
+
+RLLIKCache::Key RLLIKCache::key(const geometry_msgs::Pose& pose, const RLLKinGlobalConfig& seed_config)
+{
+  auto quantize = [](double value) { return static_cast<int64_t>(std::llround(value / RESOLUTION)); };
+  return { quantize(pose.position.x),    quantize(pose.position.y),    quantize(pose.position.z),
+           quantize(pose.orientation.x), quantize(pose.orientation.y), quantize(pose.orientation.z),
+           quantize(pose.orientation.w), seed_config.val() };
+}
+
+bool RLLIKCache::lookup(const geometry_msgs::Pose& pose, const RLLKinGlobalConfig& seed_config,
+                        RLLKinSolutions* solutions) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key(pose, seed_config));
+  if (it == entries_.end())
+  {
+    return false;
+  }
+
+  *solutions = it->second;
+  return true;
+}
+
+void RLLIKCache::insert(const geometry_msgs::Pose& pose, const RLLKinGlobalConfig& seed_config,
+                        const RLLKinSolutions& solutions)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.size() >= MAX_ENTRIES)
+  {
+    entries_.clear();
+  }
+
+  entries_[key(pose, seed_config)] = solutions;
+}
+
+void RLLIKCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+}
+
+size_t RLLIKCache::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
@@ -0,0 +1,175 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/bind.hpp>
+
+#include <rll_move/job_dispatcher.h>
+#include <rll_move/move_iface_base.h>
+
+namespace
+{
+rll_msgs::JobEnvResult internalErrorResult(const std::string& detail)
+{
+  rll_msgs::JobEnvResult result;
+  result.job.status = rll_msgs::JobStatus::INTERNAL_ERROR;
+  result.job.status_detail = detail;
+  return result;
+}
+}  // namespace
+
+RLLJobDispatcher::RLLJobDispatcher(ros::NodeHandle* nh, const std::vector<std::string>& instance_namespaces)
+  : server_(*nh, RLLMoveIfaceBase::RUN_JOB_SRV_NAME, boost::bind(&RLLJobDispatcher::goalCallback, this, _1),
+            boost::bind(&RLLJobDispatcher::cancelCallback, this, _1), false)
+{
+  for (const auto& ns : instance_namespaces)
+  {
+    std::unique_ptr<Instance> instance(new Instance);
+    instance->ns = ns;
+    instance->job_client.reset(new JobClient(*nh, ns + "/" + RLLMoveIfaceBase::RUN_JOB_SRV_NAME, false));
+    instance->idle_client.reset(new JobClient(*nh, ns + "/" + RLLMoveIfaceBase::IDLE_JOB_SRV_NAME, false));
+    instances_.push_back(std::move(instance));
+  }
+}
+
+bool RLLJobDispatcher::waitForInstances(const ros::Duration& timeout)
+{
+  for (const auto& instance : instances_)
+  {
+    if (!instance->job_client->waitForServer(timeout) || !instance->idle_client->waitForServer(timeout))
+    {
+      ROS_FATAL("The job actions of the instance '%s' are not available", instance->ns.c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void RLLJobDispatcher::start()
+{
+  server_.start();
+  ROS_INFO("Dispatching jobs to %lu instances", instances_.size());
+}
+
+void RLLJobDispatcher::goalCallback(JobServer::GoalHandle job)
+{
+  if (allInstancesFailed())
+  {
+    job.setAccepted();
+    job.setSucceeded(internalErrorResult("no instance available"));
+    return;
+  }
+
+  job.setAccepted();
+  pending_jobs_.push_back(job);
+  ROS_INFO("Queued job, %lu jobs pending", pending_jobs_.size());
+  dispatchJobs();
+}
+
+void RLLJobDispatcher::cancelCallback(JobServer::GoalHandle job)
+{
+  for (auto it = pending_jobs_.begin(); it != pending_jobs_.end(); ++it)
+  {
+    if (*it == job)
+    {
+      pending_jobs_.erase(it);
+      job.setCanceled();
+      return;
+    }
+  }
+
+  // the move interface cannot abort a running job, it ends with the job execution timeout at the latest
+  ROS_WARN("Cannot cancel a job that is already running");
+}
+
+void RLLJobDispatcher::dispatchJobs()
+{
+  for (const auto& instance : instances_)
+  {
+    if (pending_jobs_.empty())
+    {
+      return;
+    }
+    if (instance->busy || instance->failed)
+    {
+      continue;
+    }
+
+    instance->job = pending_jobs_.front();
+    pending_jobs_.pop_front();
+    instance->busy = true;
+    ROS_INFO("Running job on instance '%s'", instance->ns.c_str());
+    instance->job_client->sendGoal(*instance->job.getGoal(),
+                                   boost::bind(&RLLJobDispatcher::jobDone, this, instance.get(), _1, _2));
+  }
+}
+
+void RLLJobDispatcher::jobDone(Instance* instance, const actionlib::SimpleClientGoalState& state,
+                               const rll_msgs::JobEnvResultConstPtr& result)
+{
+  if (state != actionlib::SimpleClientGoalState::SUCCEEDED || !result)
+  {
+    ROS_ERROR("Job on instance '%s' ended in state %s", instance->ns.c_str(), state.toString().c_str());
+    instance->job.setSucceeded(internalErrorResult("job action failed"));
+  }
+  else
+  {
+    instance->job.setSucceeded(*result);
+  }
+
+  // reset the instance for the next job, as after each job that is run with rll_tools
+  rll_msgs::JobEnvGoal idle_goal;
+  idle_goal.authentication_secret = instance->job.getGoal()->authentication_secret;
+  instance->idle_client->sendGoal(idle_goal, boost::bind(&RLLJobDispatcher::idleDone, this, instance, _1, _2));
+}
+
+void RLLJobDispatcher::idleDone(Instance* instance, const actionlib::SimpleClientGoalState& state,
+                                const rll_msgs::JobEnvResultConstPtr& result)
+{
+  instance->busy = false;
+  if (state != actionlib::SimpleClientGoalState::SUCCEEDED || !result ||
+      result->job.status == rll_msgs::JobStatus::INTERNAL_ERROR)
+  {
+    ROS_FATAL("Resetting the instance '%s' failed, it won't receive further jobs", instance->ns.c_str());
+    instance->failed = true;
+  }
+
+  if (allInstancesFailed())
+  {
+    while (!pending_jobs_.empty())
+    {
+      pending_jobs_.front().setSucceeded(internalErrorResult("no instance available"));
+      pending_jobs_.pop_front();
+    }
+    return;
+  }
+
+  dispatchJobs();
+}
+
+bool RLLJobDispatcher::allInstancesFailed() const
+{
+  for (const auto& instance : instances_)
+  {
+    if (!instance->failed)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
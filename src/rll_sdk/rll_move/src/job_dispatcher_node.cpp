@@ -0,0 +1,45 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <rll_move/job_dispatcher.h>
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "job_dispatcher");
+  ros::NodeHandle nh;
+
+  std::vector<std::string> instances;
+  if (!ros::param::get("~instances", instances) || instances.empty())
+  {
+    ROS_FATAL("No instances specified, set ~instances to the namespaces of the cell instances");
+    return 1;
+  }
+
+  // a single thread processes all callbacks, see RLLJobDispatcher
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+
+  RLLJobDispatcher dispatcher(&nh, instances);
+  if (!dispatcher.waitForInstances(ros::Duration(30)))
+  {
+    return 1;
+  }
+
+  dispatcher.start();
+  ros::waitForShutdown();
+  return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <ros/console.h>
+
+#include <rll_move/job_recorder.h>
+
+const char RLLJobRecorder::MAGIC[8] = { 'R', 'L', 'L', 'J', 'O', 'B', 'L', 'G' };
+const uint32_t RLLJobRecorder::VERSION;
+
+namespace
+{
+struct FileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+const size_t RECORD_ALIGNMENT = 8;
+// the records are buffered, a job usually fits into a few writes
+const size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+size_t paddedSize(size_t size)
+{
+  return (size + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT;
+}
+}  // namespace
+
+RLLJobRecorder::~RLLJobRecorder()
+{
+  close();
+}
+
+bool RLLJobRecorder::open(const std::string& file_name)
+{
+  close();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_ = std::fopen(file_name.c_str(), "wb");
+  if (file_ == nullptr)
+  {
+    ROS_ERROR("failed to open the job log %s: %s", file_name.c_str(), std::strerror(errno));
+    return false;
+  }
+
+  std::setvbuf(file_, nullptr, _IOFBF, WRITE_BUFFER_SIZE);
+  FileHeader header = {};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  std::fwrite(&header, sizeof(header), 1, file_);
+  recording_ = true;
+  return true;
+}
+
+void RLLJobRecorder::close()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  recording_ = false;
+  if (file_ != nullptr)
+  {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+void RLLJobRecorder::recordJobStart(const moveit_msgs::PlanningScene& planning_scene,
+                                    const std::vector<double>& joint_values)
+{
+  if (!recording_)
+  {
+    return;
+  }
+
+  std::vector<uint8_t> scene;
+  serialize(planning_scene, &scene);
+  write(RLLJobLogRecordType::JOB_START, "", scene, {}, ros::WallTime::now(), ros::WallDuration(), 0, joint_values);
+}
+
+void RLLJobRecorder::recordJobEnd(int32_t job_status)
+{
+  if (!recording_)
+  {
+    return;
+  }
+
+  write(RLLJobLogRecordType::JOB_END, "", {}, {}, ros::WallTime::now(), ros::WallDuration(), job_status, {});
+}
+
+void RLLJobRecorder::write(RLLJobLogRecordType type, const std::string& name, const std::vector<uint8_t>& request,
+                           const std::vector<uint8_t>& response, ros::WallTime start, ros::WallDuration duration,
+                           int32_t error_code, const std::vector<double>& joint_values)
+{
+  RLLJobLogRecordHeader header = {};
+  header.type = type;
+  header.name_size = name.size();
+  header.request_size = request.size();
+  header.response_size = response.size();
+  header.start_ns = start.toNSec();
+  header.duration_ns = duration.toNSec();
+  header.error_code = error_code;
+  header.num_joints = std::min(joint_values.size(), static_cast<size_t>(RLL_NUM_JOINTS));
+  std::copy_n(joint_values.begin(), header.num_joints, header.joint_values);
+
+  size_t payload_size = name.size() + request.size() + response.size();
+  const char padding[RECORD_ALIGNMENT] = {};
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (file_ == nullptr)
+  {
+    return;
+  }
+
+  std::fwrite(&header, sizeof(header), 1, file_);
+  std::fwrite(name.data(), 1, name.size(), file_);
+  std::fwrite(request.data(), 1, request.size(), file_);
+  std::fwrite(response.data(), 1, response.size(), file_);
+  std::fwrite(padding, 1, paddedSize(payload_size) - payload_size, file_);
+}
+
+RLLJobLogReader::~RLLJobLogReader()
+{
+  close();
+}
+
+bool RLLJobLogReader::open(const std::string& file_name)
+{
+  close();
+
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    ROS_ERROR("failed to open the job log %s: %s", file_name.c_str(), std::strerror(errno));
+    return false;
+  }
+
+  struct stat file_stat = {};
+  if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(FileHeader))
+  {
+    ROS_ERROR("job log %s is too short", file_name.c_str());
+    ::close(fd);
+    return false;
+  }
+
+  size_ = file_stat.st_size;
+  void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    ROS_ERROR("failed to map the job log %s: %s", file_name.c_str(), std::strerror(errno));
+    size_ = 0;
+    return false;
+  }
+  data_ = static_cast<uint8_t*>(mapping);
+
+  const auto* file_header = reinterpret_cast<const FileHeader*>(data_);
+  if (std::memcmp(file_header->magic, RLLJobRecorder::MAGIC, sizeof(RLLJobRecorder::MAGIC)) != 0 ||
+      file_header->version != RLLJobRecorder::VERSION)
+  {
+    ROS_ERROR("%s is not a job log of version %u", file_name.c_str(), RLLJobRecorder::VERSION);
+    close();
+    return false;
+  }
+
+  size_t offset = sizeof(FileHeader);
+  while (offset + sizeof(RLLJobLogRecordHeader) <= size_)
+  {
+    const auto* header = reinterpret_cast<const RLLJobLogRecordHeader*>(data_ + offset);
+    size_t payload_size = static_cast<size_t>(header->name_size) + header->request_size + header->response_size;
+    size_t record_size = sizeof(RLLJobLogRecordHeader) + paddedSize(payload_size);
+    if (offset + record_size > size_ || header->num_joints > RLL_NUM_JOINTS)
+    {
+      ROS_WARN("job log %s is truncated, skipping the last record", file_name.c_str());
+      break;
+    }
+
+    const uint8_t* payload = data_ + offset + sizeof(RLLJobLogRecordHeader);
+    Record record;
+    record.header = header;
+    record.name.assign(reinterpret_cast<const char*>(payload), header->name_size);
+    record.request = payload + header->name_size;
+    record.response = record.request + header->request_size;
+    records_.push_back(std::move(record));
+    offset += record_size;
+  }
+
+  return true;
+}
+
+void RLLJobLogReader::close()
+{
+  records_.clear();
+  if (data_ != nullptr)
+  {
+    munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
@@ -0,0 +1,26 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <rll_move/job_replay.h>
+#include <rll_move/move_iface_default_simulation.h>
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "job_replay");
+  // nothing is executed, so the execution backend of the interface does not matter
+  return runJobReplay<RLLDefaultMoveIface>(argc, argv);
+}
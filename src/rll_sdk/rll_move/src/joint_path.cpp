@@ -0,0 +1,50 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <rll_move/joint_path.h>
+
+const size_t RLLJointPath::MIN_STEPS_FOR_JUMP_THRESH;
+
+double RLLJointPath::testRelativeJointSpaceJump(const Distance& distance, const double jump_threshold_factor)
+{
+  size_t num_waypoints = size();
+  if (num_waypoints < MIN_STEPS_FOR_JUMP_THRESH)
+  {
+    return 1.0;
+  }
+
+  std::vector<double> steps(num_waypoints - 1);
+  double total_distance = 0.0;
+  for (size_t i = 1; i < num_waypoints; ++i)
+  {
+    steps[i - 1] = distance((*this)[i], (*this)[i - 1]);
+    total_distance += steps[i - 1];
+  }
+
+  double threshold = jump_threshold_factor * total_distance / static_cast<double>(steps.size());
+  for (size_t i = 0; i < steps.size(); ++i)
+  {
+    if (steps[i] > threshold)
+    {
+      resize(i + 1);
+      return static_cast<double>(i + 1) / static_cast<double>(num_waypoints);
+    }
+  }
+
+  return 1.0;
+}
@@ -0,0 +1,227 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include <rll_move/joint_state_monitor.h>
+
+namespace
+{
+// joints that move less than this between two joint states are considered at rest
+const double MOTION_TOLERANCE = 1E-04;
+
+bool withinTolerance(const std::vector<double>& lhs, const std::vector<double>& rhs, double tolerance)
+{
+  for (size_t i = 0; i < lhs.size(); ++i)
+  {
+    if (std::fabs(lhs[i] - rhs[i]) >= tolerance)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+}  // namespace
+
+const size_t RLLJointStateMonitor::MAX_TRACKED_JOINTS;
+const RLLJointStateMonitor::Duration RLLJointStateMonitor::ROS_TIME_POLL_PERIOD = std::chrono::milliseconds(1);
+
+bool RLLJointStateMonitor::trackJoints(const std::vector<std::string>& joint_names)
+{
+  if (joint_names.size() > MAX_TRACKED_JOINTS)
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  tracked_names_ = joint_names;
+  tracked_scratch_.resize(joint_names.size());
+  tracked_sequence_.store(0, std::memory_order_relaxed);
+  return true;
+}
+
+void RLLJointStateMonitor::useRosTime(bool use_ros_time)
+{
+  use_ros_time_.store(use_ros_time);
+}
+
+std::chrono::steady_clock::time_point RLLJointStateMonitor::now() const
+{
+  if (use_ros_time_.load())
+  {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(ros::Time::now().toNSec())));
+  }
+
+  return std::chrono::steady_clock::now();
+}
+
+void RLLJointStateMonitor::subscribe(ros::NodeHandle* nh, const std::string& topic)
+{
+  joint_states_sub_ = nh->subscribe(topic, 10, &RLLJointStateMonitor::jointStatesCallback, this);
+}
+
+void RLLJointStateMonitor::jointStatesCallback(const sensor_msgs::JointStateConstPtr& msg)
+{
+  update(*msg);
+}
+
+void RLLJointStateMonitor::update(const sensor_msgs::JointState& msg)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t num_joints = std::min(msg.name.size(), msg.position.size());
+    for (size_t i = 0; i < num_joints; ++i)
+    {
+      positions_[msg.name[i]] = msg.position[i];
+    }
+    ++num_updates_;
+    publishTrackedPositions();
+  }
+  updated_.notify_all();
+}
+
+bool RLLJointStateMonitor::positions(const std::vector<std::string>& joint_names, std::vector<double>* joint_positions)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return positionsLocked(joint_names, joint_positions);
+}
+
+bool RLLJointStateMonitor::positionsLocked(const std::vector<std::string>& joint_names,
+                                           std::vector<double>* joint_positions) const
+{
+  joint_positions->resize(joint_names.size());
+  for (size_t i = 0; i < joint_names.size(); ++i)
+  {
+    auto it = positions_.find(joint_names[i]);
+    if (it == positions_.end())
+    {
+      return false;
+    }
+    (*joint_positions)[i] = it->second;
+  }
+
+  return true;
+}
+
+void RLLJointStateMonitor::publishTrackedPositions()
+{
+  if (tracked_names_.empty() || !positionsLocked(tracked_names_, &tracked_scratch_))
+  {
+    return;
+  }
+
+  uint64_t sequence = tracked_sequence_.load(std::memory_order_relaxed) + 1;
+  tracked_sequence_.store(sequence, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < tracked_scratch_.size(); ++i)
+  {
+    tracked_positions_[i].store(tracked_scratch_[i], std::memory_order_relaxed);
+  }
+  tracked_sequence_.store(sequence + 1, std::memory_order_release);
+}
+
+bool RLLJointStateMonitor::trackedPositions(std::vector<double>* joint_positions) const
+{
+  joint_positions->resize(tracked_names_.size());
+  while (true)
+  {
+    uint64_t begin = tracked_sequence_.load(std::memory_order_acquire);
+    if (begin == 0)
+    {
+      return false;
+    }
+    if (begin % 2 == 1)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    for (size_t i = 0; i < joint_positions->size(); ++i)
+    {
+      (*joint_positions)[i] = tracked_positions_[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (tracked_sequence_.load(std::memory_order_relaxed) == begin)
+    {
+      return true;
+    }
+  }
+}
+
+bool RLLJointStateMonitor::waitForGoal(const std::vector<std::string>& joint_names, const std::vector<double>& goal,
+                                       const double tolerance, const Duration timeout, const Duration settle_time)
+{
+  auto deadline = now() + timeout;
+  auto last_motion = std::chrono::steady_clock::time_point::min();
+  std::vector<double> current, at_rest;
+  // evaluate the positions that are already known right away
+  uint64_t seen_updates = std::numeric_limits<uint64_t>::max();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    if (num_updates_ != seen_updates)
+    {
+      seen_updates = num_updates_;
+      if (positionsLocked(joint_names, &current))
+      {
+        if (withinTolerance(current, goal, tolerance))
+        {
+          return true;
+        }
+
+        if (at_rest.empty() || !withinTolerance(current, at_rest, MOTION_TOLERANCE))
+        {
+          at_rest = current;
+          last_motion = now();
+        }
+      }
+    }
+
+    auto time = now();
+    auto wake_up = deadline;
+    if (settle_time > Duration::zero() && !at_rest.empty())
+    {
+      if (time - last_motion >= settle_time)
+      {
+        return true;
+      }
+      wake_up = std::min(wake_up, last_motion + settle_time);
+    }
+
+    if (time >= deadline)
+    {
+      return false;
+    }
+
+    if (use_ros_time_.load())
+    {
+      // the ROS time may advance without joint state updates
+      updated_.wait_for(lock, std::min(wake_up - time, ROS_TIME_POLL_PERIOD));
+    }
+    else
+    {
+      updated_.wait_until(lock, wake_up);
+    }
+  }
+}
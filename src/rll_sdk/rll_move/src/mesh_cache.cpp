@@ -0,0 +1,106 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <geometric_shapes/shape_operations.h>
+#include <geometric_shapes/shapes.h>
+#include <ros/ros.h>
+
+#include <rll_move/mesh_cache.h>
+
+RLLMeshCache& RLLMeshCache::instance()
+{
+  static RLLMeshCache cache;
+  return cache;
+}
+
+RLLMeshCache::MeshPtr RLLMeshCache::get(const std::string& resource, double scale)
+{
+  auto key = std::make_pair(resource, scale);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = meshes_.find(key);
+    if (it != meshes_.end())
+    {
+      return it->second;
+    }
+  }
+
+  // parse without holding the lock, concurrent misses of the same key keep the first mesh
+  MeshPtr mesh = load(resource, scale);
+  if (mesh == nullptr)
+  {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  return meshes_.emplace(key, mesh).first->second;
+}
+
+void RLLMeshCache::prune()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = meshes_.begin(); it != meshes_.end();)
+  {
+    it = it->second.use_count() == 1 ? meshes_.erase(it) : std::next(it);
+  }
+}
+
+size_t RLLMeshCache::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return meshes_.size();
+}
+
+RLLMeshCache::MeshPtr RLLMeshCache::load(const std::string& resource, double scale)
+{
+  std::unique_ptr<shapes::Mesh> shape(shapes::createMeshFromResource(resource, { scale, scale, scale }));
+  if (shape == nullptr)
+  {
+    ROS_FATAL("Your mesh '%s' failed to loaded", resource.c_str());
+    return nullptr;
+  }
+
+  auto mesh = std::make_shared<RLLCachedMesh>();
+  shapes::ShapeMsg shape_msg;
+  shapes::constructMsgFromShape(shape.get(), shape_msg);
+  mesh->msg = boost::get<shape_msgs::Mesh>(shape_msg);
+
+  std::vector<fcl::Vec3f> vertices;
+  vertices.reserve(shape->vertex_count);
+  for (unsigned int i = 0; i < shape->vertex_count; ++i)
+  {
+    vertices.emplace_back(shape->vertices[3 * i], shape->vertices[3 * i + 1], shape->vertices[3 * i + 2]);
+  }
+
+  std::vector<fcl::Triangle> triangles;
+  triangles.reserve(shape->triangle_count);
+  for (unsigned int i = 0; i < shape->triangle_count; ++i)
+  {
+    triangles.emplace_back(shape->triangles[3 * i], shape->triangles[3 * i + 1], shape->triangles[3 * i + 2]);
+  }
+
+  auto bvh = std::make_shared<RLLCachedMesh::BVHModel>();
+  bvh->beginModel(triangles.size(), vertices.size());
+  bvh->addSubModel(vertices, triangles);
+  bvh->endModel();
+  bvh->computeLocalAABB();
+  mesh->bvh = bvh;
+
+  return mesh;
+}
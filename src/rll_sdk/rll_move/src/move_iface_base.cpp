@@ -18,6 +18,10 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
 #include <actionlib/client/simple_action_client.h>
 #include <geometry_msgs/Point.h>
 #include <moveit_msgs/MoveGroupAction.h>
@@ -29,9 +33,35 @@ const std::string RLLMoveIfaceBase::RUN_JOB_SRV_NAME = "job_env";
 
 const std::string RLLMoveIfaceBase::JOB_FINISHED_SRV_NAME = "job_finished";
 
-const char* RLLMoveIfaceBase::CLIENT_SERVER_START_CMD_ = "start";
-const char* RLLMoveIfaceBase::CLIENT_SERVER_OK_RESP_ = "ok";
-const char* RLLMoveIfaceBase::CLIENT_SERVER_ERROR_RESP_ = "error";
+namespace
+{
+// timeout for reading and writing on the client connection
+const int CLIENT_SOCKET_TIMEOUT_SECONDS = 2;
+}  // namespace
+
+size_t RLLJobReplayStats::mismatches() const
+{
+  size_t mismatches = 0;
+  for (const auto& service : services)
+  {
+    mismatches += service.second.mismatches;
+  }
+  return mismatches;
+}
+
+void RLLJobReplayStats::print() const
+{
+  ROS_INFO("replayed %zu jobs", jobs);
+  for (const auto& service : services)
+  {
+    const Service& s = service.second;
+    ROS_INFO_STREAM(std::left << std::setw(48) << service.first << std::right << std::setw(8) << s.calls << " calls "
+                              << std::setw(6) << s.mismatches << " mismatches, recorded " << std::fixed
+                              << std::setprecision(3) << 1E03 * s.recorded_seconds / s.calls << " ms, replayed "
+                              << 1E03 * s.replayed_seconds / s.calls << " ms, " << std::setprecision(1)
+                              << s.calls / s.replayed_seconds << " calls/s");
+  }
+}
 
 RLLMoveIfaceBase::RLLMoveIfaceBase(const ros::NodeHandle& nh) : nh_(nh)
 {
@@ -51,8 +81,32 @@ RLLMoveIfaceBase::RLLMoveIfaceBase(const ros::NodeHandle& nh) : nh_(nh)
   client_serv_addr_.sin_family = AF_INET;
   client_serv_addr_.sin_port = htons(client_server_port);
 
+  ros::param::get("~job_log_directory", job_log_directory_);
+  if (!job_log_directory_.empty())
+  {
+    ROS_INFO("recording jobs into %s", job_log_directory_.c_str());
+  }
+
+  double metrics_period = 1.0;
+  ros::param::get("~metrics_period", metrics_period);
+  ros::param::get("~metrics_textfile", metrics_textfile_);
+  if (metrics_period > 0)
+  {
+    diagnostics_pub_ = nh_.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+    metrics_timer_ = nh_.createWallTimer(ros::WallDuration(metrics_period), &RLLMoveIfaceBase::exportMetrics, this);
+  }
+
   // TODO(mark): specify the required, permission, would be better to have this in
   permissions_.setRequiredPermissionsFor(RLLMoveIfaceBase::JOB_FINISHED_SRV_NAME, only_during_job_run_permission_);
+  job_finished_srv_ = permissions_.registerService(JOB_FINISHED_SRV_NAME);
+
+  // stop waiting for the job result right away, the job cannot succeed anymore
+  iface_state_.setInternalErrorCallback([this] { job_result_.interrupt(); });
+}
+
+RLLMoveIfaceBase::~RLLMoveIfaceBase()
+{
+  closeClientSocket();
 }
 
 void RLLMoveIfaceBase::runJobAction(const rll_msgs::JobEnvGoalConstPtr& goal, JobServer* as)
@@ -66,9 +120,15 @@ void RLLMoveIfaceBase::runJobAction(const rll_msgs::JobEnvGoalConstPtr& goal, Jo
     return;
   }
 
+  startJobRecording();
+
   // run the actual job processing and set the result accordingly
+  auto job_start = std::chrono::steady_clock::now();
   runJob(goal, &result);
+  metrics_.recordJob(result.job.status, std::chrono::steady_clock::now() - job_start);
 
+  job_recorder_.recordJobEnd(result.job.status);
+  job_recorder_.close();
   afterActionExecution(&result);
   as->setSucceeded(result);
 }
@@ -138,6 +198,186 @@ bool RLLMoveIfaceBase::afterActionExecution(rll_msgs::JobEnvResult* result)
   return true;
 }
 
+void RLLMoveIfaceBase::startJobRecording()
+{
+  if (job_log_directory_.empty())
+  {
+    return;
+  }
+
+  std::string file_name = job_log_directory_ + "/job_" + std::to_string(ros::WallTime::now().toNSec()) + ".rlljob";
+  if (!job_recorder_.open(file_name))
+  {
+    return;
+  }
+
+  moveit_msgs::PlanningScene planning_scene;
+  clonePlanningScene()->getPlanningSceneMsg(planning_scene);
+  job_recorder_.recordJobStart(planning_scene, getCurrentManipJointValues());
+}
+
+void RLLMoveIfaceBase::exportMetrics(const ros::WallTimerEvent& /*event*/)
+{
+  diagnostic_msgs::DiagnosticArray diagnostics;
+  diagnostics.header.stamp = ros::Time::now();
+  diagnostics.status.resize(1);
+  diagnostic_msgs::DiagnosticStatus& status = diagnostics.status[0];
+  status.name = node_name_ + ": metrics";
+  status.hardware_id = getNamespace();
+  if (iface_state_.isInInternalErrorState())
+  {
+    status.level = diagnostic_msgs::DiagnosticStatus::ERROR;
+    status.message = "internal error";
+  }
+  else
+  {
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.message = std::to_string(metrics_.inFlight()) + " service calls in execution";
+  }
+
+  for (const auto& value : metrics_.summaryValues())
+  {
+    diagnostic_msgs::KeyValue key_value;
+    key_value.key = value.first;
+    key_value.value = value.second;
+    status.values.push_back(key_value);
+  }
+  diagnostics_pub_.publish(diagnostics);
+
+  if (metrics_textfile_.empty())
+  {
+    return;
+  }
+
+  // the collector must never see a partially written file
+  std::string tmp_file_name = metrics_textfile_ + ".tmp";
+  {
+    std::ofstream file(tmp_file_name);
+    file << metrics_.prometheusText(phase_timers_);
+    if (!file)
+    {
+      ROS_WARN_THROTTLE(60, "failed to write the metrics to %s", tmp_file_name.c_str());
+      return;
+    }
+  }
+  std::rename(tmp_file_name.c_str(), metrics_textfile_.c_str());
+}
+
+void RLLMoveIfaceBase::replayJobLog(const RLLJobLogReader& log, RLLJobReplayStats* stats)
+{
+  planning_scene::PlanningScenePtr planning_scene;
+  std::unique_ptr<robot_state::RobotState> job_start_state;
+
+  for (const auto& record : log.records())
+  {
+    const RLLJobLogRecordHeader& header = *record.header;
+    if (header.type == RLLJobLogRecordType::JOB_START)
+    {
+      moveit_msgs::PlanningScene planning_scene_msg;
+      planning_scene.reset();
+      if (!RLLJobLogReader::deserializeRequest(record, &planning_scene_msg) || header.num_joints != RLL_NUM_JOINTS)
+      {
+        ROS_WARN("skipping a job with an invalid start record");
+        continue;
+      }
+
+      // the scene of the interface stays untouched, e.g. while other logs are replayed concurrently
+      planning_scene = clonePlanningScene();
+      planning_scene->setPlanningSceneMsg(planning_scene_msg);
+      job_start_state.reset(new robot_state::RobotState(planning_scene->getCurrentState()));
+      job_start_state->setJointGroupPositions(manip_joint_model_group_, header.joint_values);
+      job_start_state->update();
+      ++stats->jobs;
+      continue;
+    }
+
+    if (header.type != RLLJobLogRecordType::SERVICE_CALL || !planning_scene || header.num_joints != RLL_NUM_JOINTS)
+    {
+      continue;
+    }
+
+    robot_state::RobotState start_state = *job_start_state;
+    start_state.setJointGroupPositions(manip_joint_model_group_, header.joint_values);
+    start_state.update();
+
+    bool matches = true;
+    ros::WallTime replay_start = ros::WallTime::now();
+    if (!replayServiceCall(record, *planning_scene, start_state, *job_start_state, &matches))
+    {
+      continue;
+    }
+
+    RLLJobReplayStats::Service& service = stats->services[record.name];
+    service.replayed_seconds += (ros::WallTime::now() - replay_start).toSec();
+    service.recorded_seconds += header.duration_ns * 1E-09;
+    ++service.calls;
+
+    if (!matches)
+    {
+      ++service.mismatches;
+    }
+  }
+}
+
+bool RLLMoveIfaceBase::replayMatches(const RLLErrorCode& recorded, const RLLErrorCode& replayed)
+{
+  switch (recorded.value())
+  {
+    case RLLErrorCode::SUCCESS:
+    case RLLErrorCode::INVALID_INPUT:
+    case RLLErrorCode::GOAL_IN_COLLISION:
+    case RLLErrorCode::NO_IK_SOLUTION_FOUND:
+    case RLLErrorCode::MOVEIT_PLANNING_FAILED:
+    case RLLErrorCode::ONLY_PARTIAL_PATH_PLANNED:
+      break;
+    default:
+      return true;
+  }
+
+  if (recorded.succeeded() != replayed.succeeded())
+  {
+    ROS_WARN("replay differs from the recording: recorded %s, replayed %s", recorded.message(), replayed.message());
+    return false;
+  }
+  return true;
+}
+
+bool RLLMoveIfaceBase::replayServiceCall(const RLLJobLogReader::Record& record,
+                                         const planning_scene::PlanningScene& planning_scene,
+                                         const robot_state::RobotState& start_state,
+                                         const robot_state::RobotState& /*job_start_state*/, bool* matches)
+{
+  if (record.name == ros::message_traits::DataType<rll_msgs::MoveLin::Request>::value())
+  {
+    rll_msgs::MoveLin::Request req;
+    if (!RLLJobLogReader::deserializeRequest(record, &req))
+    {
+      return false;
+    }
+
+    robot_trajectory::RobotTrajectory trajectory(manip_model_, manip_move_group_.getName());
+    RLLErrorCode error_code = computeLinearPath(start_state, req.pose, planning_scene, &trajectory);
+    *matches = replayMatches(record.header->error_code, error_code);
+    return true;
+  }
+
+  if (record.name == ros::message_traits::DataType<rll_msgs::MovePTP::Request>::value())
+  {
+    rll_msgs::MovePTP::Request req;
+    if (!RLLJobLogReader::deserializeRequest(record, &req))
+    {
+      return false;
+    }
+
+    std::vector<double> goal_joint_values(RLL_NUM_JOINTS);
+    RLLErrorCode error_code = poseGoalInCollision(req.pose, start_state, planning_scene, &goal_joint_values, false);
+    *matches = replayMatches(record.header->error_code, error_code);
+    return true;
+  }
+
+  return false;
+}
+
 // this method should usually be overwritten by projects to add their own routines
 void RLLMoveIfaceBase::runJob(const rll_msgs::JobEnvGoalConstPtr& goal, rll_msgs::JobEnvResult* result)
 {
@@ -166,6 +406,9 @@ RLLErrorCode RLLMoveIfaceBase::idle()
 
 bool RLLMoveIfaceBase::runClient(const rll_msgs::JobEnvGoalConstPtr& goal, rll_msgs::JobEnvResult* result)
 {
+  // no service calls are processed between jobs, so the timers can be reset safely
+  phase_timers_.reset();
+
   bool success = initClientSocket(goal->client_ip_addr);
   if (!success)
   {
@@ -184,22 +427,8 @@ bool RLLMoveIfaceBase::runClient(const rll_msgs::JobEnvGoalConstPtr& goal, rll_m
   ROS_INFO("called the interface client");
 
   ros::Time job_start = ros::Time::now();
-  while ((ros::Time::now() - job_start).toSec() < job_execution_timeout_seconds_)
-  {
-    if (job_result_.isSet())
-    {
-      break;
-    }
-
-    if (iface_state_.isInInternalErrorState())
-    {
-      break;
-    }
-
-    ros::Duration(0.01).sleep();
-  }
-
-  if (job_result_.isSet())
+  // woken up by the job finished service or by entering the INTERNAL_ERROR state
+  if (job_result_.waitForResult(std::chrono::seconds(job_execution_timeout_seconds_)))
   {
     ROS_INFO("interface client completed");
   }
@@ -214,12 +443,12 @@ bool RLLMoveIfaceBase::runClient(const rll_msgs::JobEnvGoalConstPtr& goal, rll_m
   // therefore wait for the service call to end before completing the runJob action
   if (iface_state_.setCurrentServiceCallResult(RLLErrorCode::JOB_EXECUTION_TIMED_OUT))
   {
-    while (iface_state_.isServiceCallInExecution())
-    {
-      ros::Duration(.01).sleep();
-    }
+    iface_state_.waitForServiceCallsToEnd();
   }
 
+  ROS_INFO("job finished with status %d after %.2f seconds, phase timings:\n%s", result->job.status,
+           (ros::Time::now() - job_start).toSec(), phase_timers_.summary().c_str());
+
   if (iface_state_.isInInternalErrorState())
   {
     ROS_FATAL("Internal error during current job execution!");
@@ -240,7 +469,7 @@ bool RLLMoveIfaceBase::runClient(const rll_msgs::JobEnvGoalConstPtr& goal, rll_m
 
 bool RLLMoveIfaceBase::jobFinishedSrv(std_srvs::SetBool::Request& req, std_srvs::SetBool::Response& resp)
 {
-  RLLErrorCode error_code = beforeServiceCall(RLLMoveIfaceBase::JOB_FINISHED_SRV_NAME);
+  RLLErrorCode error_code = beforeServiceCall(job_finished_srv_);
 
   if (error_code.succeeded())
   {
@@ -264,97 +493,127 @@ bool RLLMoveIfaceBase::jobFinishedSrv(std_srvs::SetBool::Request& req, std_srvs:
     permissions_.debugPermission(RLLMoveIfaceBase::JOB_FINISHED_SRV_NAME);
   }
 
-  error_code = afterServiceCall(RLLMoveIfaceBase::JOB_FINISHED_SRV_NAME, error_code);
+  error_code = afterServiceCall(job_finished_srv_, error_code);
   resp.success = error_code.succeededSrv();
   return true;
 }
 
 bool RLLMoveIfaceBase::initClientSocket(const std::string& client_ip_addr)
 {
-  if (inet_pton(AF_INET, client_ip_addr.c_str(), &client_serv_addr_.sin_addr) <= 0)
+  struct in_addr client_addr;
+  if (inet_pton(AF_INET, client_ip_addr.c_str(), &client_addr) <= 0)
   {
     ROS_ERROR("Invalid client address");
     return false;
   }
 
-  client_socket_ = socket(AF_INET, SOCK_STREAM, 0);
-  if (client_socket_ < 0)
-  {
-    ROS_ERROR("failed to create client socket");
-    return false;
-  }
-
-  // set a timeout of 2s for reading and writing
-  struct timeval timeout;
-  timeout.tv_sec = 2;
-  timeout.tv_usec = 0;
-
-  if (setsockopt(client_socket_, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<char*>(&timeout), sizeof(timeout)) < 0)
+  if (client_socket_ >= 0 && client_addr.s_addr == client_serv_addr_.sin_addr.s_addr)
   {
-    ROS_ERROR("setsockopt for receive timeout failed");
-    return false;
-  }
-
-  if (setsockopt(client_socket_, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<char*>(&timeout), sizeof(timeout)) < 0)
-  {
-    ROS_ERROR("setsockopt for send timeout failed");
-    return false;
+    // reuse the connection of the previous job
+    return true;
   }
 
+  closeClientSocket();
+  client_serv_addr_.sin_addr = client_addr;
   return true;
 }
 
-bool RLLMoveIfaceBase::callClient()
+bool RLLMoveIfaceBase::connectClient()
 {
   unsigned int max_retries = 11;
-  unsigned int retry_counter = 0;
-  char recv_msg[CLIENT_SERVER_BUFFER_SIZE];
-  memset(recv_msg, 0, CLIENT_SERVER_BUFFER_SIZE * sizeof(char));
-  int send_msg_size = strlen(CLIENT_SERVER_START_CMD_);
-
-  while (retry_counter < max_retries)
+  for (unsigned int retry_counter = 0; retry_counter < max_retries; ++retry_counter)
   {
-    int result =
-        connect(client_socket_, reinterpret_cast<struct sockaddr*>(&client_serv_addr_), sizeof(client_serv_addr_));
-    if (result < 0 && retry_counter < max_retries)
+    if (retry_counter > 0)
     {
       ROS_INFO("failed to connect to client, retrying...");
-      retry_counter++;
       ros::Duration(3.0).sleep();
     }
-    else
+
+    client_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (client_socket_ < 0)
     {
-      break;
+      ROS_ERROR("failed to create client socket");
+      return false;
     }
-  }
-  if (retry_counter == max_retries)
-  {
-    ROS_WARN("max retries exceeded, failed to connect to client");
-    return false;
+
+    if (!setClientSocketTimeouts(client_socket_, CLIENT_SOCKET_TIMEOUT_SECONDS))
+    {
+      ROS_ERROR("setsockopt for the client socket timeouts failed");
+      closeClientSocket();
+      return false;
+    }
+
+    if (connect(client_socket_, reinterpret_cast<struct sockaddr*>(&client_serv_addr_), sizeof(client_serv_addr_)) == 0)
+    {
+      client_reader_.clear();
+      ROS_INFO("connected to the client");
+      return true;
+    }
+
+    closeClientSocket();
   }
 
-  int client_sent = send(client_socket_, CLIENT_SERVER_START_CMD_, send_msg_size, 0);
-  if (client_sent != send_msg_size)
+  ROS_WARN("max retries exceeded, failed to connect to client");
+  return false;
+}
+
+void RLLMoveIfaceBase::closeClientSocket()
+{
+  if (client_socket_ >= 0)
   {
-    ROS_WARN("error sending start message to client");
     close(client_socket_);
-    return false;
+    client_socket_ = -1;
   }
+}
 
-  recv(client_socket_, recv_msg, CLIENT_SERVER_BUFFER_SIZE, 0);
-  close(client_socket_);
-  if (strcmp(recv_msg, CLIENT_SERVER_OK_RESP_) == 0)
-  {
-    job_result_.jobStarted();
-    return true;
-  }
-  if (strcmp(recv_msg, CLIENT_SERVER_ERROR_RESP_) == 0)
+bool RLLMoveIfaceBase::callClient()
+{
+  RLLClientMessage request;
+  request.command = RLLClientMessage::START_CMD;
+  request.job_id = ++last_job_id_;
+
+  // the client may have closed the connection since the last job, e.g. because it was restarted, so reconnect once
+  for (int attempt = 0; attempt < 2; ++attempt)
   {
-    ROS_WARN("client responded with an error");
-    return false;
+    if (client_socket_ < 0 && !connectClient())
+    {
+      return false;
+    }
+
+    auto status = RLLClientMessageReader::Status::CLOSED;
+    if (sendClientMessage(client_socket_, request))
+    {
+      RLLClientMessage response;
+      while ((status = client_reader_.receive(client_socket_, &response)) == RLLClientMessageReader::Status::MESSAGE)
+      {
+        if (response.job_id != request.job_id)
+        {
+          ROS_WARN("ignoring client response for job %u", response.job_id);
+          continue;
+        }
+
+        if (response.command == RLLClientMessage::OK_RESP)
+        {
+          job_result_.jobStarted();
+          return true;
+        }
+
+        ROS_WARN("client responded with an error");
+        return false;
+      }
+    }
+
+    closeClientSocket();
+    if (status == RLLClientMessageReader::Status::TIMEOUT)
+    {
+      ROS_WARN("error reading response from client");
+      return false;
+    }
+
+    ROS_INFO("connection to the client was closed");
   }
 
-  ROS_WARN("error reading response from client");
+  ROS_WARN("error sending start message to client");
   return false;
 }
 
@@ -371,6 +630,12 @@ bool waitForMoveGroupAction()
   }
   ROS_INFO("done waiting");
 
-  ros::Duration(1).sleep();
+  // the startup checks wait for the remaining setup themselves
+  bool fast_startup = false;
+  ros::param::get("~fast_startup", fast_startup);
+  if (!fast_startup)
+  {
+    ros::Duration(1).sleep();
+  }
   return true;
 }
@@ -18,6 +18,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <rll_move/move_iface_default_kinematic.h>
 #include <rll_move/move_iface_default_simulation.h>
 
 int main(int argc, char** argv)
@@ -25,7 +26,20 @@ int main(int argc, char** argv)
   ros::init(argc, argv, "move_iface");
   ros::NodeHandle nh;
 
-  if (waitForMoveGroupAction())
+  bool kinematic_execution = false;
+  ros::param::get("~kinematic_execution", kinematic_execution);
+
+  if (!waitForMoveGroupAction())
+  {
+    return 0;
+  }
+
+  if (kinematic_execution)
+  {
+    RLLDefaultKinematicMoveIface iface(nh);
+    iface.startServicesAndRunNode(&nh);
+  }
+  else
   {
     RLLDefaultMoveIface iface(nh);
     iface.startServicesAndRunNode(&nh);
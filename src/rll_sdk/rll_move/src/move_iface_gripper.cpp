@@ -31,11 +31,18 @@ const std::string RLLMoveIfaceGripperServices::GRIPPER_PLANNING_GROUP = "gripper
 const std::string RLLMoveIfaceGripperServices::GRIPPER_OPEN_TARGET_NAME = "gripper_open";
 const std::string RLLMoveIfaceGripperServices::GRIPPER_CLOSE_TARGET_NAME = "gripper_close";
 
-RLLMoveIfaceGripperServices::RLLMoveIfaceGripperServices() : gripper_move_group_(GRIPPER_PLANNING_GROUP)
+RLLMoveIfaceGripperServices::RLLMoveIfaceGripperServices()
+  : gripper_move_group_(sharedMoveGroupOptions(GRIPPER_PLANNING_GROUP, robot_model_loader_))
 {
   gripper_move_group_.setPlannerId("RRTConnectkConfigDefault");
   gripper_move_group_.setPlanningTime(2.0);
   setupPickPlacePermissions();
+
+  ros::param::get("~planned_pick_place", planned_pick_place_);
+  if (planned_pick_place_)
+  {
+    ROS_INFO("pick place motions are planned up front");
+  }
 }
 
 void RLLMoveIfaceGripperServices::offerGripperServices(ros::NodeHandle* nh)
@@ -79,6 +86,10 @@ void RLLMoveIfaceGripperServices::setupPickPlacePermissions()
                                          true);
   permissions_.setRequiredPermissionsFor(RLLMoveIfaceGripperServices::MOVE_GRIPPER_SRV_NAME, pick_place_permission_,
                                          true);
+
+  pick_place_srv_ = permissions_.registerService(PICK_PLACE_SRV_NAME);
+  pick_place_here_srv_ = permissions_.registerService(PICK_PLACE_HERE_SRV_NAME);
+  move_gripper_srv_ = permissions_.registerService(MOVE_GRIPPER_SRV_NAME);
 }
 
 RLLErrorCode RLLMoveIfaceGripperServices::isGripperOperationConsistent(bool close_gripper)
@@ -142,7 +153,9 @@ RLLErrorCode RLLMoveIfaceGripperServices::isGripperAttachmentOperationConsistent
 GraspObject* RLLMoveIfaceGripperServices::registerGraspObject(std::unique_ptr<GraspObject> grasp_object_ptr,
                                                               const moveit_msgs::CollisionObject& collision_object)
 {
-  bool success = planning_scene_interface_.applyCollisionObject(collision_object);
+  // re-registering an object with unchanged geometry only moves it
+  scene_diff_.addOrMove(collision_object);
+  bool success = applyPlanningSceneDiff();
   if (!success)
   {
     ROS_ERROR("Failed to add collision object!");
@@ -226,25 +239,24 @@ bool RLLMoveIfaceGripperServices::moveGripperSrv(rll_msgs::MoveGripper::Request&
                                                  rll_msgs::MoveGripper::Response& resp)
 {
   // TODO(mark): remove this service? Is it needed and safe?
-  return controlledMovementExecution(req, &resp, MOVE_GRIPPER_SRV_NAME, &RLLMoveIfaceGripperServices::moveGripper);
+  return controlledMovementExecution(req, &resp, move_gripper_srv_, &RLLMoveIfaceGripperServices::moveGripper);
 }
 
 bool RLLMoveIfaceGripperServices::pickPlaceSrv(rll_msgs::PickPlace::Request& req, rll_msgs::PickPlace::Response& resp)
 {
-  return controlledMovementExecution(req, &resp, PICK_PLACE_SRV_NAME, &RLLMoveIfaceGripperServices::pickPlace);
+  return controlledMovementExecution(req, &resp, pick_place_srv_, &RLLMoveIfaceGripperServices::pickPlace);
 }
 
 bool RLLMoveIfaceGripperServices::pickPlaceHereSrv(rll_msgs::PickPlaceHere::Request& req,
                                                    rll_msgs::PickPlaceHere::Response& resp)
 {
-  return controlledMovementExecution(req, &resp, PICK_PLACE_HERE_SRV_NAME, &RLLMoveIfaceGripperServices::pickPlaceHere);
+  return controlledMovementExecution(req, &resp, pick_place_here_srv_, &RLLMoveIfaceGripperServices::pickPlaceHere);
 }
 
 bool RLLMoveIfaceGripperServices::validatePickPlaceSrv(rll_msgs::ValidatePickPlace::Request& req,
                                                        rll_msgs::ValidatePickPlace::Response& resp)
 {
-  return controlledMovementExecution(req, &resp, PICK_PLACE_HERE_SRV_NAME,
-                                     &RLLMoveIfaceGripperServices::validatePickPlace);
+  return controlledMovementExecution(req, &resp, pick_place_here_srv_, &RLLMoveIfaceGripperServices::validatePickPlace);
 }
 
 RLLErrorCode RLLMoveIfaceGripperServices::moveGripper(const rll_msgs::MoveGripper::Request& req,
@@ -269,6 +281,12 @@ RLLErrorCode RLLMoveIfaceGripperServices::moveGripper(const rll_msgs::MoveGrippe
 
 RLLErrorCode RLLMoveIfaceGripperServices::pickPlace(const rll_msgs::PickPlace::Request& req,
                                                     rll_msgs::PickPlace::Response* /*resp*/)
+{
+  return runPickPlace(req, false);
+}
+
+RLLErrorCode RLLMoveIfaceGripperServices::runPickPlace(const rll_msgs::PickPlace::Request& req,
+                                                       bool use_trajectory_cache)
 {
   // TODO(mark): validate the poses we are given are valid! E.g. orientation is normalized, this should be done for
   // all movement services
@@ -286,7 +304,12 @@ RLLErrorCode RLLMoveIfaceGripperServices::pickPlace(const rll_msgs::PickPlace::R
   }
   ROS_ASSERT(grasp_object_ptr != nullptr);
 
-  error_code = approachPickPlaceGripPose(req.pose_approach, req.pose_grip);
+  if (planned_pick_place_)
+  {
+    return pickPlacePlanned(req, close_gripper, grasp_object_ptr);
+  }
+
+  error_code = approachPickPlaceGripPose(req.pose_approach, req.pose_grip, use_trajectory_cache);
   if (error_code.failed())
   {
     return error_code;
@@ -304,7 +327,7 @@ RLLErrorCode RLLMoveIfaceGripperServices::pickPlace(const rll_msgs::PickPlace::R
     return gripper_error_code;
   }
 
-  error_code = retreatFromPickPlaceGripPose(req.pose_retreat);
+  error_code = retreatFromPickPlaceGripPose(req.pose_retreat, use_trajectory_cache);
 
   // in case grasping failed (not critically), and the retreat was successful still return the grasping error
   if (gripper_error_code.failed() and error_code.succeeded())
@@ -315,11 +338,139 @@ RLLErrorCode RLLMoveIfaceGripperServices::pickPlace(const rll_msgs::PickPlace::R
   return error_code;
 }
 
+RLLErrorCode RLLMoveIfaceGripperServices::pickPlacePlanned(const rll_msgs::PickPlace::Request& req, bool close_gripper,
+                                                           GraspObject* grasp_object_ptr)
+{
+  // nothing is executed unless all motions can be planned
+  PickPlacePlans plans;
+  RLLErrorCode error_code = planPickPlace(req, close_gripper, *grasp_object_ptr, &plans);
+  if (error_code.failed())
+  {
+    ROS_WARN("pickPlace: planning failed, the robot was not moved");
+    return error_code;
+  }
+
+  if (plans.approach_required)
+  {
+    error_code = execute(&manip_move_group_, plans.approach);
+    if (error_code.failed())
+    {
+      ROS_WARN("pickPlace: Failed to move to approach position");
+      return error_code;
+    }
+  }
+
+  error_code = execute(&manip_move_group_, plans.grip);
+  if (error_code.failed())
+  {
+    ROS_WARN("pickPlace: Moving to grip position failed");
+    return error_code;
+  }
+
+  // instead of a fixed delay, wait until the planning scene caught up, the attach pose is taken from it
+  waitForGoalFromPlanningScene(plans.grip.trajectory_.joint_trajectory.points.back().positions);
+
+  RLLErrorCode gripper_error_code =
+      close_gripper ? closeGripperAndAttach(grasp_object_ptr, true) : openGripperAndDetach(true);
+
+  if (gripper_error_code.isCriticalFailure())
+  {
+    ROS_ERROR("pickPlace: Gripper motion failed critically, aborting pick place.");
+    return gripper_error_code;
+  }
+
+  if (gripper_error_code.failed())
+  {
+    // the planned retreat assumed a successful gripping operation
+    error_code = retreatFromPickPlaceGripPose(req.pose_retreat);
+    return error_code.succeeded() ? gripper_error_code : error_code;
+  }
+
+  error_code = execute(&manip_move_group_, plans.retreat);
+  if (error_code.failed())
+  {
+    ROS_WARN("pickPlace: Retreating from grip position failed");
+  }
+  return error_code;
+}
+
+RLLErrorCode RLLMoveIfaceGripperServices::planPickPlace(const rll_msgs::PickPlace::Request& req, bool close_gripper,
+                                                        const GraspObject& grasp_object, PickPlacePlans* plans)
+{
+  planning_scene::PlanningScenePtr planning_scene = clonePlanningScene();
+  robot_state::RobotState state = getCurrentRobotState();
+  state.setJointGroupPositions(manip_joint_model_group_, getCurrentManipJointValues());
+  state.update();
+
+  plans->approach_required = !tooCloseForLinearMovement(req.pose_approach);
+  if (plans->approach_required)
+  {
+    RLLErrorCode error_code = planPickPlaceSegment(*planning_scene, req.pose_approach, &state, &plans->approach);
+    if (error_code.failed())
+    {
+      ROS_WARN("pickPlace: planning the approach failed");
+      return error_code;
+    }
+  }
+
+  RLLErrorCode error_code = planPickPlaceSegment(*planning_scene, req.pose_grip, &state, &plans->grip);
+  if (error_code.failed())
+  {
+    ROS_WARN("pickPlace: planning the motion to the grip pose failed");
+    return error_code;
+  }
+
+  // apply the outcome of the gripping operation to the private scene
+  state.setToDefaultValues(manip_model_->getJointModelGroup(GRIPPER_PLANNING_GROUP),
+                           close_gripper ? GRIPPER_CLOSE_TARGET_NAME : GRIPPER_OPEN_TARGET_NAME);
+  state.update();
+  planning_scene->setCurrentState(state);
+
+  moveit_msgs::AttachedCollisionObject attached_object;
+  attached_object.link_name = manip_move_group_.getEndEffectorLink();
+  attached_object.object.id = grasp_object.getID();
+  attached_object.object.operation =
+      close_gripper ? moveit_msgs::CollisionObject::ADD : moveit_msgs::CollisionObject::REMOVE;
+  attached_object.touch_links = fingerLinks();
+  if (!planning_scene->processAttachedCollisionObjectMsg(attached_object))
+  {
+    ROS_ERROR("pickPlace: failed to update the attachment of '%s' for planning", attached_object.object.id.c_str());
+    return RLLErrorCode::GRIPPER_OPERATION_FAILED;
+  }
+  state = planning_scene->getCurrentState();
+
+  error_code = planPickPlaceSegment(*planning_scene, req.pose_retreat, &state, &plans->retreat);
+  if (error_code.failed())
+  {
+    ROS_WARN("pickPlace: planning the retreat failed");
+  }
+  return error_code;
+}
+
+RLLErrorCode RLLMoveIfaceGripperServices::planPickPlaceSegment(
+    const planning_scene::PlanningScene& planning_scene, const geometry_msgs::Pose& goal,
+    robot_state::RobotState* state, moveit::planning_interface::MoveGroupInterface::Plan* plan)
+{
+  robot_trajectory::RobotTrajectory rt(manip_model_, manip_move_group_.getName());
+  RLLErrorCode error_code = computeLinearPath(*state, goal, planning_scene, &rt);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  // the next segment starts where this one ends
+  *state = rt.getLastWayPoint();
+
+  moveit_msgs::RobotTrajectory trajectory;
+  rt.getRobotTrajectoryMsg(trajectory);
+  return prepareLinearTrajectory(trajectory, false, plan);
+}
+
 RLLErrorCode RLLMoveIfaceGripperServices::pickPlaceHere(const rll_msgs::PickPlaceHere::Request& req,
                                                         rll_msgs::PickPlaceHere::Response* /*resp*/)
 {
   // use the current pose as the approach/retreat pose
-  geometry_msgs::Pose current = getCurrentPoseFromPlanningScene();
+  geometry_msgs::Pose current = getCurrentManipPose();
   rll_msgs::PickPlace::Response pp_response;  // is unused in pickPlace
   rll_msgs::PickPlace::Request pp_request;
   pp_request.pose_approach = current;
@@ -388,13 +539,14 @@ RLLErrorCode RLLMoveIfaceGripperServices::validatePickPlaceGripPose(const std::s
 }
 
 RLLErrorCode RLLMoveIfaceGripperServices::approachPickPlaceGripPose(const geometry_msgs::Pose& approach_pose,
-                                                                    const geometry_msgs::Pose& grip_pose)
+                                                                    const geometry_msgs::Pose& grip_pose,
+                                                                    bool use_trajectory_cache)
 {
   if (!tooCloseForLinearMovement(approach_pose))
   {
     ROS_INFO_POS("[pickPlace] Moving to approach position", approach_pose.position);
     // TOOD(mark): linear only if no object is currently grasped?
-    RLLErrorCode error_code = moveToGoalLinear(approach_pose);
+    RLLErrorCode error_code = moveToGoalLinear(approach_pose, false, use_trajectory_cache);
 
     if (error_code.failed())
     {
@@ -410,7 +562,7 @@ RLLErrorCode RLLMoveIfaceGripperServices::approachPickPlaceGripPose(const geomet
   }
 
   ROS_INFO_POSE("Moving to grip pose", grip_pose);
-  RLLErrorCode error_code = moveToGoalLinear(grip_pose);
+  RLLErrorCode error_code = moveToGoalLinear(grip_pose, false, use_trajectory_cache);
   if (error_code.failed())
   {
     ROS_WARN("pickPlace: Moving to grip position failed");
@@ -421,11 +573,12 @@ RLLErrorCode RLLMoveIfaceGripperServices::approachPickPlaceGripPose(const geomet
   return RLLErrorCode::SUCCESS;
 }
 
-RLLErrorCode RLLMoveIfaceGripperServices::retreatFromPickPlaceGripPose(const geometry_msgs::Pose& retreat_pose)
+RLLErrorCode RLLMoveIfaceGripperServices::retreatFromPickPlaceGripPose(const geometry_msgs::Pose& retreat_pose,
+                                                                       bool use_trajectory_cache)
 {
   ROS_INFO_POS("[pickPlace] Retreating to position", retreat_pose.position);
 
-  RLLErrorCode error_code = moveToGoalLinear(retreat_pose);
+  RLLErrorCode error_code = moveToGoalLinear(retreat_pose, false, use_trajectory_cache);
   if (error_code.failed())
   {
     ROS_WARN("pickPlace: Retreating from grip position failed");
@@ -466,7 +619,7 @@ RLLErrorCode RLLMoveIfaceGripperServices::closeGripper()
   return error_code;
 }
 
-RLLErrorCode RLLMoveIfaceGripperServices::openGripper()
+RLLErrorCode RLLMoveIfaceGripperServices::openGripper(bool wait_for_gripper)
 {
   if (!manipCurrentStateAvailable())
   {
@@ -482,7 +635,7 @@ RLLErrorCode RLLMoveIfaceGripperServices::openGripper()
   gripper_move_group_.setStartStateToCurrentState();
   gripper_move_group_.setNamedTarget(GRIPPER_OPEN_TARGET_NAME);
 
-  error_code = runPTPTrajectory(&gripper_move_group_, true);
+  error_code = runPTPTrajectory(&gripper_move_group_, true, false, wait_for_gripper);
   if (error_code.failed())
   {
     ROS_FATAL("Failed to open the gripper");
@@ -495,82 +648,62 @@ RLLErrorCode RLLMoveIfaceGripperServices::openGripper()
   return error_code;
 }
 
-bool RLLMoveIfaceGripperServices::attachCollisionObject(const moveit_msgs::CollisionObject& collision_object)
+std::vector<std::string> RLLMoveIfaceGripperServices::fingerLinks()
 {
-  moveit_msgs::CollisionObject to_remove;
-  to_remove.id = collision_object.id;
-  to_remove.operation = moveit_msgs::CollisionObject::REMOVE;  // Check whether it is currently attached?
-
-  // 1. remove the (unattached) object from the scene
-  bool result = planning_scene_interface_.applyCollisionObject(to_remove);
-  if (!result)
-  {
-    ROS_INFO("Failed to remove CollisionObject '%s'", to_remove.id.c_str());
-    return false;
-  }
-
-  // 2. attach the collision_object to the EEF
-  moveit_msgs::AttachedCollisionObject attached_object;
-  attached_object.link_name = manip_move_group_.getEndEffectorLink();
-  attached_object.object = collision_object;
-  attached_object.object.operation = moveit_msgs::CollisionObject::ADD;
-  // these links will be ignored for collisions with the grasp collision_object
-  attached_object.touch_links = std::vector<std::string>{ getNamespace() + "_" + getEEFType() + "_finger_left",
-                                                          getNamespace() + "_" + getEEFType() + "_finger_right" };
+  std::string prefix = getNamespace() + "_" + getEEFType();
+  return { prefix + "_finger_left", prefix + "_finger_right" };
+}
 
-  result = planning_scene_interface_.applyAttachedCollisionObject(attached_object);
+bool RLLMoveIfaceGripperServices::attachCollisionObject(const moveit_msgs::CollisionObject& collision_object,
+                                                        bool wait_for_scene_update)
+{
+  // move the (unattached) object from the scene to the EEF in one diff, move_group keeps its geometry
+  // the finger links will be ignored for collisions with the grasp collision_object
+  scene_diff_.attach(collision_object, manip_move_group_.getEndEffectorLink(), fingerLinks());
+  bool result = applyPlanningSceneDiff();
   if (!result)
   {
-    ROS_ERROR("Failed to add AttachCollisionObject: %s", attached_object.object.id.c_str());
+    ROS_ERROR("Failed to add AttachCollisionObject: %s", collision_object.id.c_str());
     // TODO(mark): what now?
     return false;
   }
 
-  // ROS_INFO_STREAM("AttachCollisionObject: \n" << attached_object);
   // TODO(mark): figure out if this is really needed
   // occasionally, there seems to be a race condition with subsequent planning requests
-  ros::Duration(0.25).sleep();
+  if (wait_for_scene_update)
+  {
+    ros::Duration(0.25).sleep();
+  }
 
   return result;
 }
 
-bool RLLMoveIfaceGripperServices::detachAttachedCollisionObject(const moveit_msgs::CollisionObject& collision_object)
+bool RLLMoveIfaceGripperServices::detachAttachedCollisionObject(const moveit_msgs::CollisionObject& collision_object,
+                                                                bool wait_for_scene_update)
 {
   ROS_INFO("Detaching grasp object '%s'", collision_object.id.c_str());
 
-  // 1. remove the previous attachment, set only the mandatory fields (no need to publish the shape on removal)
-  moveit_msgs::AttachedCollisionObject attached_object;
-  attached_object.link_name = manip_move_group_.getEndEffectorLink();
-  attached_object.object.id = collision_object.id;
-  attached_object.object.operation = moveit_msgs::CollisionObject::REMOVE;
-  bool result = planning_scene_interface_.applyAttachedCollisionObject(attached_object);
-  if (!result)
-  {
-    ROS_ERROR("Failed to detach AttachCollisionObject object: %s", attached_object.object.id.c_str());
-    return false;
-  }
-
-  // 2. add the object back to the scene
+  // remove the attachment, move_group adds the object back to the scene at its current pose
   // TODO(mark): disable collision between world and object? -> Ensure there is  small gap, e.g. 1mm?
   // TODO(mark): validate the collision object is in the right location after detach
-  attached_object.object = collision_object;
-  attached_object.object.operation = moveit_msgs::CollisionObject::ADD;
-  result = planning_scene_interface_.applyCollisionObject(attached_object.object);
-
+  scene_diff_.detach(collision_object.id, manip_move_group_.getEndEffectorLink());
+  bool result = applyPlanningSceneDiff();
   if (!result)
   {
-    ROS_ERROR("Failed to add the CollisionObject to the scene after detaching it: %s", collision_object.id.c_str());
+    ROS_ERROR("Failed to detach AttachCollisionObject object: %s", collision_object.id.c_str());
     return false;
   }
 
-  // ROS_INFO_STREAM("Detached object and added it back to the scene: \n" << collision_object);
   // TODO(mark): figure out if this is really needed
   // occasionally, there seems to be a race condition with subsequent planning requests
-  ros::Duration(0.25).sleep();
+  if (wait_for_scene_update)
+  {
+    ros::Duration(0.25).sleep();
+  }
   return true;
 }
 
-RLLErrorCode RLLMoveIfaceGripperServices::openGripperAndDetach()
+RLLErrorCode RLLMoveIfaceGripperServices::openGripperAndDetach(bool retreat_planned)
 {
   ROS_ASSERT(currently_grasped_object_ptr_ != nullptr);
 
@@ -581,21 +714,21 @@ RLLErrorCode RLLMoveIfaceGripperServices::openGripperAndDetach()
     return RLLErrorCode::GRIPPER_OPERATION_FAILED;
   }
 
-  geometry_msgs::Pose eef_pose = getCurrentPoseFromPlanningScene();
+  geometry_msgs::Pose eef_pose = getCurrentManipPose();
   bool can_be_placed_here = currently_grasped_object_ptr_->canBeReleased(eef_pose);
   if (!can_be_placed_here)
   {
     return RLLErrorCode::GRIPPER_CONSTRAINT_FAILED;
   }
 
-  RLLErrorCode error_code = openGripper();
+  RLLErrorCode error_code = openGripper(!retreat_planned);
   if (error_code.failed())
   {
     return error_code;
   }
 
   // detach the moveit collision object after successfully opening the gripper
-  bool result = detachAttachedCollisionObject(currently_grasped_object_ptr_->getCollisionObject());
+  bool result = detachAttachedCollisionObject(currently_grasped_object_ptr_->getCollisionObject(), !retreat_planned);
   if (!result)
   {
     ROS_FATAL("Something went wrong detaching the collision object!");
@@ -617,7 +750,7 @@ RLLErrorCode RLLMoveIfaceGripperServices::openGripperAndDetach()
   return RLLErrorCode::SUCCESS;
 }
 
-RLLErrorCode RLLMoveIfaceGripperServices::closeGripperAndAttach(GraspObject* grasp_object_ptr)
+RLLErrorCode RLLMoveIfaceGripperServices::closeGripperAndAttach(GraspObject* grasp_object_ptr, bool retreat_planned)
 {
   ROS_ASSERT(grasp_object_ptr != nullptr);
 
@@ -627,7 +760,7 @@ RLLErrorCode RLLMoveIfaceGripperServices::closeGripperAndAttach(GraspObject* gra
     return RLLErrorCode::GRIPPER_OPERATION_FAILED;
   }
 
-  geometry_msgs::Pose eef_target_pose = getCurrentPoseFromPlanningScene();
+  geometry_msgs::Pose eef_target_pose = getCurrentManipPose();
   bool is_possible = grasp_object_ptr->canBeGrasped(eef_target_pose);
   if (!is_possible)
   {
@@ -635,7 +768,7 @@ RLLErrorCode RLLMoveIfaceGripperServices::closeGripperAndAttach(GraspObject* gra
   }
 
   // attach the object first, which will prevent collision checks between the gripper fingers and the object
-  bool attachment_result = attachCollisionObject(grasp_object_ptr->getCollisionObject());
+  bool attachment_result = attachCollisionObject(grasp_object_ptr->getCollisionObject(), !retreat_planned);
   if (!attachment_result)
   {
     ROS_FATAL("Attachment failed");
@@ -682,10 +815,10 @@ void RLLMoveIfaceGripperServices::debugCurrentlyGraspedObject()
     updateCollisionObject(currently_grasped_object_ptr_, true);
 
     ROS_INFO("\nCurrently grasped object:\n");
-    ROS_INFO_STREAM("EEF pose: " << getCurrentPoseFromPlanningScene());
+    ROS_INFO_STREAM("EEF pose: " << getCurrentManipPose());
     ROS_INFO_STREAM("Attached pose: " << currently_grasped_object_ptr_->getCenterPose());
     geometry_msgs::Pose world_obj_pose =
-        currently_grasped_object_ptr_->getObjectPoseForEEFPose(getCurrentPoseFromPlanningScene());
+        currently_grasped_object_ptr_->getObjectPoseForEEFPose(getCurrentManipPose());
     ROS_INFO_STREAM("Object world pose: " << world_obj_pose);
   }
   else
@@ -0,0 +1,61 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sensor_msgs/JointState.h>
+
+#include <rll_move/move_iface_kinematic.h>
+
+const std::string RLLKinematicMoveIface::JOINT_STATES_TOPIC = "kinematic_joint_states";
+
+RLLKinematicMoveIface::RLLKinematicMoveIface()
+{
+  ros::NodeHandle nh("~");
+  joint_states_pub_ = nh.advertise<sensor_msgs::JointState>(JOINT_STATES_TOPIC, 1);
+  ROS_INFO("Executing trajectories kinematically");
+}
+
+moveit::planning_interface::MoveItErrorCode
+RLLKinematicMoveIface::executeTrajectory(moveit::planning_interface::MoveGroupInterface* move_group,
+                                         const moveit::planning_interface::MoveGroupInterface::Plan& plan)
+{
+  const trajectory_msgs::JointTrajectory& joint_trajectory = plan.trajectory_.joint_trajectory;
+  if (joint_trajectory.points.empty())
+  {
+    return moveit::planning_interface::MoveItErrorCode(moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN);
+  }
+
+  // without physics, nothing stops the robot on a collision, so the trajectory is rejected instead
+  // the gripper fingers are expected to touch the grasp object
+  if (move_group == &manip_move_group_)
+  {
+    robot_trajectory::RobotTrajectory rt(manip_model_, move_group->getName());
+    rt.setRobotTrajectoryMsg(getCurrentRobotState(), plan.trajectory_);
+    if (!isPathValid(*clonePlanningScene(), rt))
+    {
+      ROS_ERROR("Kinematic execution: the trajectory is in collision");
+      return moveit::planning_interface::MoveItErrorCode(moveit_msgs::MoveItErrorCodes::MOTION_PLAN_INVALIDATED);
+    }
+  }
+
+  sensor_msgs::JointState joint_state;
+  joint_state.header.stamp = ros::Time::now();
+  joint_state.name = joint_trajectory.joint_names;
+  joint_state.position = joint_trajectory.points.back().positions;
+  joint_states_pub_.publish(joint_state);
+
+  return moveit::planning_interface::MoveItErrorCode(moveit_msgs::MoveItErrorCodes::SUCCESS);
+}
@@ -18,7 +18,16 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <future>
+#include <random>
+#include <thread>
+
 #include <eigen_conversions/eigen_msg.h>
+#include <geometric_shapes/bodies.h>
+#include <random_numbers/random_numbers.h>
 #include <tf2_ros/transform_listener.h>
 
 #include <rll_move/move_iface_planning.h>
@@ -28,17 +37,58 @@ const double RLLMoveIfacePlanning::DEFAULT_ACCELERATION_SCALING_FACTOR = 0.4;
 
 const double RLLMoveIfacePlanning::DEFAULT_LINEAR_EEF_STEP = 0.001;
 const double RLLMoveIfacePlanning::DEFAULT_ROTATION_EEF_STEP = 1 * M_PI / 180;
-// TODO(wolfgang): get rid of the jump threshold. Instead, modify the IK error code with a flag to report if new arm
-// angle is in same interval as old arm angle -> no jump.
-// The jump threshold is too restrictive and throws errors on otherwise admissible trajectories.
+// The IK reports jumps to another arm angle interval along linear paths, so the jump threshold is only needed for
+// linear motions with given arm angles.
+// TODO(wolfgang): get rid of the jump threshold for these as well, it is too restrictive and throws errors on
+// otherwise admissible trajectories.
 const double RLLMoveIfacePlanning::DEFAULT_LINEAR_JUMP_THRESHOLD = 10;
 const size_t RLLMoveIfacePlanning::LINEAR_MIN_STEPS_FOR_JUMP_THRESH = 10;
+const double RLLMoveIfacePlanning::CONTINUOUS_COLLISION_SAFETY_MARGIN = 0.002;
+const size_t RLLMoveIfacePlanning::ADAPTIVE_MAX_STRIDE = 10;
+const double RLLMoveIfacePlanning::ADAPTIVE_MAX_JOINT_STEP = 0.02;
+// with the default step of 1 mm, the first segment is 4 cm long and paths shorter than 16 cm are not streamed
+const size_t RLLMoveIfacePlanning::STREAMING_FIRST_SEGMENT_WAYPOINTS = 40;
+const size_t RLLMoveIfacePlanning::STREAMING_MIN_WAYPOINTS = 160;
+const double RLLMoveIfacePlanning::COMPRESSION_JOINT_TOLERANCE = 1E-04;
+const double RLLMoveIfacePlanning::COMPRESSION_CARTESIAN_TOLERANCE = 1E-04;
 
 const std::string RLLMoveIfacePlanning::MANIP_PLANNING_GROUP = "manipulator";
 
 const std::string RLLMoveIfacePlanning::HOME_TARGET_NAME = "home_bow";
 
-RLLMoveIfacePlanning::RLLMoveIfacePlanning() : manip_move_group_(MANIP_PLANNING_GROUP)
+namespace
+{
+const char* EE_TO_TIP_TRANSFORM = "ee_to_tip";
+const char* BASE_TO_WORLD_TRANSFORM = "base_to_world";
+
+RLLConstTransformCache::Transform toCachedTransform(const geometry_msgs::Transform& transform)
+{
+  return { transform.translation.x, transform.translation.y, transform.translation.z, transform.rotation.x,
+           transform.rotation.y,    transform.rotation.z,    transform.rotation.w };
+}
+
+tf::Transform fromCachedTransform(const RLLConstTransformCache::Transform& transform)
+{
+  return tf::Transform(tf::Quaternion(transform[3], transform[4], transform[5], transform[6]),
+                       tf::Vector3(transform[0], transform[1], transform[2]));
+}
+
+// the interpolation of equal poses is only exact up to rounding
+bool samePose(const geometry_msgs::Pose& lhs, const geometry_msgs::Pose& rhs)
+{
+  const double tolerance = 1E-09;
+  return fabs(lhs.position.x - rhs.position.x) < tolerance && fabs(lhs.position.y - rhs.position.y) < tolerance &&
+         fabs(lhs.position.z - rhs.position.z) < tolerance &&
+         fabs(lhs.orientation.x - rhs.orientation.x) < tolerance &&
+         fabs(lhs.orientation.y - rhs.orientation.y) < tolerance &&
+         fabs(lhs.orientation.z - rhs.orientation.z) < tolerance &&
+         fabs(lhs.orientation.w - rhs.orientation.w) < tolerance;
+}
+}  // namespace
+
+RLLMoveIfacePlanning::RLLMoveIfacePlanning()
+  : robot_model_loader_(getSharedRobotModelLoader())
+  , manip_move_group_(sharedMoveGroupOptions(MANIP_PLANNING_GROUP, robot_model_loader_))
 {
   ns_ = ros::this_node::getNamespace();
 // remove the slashes at the beginning
@@ -52,6 +102,38 @@ RLLMoveIfacePlanning::RLLMoveIfacePlanning() : manip_move_group_(MANIP_PLANNING_
   node_name_ = ros::this_node::getName();
 
   ros::param::get("move_group/trajectory_execution/allowed_start_tolerance", allowed_start_tolerance_);
+  ros::param::get("~continuous_collision_checking", continuous_collision_checking_);
+  if (continuous_collision_checking_)
+  {
+    ROS_INFO("Using continuous collision checking for linear paths");
+  }
+  ros::param::get("~adaptive_interpolation", adaptive_interpolation_);
+  if (adaptive_interpolation_)
+  {
+    ROS_INFO("Using adaptive interpolation for linear paths");
+  }
+  ros::param::get("~streaming_linear_execution", streaming_linear_execution_);
+  if (streaming_linear_execution_)
+  {
+    ROS_INFO("Executing long linear paths while they are planned");
+  }
+  ros::param::get("~trajectory_compression", trajectory_compression_);
+  if (trajectory_compression_)
+  {
+    ROS_INFO("Compressing linear trajectories before their execution");
+  }
+  ros::param::get("~fast_sim", fast_sim_);
+  if (fast_sim_)
+  {
+    ROS_INFO("Waiting for the end of motions in simulation time");
+    joint_state_monitor_.useRosTime(true);
+  }
+
+  ros::param::get("~fast_startup", fast_startup_);
+  if (fast_startup_)
+  {
+    ROS_INFO("Using cached constant transforms during startup");
+  }
 
   ros::param::get("~eef_type", eef_type_);
   if (eef_type_.empty())
@@ -78,19 +160,70 @@ RLLMoveIfacePlanning::RLLMoveIfacePlanning() : manip_move_group_(MANIP_PLANNING_
   manip_model_ = manip_move_group_.getRobotModel();
   manip_joint_model_group_ = manip_model_->getJointModelGroup(manip_move_group_.getName());
 
+  ros::param::get("~collision_pre_check", goal_pre_check_);
+  if (goal_pre_check_)
+  {
+    ROS_INFO("Using a distance field pre-check for goal collisions");
+  }
+  ros::param::get("~sphere_proxy_check", sphere_proxy_check_);
+  if (sphere_proxy_check_)
+  {
+    ROS_INFO("Using sphere proxies for the collision checks of linear paths");
+  }
+  if (goal_pre_check_ || sphere_proxy_check_)
+  {
+    // the sphere proxies need larger distances to clear the outer spheres of the links
+    double max_distance =
+        sphere_proxy_check_ ? RLLSphereProxyCheck::MAX_DISTANCE : RLLDistanceFieldPreCheck::MAX_DISTANCE;
+    collision_pre_check_.reset(new RLLDistanceFieldPreCheck(manip_joint_model_group_, max_distance));
+  }
+
   // each configurable EEF will have this link
   std::string ee_link = ns_ + "_link_tcp";
   manip_move_group_.setEndEffectorLink(ee_link);
 
-  planning_scene_monitor_ = std::make_shared<planning_scene_monitor::PlanningSceneMonitor>("robot_description");
+  if (getJointValuesFromNamedTarget(HOME_TARGET_NAME).empty())
+  {
+    ROS_WARN("Failed to cache the joint values of the %s target", HOME_TARGET_NAME.c_str());
+  }
+
+  planning_scene_monitor_ = getSharedPlanningSceneMonitor();
+
+  ros::NodeHandle nh;
+  if (!joint_state_monitor_.trackJoints(manip_joint_model_group_->getVariableNames()))
+  {
+    ROS_WARN("Too many manipulator joints to track, falling back to the move group for the current joint values");
+  }
+  joint_state_monitor_.subscribe(&nh);
+
+  // the tf lookups wait while the planning scene is requested and checked
+  tf2_ros::Buffer tf_buffer;
+  tf2_ros::TransformListener tf_listener(tf_buffer);
+  bool kinematics_solver_loaded = getKinematicsSolver();
+  std::future<bool> collision_link_available =
+      std::async(std::launch::async, [this, &tf_buffer] { return isCollisionLinkAvailable(tf_buffer); });
+  std::future<bool> const_transforms_initialized;
+  if (kinematics_solver_loaded)
+  {
+    const_transforms_initialized =
+        std::async(std::launch::async, [this, &tf_buffer] { return initConstTransforms(tf_buffer); });
+  }
 
   planning_scene_monitor_->requestPlanningSceneState("get_planning_scene");
   planning_scene_ = planning_scene_monitor::LockedPlanningSceneRO(planning_scene_monitor_);
   acm_ = planning_scene_->getAllowedCollisionMatrix();  // this is only a copy of the ACM from the current planning
                                                         // scene, it is not updated?
 
+  bool startup_checks_passed = !isInitialStateInCollision() && kinematics_solver_loaded;
+  // always wait for the lookups, they use the tf buffer
+  startup_checks_passed = collision_link_available.get() && startup_checks_passed;
+  if (const_transforms_initialized.valid())
+  {
+    startup_checks_passed = const_transforms_initialized.get() && startup_checks_passed;
+  }
+
   // startup checks, shutdown the node if something is wrong
-  if (isInitialStateInCollision() || !isCollisionLinkAvailable() || !getKinematicsSolver() || !initConstTransforms())
+  if (!startup_checks_passed)
   {
     ROS_FATAL("Startup checks failed, shutting the node down!");
     ros::shutdown();
@@ -120,7 +253,25 @@ bool RLLMoveIfacePlanning::isInitialStateInCollision()
   return false;
 }
 
-bool RLLMoveIfacePlanning::isCollisionLinkAvailable()
+bool RLLMoveIfacePlanning::applyPlanningSceneDiff()
+{
+  if (scene_diff_.empty())
+  {
+    return true;
+  }
+
+  bool success = planning_scene_interface_.applyPlanningScene(scene_diff_.take());
+  planningSceneModified();
+  if (!success)
+  {
+    // the state of move_group is unknown, send full objects from now on
+    scene_diff_.reset();
+  }
+
+  return success;
+}
+
+bool RLLMoveIfacePlanning::isCollisionLinkAvailable(const tf2_ros::Buffer& tf_buffer)
 {
   std::string collision_link;
   bool success = ros::param::get(node_name_ + "/collision_link", collision_link);
@@ -131,10 +282,6 @@ bool RLLMoveIfacePlanning::isCollisionLinkAvailable()
     return false;
   }
 
-  tf2_ros::Buffer tf_buffer;
-  // required to allow specifying a timeout in lookupTransform
-  tf2_ros::TransformListener listener(tf_buffer);
-
   // if the workcell is loaded correctly the collision_link should be available
   success = tf_buffer.canTransform("world", collision_link, ros::Time(0), ros::Duration(5));
 
@@ -165,13 +312,35 @@ bool RLLMoveIfacePlanning::manipCurrentStateAvailable()
 }
 
 RLLErrorCode RLLMoveIfacePlanning::runPTPTrajectory(moveit::planning_interface::MoveGroupInterface* move_group,
-                                                    bool for_gripper)
+                                                    bool for_gripper, bool use_trajectory_cache, bool wait_for_gripper)
 {
   moveit::planning_interface::MoveGroupInterface::Plan my_plan;
   moveit::planning_interface::MoveItErrorCode moveit_error_code;
   bool success;
 
-  moveit_error_code = move_group->plan(my_plan);
+  use_trajectory_cache = use_trajectory_cache && !for_gripper;
+  if (use_trajectory_cache)
+  {
+    std::vector<double> start = getCurrentManipJointValues();
+    std::vector<double> goal;
+    move_group->getJointValueTarget().copyJointGroupPositions(manip_joint_model_group_, goal);
+    if (trajectory_cache_.lookup(start, goal, &my_plan.trajectory_))
+    {
+      if (cachedTrajectoryValid(my_plan.trajectory_))
+      {
+        ROS_INFO("replaying cached trajectory");
+        phase_timers_.count(RLLPhaseCounter::CACHED_TRAJECTORIES);
+        return execute(move_group, my_plan);
+      }
+
+      trajectory_cache_.erase(start, goal);
+    }
+  }
+
+  {
+    RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::PTP_PLANNING);
+    moveit_error_code = move_group->plan(my_plan);
+  }
   RLLErrorCode error_code = convertMoveItErrorCode(moveit_error_code);
   if (error_code.failed())
   {
@@ -187,22 +356,34 @@ RLLErrorCode RLLMoveIfacePlanning::runPTPTrajectory(moveit::planning_interface::
       return error_code;
     }
 
-    success = modifyPtpTrajectory(&my_plan.trajectory_);
+    {
+      RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::TRAJECTORY_MODIFICATION);
+      success = modifyPtpTrajectory(&my_plan.trajectory_);
+    }
     if (!success)
     {
       return RLLErrorCode::TRAJECTORY_MODIFICATION_FAILED;
     }
   }
 
-  return execute(move_group, my_plan);
+  error_code = execute(move_group, my_plan, wait_for_gripper);
+  if (use_trajectory_cache && error_code.succeeded())
+  {
+    trajectory_cache_.insert(my_plan.trajectory_);
+  }
+
+  return error_code;
 }
 
 RLLErrorCode RLLMoveIfacePlanning::execute(moveit::planning_interface::MoveGroupInterface* move_group,
-                                           const moveit::planning_interface::MoveGroupInterface::Plan& plan)
+                                           const moveit::planning_interface::MoveGroupInterface::Plan& plan,
+                                           bool wait_for_gripper)
 {
   moveit::planning_interface::MoveItErrorCode moveit_error_code;
+  RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::EXECUTION);
+  phase_timers_.count(RLLPhaseCounter::EXECUTED_WAYPOINTS, plan.trajectory_.joint_trajectory.points.size());
 
-  moveit_error_code = move_group->execute(plan);
+  moveit_error_code = executeTrajectory(move_group, plan);
   RLLErrorCode error_code = convertMoveItErrorCode(moveit_error_code);
   if (error_code.failed())
   {
@@ -210,13 +391,44 @@ RLLErrorCode RLLMoveIfacePlanning::execute(moveit::planning_interface::MoveGroup
     return error_code;
   }
 
+  const std::vector<std::string>& joint_names = plan.trajectory_.joint_trajectory.joint_names;
+  const std::vector<double>& last_point = plan.trajectory_.joint_trajectory.points.back().positions;
+  std::vector<double> current_point;
+  bool joint_states_available = joint_state_monitor_.positions(joint_names, &current_point);
+
   if (move_group->getName() != MANIP_PLANNING_GROUP)  // run only for manipulator
   {
-    ros::Duration(.25).sleep();  // wait a bit just in case the gripper is still moving
+    if (!wait_for_gripper)
+    {
+      return RLLErrorCode::SUCCESS;
+    }
+
+    // The controller already reported success, the gripper might still be moving though. It is done once it reached
+    // the goal or came to rest, e.g. blocked by the grasped object.
+    if (!joint_states_available ||
+        !joint_state_monitor_.waitForGoal(joint_names, last_point, allowed_start_tolerance_,
+                                          std::chrono::milliseconds(250), std::chrono::milliseconds(50)))
+    {
+      ros::Duration(.25).sleep();  // wait a bit just in case the gripper is still moving
+    }
     return RLLErrorCode::SUCCESS;
   }
 
-  std::vector<double> last_point = plan.trajectory_.joint_trajectory.points.back().positions;
+  bool reached = joint_states_available ?
+                     joint_state_monitor_.waitForGoal(joint_names, last_point, allowed_start_tolerance_,
+                                                      std::chrono::seconds(2)) :
+                     waitForGoalFromPlanningScene(last_point);
+  if (!reached)
+  {
+    ROS_FATAL("desired goal state was not reached");
+    return RLLErrorCode::EXECUTION_FAILED;
+  }
+
+  return RLLErrorCode::SUCCESS;
+}
+
+bool RLLMoveIfacePlanning::waitForGoalFromPlanningScene(const std::vector<double>& last_point)
+{
   bool identical = false;
   std::vector<double> current_point;
   ros::Rate r(200);
@@ -241,24 +453,12 @@ RLLErrorCode RLLMoveIfacePlanning::execute(moveit::planning_interface::MoveGroup
     }
   }
 
-  if (!identical)
-  {
-    ROS_FATAL("desired goal state was not reached");
-    return RLLErrorCode::EXECUTION_FAILED;
-  }
-
-  return RLLErrorCode::SUCCESS;
-}
-
-geometry_msgs::Pose RLLMoveIfacePlanning::getCurrentPoseFromPlanningScene()
-{
-  getCurrentRobotState(true).update();  // TODO(mark): does this make a difference?
-  return manip_move_group_.getCurrentPose().pose;
+  return identical;
 }
 
 double RLLMoveIfacePlanning::distanceToCurrentPosition(const geometry_msgs::Pose& pose)
 {
-  geometry_msgs::Pose current_pose = getCurrentPoseFromPlanningScene();
+  geometry_msgs::Pose current_pose = getCurrentManipPose();
 
   double distance =
       sqrt(pow(current_pose.position.x - pose.position.x, 2) + pow(current_pose.position.y - pose.position.y, 2) +
@@ -278,10 +478,11 @@ bool RLLMoveIfacePlanning::tooCloseForLinearMovement(const geometry_msgs::Pose&
 }
 
 RLLErrorCode RLLMoveIfacePlanning::moveToGoalLinear(const geometry_msgs::Pose& goal,
-                                                    bool cartesian_time_parametrization)
+                                                    bool cartesian_time_parametrization, bool use_trajectory_cache)
 {
   moveit_msgs::RobotTrajectory trajectory;
   std::vector<double> goal_joint_values(RLL_NUM_JOINTS);
+  moveit::planning_interface::MoveGroupInterface::Plan my_plan;
 
   RLLErrorCode error_code = poseGoalInCollision(goal, &goal_joint_values);
   if (error_code.failed())
@@ -290,25 +491,130 @@ RLLErrorCode RLLMoveIfacePlanning::moveToGoalLinear(const geometry_msgs::Pose& g
   }
 
   manip_move_group_.setStartStateToCurrentState();
+  use_trajectory_cache = use_trajectory_cache && !cartesian_time_parametrization;
+  if (use_trajectory_cache && lookupLinearTrajectory(goal, &my_plan.trajectory_))
+  {
+    ROS_INFO("replaying cached linear trajectory");
+    phase_timers_.count(RLLPhaseCounter::CACHED_TRAJECTORIES);
+    return execute(&manip_move_group_, my_plan);
+  }
+
+  if (streaming_linear_execution_ && !cartesian_time_parametrization && !use_trajectory_cache)
+  {
+    return runLinearTrajectoryStreaming(goal);
+  }
+
   error_code = computeLinearPath(goal, &trajectory);
   if (error_code.failed())
   {
     return error_code;
   }
 
-  return runLinearTrajectory(trajectory, cartesian_time_parametrization);
+  if (!use_trajectory_cache)
+  {
+    return runLinearTrajectory(trajectory, cartesian_time_parametrization);
+  }
+
+  error_code = prepareLinearTrajectory(trajectory, false, &my_plan);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  error_code = execute(&manip_move_group_, my_plan);
+  if (error_code.succeeded())
+  {
+    linear_trajectory_cache_.insert(my_plan.trajectory_);
+  }
+
+  return error_code;
+}
+
+bool RLLMoveIfacePlanning::lookupLinearTrajectory(const geometry_msgs::Pose& goal,
+                                                  moveit_msgs::RobotTrajectory* trajectory)
+{
+  // in meters and radians, the same as the joint tolerance of the cache
+  const double GOAL_TOLERANCE = RLLTrajectoryCache::DEFAULT_TOLERANCE;
+
+  Eigen::Isometry3d goal_pose;
+  tf::poseMsgToEigen(goal, goal_pose);
+  auto reaches_goal = [&](const std::vector<double>& last) {
+    geometry_msgs::Pose last_pose_msg;
+    double arm_angle;
+    int config;
+    kinematics_plugin_->getPositionFK(last, &last_pose_msg, &arm_angle, &config);
+    transformPoseFromFK(&last_pose_msg);
+
+    Eigen::Isometry3d last_pose;
+    tf::poseMsgToEigen(last_pose_msg, last_pose);
+    double angle = Eigen::Quaterniond(last_pose.linear()).angularDistance(Eigen::Quaterniond(goal_pose.linear()));
+    return (last_pose.translation() - goal_pose.translation()).norm() < GOAL_TOLERANCE && angle < GOAL_TOLERANCE;
+  };
+
+  std::vector<double> start = getCurrentManipJointValues();
+  if (!linear_trajectory_cache_.lookup(start, reaches_goal, trajectory))
+  {
+    return false;
+  }
+
+  if (!cachedTrajectoryValid(*trajectory))
+  {
+    linear_trajectory_cache_.erase(start, trajectory->joint_trajectory.points.back().positions);
+    return false;
+  }
+
+  return true;
+}
+
+RLLErrorCode RLLMoveIfacePlanning::moveToGoalPTP(const geometry_msgs::Pose& goal, bool use_trajectory_cache)
+{
+  std::vector<double> goal_joint_values(RLL_NUM_JOINTS);
+
+  manip_move_group_.setStartStateToCurrentState();
+
+  RLLErrorCode error_code = poseGoalInCollision(goal, &goal_joint_values);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  manip_move_group_.setJointValueTarget(goal_joint_values);
+
+  return runPTPTrajectory(&manip_move_group_, false, use_trajectory_cache);
 }
 
 RLLErrorCode RLLMoveIfacePlanning::computeLinearPath(const geometry_msgs::Pose& goal,
                                                      moveit_msgs::RobotTrajectory* trajectory)
 {
-  return computeLinearPath(manip_move_group_.getCurrentJointValues(), goal, trajectory);
+  return computeLinearPath(getCurrentManipJointValues(), goal, trajectory);
 }
 
 RLLErrorCode RLLMoveIfacePlanning::computeLinearPath(const std::vector<double>& start, const geometry_msgs::Pose& goal,
                                                      moveit_msgs::RobotTrajectory* trajectory)
 {
+  robot_state::RobotState start_state = getCurrentRobotState();
+  start_state.setJointGroupPositions(manip_joint_model_group_, start);
+
+  robot_trajectory::RobotTrajectory rt(manip_model_, manip_move_group_.getName());
+  RLLErrorCode error_code = computeLinearPath(start_state, goal, *planning_scene_, &rt);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  rt.getRobotTrajectoryMsg(*trajectory);
+  return RLLErrorCode::SUCCESS;
+}
+
+RLLErrorCode RLLMoveIfacePlanning::computeLinearPath(const robot_state::RobotState& start_state,
+                                                     const geometry_msgs::Pose& goal,
+                                                     const planning_scene::PlanningScene& planning_scene,
+                                                     robot_trajectory::RobotTrajectory* trajectory)
+{
+  RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::LINEAR_PATH);
   std::vector<geometry_msgs::Pose> waypoints_pose;
+  std::vector<double> start;
+  start_state.copyJointGroupPositions(manip_joint_model_group_, start);
 
   geometry_msgs::Pose start_pose;
   double arm_angle;
@@ -327,11 +633,16 @@ RLLErrorCode RLLMoveIfacePlanning::computeLinearPath(const std::vector<double>&
   }
 
   double achieved = 0.0;
-  std::vector<robot_state::RobotStatePtr> path;
-  getPathIK(waypoints_pose, start, &path, &achieved);
-
-  moveit::core::JumpThreshold thresh(DEFAULT_LINEAR_JUMP_THRESHOLD);
-  achieved *= robot_state::RobotState::testJointSpaceJump(manip_joint_model_group_, path, thresh);
+  RLLJointPath path;
+  if (adaptive_interpolation_)
+  {
+    getPathIKAdaptive(start_state, waypoints_pose, start, planning_scene, &path, &achieved);
+  }
+  else
+  {
+    getPathIK(waypoints_pose, start, &path, &achieved);
+  }
+  metrics_.countIK(achieved >= 1.0);
 
   if (achieved > 0.0 && achieved < 1.0)
   {
@@ -345,23 +656,17 @@ RLLErrorCode RLLMoveIfacePlanning::computeLinearPath(const std::vector<double>&
     return RLLErrorCode::MOVEIT_PLANNING_FAILED;
   }
 
-  robot_trajectory::RobotTrajectory rt(manip_model_, manip_move_group_.getName());
-  for (const auto& path_pose : path)
-  {
-    rt.addSuffixWayPoint(path_pose, 0.0);
-  }
+  jointPathToTrajectory(path, start_state, trajectory);
 
-  rt.getRobotTrajectoryMsg(*trajectory);
-
-  if (trajectory->joint_trajectory.points.size() < LINEAR_MIN_STEPS_FOR_JUMP_THRESH)
+  if (trajectory->getWayPointCount() < LINEAR_MIN_STEPS_FOR_JUMP_THRESH)
   {
     ROS_ERROR("trajectory has not enough points to check for continuity, only got %lu",
-              trajectory->joint_trajectory.points.size());
+              trajectory->getWayPointCount());
     return RLLErrorCode::TOO_FEW_WAYPOINTS;
   }
 
   // check for collisions
-  if (!planning_scene_->isPathValid(rt))
+  if (!isPathValid(planning_scene, *trajectory))
   {  // TODO(updim): maybe output collision state
     ROS_ERROR("There is a collision along the path");
     return RLLErrorCode::ONLY_PARTIAL_PATH_PLANNED;
@@ -374,38 +679,200 @@ RLLErrorCode RLLMoveIfacePlanning::runLinearTrajectory(const moveit_msgs::RobotT
                                                        bool cartesian_time_parametrization)
 {
   moveit::planning_interface::MoveGroupInterface::Plan my_plan;
+  RLLErrorCode error_code = prepareLinearTrajectory(trajectory, cartesian_time_parametrization, &my_plan);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  return execute(&manip_move_group_, my_plan);
+}
+
+RLLErrorCode RLLMoveIfacePlanning::prepareLinearTrajectory(const moveit_msgs::RobotTrajectory& trajectory,
+                                                           bool cartesian_time_parametrization,
+                                                           moveit::planning_interface::MoveGroupInterface::Plan* plan)
+{
   bool success;
 
-  my_plan.trajectory_ = trajectory;
+  plan->trajectory_ = trajectory;
 
-  RLLErrorCode error_code = checkTrajectory(my_plan.trajectory_);
+  RLLErrorCode error_code = checkTrajectory(plan->trajectory_);
   if (error_code.failed())
   {
     return error_code;
   }
 
-  // time parametrization happens in joint space by default
-  if (cartesian_time_parametrization)
   {
-    success = modifyLinTrajectory(&my_plan.trajectory_);
-    if (!success)
+    RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::TRAJECTORY_MODIFICATION);
+    // time parametrization happens in joint space by default
+    if (cartesian_time_parametrization)
     {
-      return RLLErrorCode::TRAJECTORY_MODIFICATION_FAILED;
+      success = modifyLinTrajectory(&plan->trajectory_);
+    }
+    else
+    {
+      success = modifyPtpTrajectory(&plan->trajectory_);
     }
   }
-  else
+  if (!success)
   {
-    success = modifyPtpTrajectory(&my_plan.trajectory_);
-    if (!success)
+    return RLLErrorCode::TRAJECTORY_MODIFICATION_FAILED;
+  }
+  compressTrajectory(&plan->trajectory_);
+
+  ROS_INFO_STREAM("trajectory duration is " << plan->trajectory_.joint_trajectory.points.back().time_from_start.toSec()
+                                            << " seconds");
+
+  return RLLErrorCode::SUCCESS;
+}
+
+RLLErrorCode RLLMoveIfacePlanning::runLinearTrajectoryStreaming(const geometry_msgs::Pose& goal)
+{
+  robot_state::RobotState segment_start = getCurrentRobotState();
+  std::vector<double> start;
+  segment_start.copyJointGroupPositions(manip_joint_model_group_, start);
+
+  geometry_msgs::Pose start_pose;
+  double arm_angle;
+  int config;
+  kinematics_plugin_->getPositionFK(start, &start_pose, &arm_angle, &config);
+  transformPoseFromFK(&start_pose);
+  std::vector<geometry_msgs::Pose> waypoints_pose;
+  RLLErrorCode error_code = interpolatePosesLinear(start_pose, goal, &waypoints_pose);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  std::vector<size_t> segment_ends;
+  streamingSegmentEnds(waypoints_pose.size(), &segment_ends);
+  ROS_INFO("executing the linear path in %lu segments", segment_ends.size());
+
+  // the monitor updates the scene while the previous segment is executed
+  planning_scene::PlanningScenePtr planning_scene = clonePlanningScene();
+
+  std::future<RLLErrorCode> execution;
+  for (size_t end : segment_ends)
+  {
+    // the segment goals lie on the interpolated path, the last one is the exact goal
+    const geometry_msgs::Pose& segment_goal = end + 1 == waypoints_pose.size() ? goal : waypoints_pose[end];
+    moveit::planning_interface::MoveGroupInterface::Plan plan;
+    error_code = planLinearSegment(segment_start, segment_goal, *planning_scene, &segment_start, &plan);
+    if (error_code.failed())
     {
-      return RLLErrorCode::TRAJECTORY_MODIFICATION_FAILED;
+      ROS_WARN("planning the linear path segment up to waypoint %lu failed, stopping after the previous segment", end);
+      break;
+    }
+
+    if (execution.valid())
+    {
+      error_code = execution.get();
+      if (error_code.failed())
+      {
+        break;
+      }
+    }
+
+    execution = std::async(std::launch::async, [this, plan] { return execute(&manip_move_group_, plan); });
+  }
+
+  if (execution.valid())
+  {
+    RLLErrorCode execution_error_code = execution.get();
+    if (error_code.succeeded())
+    {
+      error_code = execution_error_code;
     }
   }
 
-  ROS_INFO_STREAM("trajectory duration is "
-                  << my_plan.trajectory_.joint_trajectory.points.back().time_from_start.toSec() << " seconds");
+  return error_code;
+}
 
-  return execute(&manip_move_group_, my_plan);
+void RLLMoveIfacePlanning::streamingSegmentEnds(size_t num_waypoints, std::vector<size_t>* segment_ends)
+{
+  segment_ends->clear();
+  size_t last = num_waypoints - 1;
+  if (num_waypoints < STREAMING_MIN_WAYPOINTS)
+  {
+    segment_ends->push_back(last);
+    return;
+  }
+
+  size_t end = 0;
+  size_t length = STREAMING_FIRST_SEGMENT_WAYPOINTS;
+  // a short remainder is appended to the last segment
+  while (last - end >= length + STREAMING_FIRST_SEGMENT_WAYPOINTS)
+  {
+    end += length;
+    segment_ends->push_back(end);
+    length *= 2;
+  }
+  segment_ends->push_back(last);
+}
+
+RLLErrorCode RLLMoveIfacePlanning::planLinearSegment(const robot_state::RobotState& start_state,
+                                                     const geometry_msgs::Pose& goal,
+                                                     const planning_scene::PlanningScene& planning_scene,
+                                                     robot_state::RobotState* end_state,
+                                                     moveit::planning_interface::MoveGroupInterface::Plan* plan)
+{
+  robot_trajectory::RobotTrajectory rt(manip_model_, manip_move_group_.getName());
+  RLLErrorCode error_code = computeLinearPath(start_state, goal, planning_scene, &rt);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  rt.getRobotTrajectoryMsg(plan->trajectory_);
+  *end_state = rt.getLastWayPoint();
+  error_code = checkTrajectory(plan->trajectory_);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  bool success;
+  {
+    RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::TRAJECTORY_MODIFICATION);
+    success = modifyPtpTrajectory(&plan->trajectory_);
+  }
+  if (!success)
+  {
+    return RLLErrorCode::TRAJECTORY_MODIFICATION_FAILED;
+  }
+
+  compressTrajectory(&plan->trajectory_);
+  return RLLErrorCode::SUCCESS;
+}
+
+void RLLMoveIfacePlanning::compressTrajectory(moveit_msgs::RobotTrajectory* trajectory)
+{
+  if (!trajectory_compression_)
+  {
+    return;
+  }
+
+  // the flange positions of the original points, the orientation is bounded by the joint tolerance
+  std::vector<geometry_msgs::Point> positions;
+  geometry_msgs::Pose pose;
+  double arm_angle;
+  int config;
+  for (const auto& point : trajectory->joint_trajectory.points)
+  {
+    kinematics_plugin_->getPositionFK(point.positions, &pose, &arm_angle, &config);
+    positions.push_back(pose.position);
+  }
+
+  auto cartesian_error = [&](size_t i, const std::vector<double>& interpolated) {
+    kinematics_plugin_->getPositionFK(interpolated, &pose, &arm_angle, &config);
+    return std::sqrt(std::pow(pose.position.x - positions[i].x, 2) + std::pow(pose.position.y - positions[i].y, 2) +
+                     std::pow(pose.position.z - positions[i].z, 2));
+  };
+
+  RLLTrajectoryCompression compression(COMPRESSION_JOINT_TOLERANCE, COMPRESSION_CARTESIAN_TOLERANCE, cartesian_error);
+  size_t num_points = trajectory->joint_trajectory.points.size();
+  size_t num_removed = compression.compress(&trajectory->joint_trajectory);
+  ROS_DEBUG("compressed the trajectory from %lu to %lu points", num_points, num_points - num_removed);
 }
 
 RLLErrorCode RLLMoveIfacePlanning::checkTrajectory(const moveit_msgs::RobotTrajectory& trajectory)
@@ -432,16 +899,47 @@ RLLErrorCode RLLMoveIfacePlanning::checkTrajectory(const moveit_msgs::RobotTraje
   return RLLErrorCode::SUCCESS;
 }
 
+bool RLLMoveIfacePlanning::cachedTrajectoryValid(const moveit_msgs::RobotTrajectory& trajectory)
+{
+  if (checkTrajectory(trajectory).failed())
+  {
+    return false;
+  }
+
+  robot_trajectory::RobotTrajectory rt(manip_model_, MANIP_PLANNING_GROUP);
+  rt.setRobotTrajectoryMsg(getCurrentRobotState(), trajectory);
+  if (!isPathValid(*planning_scene_, rt))
+  {
+    ROS_INFO("cached trajectory is no longer collision free, replanning");
+    return false;
+  }
+
+  return true;
+}
+
 std::vector<double> RLLMoveIfacePlanning::getJointValuesFromNamedTarget(const std::string& name)
 {
-  std::vector<double> goal;
-  std::map<std::string, double> home_pose = manip_move_group_.getNamedTargetValues(name);
+  auto cached = named_target_joint_values_.find(name);
+  if (cached != named_target_joint_values_.end())
+  {
+    return cached->second;
+  }
 
+  std::vector<double> goal;
+  std::map<std::string, double> named_values = manip_move_group_.getNamedTargetValues(name);
   goal.reserve(RLL_NUM_JOINTS);
-  for (const auto& it : home_pose)
+  for (const auto& joint_name : manip_joint_model_group_->getVariableNames())
   {
-    goal.push_back(it.second);
+    auto it = named_values.find(joint_name);
+    if (it == named_values.end())
+    {
+      ROS_WARN("named target %s has no value for joint %s", name.c_str(), joint_name.c_str());
+      return {};
+    }
+    goal.push_back(it->second);
   }
+
+  named_target_joint_values_[name] = goal;
   return goal;
 }
 
@@ -462,7 +960,7 @@ bool RLLMoveIfacePlanning::poseGoalTooClose(const geometry_msgs::Pose& goal)
 {
   std::vector<double> goal_joints;
   moveit_msgs::MoveItErrorCodes error_code;
-  std::vector<double> seed = manip_move_group_.getCurrentJointValues();
+  std::vector<double> seed = getCurrentManipJointValues();
 
   geometry_msgs::Pose pose_tip = goal;
   transformPoseForIK(&pose_tip);
@@ -504,25 +1002,41 @@ RLLErrorCode RLLMoveIfacePlanning::poseGoalInCollision(const geometry_msgs::Pose
 
 RLLErrorCode RLLMoveIfacePlanning::poseGoalInCollision(const geometry_msgs::Pose& goal,
                                                        std::vector<double>* goal_joint_values)
+{
+  return poseGoalInCollision(goal, getCurrentRobotState(), *planning_scene_, goal_joint_values, true);
+}
+
+RLLErrorCode RLLMoveIfacePlanning::poseGoalInCollision(const geometry_msgs::Pose& goal,
+                                                       const robot_state::RobotState& current_state,
+                                                       const planning_scene::PlanningScene& planning_scene,
+                                                       std::vector<double>* goal_joint_values, bool use_ik_cache)
 {
   RLLKinSeedState ik_seed_state;
   RLLInvKinOptions ik_options;
   RLLKinSolutions ik_solutions;
   std::vector<double> current_joint_values(RLL_NUM_JOINTS);
-
-  robot_state::RobotState current_state = getCurrentRobotState();
   current_state.copyJointGroupPositions(manip_joint_model_group_, current_joint_values);
 
   ik_options.global_configuration_mode = RLLInvKinOptions::RETURN_ALL_GLOBAL_CONFIGS;
-  geometry_msgs::Pose goal_ik = goal;
-  transformPoseForIK(&goal_ik);
-  ik_seed_state.emplace_back(current_joint_values);
-  ik_seed_state.emplace_back(current_joint_values);
-  RLLKinMsg result = kinematics_plugin_->callRLLIK(goal_ik, ik_seed_state, &ik_solutions, ik_options);
-  if (result.error())
+  RLLKinGlobalConfig seed_config(current_joint_values);
+  if (!use_ik_cache || !goal_ik_cache_.lookup(goal, seed_config, &ik_solutions))
   {
-    ROS_WARN_STREAM("no IK solution found for given goal pose: " << result.message());
-    return RLLErrorCode::NO_IK_SOLUTION_FOUND;
+    geometry_msgs::Pose goal_ik = goal;
+    transformPoseForIK(&goal_ik);
+    ik_seed_state.emplace_back(current_joint_values);
+    ik_seed_state.emplace_back(current_joint_values);
+    RLLKinMsg result = kinematics_plugin_->callRLLIK(goal_ik, ik_seed_state, &ik_solutions, ik_options);
+    metrics_.countIK(!result.error());
+    if (result.error())
+    {
+      ROS_WARN_STREAM("no IK solution found for given goal pose: " << result.message());
+      return RLLErrorCode::NO_IK_SOLUTION_FOUND;
+    }
+
+    if (use_ik_cache)
+    {
+      goal_ik_cache_.insert(goal, seed_config, ik_solutions);
+    }
   }
 
   robot_state::RobotState goal_state = current_state;
@@ -530,7 +1044,7 @@ RLLErrorCode RLLMoveIfacePlanning::poseGoalInCollision(const geometry_msgs::Pose
   {
     ik_solutions[i].getJoints(goal_joint_values);
     goal_state.setJointGroupPositions(manip_joint_model_group_, *goal_joint_values);
-    if (!stateInCollision(&goal_state))
+    if (!stateInCollision(planning_scene, &goal_state))
     {
       return RLLErrorCode::SUCCESS;
     }
@@ -540,6 +1054,117 @@ RLLErrorCode RLLMoveIfacePlanning::poseGoalInCollision(const geometry_msgs::Pose
   return RLLErrorCode::GOAL_IN_COLLISION;
 }
 
+void RLLMoveIfacePlanning::sampleRandomGoals(size_t num_candidates, std::vector<RandomGoal>* goals)
+{
+  robot_state::RobotState current_state = getCurrentRobotState();
+  planning_scene::PlanningScenePtr planning_scene = clonePlanningScene();
+  std::vector<double> current_joint_values;
+  current_state.copyJointGroupPositions(manip_joint_model_group_, current_joint_values);
+  geometry_msgs::Pose current_pose = getCurrentManipPose();
+  const moveit::core::LinkModel* ee_link = manip_model_->getLinkModel(manip_move_group_.getEndEffectorLink());
+
+  std::vector<RandomGoal> candidates(num_candidates);
+  std::vector<char> valid(num_candidates, 0);
+  std::random_device random_device;
+  const uint32_t base_seed = random_device();
+  std::atomic<size_t> next_candidate{ 0 };
+  std::atomic<size_t> num_no_ik{ 0 }, num_too_close{ 0 }, num_in_collision{ 0 };
+
+  auto sample = [&]() {
+    robot_state::RobotState state = current_state;
+    for (size_t i = next_candidate.fetch_add(1); i < num_candidates; i = next_candidate.fetch_add(1))
+    {
+      random_numbers::RandomNumberGenerator rng(base_seed + i);
+      state.setToRandomPositions(manip_joint_model_group_, rng);
+      state.update();
+      RandomGoal* candidate = &candidates[i];
+      tf::poseEigenToMsg(state.getGlobalLinkTransform(ee_link), candidate->pose);
+
+      // same checks as poseGoalTooClose(), but against the state from before sampling
+      std::vector<double> ik_joints;
+      moveit_msgs::MoveItErrorCodes error_code;
+      geometry_msgs::Pose pose_tip = candidate->pose;
+      transformPoseForIK(&pose_tip);
+      if (!kinematics_plugin_->searchPositionIK(pose_tip, current_joint_values, 0.1, ik_joints, error_code))
+      {
+        ROS_DEBUG("random pose %zu has no IK solution", i);
+        ++num_no_ik;
+        continue;
+      }
+
+      if (jointsGoalTooClose(current_joint_values, ik_joints) ||
+          std::hypot(std::hypot(candidate->pose.position.x - current_pose.position.x,
+                                candidate->pose.position.y - current_pose.position.y),
+                     candidate->pose.position.z - current_pose.position.z) <= 0.001)
+      {
+        ROS_DEBUG("random pose %zu too close to start pose", i);
+        ++num_too_close;
+        continue;
+      }
+
+      candidate->joint_values.resize(RLL_NUM_JOINTS);
+      RLLErrorCode collision_code =
+          poseGoalInCollision(candidate->pose, current_state, *planning_scene, &candidate->joint_values, false);
+      if (collision_code.failed())
+      {
+        ROS_DEBUG("random pose %zu is in collision", i);
+        ++num_in_collision;
+        continue;
+      }
+
+      valid[i] = 1;
+    }
+  };
+
+  size_t num_threads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), num_candidates));
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t)
+  {
+    threads.emplace_back(sample);
+  }
+  sample();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  goals->clear();
+  for (size_t i = 0; i < num_candidates; ++i)
+  {
+    if (valid[i] != 0)
+    {
+      goals->push_back(std::move(candidates[i]));
+    }
+  }
+
+  ROS_INFO("%zu of %zu random poses are valid, rejected %zu without IK solution, %zu too close to the start pose and "
+           "%zu in collision",
+           goals->size(), num_candidates, num_no_ik.load(), num_too_close.load(), num_in_collision.load());
+}
+
+std::vector<double> RLLMoveIfacePlanning::getCurrentManipJointValues()
+{
+  std::vector<double> joint_values;
+  if (!joint_state_monitor_.trackedPositions(&joint_values))
+  {
+    joint_values = manip_move_group_.getCurrentJointValues();
+  }
+
+  return joint_values;
+}
+
+geometry_msgs::Pose RLLMoveIfacePlanning::getCurrentManipPose(double* arm_angle, int* config)
+{
+  geometry_msgs::Pose pose;
+  double arm_angle_tmp;
+  int config_tmp;
+  kinematics_plugin_->getPositionFK(getCurrentManipJointValues(), &pose,
+                                    arm_angle != nullptr ? arm_angle : &arm_angle_tmp,
+                                    config != nullptr ? config : &config_tmp);
+  transformPoseFromFK(&pose);
+  return pose;
+}
+
 robot_state::RobotState RLLMoveIfacePlanning::getCurrentRobotState(bool wait_for_state)
 {
   if (wait_for_state)
@@ -553,9 +1178,28 @@ robot_state::RobotState RLLMoveIfacePlanning::getCurrentRobotState(bool wait_for
   return planning_scene_rw->getCurrentState();
 }
 
+planning_scene::PlanningScenePtr RLLMoveIfacePlanning::clonePlanningScene()
+{
+  planning_scene_monitor::LockedPlanningSceneRO planning_scene_ro(planning_scene_monitor_);
+  return planning_scene::PlanningScene::clone(planning_scene_ro);
+}
+
 bool RLLMoveIfacePlanning::stateInCollision(robot_state::RobotState* state)
+{
+  return stateInCollision(*planning_scene_, state);
+}
+
+bool RLLMoveIfacePlanning::stateInCollision(const planning_scene::PlanningScene& planning_scene,
+                                            robot_state::RobotState* state)
 {
   state->update(true);
+  std::string link_name;
+  if (goal_pre_check_ && collision_pre_check_->inCollision(planning_scene, acm_, *state, &link_name))
+  {
+    ROS_INFO("Link %s is deep in collision with the static environment", link_name.c_str());
+    return true;
+  }
+
   collision_detection::CollisionRequest request;
   request.distance = true;
   request.verbose = true;
@@ -565,7 +1209,7 @@ bool RLLMoveIfacePlanning::stateInCollision(robot_state::RobotState* state)
 
   collision_detection::CollisionResult result;
   result.clear();
-  planning_scene_->checkCollision(request, result, *state, acm_);
+  planning_scene.checkCollision(request, result, *state, acm_);
 
   // TODO(mark): outputting the collision info here is redundant if a verbose CollisionRequest is used.
   // However, it might be usefull if this info is printed/published somewhere in the future
@@ -602,21 +1246,23 @@ void RLLMoveIfacePlanning::updateCollisionEntry(const std::string& link_1, const
   // we need a local copy because checkCollision doesn't automatically use the
   // updated collision matrix from the planning scene
   acm_ = planning_scene_rw->getAllowedCollisionMatrixNonConst();
+  if (collision_pre_check_)
+  {
+    collision_pre_check_->invalidate();
+  }
 }
 
 RLLErrorCode RLLMoveIfacePlanning::computeLinearPathArmangle(const std::vector<geometry_msgs::Pose>& waypoints_pose,
                                                              const std::vector<double>& waypoints_arm_angles,
                                                              const std::vector<double>& ik_seed_state,
-                                                             std::vector<robot_state::RobotStatePtr>* path)
+                                                             RLLJointPath* path)
 {
   double last_valid_percentage = 0.0;
   getPathIK(waypoints_pose, waypoints_arm_angles, ik_seed_state, path, &last_valid_percentage);
-
-  std::vector<robot_state::RobotStatePtr> traj;
+  metrics_.countIK(last_valid_percentage >= 1.0);
 
   // test for jump_threshold
-  moveit::core::JumpThreshold thresh(DEFAULT_LINEAR_JUMP_THRESHOLD);
-  last_valid_percentage *= robot_state::RobotState::testJointSpaceJump(manip_joint_model_group_, *path, thresh);
+  last_valid_percentage *= testJointSpaceJump(path);
 
   if (last_valid_percentage < 1.0 && last_valid_percentage > 0.0)
   {  // TODO(updim): visualize path until collision
@@ -632,55 +1278,188 @@ RLLErrorCode RLLMoveIfacePlanning::computeLinearPathArmangle(const std::vector<g
   return RLLErrorCode::SUCCESS;
 }
 
-void RLLMoveIfacePlanning::getPathIK(const std::vector<geometry_msgs::Pose>& waypoints_pose,
-                                     const std::vector<double>& ik_seed_state,
-                                     std::vector<robot_state::RobotStatePtr>* path, double* last_valid_percentage)
+void RLLMoveIfacePlanning::jointPathToTrajectory(const RLLJointPath& path,
+                                                 const robot_state::RobotState& state_template,
+                                                 robot_trajectory::RobotTrajectory* trajectory)
 {
-  RLLInvKinOptions ik_options;
-  RLLKinSolutions ik_solutions;
-  RLLKinSeedState seed_state;
-  robot_state::RobotState tmp_state = getCurrentRobotState();
-  std::vector<double> sol(RLL_NUM_JOINTS);
-  std::vector<double> seed_tmp_1 = ik_seed_state;
-  std::vector<double> seed_tmp_2 = ik_seed_state;
+  robot_state::RobotState tmp_state = state_template;
+  trajectory->clear();
+  for (size_t i = 0; i < path.size(); ++i)
+  {
+    tmp_state.setJointGroupPositions(manip_joint_model_group_, path[i]);
+    trajectory->addSuffixWayPoint(tmp_state, 0.0);
+  }
+}
+
+double RLLMoveIfacePlanning::testJointSpaceJump(RLLJointPath* path)
+{
+  return path->testRelativeJointSpaceJump(
+      [this](const double* lhs, const double* rhs) { return manip_joint_model_group_->distance(lhs, rhs); },
+      DEFAULT_LINEAR_JUMP_THRESHOLD);
+}
 
+RLLInvKinOptions RLLMoveIfacePlanning::pathIKOptions()
+{
+  RLLInvKinOptions ik_options;
   ik_options.joint_velocity_scaling_factor = DEFAULT_VELOCITY_SCALING_FACTOR;
   ik_options.joint_acceleration_scaling_factor = DEFAULT_ACCELERATION_SCALING_FACTOR;
   ik_options.global_configuration_mode = RLLInvKinOptions::KEEP_CURRENT_GLOBAL_CONFIG;
+  ik_options.stop_at_arm_angle_jump = true;
+  return ik_options;
+}
 
-  tmp_state.setJointGroupPositions(manip_joint_model_group_, ik_seed_state);
-  path->push_back(std::make_shared<moveit::core::RobotState>(tmp_state));
+void RLLMoveIfacePlanning::getPathIK(const std::vector<geometry_msgs::Pose>& waypoints_pose,
+                                     const std::vector<double>& ik_seed_state, RLLJointPath* path,
+                                     double* last_valid_percentage)
+{
+  RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::PATH_IK);
+  phase_timers_.count(RLLPhaseCounter::IK_WAYPOINTS, waypoints_pose.size());
+  RLLInvKinOptions ik_options = pathIKOptions();
+  RLLKinSeedState seed_state;
+  std::vector<double> sol(RLL_NUM_JOINTS);
 
-  for (size_t i = 1; i < waypoints_pose.size(); i++)
+  path->clear(ik_seed_state.size());
+  path->reserve(waypoints_pose.size());
+  path->push_back(ik_seed_state);
+
+  // the first waypoint is the start state, all others are solved in one call
+  seed_state.emplace_back(ik_seed_state);
+  seed_state.emplace_back(ik_seed_state);
+  std::vector<RLLKinJoints> ik_solutions;
+  RLLKinMsg result = kinematics_plugin_->callRLLIKPath(waypoints_pose, 1, seed_state, &ik_solutions, ik_options);
+
+  for (const auto& ik_solution : ik_solutions)
   {
-    seed_state.clear();
-    seed_state.emplace_back(seed_tmp_1);
-    seed_state.emplace_back(seed_tmp_2);
+    ik_solution.getJoints(&sol);
+    path->push_back(sol);
+  }
 
-    RLLKinMsg result = kinematics_plugin_->callRLLIK(waypoints_pose[i], seed_state, &ik_solutions, ik_options);
-    if (result.error())
+  if (path->size() < waypoints_pose.size())
+  {
+    // TODO(wolfgang): also print pose where IK failed
+    logPathIKFailure(result, path->size());
+    *last_valid_percentage = static_cast<double>(path->size()) / static_cast<double>(waypoints_pose.size());
+    return;
+  }
+
+  *last_valid_percentage = 1.0;
+}
+
+void RLLMoveIfacePlanning::logPathIKFailure(const RLLKinMsg& result, const size_t waypoint)
+{
+  if (result.val() == RLLKinMsg::ARMANGLE_NOT_IN_SAME_INTERVAL)
+  {
+    ROS_ERROR("the joints would jump at waypoint %lu, the arm angle leaves its feasible interval", waypoint);
+  }
+  else
+  {
+    ROS_ERROR("no IK solution for waypoint %lu: %s", waypoint, result.message());
+  }
+}
+
+void RLLMoveIfacePlanning::getPathIKAdaptive(const robot_state::RobotState& state_template,
+                                             const std::vector<geometry_msgs::Pose>& waypoints_pose,
+                                             const std::vector<double>& ik_seed_state,
+                                             const planning_scene::PlanningScene& planning_scene, RLLJointPath* path,
+                                             double* last_valid_percentage)
+{
+  size_t last = waypoints_pose.size() - 1;
+  // keep enough waypoints for the jump test, even if no segment is refined
+  size_t stride = std::min(ADAPTIVE_MAX_STRIDE, last / LINEAR_MIN_STEPS_FOR_JUMP_THRESH);
+  LinkRadii radii;
+  if (stride <= 1 || !collisionRadii(planning_scene, state_template, &radii))
+  {
+    getPathIK(waypoints_pose, ik_seed_state, path, last_valid_percentage);
+    return;
+  }
+
+  RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::PATH_IK);
+  RLLInvKinOptions ik_options = pathIKOptions();
+  RLLKinSeedState seed_state;
+  seed_state.emplace_back(ik_seed_state);
+  seed_state.emplace_back(ik_seed_state);
+
+  path->clear(ik_seed_state.size());
+  path->push_back(ik_seed_state);
+  size_t last_solved = 0;
+
+  robot_state::RobotState segment_start = state_template;
+  robot_state::RobotState segment_end = state_template;
+  segment_start.setJointGroupPositions(manip_joint_model_group_, ik_seed_state);
+  segment_start.update();
+  double start_clearance = clearance(planning_scene, segment_start);
+
+  std::vector<geometry_msgs::Pose> segment_poses;
+  std::vector<RLLKinJoints> ik_solutions;
+  std::vector<double> sol(RLL_NUM_JOINTS);
+  size_t num_solved_poses = 0;
+  size_t i = 0;
+  while (i < last)
+  {
+    size_t next = std::min(i + stride, last);
+
+    // try to reach the end of the segment in one step
+    segment_poses.assign({ waypoints_pose[i], waypoints_pose[next] });
+    RLLKinMsg result = kinematics_plugin_->callRLLIKPath(segment_poses, 1, seed_state, &ik_solutions, ik_options);
+    ++num_solved_poses;
+
+    bool refine = ik_solutions.empty();
+    if (!refine)
     {
-      // TODO(wolfgang): also print pose where IK failed
-      *last_valid_percentage = static_cast<double>(i) / static_cast<double>(waypoints_pose.size());
+      ik_solutions.back().getJoints(&sol);
+      segment_end.setJointGroupPositions(manip_joint_model_group_, sol);
+      segment_end.update();
+      // the joints are interpolated between the waypoints, so the motion within the segment has to stay small and
+      // clear of obstacles
+      refine = manip_joint_model_group_->distance(path->back(), sol.data()) > ADAPTIVE_MAX_JOINT_STEP ||
+               2.0 * maxDisplacement(radii, segment_start, segment_end) >= start_clearance;
+    }
+
+    // a segment of a single step cannot be refined any further
+    refine = refine && next > i + 1;
+    if (refine)
+    {
+      segment_poses.assign(waypoints_pose.begin() + i, waypoints_pose.begin() + next + 1);
+      result = kinematics_plugin_->callRLLIKPath(segment_poses, 1, seed_state, &ik_solutions, ik_options);
+      num_solved_poses += segment_poses.size() - 1;
+    }
+
+    for (size_t k = 0; k < ik_solutions.size(); ++k)
+    {
+      ik_solutions[k].getJoints(&sol);
+      path->push_back(sol);
+      last_solved = refine ? i + k + 1 : next;
+      seed_state[1] = seed_state[0];
+      seed_state[0] = ik_solutions[k];
+    }
+
+    // stopped at a waypoint without a solution or at a jump
+    if (last_solved < next)
+    {
+      phase_timers_.count(RLLPhaseCounter::IK_WAYPOINTS, num_solved_poses);
+      logPathIKFailure(result, last_solved + 1);
+      *last_valid_percentage = static_cast<double>(last_solved + 1) / static_cast<double>(waypoints_pose.size());
       return;
     }
 
-    ik_solutions.front().getJoints(&sol);
-    seed_tmp_2 = seed_tmp_1;
-    seed_tmp_1 = sol;
-    tmp_state.setJointGroupPositions(manip_joint_model_group_, sol);
-    path->push_back(std::make_shared<moveit::core::RobotState>(tmp_state));
+    segment_start.setJointGroupPositions(manip_joint_model_group_, path->back());
+    segment_start.update();
+    start_clearance = clearance(planning_scene, segment_start);
+    i = next;
   }
 
+  phase_timers_.count(RLLPhaseCounter::IK_WAYPOINTS, num_solved_poses);
+  ROS_INFO("adaptive interpolation kept %lu of %lu waypoints", path->size(), waypoints_pose.size());
   *last_valid_percentage = 1.0;
 }
 
 void RLLMoveIfacePlanning::getPathIK(const std::vector<geometry_msgs::Pose>& waypoints_pose,
                                      const std::vector<double>& waypoints_arm_angles,
                                      const std::vector<double>& ik_seed_state,
-                                     std::vector<robot_state::RobotStatePtr>* path, double* last_valid_percentage)
+                                     RLLJointPath* path, double* last_valid_percentage)
 {
-  robot_state::RobotState tmp_state = getCurrentRobotState();
+  RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::PATH_IK);
+  phase_timers_.count(RLLPhaseCounter::IK_WAYPOINTS, waypoints_pose.size());
   std::vector<double> sol(RLL_NUM_JOINTS);
   std::vector<double> seed_tmp = ik_seed_state;
 
@@ -691,11 +1470,40 @@ void RLLMoveIfacePlanning::getPathIK(const std::vector<geometry_msgs::Pose>& way
     return;
   }
 
-  tmp_state.setJointGroupPositions(manip_joint_model_group_, ik_seed_state);
-  path->push_back(std::make_shared<moveit::core::RobotState>(tmp_state));
+  path->clear(ik_seed_state.size());
+  path->reserve(waypoints_pose.size());
+  path->push_back(ik_seed_state);
 
-  for (size_t i = 1; i < waypoints_pose.size(); i++)
+  for (size_t i = 1; i < waypoints_pose.size();)
   {
+    // the pose repeats in arm angle motions, the IK coefficients of such a run are computed only once
+    size_t end = i + 1;
+    while (end < waypoints_pose.size() && samePose(waypoints_pose[i], waypoints_pose[end]))
+    {
+      ++end;
+    }
+
+    if (end - i > 1)
+    {
+      std::vector<double> arm_angles(waypoints_arm_angles.begin() + i, waypoints_arm_angles.begin() + end);
+      std::vector<std::vector<double>> solutions;
+      bool success = kinematics_plugin_->getPositionIKarmangles(waypoints_pose[i], seed_tmp, arm_angles, &solutions);
+      for (const auto& solution : solutions)
+      {
+        path->push_back(solution);
+      }
+
+      if (!success)
+      {
+        *last_valid_percentage = static_cast<double>(i + solutions.size()) / static_cast<double>(waypoints_pose.size());
+        return;
+      }
+
+      seed_tmp = solutions.back();
+      i = end;
+      continue;
+    }
+
     moveit_msgs::MoveItErrorCodes error_code;
     bool success = kinematics_plugin_->getPositionIKarmangle(waypoints_pose[i], seed_tmp, &sol, &error_code,
                                                              waypoints_arm_angles[i]);
@@ -706,8 +1514,8 @@ void RLLMoveIfacePlanning::getPathIK(const std::vector<geometry_msgs::Pose>& way
     }
 
     seed_tmp = sol;
-    tmp_state.setJointGroupPositions(manip_joint_model_group_, sol);
-    path->push_back(std::make_shared<moveit::core::RobotState>(tmp_state));
+    path->push_back(sol);
+    ++i;
   }
 
   *last_valid_percentage = 1.0;
@@ -812,6 +1620,124 @@ void RLLMoveIfacePlanning::interpolateArmangleLinear(const double start, const d
   }
 }
 
+bool RLLMoveIfacePlanning::isPathValid(const planning_scene::PlanningScene& planning_scene,
+                                       const robot_trajectory::RobotTrajectory& trajectory)
+{
+  RLLPhaseTimers::ScopedTimer timer(&phase_timers_, RLLTimedPhase::PATH_VALIDITY_CHECK);
+  std::unique_ptr<RLLSphereProxyCheck> proxy_check;
+  if (sphere_proxy_check_ && !trajectory.empty())
+  {
+    proxy_check.reset(
+        new RLLSphereProxyCheck(collision_pre_check_.get(), planning_scene, trajectory.getFirstWayPoint()));
+  }
+
+  auto state_valid = [&](const robot_state::RobotState& state) {
+    return proxy_check ? proxy_check->isStateValid(state) : planning_scene.isStateValid(state);
+  };
+
+  LinkRadii radii;
+  bool valid;
+  if (!continuous_collision_checking_ || trajectory.empty() ||
+      !collisionRadii(planning_scene, trajectory.getFirstWayPoint(), &radii))
+  {
+    if (!proxy_check)
+    {
+      return planning_scene.isPathValid(trajectory);
+    }
+
+    valid = true;
+    for (size_t i = 0; i < trajectory.getWayPointCount() && valid; ++i)
+    {
+      valid = state_valid(trajectory.getWayPoint(i));
+    }
+  }
+  else
+  {
+    RLLConservativeAdvancement advancement(
+        [&](size_t i) { return !state_valid(trajectory.getWayPoint(i)); },
+        [&](size_t i) { return clearance(planning_scene, trajectory.getWayPoint(i)); },
+        [&](size_t from, size_t to) {
+          return maxDisplacement(radii, trajectory.getWayPoint(from), trajectory.getWayPoint(to));
+        });
+
+    valid = advancement.isPathValid(trajectory.getWayPointCount());
+    ROS_DEBUG("checked %lu of %lu waypoints for collisions, %lu clearance queries", advancement.numCollisionChecks(),
+              trajectory.getWayPointCount(), advancement.numClearanceQueries());
+  }
+
+  if (proxy_check)
+  {
+    ROS_DEBUG("sphere proxies rejected %lu and cleared %lu of %lu checked states", proxy_check->numRejected(),
+              proxy_check->numCleared(), proxy_check->numChecked());
+  }
+  return valid;
+}
+
+bool RLLMoveIfacePlanning::collisionRadii(const planning_scene::PlanningScene& planning_scene,
+                                          const robot_state::RobotState& state, LinkRadii* radii)
+{
+  // radius of a sphere around the link origin that encloses the collision geometry of the link and its attached bodies
+  radii->clear();
+  for (const moveit::core::LinkModel* link : planning_scene.getRobotModel()->getLinkModelsWithCollisionGeometry())
+  {
+    (*radii)[link] = link->getCenteredBoundingBoxOffset().norm() + 0.5 * link->getShapeExtentsAtOrigin().norm();
+  }
+
+  std::vector<const moveit::core::AttachedBody*> attached_bodies;
+  state.getAttachedBodies(attached_bodies);
+  for (const moveit::core::AttachedBody* attached_body : attached_bodies)
+  {
+    double& radius = (*radii)[attached_body->getAttachedLink()];
+    for (size_t i = 0; i < attached_body->getShapes().size(); ++i)
+    {
+      std::unique_ptr<bodies::Body> body(bodies::createBodyFromShape(attached_body->getShapes()[i].get()));
+      if (!body)
+      {
+        return false;
+      }
+
+      bodies::BoundingSphere sphere;
+      body->computeBoundingSphere(sphere);
+      radius = std::max(radius, (attached_body->getFixedTransforms()[i] * sphere.center).norm() + sphere.radius);
+    }
+  }
+
+  const collision_detection::CollisionRobotConstPtr& collision_robot = planning_scene.getCollisionRobot();
+  for (auto& link_radius : *radii)
+  {
+    const std::string& link_name = link_radius.first->getName();
+    link_radius.second =
+        link_radius.second * collision_robot->getLinkScale(link_name) + collision_robot->getLinkPadding(link_name);
+  }
+
+  return true;
+}
+
+double RLLMoveIfacePlanning::clearance(const planning_scene::PlanningScene& planning_scene,
+                                       const robot_state::RobotState& state)
+{
+  // self-collisions can approach from both links
+  double self_distance =
+      planning_scene.getCollisionRobot()->distanceSelf(state, planning_scene.getAllowedCollisionMatrix());
+  return std::min(planning_scene.distanceToCollision(state), 0.5 * self_distance) - CONTINUOUS_COLLISION_SAFETY_MARGIN;
+}
+
+double RLLMoveIfacePlanning::maxDisplacement(const LinkRadii& radii, const robot_state::RobotState& start,
+                                             const robot_state::RobotState& end)
+{
+  double displacement = 0.0;
+  for (const auto& link_radius : radii)
+  {
+    const auto& start_pose = start.getGlobalLinkTransform(link_radius.first);
+    const auto& end_pose = end.getGlobalLinkTransform(link_radius.first);
+    double angle = Eigen::Quaterniond(start_pose.linear()).angularDistance(Eigen::Quaterniond(end_pose.linear()));
+    displacement = std::max(displacement, (end_pose.translation() - start_pose.translation()).norm() +
+                                              2.0 * std::sin(0.5 * angle) * link_radius.second);
+  }
+
+  return displacement;
+}
+
 void RLLMoveIfacePlanning::transformPoseForIK(geometry_msgs::Pose* pose)
 {
   tf::Transform world_to_ee, base_to_tip;
@@ -855,11 +1781,29 @@ bool RLLMoveIfacePlanning::getKinematicsSolver()
   return true;
 }
 
-bool RLLMoveIfacePlanning::initConstTransforms()
+RLLConstTransformCache RLLMoveIfacePlanning::constTransformCache()
+{
+  std::string file_name;
+  if (!ros::param::get("~const_transform_cache", file_name))
+  {
+    const char* ros_home = std::getenv("ROS_HOME");
+    const char* home = std::getenv("HOME");
+    std::string dir = ros_home != nullptr ? ros_home : std::string(home != nullptr ? home : "/tmp") + "/.ros";
+    file_name = dir + "/rll_const_transforms_" + ns_ + ".txt";
+  }
+
+  // the transforms depend on the robot description and the frames
+  std::string robot_description;
+  ros::param::get("robot_description", robot_description);
+  std::string key = std::to_string(std::hash<std::string>()(robot_description)) + " " +
+                    manip_move_group_.getEndEffectorLink() + " " + kinematics_plugin_->getTipFrame() + " " +
+                    kinematics_plugin_->getBaseFrame() + " " + manip_move_group_.getPlanningFrame();
+  return RLLConstTransformCache(file_name, key);
+}
+
+bool RLLMoveIfacePlanning::initConstTransforms(const tf2_ros::Buffer& tf_buffer)
 {
   // Static Transformations between frames
-  tf2_ros::Buffer tf_buffer;
-  tf2_ros::TransformListener tf_listener(tf_buffer);
   geometry_msgs::TransformStamped ee_to_tip_stamped, base_to_world_stamped;
   std::string world_frame = manip_move_group_.getPlanningFrame();
 #if ROS_VERSION_MINIMUM(1, 14, 3)  // Melodic
@@ -868,22 +1812,53 @@ bool RLLMoveIfacePlanning::initConstTransforms()
   // remove slash -> TODO(mark): there might not even be a slash! e.g. starting manually with ROS_NAMESPACE=iiwa
   world_frame.erase(0, 1);
 #endif
+
+  // with cached transforms, tf only gets a short time to revalidate them
+  RLLConstTransformCache cache = constTransformCache();
+  RLLConstTransformCache::Transform cached_ee_to_tip, cached_base_to_world;
+  bool cached = fast_startup_ && cache.load() && cache.lookup(EE_TO_TIP_TRANSFORM, &cached_ee_to_tip) &&
+                cache.lookup(BASE_TO_WORLD_TRANSFORM, &cached_base_to_world);
+  ros::Duration timeout(cached ? 0.2 : 1.0);
+
   try
   {
     ee_to_tip_stamped = tf_buffer.lookupTransform(manip_move_group_.getEndEffectorLink(),
-                                                  kinematics_plugin_->getTipFrame(), ros::Time(0), ros::Duration(1.0));
+                                                  kinematics_plugin_->getTipFrame(), ros::Time(0), timeout);
     base_to_world_stamped =
-        tf_buffer.lookupTransform(kinematics_plugin_->getBaseFrame(), world_frame, ros::Time(0), ros::Duration(1.0));
+        tf_buffer.lookupTransform(kinematics_plugin_->getBaseFrame(), world_frame, ros::Time(0), timeout);
   }
   catch (tf2::TransformException& ex)
   {
-    ROS_FATAL("%s", ex.what());
-    // abortDueToCriticalFailure(); -> pure virtual => NOT set in VTABLE YET!!
-    return false;
+    if (!cached)
+    {
+      ROS_FATAL("%s", ex.what());
+      // abortDueToCriticalFailure(); -> pure virtual => NOT set in VTABLE YET!!
+      return false;
+    }
+
+    ROS_WARN("constant transforms not available yet, using the cached ones: %s", ex.what());
+    ee_to_tip_ = fromCachedTransform(cached_ee_to_tip);
+    base_to_world_ = fromCachedTransform(cached_base_to_world);
+    return true;
   }
 
   tf::transformMsgToTF(ee_to_tip_stamped.transform, ee_to_tip_);
   tf::transformMsgToTF(base_to_world_stamped.transform, base_to_world_);
+
+  if (fast_startup_)
+  {
+    bool changed = cache.update(EE_TO_TIP_TRANSFORM, toCachedTransform(ee_to_tip_stamped.transform));
+    changed = cache.update(BASE_TO_WORLD_TRANSFORM, toCachedTransform(base_to_world_stamped.transform)) || changed;
+    if (changed && cached)
+    {
+      ROS_WARN("the cached constant transforms were outdated");
+    }
+    if (changed && !cache.save())
+    {
+      ROS_WARN("failed to write the constant transform cache");
+    }
+  }
+
   return true;
 }
 
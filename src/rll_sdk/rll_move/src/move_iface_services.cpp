@@ -18,9 +18,19 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
 #include <moveit/trajectory_processing/iterative_time_parameterization.h>
 #include <rll_move/move_iface_services.h>
 
+namespace
+{
+// a service call begins and ends on the thread of its callback
+thread_local std::chrono::steady_clock::time_point service_call_start;
+}  // namespace
+
 const std::string RLLMoveIfaceServices::ROBOT_READY_SRV_NAME = "robot_ready";
 const std::string RLLMoveIfaceServices::MOVE_PTP_SRV_NAME = "move_ptp";
 const std::string RLLMoveIfaceServices::MOVE_PTP_ARMANGLE_SRV_NAME = "move_ptp_armangle";
@@ -48,17 +58,27 @@ void RLLMoveIfaceServices::setupPermissions()
   // robot ready service check is always allowed
   permissions_.setRequiredPermissionsFor(RLLMoveIfaceServices::ROBOT_READY_SRV_NAME,
                                          Permissions::NO_PERMISSION_REQUIRED);
+
+  robot_ready_srv_ = permissions_.registerService(ROBOT_READY_SRV_NAME);
+  move_ptp_srv_ = permissions_.registerService(MOVE_PTP_SRV_NAME);
+  move_ptp_armangle_srv_ = permissions_.registerService(MOVE_PTP_ARMANGLE_SRV_NAME);
+  move_lin_srv_ = permissions_.registerService(MOVE_LIN_SRV_NAME);
+  move_lin_armangle_srv_ = permissions_.registerService(MOVE_LIN_ARMANGLE_SRV_NAME);
+  move_joints_srv_ = permissions_.registerService(MOVE_JOINTS_SRV_NAME);
+  move_random_srv_ = permissions_.registerService(MOVE_RANDOM_SRV_NAME);
+  get_pose_srv_ = permissions_.registerService(GET_POSE_SRV_NAME);
+  get_joint_values_srv_ = permissions_.registerService(GET_JOINT_VALUES_SRV_NAME);
 }
 
 bool RLLMoveIfaceServices::robotReadySrv(std_srvs::Trigger::Request& /*req*/, std_srvs::Trigger::Response& resp)
 {
-  RLLErrorCode error_code = beforeServiceCall(RLLMoveIfaceServices::ROBOT_READY_SRV_NAME);
+  RLLErrorCode error_code = beforeServiceCall(robot_ready_srv_);
   if (error_code.succeeded())
   {
     error_code = resetToHome();
   }
 
-  error_code = afterServiceCall(RLLMoveIfaceServices::ROBOT_READY_SRV_NAME, error_code);
+  error_code = afterServiceCall(robot_ready_srv_, error_code);
   resp.success = error_code.succeededSrv();
   return true;
 }
@@ -87,11 +107,34 @@ void RLLMoveIfaceServices::handleFailureSeverity(const RLLErrorCode& error_code)
   }
 }
 
+RLLErrorCode RLLMoveIfaceServices::beforeServiceCall(Permissions::ServiceId srv)
+{
+  return beginServiceCall(permissions_.getServiceName(srv), permissions_.getRequiredPermissionsFor(srv));
+}
+
+RLLErrorCode RLLMoveIfaceServices::afterServiceCall(Permissions::ServiceId srv, const RLLErrorCode& previous_error_code)
+{
+  return endServiceCall(permissions_.getServiceName(srv), permissions_.getRequiredPermissionsFor(srv),
+                        previous_error_code);
+}
+
 RLLErrorCode RLLMoveIfaceServices::beforeServiceCall(const std::string& srv_name)
+{
+  return beginServiceCall(srv_name, permissions_.getRequiredPermissionsFor(srv_name));
+}
+
+RLLErrorCode RLLMoveIfaceServices::afterServiceCall(const std::string& srv_name,
+                                                    const RLLErrorCode& previous_error_code)
+{
+  return endServiceCall(srv_name, permissions_.getRequiredPermissionsFor(srv_name), previous_error_code);
+}
+
+RLLErrorCode RLLMoveIfaceServices::beginServiceCall(const std::string& srv_name, Permissions::Group requirements)
 {
   ROS_DEBUG("service '%s' requested", srv_name.c_str());
+  beginServiceMetrics(srv_name);
 
-  bool only_during_job_run = permissions_.isPermissionRequiredFor(srv_name, only_during_job_run_permission_);
+  bool only_during_job_run = permissions_.areBitsSet(requirements, only_during_job_run_permission_);
   RLLErrorCode error_code = iface_state_.beginServiceCall(srv_name, only_during_job_run);
   if (error_code.failed())
   {
@@ -99,7 +142,7 @@ RLLErrorCode RLLMoveIfaceServices::beforeServiceCall(const std::string& srv_name
   }
 
   // check if this service call is permitted
-  if (!permissions_.areAllRequiredPermissionsSetFor(srv_name))
+  if (!permissions_.arePermissionsCurrentlySet(requirements))
   {
     return RLLErrorCode::INSUFFICIENT_PERMISSION;
   }
@@ -112,15 +155,16 @@ RLLErrorCode RLLMoveIfaceServices::beforeServiceCall(const std::string& srv_name
   return RLLErrorCode::SUCCESS;
 }
 
-RLLErrorCode RLLMoveIfaceServices::afterServiceCall(const std::string& srv_name,
-                                                    const RLLErrorCode& previous_error_code)
+RLLErrorCode RLLMoveIfaceServices::endServiceCall(const std::string& srv_name, Permissions::Group requirements,
+                                                  const RLLErrorCode& previous_error_code)
 {
-  bool only_during_job_run = permissions_.isPermissionRequiredFor(srv_name, only_during_job_run_permission_);
+  bool only_during_job_run = permissions_.areBitsSet(requirements, only_during_job_run_permission_);
   RLLErrorCode error_code = iface_state_.endServiceCall(srv_name, only_during_job_run);
   ROS_DEBUG("service '%s' ended", srv_name.c_str());
 
   // a previous error code is probably more specific and takes precedence
   error_code = previous_error_code.determineWorse(error_code);
+  endServiceMetrics(srv_name, error_code);
 
   if (error_code.failed())
   {
@@ -131,71 +175,111 @@ RLLErrorCode RLLMoveIfaceServices::afterServiceCall(const std::string& srv_name,
   return error_code;
 }
 
+void RLLMoveIfaceServices::beginServiceMetrics(const std::string& srv_name)
+{
+  metrics_.service(srv_name)->begin();
+  service_call_start = std::chrono::steady_clock::now();
+}
+
+void RLLMoveIfaceServices::endServiceMetrics(const std::string& srv_name, const RLLErrorCode& error_code)
+{
+  metrics_.service(srv_name)->end(static_cast<uint8_t>(error_code),
+                                  std::chrono::steady_clock::now() - service_call_start);
+}
+
+RLLErrorCode RLLMoveIfaceServices::beforeQueryCall(Permissions::ServiceId srv)
+{
+  const std::string& srv_name = permissions_.getServiceName(srv);
+  ROS_DEBUG("query '%s' requested", srv_name.c_str());
+  beginServiceMetrics(srv_name);
+
+  bool only_during_job_run = permissions_.isPermissionRequiredFor(srv, only_during_job_run_permission_);
+  RLLErrorCode error_code = iface_state_.checkQueryAllowed(srv_name, only_during_job_run);
+  if (error_code.failed())
+  {
+    return error_code;
+  }
+
+  if (!permissions_.areAllRequiredPermissionsSetFor(srv))
+  {
+    return RLLErrorCode::INSUFFICIENT_PERMISSION;
+  }
+
+  if (!manipCurrentStateAvailable())
+  {
+    return RLLErrorCode::MANIPULATOR_NOT_AVAILABLE;
+  }
+
+  return RLLErrorCode::SUCCESS;
+}
+
+RLLErrorCode RLLMoveIfaceServices::afterQueryCall(Permissions::ServiceId srv, const RLLErrorCode& previous_error_code)
+{
+  const std::string& srv_name = permissions_.getServiceName(srv);
+  ROS_DEBUG("query '%s' ended", srv_name.c_str());
+  endServiceMetrics(srv_name, previous_error_code);
+
+  if (previous_error_code.failed())
+  {
+    ROS_WARN("'%s' query failed!", srv_name.c_str());
+    handleFailureSeverity(previous_error_code);
+  }
+
+  return previous_error_code;
+}
+
 bool RLLMoveIfaceServices::moveRandomSrv(rll_msgs::MoveRandom::Request& req, rll_msgs::MoveRandom::Response& resp)
 {
-  return controlledMovementExecution(req, &resp, MOVE_RANDOM_SRV_NAME, &RLLMoveIfaceServices::moveRandom);
+  return controlledMovementExecution(req, &resp, move_random_srv_, &RLLMoveIfaceServices::moveRandom);
 }
 
 RLLErrorCode RLLMoveIfaceServices::moveRandom(const rll_msgs::MoveRandom::Request& /*req*/,
                                               rll_msgs::MoveRandom::Response* resp)
 {
-  bool success = false;
-  int retry_counter = 0;
-  geometry_msgs::Pose random_pose;
-  std::vector<double> goal_joint_values(RLL_NUM_JOINTS);
+  const size_t max_candidates = 30;
+  const size_t batch_size = std::max<size_t>(1, std::thread::hardware_concurrency());
+  std::vector<RandomGoal> goals;
 
-  while (!success && retry_counter < 30)
+  for (size_t num_candidates = 0; num_candidates < max_candidates;)
   {
-    retry_counter++;
-
-    random_pose = manip_move_group_.getRandomPose().pose;
-    if (poseGoalTooClose(random_pose))
-    {
-      success = false;
-      ROS_INFO("last random pose too close to start pose, retrying...");
-      continue;
-    }
-    RLLErrorCode error_code = poseGoalInCollision(random_pose, &goal_joint_values);
-    if (error_code.failed())
+    size_t num_sampled = std::min(batch_size, max_candidates - num_candidates);
+    num_candidates += num_sampled;
+    sampleRandomGoals(num_sampled, &goals);
+    if (goals.empty())
     {
-      success = false;
-      ROS_INFO("last random pose is in collision, retrying...");
+      ROS_INFO("no valid pose among the last %zu random poses, retrying...", num_sampled);
       continue;
     }
 
-    manip_move_group_.setJointValueTarget(goal_joint_values);
-
-    error_code = runPTPTrajectory(&manip_move_group_);
-    // make sure nothing major went wrong. only repeat in case of non critical errors
-    if (error_code.isCriticalFailure())
+    for (const auto& goal : goals)
     {
-      return error_code;
-    }
+      manip_move_group_.setJointValueTarget(goal.joint_values);
+
+      RLLErrorCode error_code = runPTPTrajectory(&manip_move_group_);
+      // make sure nothing major went wrong. only repeat in case of non critical errors
+      if (error_code.isCriticalFailure())
+      {
+        return error_code;
+      }
+
+      if (error_code.succeeded())
+      {
+        ROS_INFO("moved to random position");
+        resp->pose = goal.pose;
+        return RLLErrorCode::SUCCESS;
+      }
 
-    success = error_code.succeeded();
-    if (!success)
-    {
       ROS_INFO("planning failed for last random pose, retrying...");
     }
   }
 
-  if (success)
-  {
-    ROS_INFO("moved to random position");
-    resp->pose = random_pose;
-  }
-  else
-  {
-    ROS_WARN("failed to move to random position");
-    return RLLErrorCode::NO_RANDOM_POSITION_FOUND;
-  }
-
-  return RLLErrorCode::SUCCESS;
+  ROS_WARN("failed to move to random position");
+  return RLLErrorCode::NO_RANDOM_POSITION_FOUND;
 }
 
 bool RLLMoveIfaceServices::moveLinSrv(rll_msgs::MoveLin::Request& req, rll_msgs::MoveLin::Response& resp)
 {
-  return controlledMovementExecution(req, &resp, MOVE_LIN_SRV_NAME, &RLLMoveIfaceServices::moveLin);
+  return controlledMovementExecution(req, &resp, move_lin_srv_, &RLLMoveIfaceServices::moveLin);
 }
 
 RLLErrorCode RLLMoveIfaceServices::moveLin(const rll_msgs::MoveLin::Request& req, rll_msgs::MoveLin::Response* /*resp*/)
@@ -206,7 +290,7 @@ RLLErrorCode RLLMoveIfaceServices::moveLin(const rll_msgs::MoveLin::Request& req
 bool RLLMoveIfaceServices::moveLinArmangleSrv(rll_msgs::MoveLinArmangle::Request& req,
                                               rll_msgs::MoveLinArmangle::Response& resp)
 {
-  return controlledMovementExecution(req, &resp, MOVE_LIN_ARMANGLE_SRV_NAME, &RLLMoveIfaceServices::moveLinArmangle);
+  return controlledMovementExecution(req, &resp, move_lin_armangle_srv_, &RLLMoveIfaceServices::moveLinArmangle);
 }
 
 RLLErrorCode RLLMoveIfaceServices::moveLinArmangle(const rll_msgs::MoveLinArmangle::Request& req,
@@ -220,20 +304,20 @@ RLLErrorCode RLLMoveIfaceServices::moveLinArmangle(const rll_msgs::MoveLinArmang
     return RLLErrorCode::INVALID_INPUT;
   }
 
-  std::vector<double> seed = manip_move_group_.getCurrentJointValues();
+  std::vector<double> seed = getCurrentManipJointValues();
 
   // get arm angle in start pose
-  geometry_msgs::Pose pose_tmp;
+  geometry_msgs::Pose start_pose;
   double arm_angle_start;
   int config;
-  kinematics_plugin_->getPositionFK(seed, &pose_tmp, &arm_angle_start, &config);
+  kinematics_plugin_->getPositionFK(seed, &start_pose, &arm_angle_start, &config);
+  transformPoseFromFK(&start_pose);
 
   // calculate waypoints
   std::vector<geometry_msgs::Pose> waypoints_pose;
   std::vector<double> arm_angles;
   size_t steps_arm_angle = numStepsArmAngle(arm_angle_start, arm_angle_goal);
-  RLLErrorCode error_code =
-      interpolatePosesLinear(manip_move_group_.getCurrentPose().pose, req.pose, &waypoints_pose, steps_arm_angle);
+  RLLErrorCode error_code = interpolatePosesLinear(start_pose, req.pose, &waypoints_pose, steps_arm_angle);
   if (error_code.failed())
   {
     return error_code;
@@ -244,7 +328,7 @@ RLLErrorCode RLLMoveIfaceServices::moveLinArmangle(const rll_msgs::MoveLinArmang
     transformPoseForIK(&waypoint);
   }
   interpolateArmangleLinear(arm_angle_start, arm_angle_goal, dir, waypoints_pose.size(), &arm_angles);
-  std::vector<robot_state::RobotStatePtr> path;
+  RLLJointPath path;
   error_code = computeLinearPathArmangle(waypoints_pose, arm_angles, seed, &path);
   if (error_code.failed())
   {
@@ -252,15 +336,12 @@ RLLErrorCode RLLMoveIfaceServices::moveLinArmangle(const rll_msgs::MoveLinArmang
   }
 
   robot_trajectory::RobotTrajectory rt(manip_model_, manip_move_group_.getName());
-  for (const auto& path_pose : path)
-  {
-    rt.addSuffixWayPoint(path_pose, 0.0);
-  }
+  jointPathToTrajectory(path, getCurrentRobotState(), &rt);
   moveit_msgs::RobotTrajectory trajectory;
   rt.getRobotTrajectoryMsg(trajectory);
 
   // check for collisions
-  if (!planning_scene_->isPathValid(rt))
+  if (!isPathValid(*planning_scene_, rt))
   {  // TODO(updim): maybe output collision state
     ROS_ERROR("There is a collision along the path");
     return RLLErrorCode::ONLY_PARTIAL_PATH_PLANNED;
@@ -272,30 +353,18 @@ RLLErrorCode RLLMoveIfaceServices::moveLinArmangle(const rll_msgs::MoveLinArmang
 
 bool RLLMoveIfaceServices::movePTPSrv(rll_msgs::MovePTP::Request& req, rll_msgs::MovePTP::Response& resp)
 {
-  return controlledMovementExecution(req, &resp, MOVE_PTP_SRV_NAME, &RLLMoveIfaceServices::movePTP);
+  return controlledMovementExecution(req, &resp, move_ptp_srv_, &RLLMoveIfaceServices::movePTP);
 }
 
 RLLErrorCode RLLMoveIfaceServices::movePTP(const rll_msgs::MovePTP::Request& req, rll_msgs::MovePTP::Response* /*resp*/)
 {
-  std::vector<double> goal_joint_values(RLL_NUM_JOINTS);
-
-  manip_move_group_.setStartStateToCurrentState();
-
-  RLLErrorCode error_code = poseGoalInCollision(req.pose, &goal_joint_values);
-  if (error_code.failed())
-  {
-    return error_code;
-  }
-
-  manip_move_group_.setJointValueTarget(goal_joint_values);
-
-  return runPTPTrajectory(&manip_move_group_);
+  return moveToGoalPTP(req.pose);
 }
 
 bool RLLMoveIfaceServices::movePTPArmangleSrv(rll_msgs::MovePTPArmangle::Request& req,
                                               rll_msgs::MovePTPArmangle::Response& resp)
 {
-  return controlledMovementExecution(req, &resp, MOVE_PTP_ARMANGLE_SRV_NAME, &RLLMoveIfaceServices::movePTPArmangle);
+  return controlledMovementExecution(req, &resp, move_ptp_armangle_srv_, &RLLMoveIfaceServices::movePTPArmangle);
 }
 
 RLLErrorCode RLLMoveIfaceServices::movePTPArmangle(const rll_msgs::MovePTPArmangle::Request& req,
@@ -313,7 +382,7 @@ RLLErrorCode RLLMoveIfaceServices::movePTPArmangle(const rll_msgs::MovePTPArmang
   }
 
   // get solution
-  seed = manip_move_group_.getCurrentJointValues();
+  seed = getCurrentManipJointValues();
   geometry_msgs::Pose pose_tip = req.pose;
   transformPoseForIK(&pose_tip);
   if (!kinematics_plugin_->getPositionIKarmangle(pose_tip, seed, &sol, &error_code, arm_angle))
@@ -336,7 +405,7 @@ RLLErrorCode RLLMoveIfaceServices::movePTPArmangle(const rll_msgs::MovePTPArmang
 
 bool RLLMoveIfaceServices::moveJointsSrv(rll_msgs::MoveJoints::Request& req, rll_msgs::MoveJoints::Response& resp)
 {
-  return controlledMovementExecution(req, &resp, MOVE_JOINTS_SRV_NAME, &RLLMoveIfaceServices::moveJoints);
+  return controlledMovementExecution(req, &resp, move_joints_srv_, &RLLMoveIfaceServices::moveJoints);
 }
 
 RLLErrorCode RLLMoveIfaceServices::moveJoints(const rll_msgs::MoveJoints::Request& req,
@@ -373,11 +442,11 @@ RLLErrorCode RLLMoveIfaceServices::moveJoints(const rll_msgs::MoveJoints::Reques
 bool RLLMoveIfaceServices::getCurrentJointValuesSrv(rll_msgs::GetJointValues::Request& /*req*/,
                                                     rll_msgs::GetJointValues::Response& resp)
 {
-  RLLErrorCode error_code = beforeServiceCall(RLLMoveIfaceServices::GET_JOINT_VALUES_SRV_NAME);
+  RLLErrorCode error_code = beforeQueryCall(get_joint_values_srv_);
 
   if (error_code.succeeded())
   {
-    std::vector<double> joints = manip_move_group_.getCurrentJointValues();
+    std::vector<double> joints = getCurrentManipJointValues();
     resp.joint_1 = joints[0];
     resp.joint_2 = joints[1];
     resp.joint_3 = joints[2];
@@ -387,7 +456,7 @@ bool RLLMoveIfaceServices::getCurrentJointValuesSrv(rll_msgs::GetJointValues::Re
     resp.joint_7 = joints[6];
   }
 
-  error_code = afterServiceCall(RLLMoveIfaceServices::GET_JOINT_VALUES_SRV_NAME, error_code);
+  error_code = afterQueryCall(get_joint_values_srv_, error_code);
   resp.error_code = error_code.value();
   resp.success = error_code.succeededSrv();
   return true;
@@ -395,22 +464,19 @@ bool RLLMoveIfaceServices::getCurrentJointValuesSrv(rll_msgs::GetJointValues::Re
 
 bool RLLMoveIfaceServices::getCurrentPoseSrv(rll_msgs::GetPose::Request& /*req*/, rll_msgs::GetPose::Response& resp)
 {
-  geometry_msgs::Pose pose_tmp;
   double arm_angle;
   int config;
 
-  RLLErrorCode error_code = beforeServiceCall(RLLMoveIfaceServices::GET_POSE_SRV_NAME);
+  RLLErrorCode error_code = beforeQueryCall(get_pose_srv_);
 
   if (error_code.succeeded())
   {
-    std::vector<double> joints = manip_move_group_.getCurrentJointValues();
-    resp.pose = manip_move_group_.getCurrentPose().pose;
-    kinematics_plugin_->getPositionFK(joints, &pose_tmp, &arm_angle, &config);
+    resp.pose = getCurrentManipPose(&arm_angle, &config);
     resp.arm_angle = arm_angle;
     resp.config = config;
   }
 
-  error_code = afterServiceCall(RLLMoveIfaceServices::GET_POSE_SRV_NAME, error_code);
+  error_code = afterQueryCall(get_pose_srv_, error_code);
   resp.error_code = error_code.value();
   resp.success = error_code.succeededSrv();
   return true;
@@ -423,7 +489,7 @@ RLLErrorCode RLLMoveIfaceServices::resetToHome()
     return RLLErrorCode::MANIPULATOR_NOT_AVAILABLE;
   }
 
-  std::vector<double> start = manip_move_group_.getCurrentJointValues();
+  std::vector<double> start = getCurrentManipJointValues();
   std::vector<double> goal = getJointValuesFromNamedTarget(HOME_TARGET_NAME);
 
   if (jointsGoalTooClose(start, goal))
@@ -436,7 +502,7 @@ RLLErrorCode RLLMoveIfaceServices::resetToHome()
     manip_move_group_.setStartStateToCurrentState();
     manip_move_group_.setNamedTarget(HOME_TARGET_NAME);
 
-    RLLErrorCode error_code = runPTPTrajectory(&manip_move_group_);
+    RLLErrorCode error_code = runPTPTrajectory(&manip_move_group_, false, true);
     if (error_code.failed())
     {
       return error_code;
@@ -29,6 +29,12 @@
 
 bool RLLSimulationMoveIface::modifyPtpTrajectory(moveit_msgs::RobotTrajectory* trajectory)
 {
+  if (time_parameterization_cache_.lookup(*trajectory, DEFAULT_VELOCITY_SCALING_FACTOR,
+                                          DEFAULT_ACCELERATION_SCALING_FACTOR, trajectory))
+  {
+    return true;
+  }
+
   robot_trajectory::RobotTrajectory rt(manip_model_, manip_move_group_.getName());
   rt.setRobotTrajectoryMsg(*manip_move_group_.getCurrentState(), *trajectory);
 
@@ -43,7 +49,10 @@ bool RLLSimulationMoveIface::modifyPtpTrajectory(moveit_msgs::RobotTrajectory* t
     return false;
   }
 
+  moveit_msgs::RobotTrajectory path = std::move(*trajectory);
   rt.getRobotTrajectoryMsg(*trajectory);
+  time_parameterization_cache_.insert(path, DEFAULT_VELOCITY_SCALING_FACTOR, DEFAULT_ACCELERATION_SCALING_FACTOR,
+                                      *trajectory);
 
   return true;
 }
@@ -18,6 +18,7 @@
  */
 
 #include <string>
+#include <utility>
 
 #include <ros/ros.h>
 
@@ -33,13 +34,37 @@ void RLLMoveIfaceStateMachine::enterErrorState()
 
 void RLLMoveIfaceStateMachine::setStateToInternalError()
 {
-  if (state_ != RLLMoveIfaceState::INTERNAL_ERROR)
+  if (state_ == RLLMoveIfaceState::INTERNAL_ERROR)
   {
-    ROS_ERROR("Entering INTERNAL_ERROR state!");
+    return;
   }
 
+  ROS_ERROR("Entering INTERNAL_ERROR state!");
   // allow changing the state even if we are executing a service call
   state_ = RLLMoveIfaceState::INTERNAL_ERROR;
+
+  if (internal_error_callback_)
+  {
+    internal_error_callback_();
+  }
+}
+
+void RLLMoveIfaceStateMachine::setInternalErrorCallback(std::function<void()> callback)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  internal_error_callback_ = std::move(callback);
+}
+
+void RLLMoveIfaceStateMachine::waitForServiceCallsToEnd()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  service_calls_ended_.wait(lock, [this] { return concurrent_service_calls_counter_ == 0; });
+}
+
+bool RLLMoveIfaceStateMachine::waitForServiceCallsToEnd(std::chrono::steady_clock::duration timeout)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  return service_calls_ended_.wait_for(lock, timeout, [this] { return concurrent_service_calls_counter_ == 0; });
 }
 
 bool RLLMoveIfaceStateMachine::enterState(RLLMoveIfaceState new_state)
@@ -129,6 +154,27 @@ RLLErrorCode RLLMoveIfaceStateMachine::beginServiceCall(const std::string& srv_n
   return RLLErrorCode::SUCCESS;
 }
 
+RLLErrorCode RLLMoveIfaceStateMachine::checkQueryAllowed(const std::string& srv_name,
+                                                         bool only_allowed_during_job_run) const
+{
+  RLLMoveIfaceState state = state_.load();
+  if (state == RLLMoveIfaceState::INTERNAL_ERROR)
+  {
+    ROS_INFO("Queries are not allowed if the state is INTERNAL_ERROR!");
+    return RLLErrorCode::INTERNAL_ERROR;
+  }
+
+  // same rules as for service calls, but concurrent queries are fine
+  if (state != RLLMoveIfaceState::RUNNING_JOB &&
+      (only_allowed_during_job_run || state != RLLMoveIfaceState::WAITING))
+  {
+    ROS_ERROR("Invalid state: query %s is not allowed in state %s.", srv_name.c_str(), stateToString(state));
+    return RLLErrorCode::SERVICE_CALL_NOT_ALLOWED;
+  }
+
+  return RLLErrorCode::SUCCESS;
+}
+
 bool RLLMoveIfaceStateMachine::setCurrentServiceCallResult(RLLErrorCode error_code)
 {
   std::lock_guard<std::mutex> service_call_lock(mutex_);
@@ -155,6 +201,10 @@ RLLErrorCode RLLMoveIfaceStateMachine::endServiceCall(const std::string& srv_nam
 
   // always decrement even in case of an error
   concurrent_service_calls_counter_--;
+  if (concurrent_service_calls_counter_ == 0)
+  {
+    service_calls_ended_.notify_all();
+  }
 
   if (state_ == RLLMoveIfaceState::INTERNAL_ERROR)
   {
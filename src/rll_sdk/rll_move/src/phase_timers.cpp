@@ -0,0 +1,168 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <rll_move/phase_timers.h>
+
+const size_t RLLPhaseTimers::RING_BUFFER_SIZE;
+const size_t RLLPhaseTimers::NUM_PHASES;
+const size_t RLLPhaseTimers::NUM_COUNTERS;
+const int RLLPhaseTimers::PHASE_SHIFT;
+const uint64_t RLLPhaseTimers::DURATION_MASK;
+
+RLLPhaseTimers::RLLPhaseTimers()
+{
+  reset();
+}
+
+void RLLPhaseTimers::record(RLLTimedPhase phase, std::chrono::steady_clock::duration duration)
+{
+  int64_t signed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  auto ns = static_cast<uint64_t>(std::max<int64_t>(0, signed_ns));
+  ns = std::min(ns, DURATION_MASK);
+
+  PhaseTotals& totals = phases_[static_cast<size_t>(phase)];
+  totals.num_samples.fetch_add(1, std::memory_order_relaxed);
+  totals.total_ns.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t max_ns = totals.max_ns.load(std::memory_order_relaxed);
+  while (ns > max_ns && !totals.max_ns.compare_exchange_weak(max_ns, ns, std::memory_order_relaxed))
+  {
+  }
+
+  uint64_t entry = ((static_cast<uint64_t>(phase) + 1) << PHASE_SHIFT) | ns;
+  uint64_t index = write_index_.fetch_add(1, std::memory_order_relaxed) % RING_BUFFER_SIZE;
+  ring_buffer_[index].store(entry, std::memory_order_relaxed);
+}
+
+uint64_t RLLPhaseTimers::percentileNanoseconds(RLLTimedPhase phase, double percentile) const
+{
+  uint64_t tag = static_cast<uint64_t>(phase) + 1;
+  std::vector<uint64_t> samples;
+  samples.reserve(RING_BUFFER_SIZE);
+  for (const auto& slot : ring_buffer_)
+  {
+    uint64_t entry = slot.load(std::memory_order_relaxed);
+    if ((entry >> PHASE_SHIFT) == tag)
+    {
+      samples.push_back(entry & DURATION_MASK);
+    }
+  }
+
+  if (samples.empty())
+  {
+    return 0;
+  }
+
+  // nearest rank
+  double clamped = std::min(100.0, std::max(0.0, percentile));
+  auto rank = static_cast<size_t>(std::lround(clamped / 100.0 * (samples.size() - 1)));
+  std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+  return samples[rank];
+}
+
+std::string RLLPhaseTimers::summary() const
+{
+  std::string result;
+  char line[160];
+
+  for (size_t i = 0; i < NUM_PHASES; ++i)
+  {
+    auto phase = static_cast<RLLTimedPhase>(i);
+    uint64_t num_samples = numSamples(phase);
+    if (num_samples == 0)
+    {
+      continue;
+    }
+
+    double total_ms = totalNanoseconds(phase) * 1E-06;
+    std::snprintf(line, sizeof(line), "  %-24s n=%-6" PRIu64 " total=%9.2fms mean=%8.3fms p95=%8.3fms max=%8.3fms\n",
+                  phaseName(phase), num_samples, total_ms, total_ms / num_samples,
+                  percentileNanoseconds(phase, 95) * 1E-06, maxNanoseconds(phase) * 1E-06);
+    result += line;
+  }
+
+  for (size_t i = 0; i < NUM_COUNTERS; ++i)
+  {
+    auto c = static_cast<RLLPhaseCounter>(i);
+    std::snprintf(line, sizeof(line), "  %-24s %" PRIu64 "\n", counterName(c), counter(c));
+    result += line;
+  }
+
+  return result;
+}
+
+void RLLPhaseTimers::reset()
+{
+  for (auto& totals : phases_)
+  {
+    totals.num_samples.store(0, std::memory_order_relaxed);
+    totals.total_ns.store(0, std::memory_order_relaxed);
+    totals.max_ns.store(0, std::memory_order_relaxed);
+  }
+  for (auto& c : counters_)
+  {
+    c.store(0, std::memory_order_relaxed);
+  }
+  for (auto& slot : ring_buffer_)
+  {
+    slot.store(0, std::memory_order_relaxed);
+  }
+  write_index_.store(0, std::memory_order_relaxed);
+}
+
+const char* RLLPhaseTimers::phaseName(RLLTimedPhase phase)
+{
+  switch (phase)
+  {
+    case RLLTimedPhase::PTP_PLANNING:
+      return "ptp_planning";
+    case RLLTimedPhase::LINEAR_PATH:
+      return "linear_path";
+    case RLLTimedPhase::PATH_IK:
+      return "path_ik";
+    case RLLTimedPhase::PATH_VALIDITY_CHECK:
+      return "path_validity_check";
+    case RLLTimedPhase::TRAJECTORY_MODIFICATION:
+      return "trajectory_modification";
+    case RLLTimedPhase::EXECUTION:
+      return "execution";
+    case RLLTimedPhase::NUM_PHASES:
+      break;
+  }
+  return "unknown";
+}
+
+const char* RLLPhaseTimers::counterName(RLLPhaseCounter counter)
+{
+  switch (counter)
+  {
+    case RLLPhaseCounter::IK_WAYPOINTS:
+      return "ik_waypoints";
+    case RLLPhaseCounter::EXECUTED_WAYPOINTS:
+      return "executed_waypoints";
+    case RLLPhaseCounter::CACHED_TRAJECTORIES:
+      return "cached_trajectories";
+    case RLLPhaseCounter::NUM_COUNTERS:
+      break;
+  }
+  return "unknown";
+}
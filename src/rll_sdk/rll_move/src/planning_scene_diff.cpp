@@ -0,0 +1,191 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <rll_move/planning_scene_diff.h>
+
+namespace
+{
+bool sameMesh(const shape_msgs::Mesh& lhs, const shape_msgs::Mesh& rhs)
+{
+  if (lhs.triangles.size() != rhs.triangles.size() || lhs.vertices.size() != rhs.vertices.size())
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < lhs.triangles.size(); ++i)
+  {
+    if (lhs.triangles[i].vertex_indices != rhs.triangles[i].vertex_indices)
+    {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < lhs.vertices.size(); ++i)
+  {
+    const auto& a = lhs.vertices[i];
+    const auto& b = rhs.vertices[i];
+    if (a.x != b.x || a.y != b.y || a.z != b.z)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+}  // namespace
+
+bool RLLPlanningSceneDiff::sameGeometry(const moveit_msgs::CollisionObject& lhs,
+                                        const moveit_msgs::CollisionObject& rhs)
+{
+  if (lhs.header.frame_id != rhs.header.frame_id || lhs.primitives.size() != rhs.primitives.size() ||
+      lhs.meshes.size() != rhs.meshes.size() || lhs.planes.size() != rhs.planes.size())
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < lhs.primitives.size(); ++i)
+  {
+    const auto& a = lhs.primitives[i];
+    const auto& b = rhs.primitives[i];
+    if (a.type != b.type || a.dimensions != b.dimensions)
+    {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < lhs.meshes.size(); ++i)
+  {
+    if (!sameMesh(lhs.meshes[i], rhs.meshes[i]))
+    {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < lhs.planes.size(); ++i)
+  {
+    if (lhs.planes[i].coef != rhs.planes[i].coef)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+moveit_msgs::CollisionObject RLLPlanningSceneDiff::geometryOf(const moveit_msgs::CollisionObject& object)
+{
+  moveit_msgs::CollisionObject geometry;
+  geometry.header.frame_id = object.header.frame_id;
+  geometry.id = object.id;
+  geometry.primitives = object.primitives;
+  geometry.meshes = object.meshes;
+  geometry.planes = object.planes;
+  return geometry;
+}
+
+void RLLPlanningSceneDiff::addOrMove(const moveit_msgs::CollisionObject& object)
+{
+  auto it = known_geometries_.find(object.id);
+  if (it != known_geometries_.end() && sameGeometry(it->second, object))
+  {
+    moveit_msgs::CollisionObject move;
+    move.header = object.header;
+    move.id = object.id;
+    move.primitive_poses = object.primitive_poses;
+    move.mesh_poses = object.mesh_poses;
+    move.plane_poses = object.plane_poses;
+    move.operation = moveit_msgs::CollisionObject::MOVE;
+    diff_.world.collision_objects.push_back(move);
+    return;
+  }
+
+  // an ADD replaces an existing object with the same id
+  diff_.world.collision_objects.push_back(object);
+  diff_.world.collision_objects.back().operation = moveit_msgs::CollisionObject::ADD;
+  known_geometries_[object.id] = geometryOf(object);
+  attached_geometries_.erase(object.id);
+}
+
+void RLLPlanningSceneDiff::remove(const std::string& id)
+{
+  moveit_msgs::CollisionObject object;
+  object.id = id;
+  object.operation = moveit_msgs::CollisionObject::REMOVE;
+  diff_.world.collision_objects.push_back(object);
+  known_geometries_.erase(id);
+}
+
+void RLLPlanningSceneDiff::attach(const moveit_msgs::CollisionObject& object, const std::string& link_name,
+                                  const std::vector<std::string>& touch_links)
+{
+  moveit_msgs::AttachedCollisionObject attached_object;
+  attached_object.link_name = link_name;
+  attached_object.touch_links = touch_links;
+
+  auto it = known_geometries_.find(object.id);
+  if (it != known_geometries_.end() && sameGeometry(it->second, object))
+  {
+    // without shapes, move_group takes the object from the world
+    attached_object.object.id = object.id;
+    attached_object.object.operation = moveit_msgs::CollisionObject::ADD;
+    attached_geometries_[object.id] = it->second;
+    known_geometries_.erase(it);
+  }
+  else
+  {
+    // the world object has to be removed explicitly before attaching the full object
+    remove(object.id);
+    attached_object.object = object;
+    attached_object.object.operation = moveit_msgs::CollisionObject::ADD;
+    attached_geometries_[object.id] = geometryOf(object);
+  }
+
+  diff_.robot_state.attached_collision_objects.push_back(attached_object);
+}
+
+void RLLPlanningSceneDiff::detach(const std::string& id, const std::string& link_name)
+{
+  // move_group adds the detached object back to the world
+  moveit_msgs::AttachedCollisionObject attached_object;
+  attached_object.link_name = link_name;
+  attached_object.object.id = id;
+  attached_object.object.operation = moveit_msgs::CollisionObject::REMOVE;
+  diff_.robot_state.attached_collision_objects.push_back(attached_object);
+
+  auto it = attached_geometries_.find(id);
+  if (it != attached_geometries_.end())
+  {
+    known_geometries_[id] = it->second;
+    attached_geometries_.erase(it);
+  }
+}
+
+moveit_msgs::PlanningScene RLLPlanningSceneDiff::take()
+{
+  moveit_msgs::PlanningScene diff;
+  std::swap(diff, diff_);
+  diff.is_diff = true;
+  diff.robot_state.is_diff = true;
+  return diff;
+}
+
+void RLLPlanningSceneDiff::reset()
+{
+  diff_ = moveit_msgs::PlanningScene();
+  known_geometries_.clear();
+  attached_geometries_.clear();
+}
@@ -0,0 +1,207 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+
+#include <rll_move/service_metrics.h>
+
+const size_t RLLServiceMetrics::NUM_LATENCY_BUCKETS;
+const std::array<double, RLLServiceMetrics::NUM_LATENCY_BUCKETS> RLLServiceMetrics::LATENCY_BUCKET_BOUNDS = {
+  0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 60
+};
+const size_t RLLServiceMetrics::NUM_ERROR_CODES;
+const size_t RLLServiceMetrics::NUM_JOB_STATUSES;
+
+namespace
+{
+void appendLine(std::string* text, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+void appendLine(std::string* text, const char* format, ...)
+{
+  char line[256];
+  va_list args;
+  va_start(args, format);
+  std::vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  *text += line;
+}
+
+void appendHistogram(std::string* text, const char* metric, const std::string& labels,
+                     const RLLServiceMetrics::LatencyHistogram& histogram)
+{
+  const char* separator = labels.empty() ? "" : ",";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < RLLServiceMetrics::NUM_LATENCY_BUCKETS; ++i)
+  {
+    cumulative += histogram.bucket(i);
+    appendLine(text, "%s_bucket{%s%sle=\"%g\"} %" PRIu64 "\n", metric, labels.c_str(), separator,
+               RLLServiceMetrics::LATENCY_BUCKET_BOUNDS[i], cumulative);
+  }
+  appendLine(text, "%s_bucket{%s%sle=\"+Inf\"} %" PRIu64 "\n", metric, labels.c_str(), separator, histogram.count());
+  appendLine(text, "%s_sum{%s} %.9f\n", metric, labels.c_str(), histogram.totalNanoseconds() * 1E-09);
+  appendLine(text, "%s_count{%s} %" PRIu64 "\n", metric, labels.c_str(), histogram.count());
+}
+}  // namespace
+
+void RLLServiceMetrics::LatencyHistogram::record(std::chrono::steady_clock::duration duration)
+{
+  int64_t signed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  auto ns = static_cast<uint64_t>(std::max<int64_t>(0, signed_ns));
+  double seconds = ns * 1E-09;
+
+  auto bound = std::lower_bound(LATENCY_BUCKET_BOUNDS.begin(), LATENCY_BUCKET_BOUNDS.end(), seconds);
+  if (bound != LATENCY_BUCKET_BOUNDS.end())
+  {
+    buckets_[bound - LATENCY_BUCKET_BOUNDS.begin()].fetch_add(1, std::memory_order_relaxed);
+  }
+  total_ns_.fetch_add(ns, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RLLServiceMetrics::Service::end(uint8_t error_code, std::chrono::steady_clock::duration duration)
+{
+  error_codes_[error_code].fetch_add(1, std::memory_order_relaxed);
+  latency_.record(duration);
+  in_flight_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+RLLServiceMetrics::Service* RLLServiceMetrics::service(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(services_mutex_);
+  std::unique_ptr<Service>& service = services_[name];
+  if (!service)
+  {
+    service.reset(new Service());
+  }
+  return service.get();
+}
+
+void RLLServiceMetrics::recordJob(uint8_t job_status, std::chrono::steady_clock::duration duration)
+{
+  if (job_status < NUM_JOB_STATUSES)
+  {
+    job_statuses_[job_status].fetch_add(1, std::memory_order_relaxed);
+  }
+  job_duration_.record(duration);
+}
+
+int64_t RLLServiceMetrics::inFlight() const
+{
+  std::lock_guard<std::mutex> lock(services_mutex_);
+  int64_t in_flight = 0;
+  for (const auto& service : services_)
+  {
+    in_flight += service.second->inFlight();
+  }
+  return in_flight;
+}
+
+std::string RLLServiceMetrics::prometheusText(const RLLPhaseTimers& phase_timers) const
+{
+  std::string text;
+  std::lock_guard<std::mutex> lock(services_mutex_);
+
+  text += "# TYPE rll_service_calls_total counter\n";
+  for (const auto& service : services_)
+  {
+    for (size_t code = 0; code < NUM_ERROR_CODES; ++code)
+    {
+      uint64_t count = service.second->errorCodeCount(code);
+      if (count > 0)
+      {
+        appendLine(&text, "rll_service_calls_total{service=\"%s\",error_code=\"%zu\"} %" PRIu64 "\n",
+                   service.first.c_str(), code, count);
+      }
+    }
+  }
+
+  text += "# TYPE rll_service_calls_in_flight gauge\n";
+  for (const auto& service : services_)
+  {
+    appendLine(&text, "rll_service_calls_in_flight{service=\"%s\"} %" PRId64 "\n", service.first.c_str(),
+               service.second->inFlight());
+  }
+
+  text += "# TYPE rll_service_latency_seconds histogram\n";
+  for (const auto& service : services_)
+  {
+    appendHistogram(&text, "rll_service_latency_seconds", "service=\"" + service.first + "\"",
+                    service.second->latency());
+  }
+
+  text += "# TYPE rll_jobs_total counter\n";
+  for (size_t status = 0; status < NUM_JOB_STATUSES; ++status)
+  {
+    appendLine(&text, "rll_jobs_total{status=\"%zu\"} %" PRIu64 "\n", status,
+               job_statuses_[status].load(std::memory_order_relaxed));
+  }
+  text += "# TYPE rll_job_duration_seconds histogram\n";
+  appendHistogram(&text, "rll_job_duration_seconds", "", job_duration_);
+
+  text += "# TYPE rll_ik_requests_total counter\n";
+  appendLine(&text, "rll_ik_requests_total %" PRIu64 "\n", ikRequests());
+  text += "# TYPE rll_ik_failures_total counter\n";
+  appendLine(&text, "rll_ik_failures_total %" PRIu64 "\n", ikFailures());
+
+  // the phase timers are reset at every job start, a scraper treats this like a restart of the counters
+  text += "# TYPE rll_phase_seconds summary\n";
+  for (size_t i = 0; i < static_cast<size_t>(RLLTimedPhase::NUM_PHASES); ++i)
+  {
+    auto phase = static_cast<RLLTimedPhase>(i);
+    const char* name = RLLPhaseTimers::phaseName(phase);
+    appendLine(&text, "rll_phase_seconds{phase=\"%s\",quantile=\"0.95\"} %.9f\n", name,
+               phase_timers.percentileNanoseconds(phase, 95) * 1E-09);
+    appendLine(&text, "rll_phase_seconds_sum{phase=\"%s\"} %.9f\n", name, phase_timers.totalNanoseconds(phase) * 1E-09);
+    appendLine(&text, "rll_phase_seconds_count{phase=\"%s\"} %" PRIu64 "\n", name, phase_timers.numSamples(phase));
+  }
+
+  return text;
+}
+
+std::vector<std::pair<std::string, std::string>> RLLServiceMetrics::summaryValues() const
+{
+  std::vector<std::pair<std::string, std::string>> values;
+  char value[64];
+
+  std::lock_guard<std::mutex> lock(services_mutex_);
+  for (const auto& service : services_)
+  {
+    const Service& s = *service.second;
+    uint64_t calls = s.calls();
+    double mean_ms = calls > 0 ? s.latency().totalNanoseconds() * 1E-06 / calls : 0.0;
+    std::snprintf(value, sizeof(value), "%" PRIu64 " calls, %" PRIu64 " failed, %" PRId64 " in flight, %.3f ms mean",
+                  calls, calls - s.errorCodeCount(0), s.inFlight(), mean_ms);
+    values.emplace_back(service.first, value);
+  }
+
+  uint64_t jobs = job_duration_.count();
+  double mean_s = jobs > 0 ? job_duration_.totalNanoseconds() * 1E-09 / jobs : 0.0;
+  std::snprintf(value, sizeof(value), "%" PRIu64 " jobs, %" PRIu64 " succeeded, %.1f s mean", jobs,
+                job_statuses_[0].load(std::memory_order_relaxed), mean_s);
+  values.emplace_back("jobs", value);
+
+  uint64_t ik_requests = ikRequests();
+  double ik_success_rate = ik_requests > 0 ? 1.0 - static_cast<double>(ikFailures()) / ik_requests : 1.0;
+  std::snprintf(value, sizeof(value), "%" PRIu64 " requests, %.2f %% solved", ik_requests, 100.0 * ik_success_rate);
+  values.emplace_back("ik", value);
+
+  return values;
+}
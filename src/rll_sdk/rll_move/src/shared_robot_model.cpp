@@ -0,0 +1,79 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <ros/console.h>
+#include <ros/names.h>
+
+#include <rll_move/shared_robot_model.h>
+
+namespace
+{
+std::mutex shared_mutex;
+// the loaders are only held weakly, so that they are destroyed with their last user and not after ros::shutdown()
+std::map<std::string, std::weak_ptr<robot_model_loader::RobotModelLoader>> shared_loaders;
+std::map<std::string, std::weak_ptr<planning_scene_monitor::PlanningSceneMonitor>> shared_monitors;
+
+robot_model_loader::RobotModelLoaderPtr getSharedRobotModelLoaderLocked(const std::string& key,
+                                                                        const std::string& robot_description)
+{
+  robot_model_loader::RobotModelLoaderPtr loader = shared_loaders[key].lock();
+  if (!loader)
+  {
+    ROS_INFO("loading the shared robot model from %s", key.c_str());
+    loader = std::make_shared<robot_model_loader::RobotModelLoader>(robot_description);
+    shared_loaders[key] = loader;
+  }
+
+  return loader;
+}
+}  // namespace
+
+robot_model_loader::RobotModelLoaderPtr getSharedRobotModelLoader(const std::string& robot_description)
+{
+  std::lock_guard<std::mutex> lock(shared_mutex);
+  return getSharedRobotModelLoaderLocked(ros::names::resolve(robot_description), robot_description);
+}
+
+planning_scene_monitor::PlanningSceneMonitorPtr getSharedPlanningSceneMonitor(const std::string& robot_description)
+{
+  std::lock_guard<std::mutex> lock(shared_mutex);
+  std::string key = ros::names::resolve(robot_description);
+  planning_scene_monitor::PlanningSceneMonitorPtr monitor = shared_monitors[key].lock();
+  if (!monitor)
+  {
+    // the monitor keeps its loader, and with it the shared model, alive
+    monitor = std::make_shared<planning_scene_monitor::PlanningSceneMonitor>(
+        getSharedRobotModelLoaderLocked(key, robot_description));
+    shared_monitors[key] = monitor;
+  }
+
+  return monitor;
+}
+
+moveit::planning_interface::MoveGroupInterface::Options
+sharedMoveGroupOptions(const std::string& group_name,
+                       const robot_model_loader::RobotModelLoaderPtr& robot_model_loader)
+{
+  moveit::planning_interface::MoveGroupInterface::Options options(group_name,
+                                                                  robot_model_loader->getRobotDescription());
+  options.robot_model_ = robot_model_loader->getModel();
+  return options;
+}
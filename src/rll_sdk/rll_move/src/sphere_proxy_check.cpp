@@ -0,0 +1,181 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+
+#include <rll_move/sphere_proxy_check.h>
+
+const double RLLSphereProxyCheck::MAX_DISTANCE = 0.3;
+
+RLLSphereProxyCheck::RLLSphereProxyCheck(RLLDistanceFieldPreCheck* pre_check,
+                                         const planning_scene::PlanningScene& planning_scene,
+                                         const robot_state::RobotState& state)
+  : planning_scene_(planning_scene), acm_(planning_scene.getAllowedCollisionMatrix())
+{
+  field_ = pre_check->field(planning_scene, acm_, state);
+  if (!field_)
+  {
+    return;
+  }
+
+  const distance_field::PropagationDistanceField& distances = *field_->distances;
+  field_min_ = Eigen::Vector3d(distances.getOriginX(), distances.getOriginY(), distances.getOriginZ());
+  field_max_ = field_min_ + Eigen::Vector3d(distances.getSizeX(), distances.getSizeY(), distances.getSizeZ());
+
+  // the exact check pads the static links in the field, their unpadded shapes were voxelized
+  const collision_detection::CollisionRobotConstPtr& collision_robot = planning_scene.getCollisionRobot();
+  bool obstacles_scaled = false;
+  for (const std::string& obstacle : field_->obstacles)
+  {
+    if (planning_scene.getRobotModel()->hasLinkModel(obstacle))
+    {
+      obstacle_padding_ = std::max(obstacle_padding_, collision_robot->getLinkPadding(obstacle));
+      obstacles_scaled = obstacles_scaled || collision_robot->getLinkScale(obstacle) != 1.0;
+    }
+  }
+
+  for (const RLLDistanceFieldPreCheck::LinkSpheres& link_spheres : pre_check->linkSpheres())
+  {
+    addBody(link_spheres.link->getName(), link_spheres.link, link_spheres.inner, link_spheres.outer,
+            link_spheres.covered && !obstacles_scaled, {});
+  }
+
+  std::vector<const moveit::core::AttachedBody*> attached_bodies;
+  state.getAttachedBodies(attached_bodies);
+  for (const moveit::core::AttachedBody* attached_body : attached_bodies)
+  {
+    std::vector<RLLDistanceFieldPreCheck::Sphere> inner, outer;
+    bool covered = !obstacles_scaled;
+    const moveit::core::LinkModel* link = attached_body->getAttachedLink();
+    for (size_t i = 0; i < attached_body->getShapes().size(); ++i)
+    {
+      const shapes::Shape& shape = *attached_body->getShapes()[i];
+      const Eigen::Isometry3d& origin = attached_body->getFixedTransforms()[i];
+      RLLDistanceFieldPreCheck::addInnerSpheres(link, shape, origin, &inner);
+      covered = RLLDistanceFieldPreCheck::addOuterSpheres(link, shape, origin, &outer) && covered;
+    }
+    addBody(attached_body->getName(), link, std::move(inner), std::move(outer), covered,
+            attached_body->getTouchLinks());
+  }
+}
+
+void RLLSphereProxyCheck::addBody(const std::string& name, const moveit::core::LinkModel* link,
+                                  std::vector<RLLDistanceFieldPreCheck::Sphere> inner,
+                                  std::vector<RLLDistanceFieldPreCheck::Sphere> outer, bool covered,
+                                  const std::set<std::string>& touch_links)
+{
+  // attached bodies use the padding and scale of the link they are attached to
+  const collision_detection::CollisionRobotConstPtr& collision_robot = planning_scene_.getCollisionRobot();
+  double padding = collision_robot->getLinkPadding(link->getName());
+  bool usable = covered && !outer.empty() && collision_robot->getLinkScale(link->getName()) == 1.0;
+  for (RLLDistanceFieldPreCheck::Sphere& sphere : outer)
+  {
+    sphere.radius += padding;
+  }
+
+  // a body that may touch an obstacle of the field can neither be rejected nor cleared by it
+  collision_detection::AllowedCollision::Type type;
+  for (const std::string& obstacle : field_->obstacles)
+  {
+    if (!usable)
+    {
+      break;
+    }
+
+    usable = touch_links.count(obstacle) == 0 && (!acm_.getAllowedCollision(name, obstacle, type) ||
+                                                  type == collision_detection::AllowedCollision::NEVER);
+  }
+
+  bodies_.push_back({ name, link, std::move(inner), std::move(outer), usable, false });
+}
+
+bool RLLSphereProxyCheck::sphereClear(const Eigen::Vector3d& center, double radius) const
+{
+  // the whole sphere has to lie inside the field, obstacles outside of it are not represented
+  double margin = radius + RLLDistanceFieldPreCheck::DISCRETIZATION_ERROR + obstacle_padding_;
+  Eigen::Vector3d border = Eigen::Vector3d::Constant(margin + RLLDistanceFieldPreCheck::RESOLUTION);
+  if (((center - border).array() < field_min_.array()).any() || ((center + border).array() > field_max_.array()).any())
+  {
+    return false;
+  }
+
+  int x, y, z;
+  return field_->distances->worldToGrid(center.x(), center.y(), center.z(), x, y, z) &&
+         field_->distances->getDistance(x, y, z) >= margin;
+}
+
+bool RLLSphereProxyCheck::isStateValid(const robot_state::RobotState& state)
+{
+  ++num_checked_;
+  if (!field_)
+  {
+    return planning_scene_.isStateValid(state);
+  }
+
+  bool all_cleared = true;
+  for (Body& body : bodies_)
+  {
+    if (!body.usable)
+    {
+      all_cleared = false;
+      continue;
+    }
+
+    const Eigen::Isometry3d& link_pose = state.getGlobalLinkTransform(body.link);
+    for (const RLLDistanceFieldPreCheck::Sphere& sphere : body.inner)
+    {
+      if (sphere.radius <= RLLDistanceFieldPreCheck::DISCRETIZATION_ERROR)
+      {
+        continue;
+      }
+
+      Eigen::Vector3d center = link_pose * sphere.center;
+      int x, y, z;
+      if (field_->distances->worldToGrid(center.x(), center.y(), center.z(), x, y, z) &&
+          field_->distances->getDistance(x, y, z) + RLLDistanceFieldPreCheck::DISCRETIZATION_ERROR < sphere.radius)
+      {
+        ++num_rejected_;
+        return false;
+      }
+    }
+
+    bool cleared = std::all_of(body.outer.begin(), body.outer.end(), [&](const RLLDistanceFieldPreCheck::Sphere& s) {
+      return sphereClear(link_pose * s.center, s.radius);
+    });
+    if (cleared != body.cleared)
+    {
+      for (const std::string& obstacle : field_->obstacles)
+      {
+        acm_.setEntry(body.name, obstacle, cleared);
+      }
+      body.cleared = cleared;
+    }
+    all_cleared = all_cleared && cleared;
+  }
+
+  if (all_cleared)
+  {
+    ++num_cleared_;
+  }
+
+  // the remaining pairs, including all self-collisions, are checked exactly
+  collision_detection::CollisionRequest request;
+  collision_detection::CollisionResult result;
+  planning_scene_.checkCollision(request, result, state, acm_);
+  return !result.collision && planning_scene_.isStateFeasible(state);
+}
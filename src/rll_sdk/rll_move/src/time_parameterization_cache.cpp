@@ -0,0 +1,140 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <rll_move/time_parameterization_cache.h>
+
+namespace
+{
+// FNV-1a
+const uint64_t HASH_OFFSET = 14695981039346656037ULL;
+const uint64_t HASH_PRIME = 1099511628211ULL;
+
+void hashBytes(const void* data, size_t size, uint64_t* hash)
+{
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i)
+  {
+    *hash = (*hash ^ bytes[i]) * HASH_PRIME;
+  }
+}
+
+void hashValue(double value, uint64_t* hash)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  hashBytes(&bits, sizeof(bits), hash);
+}
+}  // namespace
+
+const size_t RLLTimeParameterizationCache::MAX_ENTRIES;
+
+uint64_t RLLTimeParameterizationCache::hash(const moveit_msgs::RobotTrajectory& path, double velocity_scaling,
+                                            double acceleration_scaling)
+{
+  uint64_t hash = HASH_OFFSET;
+  for (const auto& name : path.joint_trajectory.joint_names)
+  {
+    hashBytes(name.data(), name.size() + 1, &hash);
+  }
+  for (const auto& point : path.joint_trajectory.points)
+  {
+    for (double position : point.positions)
+    {
+      hashValue(position, &hash);
+    }
+  }
+  hashValue(velocity_scaling, &hash);
+  hashValue(acceleration_scaling, &hash);
+  return hash;
+}
+
+size_t RLLTimeParameterizationCache::find(uint64_t hash, const moveit_msgs::RobotTrajectory& path,
+                                          double velocity_scaling, double acceleration_scaling) const
+{
+  const auto& points = path.joint_trajectory.points;
+  for (size_t i = 0; i < entries_.size(); ++i)
+  {
+    const Entry& entry = entries_[i];
+    if (entry.hash != hash || entry.velocity_scaling != velocity_scaling ||
+        entry.acceleration_scaling != acceleration_scaling || entry.joint_names != path.joint_trajectory.joint_names ||
+        entry.positions.size() != points.size())
+    {
+      continue;
+    }
+
+    // rule out hash collisions
+    bool same_path = true;
+    for (size_t j = 0; j < points.size() && same_path; ++j)
+    {
+      same_path = entry.positions[j] == points[j].positions;
+    }
+    if (same_path)
+    {
+      return i;
+    }
+  }
+
+  return entries_.size();
+}
+
+bool RLLTimeParameterizationCache::lookup(const moveit_msgs::RobotTrajectory& path, double velocity_scaling,
+                                          double acceleration_scaling,
+                                          moveit_msgs::RobotTrajectory* timed_trajectory) const
+{
+  size_t i = find(hash(path, velocity_scaling, acceleration_scaling), path, velocity_scaling, acceleration_scaling);
+  if (i == entries_.size())
+  {
+    return false;
+  }
+
+  *timed_trajectory = entries_[i].timed_trajectory;
+  return true;
+}
+
+void RLLTimeParameterizationCache::insert(const moveit_msgs::RobotTrajectory& path, double velocity_scaling,
+                                          double acceleration_scaling,
+                                          const moveit_msgs::RobotTrajectory& timed_trajectory)
+{
+  if (path.joint_trajectory.points.empty())
+  {
+    return;
+  }
+
+  Entry entry;
+  entry.hash = hash(path, velocity_scaling, acceleration_scaling);
+  size_t i = find(entry.hash, path, velocity_scaling, acceleration_scaling);
+  if (i < entries_.size())
+  {
+    entries_.erase(entries_.begin() + i);
+  }
+  if (entries_.size() >= MAX_ENTRIES)
+  {
+    entries_.pop_front();
+  }
+
+  entry.velocity_scaling = velocity_scaling;
+  entry.acceleration_scaling = acceleration_scaling;
+  entry.joint_names = path.joint_trajectory.joint_names;
+  for (const auto& point : path.joint_trajectory.points)
+  {
+    entry.positions.push_back(point.positions);
+  }
+  entry.timed_trajectory = timed_trajectory;
+  entries_.push_back(std::move(entry));
+}
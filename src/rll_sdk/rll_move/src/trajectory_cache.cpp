@@ -0,0 +1,114 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cmath>
+
+#include <rll_move/trajectory_cache.h>
+
+const size_t RLLTrajectoryCache::MAX_ENTRIES;
+const double RLLTrajectoryCache::DEFAULT_TOLERANCE = 1E-03;
+
+bool RLLTrajectoryCache::withinTolerance(const std::vector<double>& lhs, const std::vector<double>& rhs) const
+{
+  if (lhs.size() != rhs.size())
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < lhs.size(); ++i)
+  {
+    if (std::fabs(lhs[i] - rhs[i]) > tolerance_)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+size_t RLLTrajectoryCache::find(const std::vector<double>& start, const std::vector<double>& goal) const
+{
+  return find(start, [this, &goal](const std::vector<double>& last) { return withinTolerance(last, goal); });
+}
+
+size_t RLLTrajectoryCache::find(const std::vector<double>& start,
+                                const std::function<bool(const std::vector<double>&)>& goal_matches) const
+{
+  for (size_t i = 0; i < entries_.size(); ++i)
+  {
+    const auto& points = entries_[i].joint_trajectory.points;
+    if (withinTolerance(points.front().positions, start) && goal_matches(points.back().positions))
+    {
+      return i;
+    }
+  }
+
+  return entries_.size();
+}
+
+bool RLLTrajectoryCache::lookup(const std::vector<double>& start, const std::vector<double>& goal,
+                                moveit_msgs::RobotTrajectory* trajectory)
+{
+  return lookup(find(start, goal), trajectory);
+}
+
+bool RLLTrajectoryCache::lookup(const std::vector<double>& start,
+                                const std::function<bool(const std::vector<double>&)>& goal_matches,
+                                moveit_msgs::RobotTrajectory* trajectory)
+{
+  return lookup(find(start, goal_matches), trajectory);
+}
+
+bool RLLTrajectoryCache::lookup(size_t i, moveit_msgs::RobotTrajectory* trajectory)
+{
+  if (i == entries_.size())
+  {
+    return false;
+  }
+
+  *trajectory = entries_[i];
+  // the transitions that are still replayed stay in the cache
+  entries_.erase(entries_.begin() + i);
+  entries_.push_back(*trajectory);
+  return true;
+}
+
+void RLLTrajectoryCache::insert(const moveit_msgs::RobotTrajectory& trajectory)
+{
+  const auto& points = trajectory.joint_trajectory.points;
+  if (points.empty())
+  {
+    return;
+  }
+
+  erase(points.front().positions, points.back().positions);
+  if (entries_.size() >= MAX_ENTRIES)
+  {
+    entries_.pop_front();
+  }
+  entries_.push_back(trajectory);
+}
+
+void RLLTrajectoryCache::erase(const std::vector<double>& start, const std::vector<double>& goal)
+{
+  size_t i = find(start, goal);
+  if (i < entries_.size())
+  {
+    entries_.erase(entries_.begin() + i);
+  }
+}
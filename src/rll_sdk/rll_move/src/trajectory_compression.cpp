@@ -0,0 +1,128 @@
+/*
+ * This file is part of the Robot Learning Lab SDK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <rll_move/trajectory_compression.h>
+
+const size_t RLLTrajectoryCompression::MAX_REMOVED_POINTS;
+
+void RLLTrajectoryCompression::interpolate(const trajectory_msgs::JointTrajectoryPoint& from,
+                                           const trajectory_msgs::JointTrajectoryPoint& to, double duration,
+                                           double time, std::vector<double>* positions)
+{
+  size_t num_joints = from.positions.size();
+  bool with_velocities = from.velocities.size() == num_joints && to.velocities.size() == num_joints;
+  bool with_accelerations =
+      with_velocities && from.accelerations.size() == num_joints && to.accelerations.size() == num_joints;
+
+  const double t = time;
+  const double T = duration;
+  positions->resize(num_joints);
+  for (size_t j = 0; j < num_joints; ++j)
+  {
+    double p0 = from.positions[j];
+    double p1 = to.positions[j];
+    if (!with_velocities)
+    {
+      (*positions)[j] = p0 + (p1 - p0) * t / T;
+      continue;
+    }
+
+    double v0 = from.velocities[j];
+    double v1 = to.velocities[j];
+    if (!with_accelerations)
+    {
+      double c2 = (3 * (p1 - p0) - (2 * v0 + v1) * T) / (T * T);
+      double c3 = (2 * (p0 - p1) + (v0 + v1) * T) / (T * T * T);
+      (*positions)[j] = p0 + t * (v0 + t * (c2 + t * c3));
+      continue;
+    }
+
+    double a0 = from.accelerations[j];
+    double a1 = to.accelerations[j];
+    double c3 = (20 * (p1 - p0) - (8 * v1 + 12 * v0) * T - (3 * a0 - a1) * T * T) / (2 * std::pow(T, 3));
+    double c4 = (30 * (p0 - p1) + (14 * v1 + 16 * v0) * T + (3 * a0 - 2 * a1) * T * T) / (2 * std::pow(T, 4));
+    double c5 = (12 * (p1 - p0) - 6 * (v1 + v0) * T - (a0 - a1) * T * T) / (2 * std::pow(T, 5));
+    (*positions)[j] = p0 + t * (v0 + t * (a0 / 2 + t * (c3 + t * (c4 + t * c5))));
+  }
+}
+
+bool RLLTrajectoryCompression::reproducible(const std::vector<trajectory_msgs::JointTrajectoryPoint>& points,
+                                            size_t first, size_t last) const
+{
+  double start_time = points[first].time_from_start.toSec();
+  double duration = points[last].time_from_start.toSec() - start_time;
+  if (duration <= 0.0)
+  {
+    return false;
+  }
+
+  std::vector<double> positions;
+  for (size_t i = first + 1; i < last; ++i)
+  {
+    interpolate(points[first], points[last], duration, points[i].time_from_start.toSec() - start_time, &positions);
+    for (size_t j = 0; j < positions.size(); ++j)
+    {
+      if (std::fabs(positions[j] - points[i].positions[j]) > joint_tolerance_)
+      {
+        return false;
+      }
+    }
+
+    if (cartesian_error_ && cartesian_error_(i, positions) > cartesian_tolerance_)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+size_t RLLTrajectoryCompression::compress(trajectory_msgs::JointTrajectory* trajectory) const
+{
+  std::vector<trajectory_msgs::JointTrajectoryPoint>& points = trajectory->points;
+  if (points.size() < 3)
+  {
+    return 0;
+  }
+
+  // greedily extend the spline from the last kept point as far as the points in between are reproduced
+  std::vector<size_t> kept = { 0 };
+  size_t first = 0;
+  while (first + 1 < points.size())
+  {
+    size_t last = first + 1;
+    while (last + 1 < points.size() && last - first <= MAX_REMOVED_POINTS && reproducible(points, first, last + 1))
+    {
+      ++last;
+    }
+    kept.push_back(last);
+    first = last;
+  }
+
+  std::vector<trajectory_msgs::JointTrajectoryPoint> compressed;
+  compressed.reserve(kept.size());
+  for (size_t i : kept)
+  {
+    compressed.push_back(std::move(points[i]));
+  }
+
+  size_t num_removed = points.size() - compressed.size();
+  points = std::move(compressed);
+  return num_removed;
+}
@@ -0,0 +1,218 @@
+#! /usr/bin/env python
+#
+# This file is part of the Robot Learning Lab Move Client
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+from __future__ import print_function
+
+import csv
+import threading
+import time
+from math import pi
+
+import rospy
+import rosservice
+from geometry_msgs.msg import Pose, Point
+from sensor_msgs.msg import JointState
+from rll_move_client.client import RLLDefaultMoveClient
+from rll_move_client.util import orientation_from_rpy
+from rll_tools.run import run_project_in_background
+
+from test_iface_util import grip_pose_at, INITIAL_GRIP_POSE_BOX
+
+# Latency benchmark for the move_iface services. Every service is called in a
+# loop and the wall time of each call is split into phases with the help of
+# the joint states published by the fake controllers:
+#   planning:  from the request until the robot starts to move
+#   execution: from the first to the last joint state change
+#   overhead:  the rest, i.e. settling, state machine and service round trip
+# The resolution of the phases is limited by the rate of the joint states,
+# 60 Hz with the fake controller setup.
+
+PHASES = ["total", "planning", "execution", "overhead"]
+PERCENTILES = [50, 95, 99]
+JOINT_STATE_CHANGE_TOL = 1E-06
+# time to wait for the last joint states of a motion after a call returned
+JOINT_STATE_SETTLE_TIME = 0.1
+
+
+class JointStateTracker(object):
+    """Records when the joint states start and stop changing."""
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._last_positions = None
+        self._first_change = None
+        self._last_change = None
+        self._sub = rospy.Subscriber("joint_states", JointState,
+                                     self._on_joint_states, queue_size=100)
+
+    def _on_joint_states(self, msg):
+        stamp = time.time()
+        with self._lock:
+            if self._last_positions is not None and any(
+                    abs(a - b) > JOINT_STATE_CHANGE_TOL
+                    for a, b in zip(msg.position, self._last_positions)):
+                if self._first_change is None:
+                    self._first_change = stamp
+                self._last_change = stamp
+            self._last_positions = msg.position
+
+    def reset(self):
+        with self._lock:
+            self._first_change = None
+            self._last_change = None
+
+    def changes(self):
+        with self._lock:
+            return self._first_change, self._last_change
+
+
+def percentile(values, pct):
+    # nearest-rank percentile, values have to be sorted
+    if not values:
+        return float("nan")
+    rank = int(round(pct / 100.0 * (len(values) - 1)))
+    return values[rank]
+
+
+class LatencyBenchmark(object):
+
+    def __init__(self, iterations):
+        self.iterations = iterations
+        self.tracker = JointStateTracker()
+        self.results = []
+
+    def run(self, name, call, moves=True):
+        samples = dict((phase, []) for phase in PHASES)
+        failed = 0
+
+        for i in range(self.iterations):
+            self.tracker.reset()
+            start = time.time()
+            success = call(i)
+            end = time.time()
+
+            if not success:
+                failed += 1
+                continue
+
+            samples["total"].append(end - start)
+            if not moves:
+                continue
+
+            rospy.sleep(JOINT_STATE_SETTLE_TIME)
+            first_change, last_change = self.tracker.changes()
+            if first_change is None or first_change > end:
+                rospy.logwarn("%s: no motion observed in call %d", name, i)
+                continue
+
+            last_change = min(last_change, end)
+            samples["planning"].append(first_change - start)
+            samples["execution"].append(last_change - first_change)
+            samples["overhead"].append(end - last_change)
+
+        for phase in PHASES:
+            values = sorted(samples[phase])
+            if not values:
+                continue
+            self.results.append(
+                [name, phase, len(values), failed] +
+                [1000 * percentile(values, pct) for pct in PERCENTILES])
+
+    def report(self, output_file):
+        header = ["service", "phase", "samples", "failed"] + \
+            ["p%d_ms" % pct for pct in PERCENTILES]
+
+        print("%-28s %-10s %8s %7s %10s %10s %10s" % tuple(header))
+        for row in self.results:
+            print("%-28s %-10s %8d %7d %10.2f %10.2f %10.2f" % tuple(row))
+
+        with open(output_file, "w") as csv_file:
+            writer = csv.writer(csv_file)
+            writer.writerow(header)
+            writer.writerows(self.results)
+
+        rospy.loginfo("latency results written to %s", output_file)
+
+
+def service_available(name):
+    return rosservice.get_service_type(rospy.resolve_name(name)) is not None
+
+
+def execute(client):
+    # type: (RLLDefaultMoveClient) -> bool
+
+    iterations = rospy.get_param("~iterations", 20)
+    output_file = rospy.get_param("~output_file", "/tmp/rll_move_latency.csv")
+    benchmark = LatencyBenchmark(iterations)
+
+    ptp_poses = [Pose(Point(.4, -.3, .3), orientation_from_rpy(0, pi, 0)),
+                 Pose(Point(.4, .3, .3), orientation_from_rpy(0, pi, pi / 2))]
+    lin_poses = [Pose(Point(.4, -.1, .3), orientation_from_rpy(0, pi, 0)),
+                 Pose(Point(.5, .1, .25), orientation_from_rpy(0, pi, 0))]
+    approach_pose_box = grip_pose_at(3, .2)
+    approach_pose_box.orientation = INITIAL_GRIP_POSE_BOX.orientation
+
+    benchmark.run("get_current_joint_values",
+                  lambda i: client.get_current_joint_values() is not None,
+                  moves=False)
+
+    client.move_ptp(ptp_poses[1])
+    benchmark.run("move_ptp", lambda i: client.move_ptp(ptp_poses[i % 2]))
+
+    client.move_ptp(lin_poses[1])
+    benchmark.run("move_lin", lambda i: client.move_lin(lin_poses[i % 2]))
+
+    # pick the box up and put it back down at the same position
+    client.move_ptp(approach_pose_box)
+    benchmark.run("pick_place", lambda i: client.pick_place(
+        approach_pose_box, INITIAL_GRIP_POSE_BOX, approach_pose_box,
+        i % 2 == 0, "box1"))
+    if iterations % 2 == 1:
+        client.pick_place(approach_pose_box, INITIAL_GRIP_POSE_BOX,
+                          approach_pose_box, False, "box1")
+
+    # check_path is only offered by the planning project interface
+    if service_available("check_path"):
+        from geometry_msgs.msg import Pose2D
+        from rll_planning_project.srv import CheckPath
+        check_path = rospy.ServiceProxy("check_path", CheckPath)
+        starts = [Pose2D(.3, -.1, 0), Pose2D(.3, .1, pi / 2)]
+        goals = [Pose2D(.3, .1, 0), Pose2D(.3, -.1, pi / 2)]
+
+        def call_check_path(i):
+            return check_path(starts[i % 2], goals[i % 2]) is not None
+
+        benchmark.run("check_path", call_check_path, moves=False)
+
+    benchmark.report(output_file)
+
+    return True
+
+
+def main():
+    # wait for the move_iface to start
+    time.sleep(8)
+
+    rospy.init_node("latency_benchmark")
+    client = RLLDefaultMoveClient(execute)
+    run_project_in_background(2)
+    client.spin(oneshot=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,248 @@
+#! /usr/bin/env python
+#
+# This file is part of the Robot Learning Lab Move Client
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+from __future__ import print_function
+
+import csv
+import math
+import time
+
+import rospy
+import yaml
+from geometry_msgs.msg import Pose, Point
+from moveit_msgs.msg import (Constraints, JointConstraint, MoveItErrorCodes,
+                             MotionPlanRequest, OrientationConstraint,
+                             PositionConstraint)
+from moveit_msgs.srv import GetMotionPlan
+from shape_msgs.msg import SolidPrimitive
+from rll_move_client.util import orientation_from_rpy
+
+# Benchmark of the OMPL planner configs for PTP motions in the RLL cell. The
+# queries of a stored corpus are sent to the planning service of the move
+# group, which runs with the fake controllers, so that no warehouse database
+# and no benchmark config files are needed. Each planner config solves every
+# query several times and is rated by its success rate, its solve times and
+# the quality of the paths:
+#   path_ratio: joint space length of the path divided by the length of the
+#               shortest path any planner found for the same query
+#   duration:   duration of the time parameterized trajectory
+
+GROUP_NAME = "manipulator"
+# the planner and planning time used by the move_iface
+DEFAULT_PLANNER = "RRTConnectkConfigDefault"
+DEFAULT_PLANNING_TIME = 2.0
+PERCENTILES = [50, 95]
+# goal tolerances of the MoveGroupInterface
+JOINT_TOLERANCE = 1E-04
+POSITION_TOLERANCE = 1E-04
+ORIENTATION_TOLERANCE = 1E-03
+
+
+def percentile(values, pct):
+    # nearest-rank percentile, values have to be sorted
+    if not values:
+        return float("nan")
+    rank = int(round(pct / 100.0 * (len(values) - 1)))
+    return values[rank]
+
+
+def mean(values):
+    return sum(values) / len(values) if values else float("nan")
+
+
+def joint_path_length(trajectory):
+    points = trajectory.joint_trajectory.points
+    return sum(math.sqrt(sum((a - b) ** 2 for a, b in
+                             zip(p.positions, q.positions)))
+               for p, q in zip(points, points[1:]))
+
+
+class PlannerBenchmark(object):
+
+    def __init__(self, robot, corpus, planning_time, runs):
+        self.joint_names = ["%s_joint_%d" % (robot, i) for i in range(1, 8)]
+        self.tcp_link = "%s_link_tcp" % robot
+        self.joint_states = corpus["joint_states"]
+        self.poses = corpus["poses"]
+        self.queries = corpus["queries"]
+        self.planning_time = planning_time
+        self.runs = runs
+        self.results = []
+
+        rospy.wait_for_service("plan_kinematic_path")
+        self.plan = rospy.ServiceProxy("plan_kinematic_path", GetMotionPlan)
+
+    def goal_constraints(self, goal):
+        constraints = Constraints(name=goal)
+        if goal in self.joint_states:
+            for name, position in zip(self.joint_names,
+                                      self.joint_states[goal]):
+                constraints.joint_constraints.append(JointConstraint(
+                    joint_name=name, position=position,
+                    tolerance_above=JOINT_TOLERANCE,
+                    tolerance_below=JOINT_TOLERANCE, weight=1.0))
+            return constraints
+
+        x, y, z, roll, pitch, yaw = self.poses[goal]
+        region = SolidPrimitive(type=SolidPrimitive.SPHERE,
+                                dimensions=[POSITION_TOLERANCE])
+        position = PositionConstraint(link_name=self.tcp_link, weight=1.0)
+        position.header.frame_id = "world"
+        position.constraint_region.primitives.append(region)
+        position.constraint_region.primitive_poses.append(
+            Pose(Point(x, y, z), orientation_from_rpy(0, 0, 0)))
+        orientation = OrientationConstraint(
+            link_name=self.tcp_link,
+            orientation=orientation_from_rpy(roll, pitch, yaw),
+            absolute_x_axis_tolerance=ORIENTATION_TOLERANCE,
+            absolute_y_axis_tolerance=ORIENTATION_TOLERANCE,
+            absolute_z_axis_tolerance=ORIENTATION_TOLERANCE, weight=1.0)
+        orientation.header.frame_id = "world"
+        constraints.position_constraints.append(position)
+        constraints.orientation_constraints.append(orientation)
+        return constraints
+
+    def request(self, planner, query):
+        request = MotionPlanRequest(group_name=GROUP_NAME, planner_id=planner,
+                                    num_planning_attempts=1,
+                                    allowed_planning_time=self.planning_time,
+                                    max_velocity_scaling_factor=1.0,
+                                    max_acceleration_scaling_factor=1.0)
+        # the gripper joints are taken from the current state
+        request.start_state.is_diff = True
+        request.start_state.joint_state.name = self.joint_names
+        request.start_state.joint_state.position = \
+            self.joint_states[query["start"]]
+        request.goal_constraints.append(self.goal_constraints(query["goal"]))
+        return request
+
+    def run(self, planner):
+        rospy.loginfo("benchmarking %s", planner)
+        for query in self.queries:
+            request = self.request(planner, query)
+            for i in range(self.runs):
+                start = time.time()
+                try:
+                    response = self.plan(request).motion_plan_response
+                except rospy.ServiceException as e:
+                    rospy.logerr("%s failed on %s: %s", planner,
+                                 query["name"], e)
+                    continue
+                wall_time = time.time() - start
+
+                success = response.error_code.val == MoveItErrorCodes.SUCCESS
+                points = response.trajectory.joint_trajectory.points
+                self.results.append({
+                    "planner": planner, "query": query["name"], "run": i,
+                    "success": int(success),
+                    "error_code": response.error_code.val,
+                    "solve_time": response.planning_time,
+                    "wall_time": wall_time,
+                    "path_length": joint_path_length(response.trajectory)
+                    if success else float("nan"),
+                    "duration": points[-1].time_from_start.to_sec()
+                    if success and points else float("nan")})
+
+    def report(self, output_file, summary_file):
+        fields = ["planner", "query", "run", "success", "error_code",
+                  "solve_time", "wall_time", "path_length", "duration"]
+        with open(output_file, "w") as csv_file:
+            writer = csv.DictWriter(csv_file, fieldnames=fields)
+            writer.writeheader()
+            writer.writerows(self.results)
+
+        shortest = {}
+        for result in self.results:
+            if result["success"]:
+                shortest[result["query"]] = min(
+                    shortest.get(result["query"], float("inf")),
+                    result["path_length"])
+
+        header = ["planner", "runs", "success_rate", "queries_solved"] + \
+            ["solve_p%d_s" % pct for pct in PERCENTILES] + \
+            ["path_ratio", "duration_s"]
+        rows = []
+        planners = []
+        for result in self.results:
+            if result["planner"] not in planners:
+                planners.append(result["planner"])
+        for planner in planners:
+            runs = [r for r in self.results if r["planner"] == planner]
+            solved = [r for r in runs if r["success"]]
+            solve_times = sorted(r["solve_time"] for r in solved)
+            ratios = [r["path_length"] / shortest[r["query"]]
+                      for r in solved if shortest[r["query"]] > 0]
+            rows.append([planner, len(runs),
+                         float(len(solved)) / len(runs) if runs else 0.0,
+                         len(set(r["query"] for r in solved))] +
+                        [percentile(solve_times, pct)
+                         for pct in PERCENTILES] +
+                        [mean(ratios), mean([r["duration"] for r in solved])])
+
+        # most reliable planners first, ties are broken by the solve time
+        rows.sort(key=lambda row: (-row[2], row[4] if not math.isnan(row[4])
+                                   else float("inf")))
+        print("%-28s %6s %8s %7s %10s %10s %10s %10s" % tuple(header))
+        for row in rows:
+            marker = " (default)" if row[0] == DEFAULT_PLANNER else ""
+            print(("%-28s %6d %8.3f %7d %10.3f %10.3f %10.3f %10.3f" %
+                   tuple(row)) + marker)
+
+        with open(summary_file, "w") as csv_file:
+            writer = csv.writer(csv_file)
+            writer.writerow(header)
+            writer.writerows(rows)
+
+        rospy.loginfo("planner benchmark results written to %s and %s",
+                      output_file, summary_file)
+
+
+def main():
+    rospy.init_node("planner_benchmark")
+
+    robot = rospy.get_param("~robot", "iiwa")
+    runs = rospy.get_param("~runs", 10)
+    planning_time = rospy.get_param("~planning_time", DEFAULT_PLANNING_TIME)
+    output_file = rospy.get_param("~output_file",
+                                  "/tmp/rll_planner_benchmark.csv")
+    summary_file = rospy.get_param("~summary_file",
+                                   "/tmp/rll_planner_benchmark_summary.csv")
+    with open(rospy.get_param("~queries_file")) as queries_file:
+        corpus = yaml.safe_load(queries_file)
+
+    # all planner configs of the group in the ompl_planning.yaml by default
+    planners = rospy.get_param("~planners", "")
+    if planners:
+        planners = planners.split(",")
+    else:
+        planners = rospy.get_param("move_group/%s/planner_configs" %
+                                   GROUP_NAME)
+
+    benchmark = PlannerBenchmark(robot, corpus, planning_time, runs)
+    rospy.loginfo("benchmarking %d planner configs on %d queries",
+                  len(planners), len(benchmark.queries))
+    for planner in planners:
+        if rospy.is_shutdown():
+            break
+        benchmark.run(planner)
+
+    benchmark.report(output_file, summary_file)
+
+
+if __name__ == "__main__":
+    main()
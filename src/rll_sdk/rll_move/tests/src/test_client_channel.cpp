@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <rll_move/client_channel.h>
+
+TEST(ClientChannelTest, testFormatAndParse)
+{
+  RLLClientMessage msg;
+  msg.command = RLLClientMessage::START_CMD;
+  msg.job_id = 42;
+  EXPECT_EQ(msg.format(), "start 42\n");
+
+  RLLClientMessage parsed;
+  ASSERT_TRUE(parsed.parse("ok 4294967295"));
+  EXPECT_EQ(parsed.command, "ok");
+  EXPECT_EQ(parsed.job_id, 4294967295u);
+
+  EXPECT_FALSE(parsed.parse("start"));
+  EXPECT_FALSE(parsed.parse("start "));
+  EXPECT_FALSE(parsed.parse(" 1"));
+  EXPECT_FALSE(parsed.parse("start -1"));
+  EXPECT_FALSE(parsed.parse("start 1x"));
+  EXPECT_FALSE(parsed.parse("start 4294967296"));
+}
+
+TEST(ClientChannelTest, testReaderSplitsMessages)
+{
+  RLLClientMessageReader reader;
+  RLLClientMessage msg;
+  std::string data = "ok 1\nerr";
+  reader.append(data.c_str(), data.size());
+  ASSERT_TRUE(reader.next(&msg));
+  EXPECT_EQ(msg.command, "ok");
+  EXPECT_EQ(msg.job_id, 1u);
+  EXPECT_FALSE(reader.next(&msg));
+
+  // malformed lines are skipped
+  data = "or 2\ngarbage\nok 3\n";
+  reader.append(data.c_str(), data.size());
+  ASSERT_TRUE(reader.next(&msg));
+  EXPECT_EQ(msg.command, "error");
+  EXPECT_EQ(msg.job_id, 2u);
+  ASSERT_TRUE(reader.next(&msg));
+  EXPECT_EQ(msg.job_id, 3u);
+  EXPECT_FALSE(reader.next(&msg));
+
+  // overlong lines are dropped without growing the buffer
+  std::string overlong(RLLClientMessage::MAX_LINE_LENGTH + 1, 'x');
+  reader.append(overlong.c_str(), overlong.size());
+  EXPECT_FALSE(reader.next(&msg));
+  data = "\nok 4\n";
+  reader.append(data.c_str(), data.size());
+  ASSERT_TRUE(reader.next(&msg));
+  EXPECT_EQ(msg.job_id, 4u);
+}
+
+TEST(ClientChannelTest, testReceive)
+{
+  int sockets[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+  ASSERT_TRUE(setClientSocketTimeouts(sockets[0], 1));
+
+  RLLClientMessage msg;
+  msg.command = RLLClientMessage::OK_RESP;
+  for (uint32_t job_id : { 7, 8 })
+  {
+    msg.job_id = job_id;
+    ASSERT_TRUE(sendClientMessage(sockets[1], msg));
+  }
+
+  // both messages arrive with the same read, the second one stays buffered
+  RLLClientMessageReader reader;
+  RLLClientMessage received;
+  ASSERT_EQ(reader.receive(sockets[0], &received), RLLClientMessageReader::Status::MESSAGE);
+  EXPECT_EQ(received.job_id, 7u);
+  ASSERT_EQ(reader.receive(sockets[0], &received), RLLClientMessageReader::Status::MESSAGE);
+  EXPECT_EQ(received.job_id, 8u);
+
+  close(sockets[1]);
+  EXPECT_EQ(reader.receive(sockets[0], &received), RLLClientMessageReader::Status::CLOSED);
+  EXPECT_FALSE(sendClientMessage(sockets[0], msg));
+  close(sockets[0]);
+}
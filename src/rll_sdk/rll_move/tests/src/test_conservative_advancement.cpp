@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include <rll_move/conservative_advancement.h>
+
+namespace
+{
+// a point moving along a line in millimetre steps, obstacles are intervals on the line
+class LinePath
+{
+public:
+  explicit LinePath(size_t num_waypoints) : num_waypoints_(num_waypoints)
+  {
+  }
+
+  void addObstacle(double begin, double end)
+  {
+    obstacles_.push_back({ begin, end });
+  }
+
+  double position(size_t i) const
+  {
+    return 0.001 * i;
+  }
+
+  bool inCollision(size_t i) const
+  {
+    return clearance(i) <= 0.0;
+  }
+
+  double clearance(size_t i) const
+  {
+    double clearance = 1.0;
+    for (const auto& obstacle : obstacles_)
+    {
+      double x = position(i);
+      if (x >= obstacle.first && x <= obstacle.second)
+      {
+        return 0.0;
+      }
+      clearance = std::min(clearance, std::min(std::fabs(x - obstacle.first), std::fabs(x - obstacle.second)));
+    }
+    return clearance;
+  }
+
+  RLLConservativeAdvancement advancement() const
+  {
+    return RLLConservativeAdvancement(
+        [this](size_t i) { return inCollision(i); }, [this](size_t i) { return clearance(i); },
+        [this](size_t from, size_t to) { return std::fabs(position(to) - position(from)); });
+  }
+
+  bool isPathValidDiscrete() const
+  {
+    for (size_t i = 0; i < num_waypoints_; ++i)
+    {
+      if (inCollision(i))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t numWaypoints() const
+  {
+    return num_waypoints_;
+  }
+
+private:
+  size_t num_waypoints_;
+  std::vector<std::pair<double, double>> obstacles_;
+};
+}  // namespace
+
+TEST(ConservativeAdvancementTest, testFreePath)
+{
+  LinePath path(1000);
+  path.addObstacle(1.5, 2.0);
+  RLLConservativeAdvancement advancement = path.advancement();
+
+  EXPECT_TRUE(advancement.isPathValid(path.numWaypoints()));
+  EXPECT_LT(advancement.numCollisionChecks(), 10u);
+}
+
+TEST(ConservativeAdvancementTest, testCollision)
+{
+  LinePath path(1000);
+  path.addObstacle(0.5, 0.5005);
+  RLLConservativeAdvancement advancement = path.advancement();
+
+  EXPECT_FALSE(advancement.isPathValid(path.numWaypoints()));
+}
+
+TEST(ConservativeAdvancementTest, testCloseToObstacle)
+{
+  // the path passes within the step size of an obstacle, so waypoints around it are checked discretely
+  LinePath path(1000);
+  path.addObstacle(0.5003, 0.5007);
+  RLLConservativeAdvancement advancement = path.advancement();
+
+  EXPECT_TRUE(advancement.isPathValid(path.numWaypoints()));
+  EXPECT_LT(advancement.numCollisionChecks(), 100u);
+  EXPECT_GT(advancement.numCollisionChecks(), RLLConservativeAdvancement::DEFAULT_DISCRETE_RUN);
+}
+
+TEST(ConservativeAdvancementTest, testSameResultAsDiscreteChecks)
+{
+  for (size_t k = 0; k < 200; ++k)
+  {
+    LinePath path(1000);
+    double begin = 0.0071 * k - 0.2;
+    path.addObstacle(begin, begin + 0.0001 * (k % 7));
+    EXPECT_EQ(path.advancement().isPathValid(path.numWaypoints()), path.isPathValidDiscrete()) << k;
+  }
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <rll_move/const_transform_cache.h>
+
+namespace
+{
+std::string cacheFileName()
+{
+  return std::string("/tmp/rll_const_transform_cache_") + testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+}  // namespace
+
+TEST(ConstTransformCacheTest, testSaveAndLoad)
+{
+  std::string file_name = cacheFileName();
+  std::remove(file_name.c_str());
+
+  RLLConstTransformCache::Transform ee_to_tip = { 0.0, 0.0, 0.1, 0.0, 0.0, 0.38268343236508984, 0.92387953251128674 };
+  RLLConstTransformCache::Transform base_to_world = { -0.2, 1.0 / 3.0, 0.0, 0.0, 0.0, 0.0, 1.0 };
+  {
+    RLLConstTransformCache cache(file_name, "robot 1");
+    EXPECT_FALSE(cache.load());
+    EXPECT_TRUE(cache.update("ee_to_tip", ee_to_tip));
+    EXPECT_TRUE(cache.update("base_to_world", base_to_world));
+    ASSERT_TRUE(cache.save());
+  }
+
+  RLLConstTransformCache cache(file_name, "robot 1");
+  ASSERT_TRUE(cache.load());
+  RLLConstTransformCache::Transform transform;
+  ASSERT_TRUE(cache.lookup("ee_to_tip", &transform));
+  EXPECT_EQ(transform, ee_to_tip);
+  ASSERT_TRUE(cache.lookup("base_to_world", &transform));
+  // written with full precision
+  EXPECT_EQ(transform, base_to_world);
+  EXPECT_FALSE(cache.lookup("other", &transform));
+
+  // the cache of another robot description is not used
+  RLLConstTransformCache other(file_name, "robot 2");
+  EXPECT_FALSE(other.load());
+  EXPECT_FALSE(other.lookup("ee_to_tip", &transform));
+  std::remove(file_name.c_str());
+}
+
+TEST(ConstTransformCacheTest, testUpdate)
+{
+  RLLConstTransformCache cache(cacheFileName(), "key");
+  RLLConstTransformCache::Transform transform = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0 };
+  EXPECT_TRUE(cache.update("transform", transform));
+  EXPECT_FALSE(cache.update("transform", transform));
+
+  transform[0] += RLLConstTransformCache::TOLERANCE / 2;
+  EXPECT_FALSE(cache.update("transform", transform));
+  transform[0] += 1E-06;
+  EXPECT_TRUE(cache.update("transform", transform));
+
+  RLLConstTransformCache::Transform cached;
+  ASSERT_TRUE(cache.lookup("transform", &cached));
+  EXPECT_EQ(cached, transform);
+}
+
+TEST(ConstTransformCacheTest, testMalformedFile)
+{
+  std::string file_name = cacheFileName();
+  {
+    std::ofstream file(file_name);
+    file << "key\nee_to_tip 0 0 0.1 0 0\n";
+  }
+
+  RLLConstTransformCache cache(file_name, "key");
+  EXPECT_FALSE(cache.load());
+  RLLConstTransformCache::Transform transform;
+  EXPECT_FALSE(cache.lookup("ee_to_tip", &transform));
+  std::remove(file_name.c_str());
+}
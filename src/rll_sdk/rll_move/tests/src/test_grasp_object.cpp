@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include <fcl/collision.h>
+#include <rll_move/grasp_object.h>
+#include <rll_move/grasp_util.h>
+
+namespace
+{
+geometry_msgs::Point point(double x, double y, double z)
+{
+  geometry_msgs::Point p;
+  p.x = x;
+  p.y = y;
+  p.z = z;
+  return p;
+}
+
+// the FCL query that the analytic tests replace
+bool fclPointInCollisionGeometry(const GraspObject& object, const geometry_msgs::Point& p)
+{
+  const geometry_msgs::Pose& pose = object.getCenterPose();
+  fcl::Transform3f object_tf(
+      fcl::Quaternion3f(pose.orientation.w, pose.orientation.x, pose.orientation.y, pose.orientation.z),
+      fcl::Vec3f(pose.position.x, pose.position.y, pose.position.z));
+  fcl::Sphere sphere(GraspObject::QUERY_RADIUS);
+  fcl::CollisionRequest req(1, false);
+  fcl::CollisionResult res;
+  fcl::Transform3f point_tf(fcl::Vec3f(p.x, p.y, p.z));
+  return fcl::collide(object.getBoundingCollisionGeometry(), object_tf, &sphere, point_tf, req, res) > 0;
+}
+
+void expectPointsInCollision(const GraspObject& object, const std::vector<geometry_msgs::Point>& points,
+                             const std::vector<bool>& expected)
+{
+  std::vector<bool> in_collision;
+  size_t num_expected = std::count(expected.begin(), expected.end(), true);
+  EXPECT_EQ(object.pointsInCollisionGeometry(object.getCenterPose(), points, &in_collision), num_expected);
+  EXPECT_EQ(in_collision, expected);
+
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    EXPECT_EQ(object.pointInCollisionGeometry(object.getCenterPose(), points[i]), expected[i]) << "point " << i;
+    EXPECT_EQ(fclPointInCollisionGeometry(object, points[i]), expected[i]) << "point " << i;
+  }
+}
+}  // namespace
+
+TEST(GraspObjectTest, testBox)
+{
+  CollisionObjectBuilder builder;
+  BoxGraspObject box;
+  box.updateDataFromCollisionObject(
+      builder.begin().addBox(.1, .05, .02).translate(.4, .2, .01).rotateRPY(0, 0, M_PI / 2).build("box", "world"));
+
+  // the local x axis points along the world y axis
+  expectPointsInCollision(box,
+                          { point(.4, .2, .01), point(.4, .259, .01), point(.4, .261, .01), point(.459, .2, .01),
+                            point(.369, .256, .01), point(.367, .258, .01) },
+                          { true, true, false, false, true, false });
+}
+
+TEST(GraspObjectTest, testCylinder)
+{
+  CollisionObjectBuilder builder;
+  CylinderGraspObject cylinder;
+  cylinder.updateDataFromCollisionObject(
+      builder.begin().addCylinder(.05, .06).positionBottomAtZ(.06, 0).build("cylinder", "world"));
+
+  expectPointsInCollision(cylinder,
+                          { point(0, 0, .03), point(.059, 0, .03), point(0, .061, .03), point(0, 0, .069),
+                            point(0, 0, -.011), point(.056, 0, .066), point(0, -.058, .068) },
+                          { true, true, false, true, false, true, false });
+}
+
+TEST(GraspObjectTest, testMeshBoundingBox)
+{
+  moveit_msgs::CollisionObject collision_object;
+  collision_object.id = "mesh";
+  collision_object.meshes.resize(1);
+  geometry_msgs::Pose pose;
+  pose.position = point(.2, .3, .02);
+  pose.orientation.w = 1;
+  collision_object.mesh_poses.push_back(pose);
+
+  SingleMeshGraspObject mesh(.08, .04, .04);
+  mesh.updateDataFromCollisionObject(collision_object);
+
+  expectPointsInCollision(mesh, { point(.2, .3, .02), point(.249, .3, .02), point(.251, .3, .02), point(.2, .3, .071) },
+                          { true, true, false, false });
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <rll_move/ik_cache.h>
+
+namespace
+{
+geometry_msgs::Pose pose(double x, double y, double z)
+{
+  geometry_msgs::Pose pose;
+  pose.position.x = x;
+  pose.position.y = y;
+  pose.position.z = z;
+  pose.orientation.w = 1.0;
+  return pose;
+}
+
+RLLKinSolutions solutions(double joint_1)
+{
+  RLLKinSolutions solutions;
+  solutions.push_back({ joint_1, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6 });
+  solutions.push_back({ -joint_1, -0.1, -0.2, -0.3, -0.4, -0.5, -0.6 });
+  return solutions;
+}
+}  // namespace
+
+TEST(IKCacheTest, testLookup)
+{
+  RLLIKCache cache;
+  RLLKinSolutions cached;
+  RLLKinGlobalConfig config(2);
+  EXPECT_FALSE(cache.lookup(pose(0.4, 0.1, 0.5), config, &cached));
+
+  cache.insert(pose(0.4, 0.1, 0.5), config, solutions(1.0));
+  ASSERT_TRUE(cache.lookup(pose(0.4, 0.1 + 0.1 * RLLIKCache::RESOLUTION, 0.5), config, &cached));
+  ASSERT_EQ(cached.size(), 2u);
+  EXPECT_DOUBLE_EQ(cached[0](0), 1.0);
+  EXPECT_DOUBLE_EQ(cached[1](0), -1.0);
+
+  // other poses and seed configurations are separate entries
+  EXPECT_FALSE(cache.lookup(pose(0.4, 0.1 + 10 * RLLIKCache::RESOLUTION, 0.5), config, &cached));
+  EXPECT_FALSE(cache.lookup(pose(0.4, 0.1, 0.5), RLLKinGlobalConfig(3), &cached));
+
+  cache.insert(pose(0.4, 0.1, 0.5), config, solutions(2.0));
+  ASSERT_TRUE(cache.lookup(pose(0.4, 0.1, 0.5), config, &cached));
+  EXPECT_DOUBLE_EQ(cached[0](0), 2.0);
+  EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(IKCacheTest, testBoundedSize)
+{
+  RLLIKCache cache;
+  for (size_t i = 0; i < RLLIKCache::MAX_ENTRIES; ++i)
+  {
+    cache.insert(pose(0.001 * i, 0.0, 0.5), RLLKinGlobalConfig(0), solutions(0.0));
+  }
+  EXPECT_EQ(cache.size(), RLLIKCache::MAX_ENTRIES);
+
+  cache.insert(pose(1.0, 0.0, 0.5), RLLKinGlobalConfig(0), solutions(0.0));
+  EXPECT_EQ(cache.size(), 1u);
+
+  RLLKinSolutions cached;
+  EXPECT_TRUE(cache.lookup(pose(1.0, 0.0, 0.5), RLLKinGlobalConfig(0), &cached));
+  cache.clear();
+  EXPECT_FALSE(cache.lookup(pose(1.0, 0.0, 0.5), RLLKinGlobalConfig(0), &cached));
+}
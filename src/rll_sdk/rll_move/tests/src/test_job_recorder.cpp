@@ -0,0 +1,142 @@
+#include <unistd.h>
+
+#include <cstdio>
+
+#include <gtest/gtest.h>
+
+#include <rll_move/job_recorder.h>
+#include <rll_msgs/MoveLin.h>
+
+namespace
+{
+std::string tempFileName()
+{
+  char file_name[] = "/tmp/rll_job_recorder_XXXXXX";
+  int fd = mkstemp(file_name);
+  ::close(fd);
+  return file_name;
+}
+
+rll_msgs::MoveLin::Request moveLinRequest(double x)
+{
+  rll_msgs::MoveLin::Request req;
+  req.pose.position.x = x;
+  req.pose.position.z = 0.5;
+  req.pose.orientation.w = 1.0;
+  return req;
+}
+}  // namespace
+
+TEST(JobRecorderTest, testRoundTrip)
+{
+  std::string file_name = tempFileName();
+  RLLJobRecorder recorder;
+  EXPECT_FALSE(recorder.recording());
+  ASSERT_TRUE(recorder.open(file_name));
+  EXPECT_TRUE(recorder.recording());
+
+  moveit_msgs::PlanningScene scene;
+  scene.name = "maze";
+  scene.world.collision_objects.resize(2);
+  scene.world.collision_objects[1].id = "wall";
+  std::vector<double> joint_values = { 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7 };
+  recorder.recordJobStart(scene, joint_values);
+
+  rll_msgs::MoveLin::Response resp;
+  resp.success = 0u;
+  resp.error_code = 7;
+  recorder.recordServiceCall(moveLinRequest(0.3), resp, ros::WallTime(10, 5), ros::WallDuration(0, 250), 7,
+                             joint_values);
+  recorder.recordJobEnd(3);
+  recorder.close();
+  EXPECT_FALSE(recorder.recording());
+
+  // nothing is recorded after closing
+  recorder.recordJobEnd(4);
+
+  RLLJobLogReader reader;
+  ASSERT_TRUE(reader.open(file_name));
+  const auto& records = reader.records();
+  ASSERT_EQ(records.size(), 3u);
+
+  EXPECT_EQ(records[0].header->type, RLLJobLogRecordType::JOB_START);
+  moveit_msgs::PlanningScene read_scene;
+  ASSERT_TRUE(RLLJobLogReader::deserializeRequest(records[0], &read_scene));
+  EXPECT_EQ(read_scene.name, "maze");
+  ASSERT_EQ(read_scene.world.collision_objects.size(), 2u);
+  EXPECT_EQ(read_scene.world.collision_objects[1].id, "wall");
+  ASSERT_EQ(records[0].header->num_joints, joint_values.size());
+  for (size_t i = 0; i < joint_values.size(); ++i)
+  {
+    EXPECT_EQ(records[0].header->joint_values[i], joint_values[i]);
+  }
+
+  EXPECT_EQ(records[1].header->type, RLLJobLogRecordType::SERVICE_CALL);
+  EXPECT_EQ(records[1].name, "rll_msgs/MoveLinRequest");
+  EXPECT_EQ(records[1].header->start_ns, static_cast<int64_t>(ros::WallTime(10, 5).toNSec()));
+  EXPECT_EQ(records[1].header->duration_ns, 250);
+  EXPECT_EQ(records[1].header->error_code, 7);
+  rll_msgs::MoveLin::Request read_req;
+  ASSERT_TRUE(RLLJobLogReader::deserializeRequest(records[1], &read_req));
+  EXPECT_EQ(read_req.pose.position.x, 0.3);
+  EXPECT_EQ(read_req.pose.orientation.w, 1.0);
+  rll_msgs::MoveLin::Response read_resp;
+  ASSERT_TRUE(RLLJobLogReader::deserializeResponse(records[1], &read_resp));
+  EXPECT_EQ(read_resp.error_code, 7);
+
+  EXPECT_EQ(records[2].header->type, RLLJobLogRecordType::JOB_END);
+  EXPECT_EQ(records[2].header->error_code, 3);
+  EXPECT_EQ(records[2].header->num_joints, 0u);
+
+  // the headers are read in place
+  for (const auto& record : records)
+  {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(record.header) % alignof(RLLJobLogRecordHeader), 0u);
+  }
+
+  std::remove(file_name.c_str());
+}
+
+TEST(JobRecorderTest, testTruncatedLog)
+{
+  std::string file_name = tempFileName();
+  RLLJobRecorder recorder;
+  ASSERT_TRUE(recorder.open(file_name));
+  recorder.recordServiceCall(moveLinRequest(0.1), rll_msgs::MoveLin::Response(), ros::WallTime::now(),
+                             ros::WallDuration(), 0, {});
+  recorder.recordServiceCall(moveLinRequest(0.2), rll_msgs::MoveLin::Response(), ros::WallTime::now(),
+                             ros::WallDuration(), 0, {});
+  recorder.close();
+
+  // e.g. the interface crashed during the second write
+  FILE* file = std::fopen(file_name.c_str(), "r+b");
+  ASSERT_NE(file, nullptr);
+  std::fseek(file, 0, SEEK_END);
+  ASSERT_EQ(ftruncate(fileno(file), std::ftell(file) - 8), 0);
+  std::fclose(file);
+
+  RLLJobLogReader reader;
+  ASSERT_TRUE(reader.open(file_name));
+  ASSERT_EQ(reader.records().size(), 1u);
+  rll_msgs::MoveLin::Request read_req;
+  ASSERT_TRUE(RLLJobLogReader::deserializeRequest(reader.records()[0], &read_req));
+  EXPECT_EQ(read_req.pose.position.x, 0.1);
+
+  std::remove(file_name.c_str());
+}
+
+TEST(JobRecorderTest, testForeignFile)
+{
+  std::string file_name = tempFileName();
+  FILE* file = std::fopen(file_name.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  std::fputs("this is not a job log", file);
+  std::fclose(file);
+
+  RLLJobLogReader reader;
+  EXPECT_FALSE(reader.open(file_name));
+  EXPECT_TRUE(reader.records().empty());
+  EXPECT_FALSE(reader.open("/nonexistent/job.rlljob"));
+
+  std::remove(file_name.c_str());
+}
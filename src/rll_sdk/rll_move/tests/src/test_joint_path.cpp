@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include <rll_move/joint_path.h>
+
+namespace
+{
+double sumOfDistances(const double* lhs, const double* rhs)
+{
+  return std::fabs(lhs[0] - rhs[0]) + std::fabs(lhs[1] - rhs[1]);
+}
+
+RLLJointPath linearPath(size_t num_waypoints)
+{
+  RLLJointPath path(2);
+  for (size_t i = 0; i < num_waypoints; ++i)
+  {
+    path.push_back({ 0.01 * i, -0.01 * i });
+  }
+  return path;
+}
+}  // namespace
+
+TEST(JointPathTest, testWaypoints)
+{
+  RLLJointPath path(3);
+  EXPECT_TRUE(path.empty());
+  path.push_back({ 1.0, 2.0, 3.0 });
+  path.push_back({ 4.0, 5.0, 6.0 });
+
+  ASSERT_EQ(path.size(), 2u);
+  EXPECT_EQ(path.numJoints(), 3u);
+  EXPECT_EQ(path[0][2], 3.0);
+  EXPECT_EQ(path.back()[0], 4.0);
+
+  path.clear(2);
+  EXPECT_TRUE(path.empty());
+  EXPECT_EQ(path.numJoints(), 2u);
+}
+
+TEST(JointPathTest, testNoJump)
+{
+  RLLJointPath path = linearPath(20);
+  EXPECT_EQ(path.testRelativeJointSpaceJump(sumOfDistances, 4.5), 1.0);
+  EXPECT_EQ(path.size(), 20u);
+}
+
+TEST(JointPathTest, testJump)
+{
+  RLLJointPath path = linearPath(20);
+  path.push_back({ 1.0, 1.0 });
+  for (size_t i = 0; i < 9; ++i)
+  {
+    path.push_back({ 1.0 + 0.01 * i, 1.0 });
+  }
+
+  // the jump is the 20th step, the path is truncated right before it
+  EXPECT_DOUBLE_EQ(path.testRelativeJointSpaceJump(sumOfDistances, 4.5), 20.0 / 30.0);
+  ASSERT_EQ(path.size(), 20u);
+  EXPECT_DOUBLE_EQ(path.back()[0], 0.19);
+}
+
+TEST(JointPathTest, testTooShortForJumpTest)
+{
+  RLLJointPath path = linearPath(RLLJointPath::MIN_STEPS_FOR_JUMP_THRESH - 2);
+  path.push_back({ 5.0, 5.0 });
+  EXPECT_EQ(path.testRelativeJointSpaceJump(sumOfDistances, 4.5), 1.0);
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include <rll_move/joint_state_monitor.h>
+
+namespace
+{
+sensor_msgs::JointState jointState(double joint_1, double joint_2)
+{
+  sensor_msgs::JointState msg;
+  msg.name = { "joint_1", "joint_2" };
+  msg.position = { joint_1, joint_2 };
+  return msg;
+}
+}  // namespace
+
+TEST(JointStateMonitorTest, testPositions)
+{
+  RLLJointStateMonitor monitor;
+  std::vector<double> positions;
+  EXPECT_FALSE(monitor.positions({ "joint_1" }, &positions));
+
+  monitor.update(jointState(0.1, 0.2));
+  ASSERT_TRUE(monitor.positions({ "joint_2", "joint_1" }, &positions));
+  EXPECT_EQ(positions, std::vector<double>({ 0.2, 0.1 }));
+  EXPECT_FALSE(monitor.positions({ "joint_1", "joint_3" }, &positions));
+}
+
+TEST(JointStateMonitorTest, testGoalAlreadyReached)
+{
+  RLLJointStateMonitor monitor;
+  monitor.update(jointState(1.0, -1.0));
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(monitor.waitForGoal({ "joint_1", "joint_2" }, { 1.005, -1.0 }, 0.01, std::chrono::seconds(2)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+}
+
+TEST(JointStateMonitorTest, testWakeUpOnGoal)
+{
+  RLLJointStateMonitor monitor;
+  monitor.update(jointState(0.0, 0.0));
+
+  std::thread publisher([&monitor] {
+    for (int i = 1; i <= 10; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      monitor.update(jointState(0.1 * i, 0.0));
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(monitor.waitForGoal({ "joint_1", "joint_2" }, { 1.0, 0.0 }, 0.01, std::chrono::seconds(2)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  publisher.join();
+}
+
+TEST(JointStateMonitorTest, testTimeout)
+{
+  RLLJointStateMonitor monitor;
+  monitor.update(jointState(0.0, 0.0));
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(monitor.waitForGoal({ "joint_1", "joint_2" }, { 1.0, 0.0 }, 0.01, std::chrono::milliseconds(50)));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+
+  // joints without joint states never reach the goal
+  EXPECT_FALSE(monitor.waitForGoal({ "joint_3" }, { 0.0 }, 0.01, std::chrono::milliseconds(10),
+                                   std::chrono::milliseconds(1)));
+}
+
+TEST(JointStateMonitorTest, testRosTime)
+{
+  RLLJointStateMonitor monitor;
+  monitor.useRosTime(true);
+  monitor.update(jointState(0.0, 0.0));
+
+  std::thread publisher([&monitor] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    monitor.update(jointState(1.0, 0.0));
+  });
+
+  EXPECT_TRUE(monitor.waitForGoal({ "joint_1", "joint_2" }, { 1.0, 0.0 }, 0.01, std::chrono::seconds(2)));
+  publisher.join();
+
+  // times out without joint state updates
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(monitor.waitForGoal({ "joint_1" }, { 0.0 }, 0.01, std::chrono::milliseconds(50)));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(40));
+}
+
+TEST(JointStateMonitorTest, testSettleBeforeGoal)
+{
+  RLLJointStateMonitor monitor;
+  monitor.update(jointState(0.0, 0.0));
+
+  // e.g. gripper fingers that are blocked by an object
+  std::thread publisher([&monitor] {
+    for (int i = 1; i <= 20; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      monitor.update(jointState(std::min(0.01 * i, 0.05), 0.0));
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(monitor.waitForGoal({ "joint_1" }, { 0.1 }, 0.001, std::chrono::seconds(2),
+                                  std::chrono::milliseconds(30)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+  std::vector<double> positions;
+  ASSERT_TRUE(monitor.positions({ "joint_1" }, &positions));
+  EXPECT_NEAR(positions[0], 0.05, 1E-09);
+  publisher.join();
+}
+
+TEST(JointStateMonitorTest, testTrackedPositions)
+{
+  RLLJointStateMonitor monitor;
+  ASSERT_TRUE(monitor.trackJoints({ "joint_2", "joint_1" }));
+  EXPECT_FALSE(monitor.trackJoints(std::vector<std::string>(RLLJointStateMonitor::MAX_TRACKED_JOINTS + 1, "joint")));
+
+  std::vector<double> positions;
+  EXPECT_FALSE(monitor.trackedPositions(&positions));
+
+  sensor_msgs::JointState partial;
+  partial.name = { "joint_1" };
+  partial.position = { 0.1 };
+  monitor.update(partial);
+  EXPECT_FALSE(monitor.trackedPositions(&positions));
+
+  monitor.update(jointState(0.3, 0.4));
+  ASSERT_TRUE(monitor.trackedPositions(&positions));
+  EXPECT_EQ(positions, std::vector<double>({ 0.4, 0.3 }));
+}
+
+TEST(JointStateMonitorTest, testConcurrentTrackedPositions)
+{
+  std::vector<std::string> names;
+  for (size_t i = 0; i < RLLJointStateMonitor::MAX_TRACKED_JOINTS; ++i)
+  {
+    names.push_back("joint_" + std::to_string(i));
+  }
+
+  RLLJointStateMonitor monitor;
+  ASSERT_TRUE(monitor.trackJoints(names));
+
+  // all joints of one update share the same position, a torn read would mix two updates
+  const int num_updates = 20000;
+  sensor_msgs::JointState msg;
+  msg.name = names;
+  msg.position.assign(names.size(), 0.0);
+  monitor.update(msg);
+
+  std::thread publisher([&] {
+    for (int i = 1; i <= num_updates; ++i)
+    {
+      msg.position.assign(names.size(), i);
+      monitor.update(msg);
+    }
+  });
+
+  size_t torn_reads = 0;
+  std::vector<double> positions;
+  double last = 0.0;
+  while (last < num_updates)
+  {
+    ASSERT_TRUE(monitor.trackedPositions(&positions));
+    for (double position : positions)
+    {
+      torn_reads += position != positions[0] ? 1 : 0;
+    }
+    EXPECT_GE(positions[0], last);
+    last = positions[0];
+  }
+  publisher.join();
+
+  EXPECT_EQ(torn_reads, 0u);
+}
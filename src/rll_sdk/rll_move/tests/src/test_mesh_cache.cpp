@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <rll_move/mesh_cache.h>
+
+namespace
+{
+const char* MESH_RESOURCE = "package://rll_move/tests/meshes/bone.dae";
+}  // namespace
+
+TEST(MeshCacheTest, testSharedMesh)
+{
+  RLLMeshCache& cache = RLLMeshCache::instance();
+  RLLMeshCache::MeshPtr mesh = cache.get(MESH_RESOURCE, 0.01);
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_FALSE(mesh->msg.triangles.empty());
+  ASSERT_NE(mesh->bvh, nullptr);
+  EXPECT_EQ(static_cast<size_t>(mesh->bvh->num_tris), mesh->msg.triangles.size());
+  EXPECT_EQ(static_cast<size_t>(mesh->bvh->num_vertices), mesh->msg.vertices.size());
+
+  EXPECT_EQ(cache.get(MESH_RESOURCE, 0.01), mesh);
+
+  RLLMeshCache::MeshPtr scaled = cache.get(MESH_RESOURCE, 0.02);
+  ASSERT_NE(scaled, nullptr);
+  EXPECT_NE(scaled, mesh);
+  EXPECT_NEAR(scaled->msg.vertices[0].x, 2 * mesh->msg.vertices[0].x, 1E-09);
+}
+
+TEST(MeshCacheTest, testMissingResource)
+{
+  RLLMeshCache& cache = RLLMeshCache::instance();
+  size_t size = cache.size();
+  EXPECT_EQ(cache.get("package://rll_move/tests/meshes/missing.stl", 0.01), nullptr);
+  EXPECT_EQ(cache.size(), size);
+}
+
+TEST(MeshCacheTest, testPrune)
+{
+  RLLMeshCache& cache = RLLMeshCache::instance();
+  RLLMeshCache::MeshPtr mesh = cache.get(MESH_RESOURCE, 0.03);
+  ASSERT_NE(mesh, nullptr);
+  cache.get(MESH_RESOURCE, 0.04);
+
+  cache.prune();
+  EXPECT_EQ(cache.size(), 1u);
+  EXPECT_EQ(cache.get(MESH_RESOURCE, 0.03), mesh);
+
+  mesh.reset();
+  cache.prune();
+  EXPECT_EQ(cache.size(), 0u);
+}
@@ -169,6 +169,39 @@ TEST(PermissionsTest, testIsPermissionRequired)
   EXPECT_TRUE(p.isPermissionRequiredFor("test", p2));
 }
 
+TEST(PermissionsTest, testRegisteredService)
+{
+  Permissions p;
+  auto p1 = p.registerPermission("p1", true);
+  auto p2 = p.registerPermission("p2", false);
+
+  auto test_srv = p.registerService("test");
+  EXPECT_EQ(p.registerService("test"), test_srv);
+  auto other_srv = p.registerService("other");
+  EXPECT_NE(other_srv, test_srv);
+  EXPECT_EQ(p.getServiceName(other_srv), "other");
+
+  // nothing is permitted before the requirements are set
+  EXPECT_FALSE(p.areAllRequiredPermissionsSetFor(test_srv));
+
+  // requirements set after the registration apply to the service id as well
+  p.setRequiredPermissionsFor("test", p1);
+  EXPECT_EQ(p.getRequiredPermissionsFor(test_srv), p1);
+  EXPECT_TRUE(p.areAllRequiredPermissionsSetFor(test_srv));
+  EXPECT_TRUE(p.isPermissionRequiredFor(test_srv, p1));
+  EXPECT_FALSE(p.isPermissionRequiredFor(test_srv, p2));
+
+  p.setDefaultRequiredPermissions(p2);
+  p.setRequiredPermissionsFor("test", p1, true);
+  EXPECT_EQ(p.getRequiredPermissionsFor(test_srv), p1 | p2);
+  EXPECT_EQ(p.getRequiredPermissionsFor(other_srv), p2);
+  EXPECT_FALSE(p.areAllRequiredPermissionsSetFor(test_srv));
+
+  p.updateCurrentPermissions(p2, true);
+  EXPECT_TRUE(p.areAllRequiredPermissionsSetFor(test_srv));
+  EXPECT_EQ(p.areAllRequiredPermissionsSetFor(other_srv), p.areAllRequiredPermissionsSetFor("other"));
+}
+
 TEST(PermissionsTest, testClearPermissions)
 {
   Permissions p;
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include <rll_move/phase_timers.h>
+
+TEST(PhaseTimersTest, testRecordTotals)
+{
+  RLLPhaseTimers timers;
+  EXPECT_EQ(timers.numSamples(RLLTimedPhase::PATH_IK), 0u);
+  EXPECT_EQ(timers.percentileNanoseconds(RLLTimedPhase::PATH_IK, 50), 0u);
+
+  timers.record(RLLTimedPhase::PATH_IK, std::chrono::microseconds(3));
+  timers.record(RLLTimedPhase::PATH_IK, std::chrono::microseconds(1));
+  timers.record(RLLTimedPhase::EXECUTION, std::chrono::milliseconds(2));
+
+  EXPECT_EQ(timers.numSamples(RLLTimedPhase::PATH_IK), 2u);
+  EXPECT_EQ(timers.totalNanoseconds(RLLTimedPhase::PATH_IK), 4000u);
+  EXPECT_EQ(timers.maxNanoseconds(RLLTimedPhase::PATH_IK), 3000u);
+  EXPECT_EQ(timers.numSamples(RLLTimedPhase::EXECUTION), 1u);
+  EXPECT_EQ(timers.numSamples(RLLTimedPhase::PTP_PLANNING), 0u);
+}
+
+TEST(PhaseTimersTest, testPercentiles)
+{
+  RLLPhaseTimers timers;
+  for (int i = 1; i <= 100; ++i)
+  {
+    timers.record(RLLTimedPhase::LINEAR_PATH, std::chrono::nanoseconds(i));
+    // samples of other phases must not affect the percentiles
+    timers.record(RLLTimedPhase::EXECUTION, std::chrono::seconds(1));
+  }
+
+  EXPECT_EQ(timers.percentileNanoseconds(RLLTimedPhase::LINEAR_PATH, 0), 1u);
+  EXPECT_EQ(timers.percentileNanoseconds(RLLTimedPhase::LINEAR_PATH, 50), 51u);
+  EXPECT_EQ(timers.percentileNanoseconds(RLLTimedPhase::LINEAR_PATH, 100), 100u);
+}
+
+TEST(PhaseTimersTest, testRingBufferWrapAround)
+{
+  RLLPhaseTimers timers;
+  size_t num_samples = 2 * RLLPhaseTimers::RING_BUFFER_SIZE;
+  for (size_t i = 0; i < num_samples; ++i)
+  {
+    timers.record(RLLTimedPhase::PATH_VALIDITY_CHECK, std::chrono::nanoseconds(i));
+  }
+
+  // the totals are exact, the percentiles only cover the most recent samples
+  EXPECT_EQ(timers.numSamples(RLLTimedPhase::PATH_VALIDITY_CHECK), num_samples);
+  EXPECT_EQ(timers.maxNanoseconds(RLLTimedPhase::PATH_VALIDITY_CHECK), num_samples - 1);
+  EXPECT_EQ(timers.percentileNanoseconds(RLLTimedPhase::PATH_VALIDITY_CHECK, 0), RLLPhaseTimers::RING_BUFFER_SIZE);
+}
+
+TEST(PhaseTimersTest, testConcurrentRecording)
+{
+  RLLPhaseTimers timers;
+  const size_t num_threads = 4, samples_per_thread = 10000;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t)
+  {
+    threads.emplace_back([&timers, samples_per_thread]() {
+      for (size_t i = 0; i < samples_per_thread; ++i)
+      {
+        RLLPhaseTimers::ScopedTimer timer(&timers, RLLTimedPhase::TRAJECTORY_MODIFICATION);
+        timers.count(RLLPhaseCounter::IK_WAYPOINTS);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  EXPECT_EQ(timers.numSamples(RLLTimedPhase::TRAJECTORY_MODIFICATION), num_threads * samples_per_thread);
+  EXPECT_EQ(timers.counter(RLLPhaseCounter::IK_WAYPOINTS), num_threads * samples_per_thread);
+}
+
+TEST(PhaseTimersTest, testSummaryAndReset)
+{
+  RLLPhaseTimers timers;
+  timers.record(RLLTimedPhase::PTP_PLANNING, std::chrono::milliseconds(5));
+  timers.count(RLLPhaseCounter::EXECUTED_WAYPOINTS, 42);
+
+  std::string summary = timers.summary();
+  EXPECT_NE(summary.find("ptp_planning"), std::string::npos);
+  EXPECT_EQ(summary.find("path_ik"), std::string::npos);
+  EXPECT_NE(summary.find("executed_waypoints"), std::string::npos);
+
+  timers.reset();
+  EXPECT_EQ(timers.numSamples(RLLTimedPhase::PTP_PLANNING), 0u);
+  EXPECT_EQ(timers.counter(RLLPhaseCounter::EXECUTED_WAYPOINTS), 0u);
+  EXPECT_EQ(timers.percentileNanoseconds(RLLTimedPhase::PTP_PLANNING, 50), 0u);
+}
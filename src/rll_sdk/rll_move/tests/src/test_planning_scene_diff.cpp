@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <rll_move/planning_scene_diff.h>
+
+namespace
+{
+moveit_msgs::CollisionObject box(const std::string& id, double x, double side = 0.1)
+{
+  moveit_msgs::CollisionObject object;
+  object.id = id;
+  object.header.frame_id = "world";
+  shape_msgs::SolidPrimitive primitive;
+  primitive.type = shape_msgs::SolidPrimitive::BOX;
+  primitive.dimensions = { side, side, side };
+  object.primitives.push_back(primitive);
+  geometry_msgs::Pose pose;
+  pose.position.x = x;
+  pose.orientation.w = 1;
+  object.primitive_poses.push_back(pose);
+  return object;
+}
+}  // namespace
+
+TEST(PlanningSceneDiffTest, testAddThenMove)
+{
+  RLLPlanningSceneDiff diff;
+  EXPECT_TRUE(diff.empty());
+
+  diff.addOrMove(box("box1", 0.1));
+  diff.addOrMove(box("box2", 0.2));
+  EXPECT_TRUE(diff.isKnown("box1"));
+
+  moveit_msgs::PlanningScene scene = diff.take();
+  EXPECT_TRUE(diff.empty());
+  EXPECT_TRUE(scene.is_diff);
+  ASSERT_EQ(scene.world.collision_objects.size(), 2u);
+  EXPECT_EQ(scene.world.collision_objects[0].operation, moveit_msgs::CollisionObject::ADD);
+  EXPECT_EQ(scene.world.collision_objects[0].primitives.size(), 1u);
+
+  // unchanged geometry is only moved, changed geometry is sent again
+  diff.addOrMove(box("box1", 0.3));
+  diff.addOrMove(box("box2", 0.2, 0.2));
+  scene = diff.take();
+  ASSERT_EQ(scene.world.collision_objects.size(), 2u);
+  const auto& move = scene.world.collision_objects[0];
+  EXPECT_EQ(move.operation, moveit_msgs::CollisionObject::MOVE);
+  EXPECT_TRUE(move.primitives.empty());
+  ASSERT_EQ(move.primitive_poses.size(), 1u);
+  EXPECT_EQ(move.primitive_poses[0].position.x, 0.3);
+  EXPECT_EQ(scene.world.collision_objects[1].operation, moveit_msgs::CollisionObject::ADD);
+  EXPECT_EQ(scene.world.collision_objects[1].primitives.size(), 1u);
+}
+
+TEST(PlanningSceneDiffTest, testRemoveAndReset)
+{
+  RLLPlanningSceneDiff diff;
+  diff.addOrMove(box("box1", 0.1));
+  diff.addOrMove(box("box2", 0.2));
+  diff.take();
+
+  diff.remove("box1");
+  EXPECT_FALSE(diff.isKnown("box1"));
+  moveit_msgs::PlanningScene scene = diff.take();
+  ASSERT_EQ(scene.world.collision_objects.size(), 1u);
+  EXPECT_EQ(scene.world.collision_objects[0].operation, moveit_msgs::CollisionObject::REMOVE);
+
+  diff.addOrMove(box("box2", 0.2));
+  diff.reset();
+  EXPECT_TRUE(diff.empty());
+  diff.addOrMove(box("box2", 0.2));
+  scene = diff.take();
+  ASSERT_EQ(scene.world.collision_objects.size(), 1u);
+  EXPECT_EQ(scene.world.collision_objects[0].operation, moveit_msgs::CollisionObject::ADD);
+}
+
+TEST(PlanningSceneDiffTest, testAttachDetach)
+{
+  RLLPlanningSceneDiff diff;
+  diff.addOrMove(box("box1", 0.1));
+  diff.take();
+
+  // known objects are attached without their shapes
+  diff.attach(box("box1", 0.1), "eef", { "finger" });
+  moveit_msgs::PlanningScene scene = diff.take();
+  EXPECT_TRUE(scene.robot_state.is_diff);
+  EXPECT_TRUE(scene.world.collision_objects.empty());
+  ASSERT_EQ(scene.robot_state.attached_collision_objects.size(), 1u);
+  const auto& attached = scene.robot_state.attached_collision_objects[0];
+  EXPECT_EQ(attached.link_name, "eef");
+  EXPECT_EQ(attached.touch_links, std::vector<std::string>({ "finger" }));
+  EXPECT_EQ(attached.object.operation, moveit_msgs::CollisionObject::ADD);
+  EXPECT_TRUE(attached.object.primitives.empty());
+  EXPECT_FALSE(diff.isKnown("box1"));
+
+  // the detached object is in the world again and can be moved
+  diff.detach("box1", "eef");
+  EXPECT_TRUE(diff.isKnown("box1"));
+  diff.addOrMove(box("box1", 0.5));
+  scene = diff.take();
+  ASSERT_EQ(scene.robot_state.attached_collision_objects.size(), 1u);
+  EXPECT_EQ(scene.robot_state.attached_collision_objects[0].object.operation,
+            moveit_msgs::CollisionObject::REMOVE);
+  ASSERT_EQ(scene.world.collision_objects.size(), 1u);
+  EXPECT_EQ(scene.world.collision_objects[0].operation, moveit_msgs::CollisionObject::MOVE);
+
+  // unknown objects are removed from the world and attached with their shapes
+  diff.attach(box("box3", 0.1), "eef", {});
+  scene = diff.take();
+  ASSERT_EQ(scene.world.collision_objects.size(), 1u);
+  EXPECT_EQ(scene.world.collision_objects[0].operation, moveit_msgs::CollisionObject::REMOVE);
+  ASSERT_EQ(scene.robot_state.attached_collision_objects.size(), 1u);
+  EXPECT_EQ(scene.robot_state.attached_collision_objects[0].object.primitives.size(), 1u);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include <rll_move/service_metrics.h>
+
+TEST(ServiceMetricsTest, testServiceCalls)
+{
+  RLLServiceMetrics metrics;
+  RLLServiceMetrics::Service* move_lin = metrics.service("move_lin");
+  EXPECT_EQ(metrics.service("move_lin"), move_lin);
+  EXPECT_EQ(move_lin->calls(), 0u);
+
+  move_lin->begin();
+  move_lin->begin();
+  EXPECT_EQ(move_lin->inFlight(), 2);
+  EXPECT_EQ(metrics.inFlight(), 2);
+
+  move_lin->end(0, std::chrono::milliseconds(3));
+  move_lin->end(65, std::chrono::seconds(120));
+  metrics.service("move_ptp")->begin();
+
+  EXPECT_EQ(move_lin->inFlight(), 0);
+  EXPECT_EQ(metrics.inFlight(), 1);
+  EXPECT_EQ(move_lin->calls(), 2u);
+  EXPECT_EQ(move_lin->errorCodeCount(0), 1u);
+  EXPECT_EQ(move_lin->errorCodeCount(65), 1u);
+  EXPECT_EQ(move_lin->latency().totalNanoseconds(), 120003000000u);
+
+  // 3 ms fall into the 5 ms bucket, 120 s are beyond the last bound and only counted
+  uint64_t bucket_samples = 0;
+  for (size_t i = 0; i < RLLServiceMetrics::NUM_LATENCY_BUCKETS; ++i)
+  {
+    bucket_samples += move_lin->latency().bucket(i);
+  }
+  EXPECT_EQ(bucket_samples, 1u);
+  EXPECT_EQ(move_lin->latency().bucket(2), 1u);
+}
+
+TEST(ServiceMetricsTest, testIKAndJobs)
+{
+  RLLServiceMetrics metrics;
+  metrics.countIK(true);
+  metrics.countIK(false);
+  metrics.countIK(true);
+  EXPECT_EQ(metrics.ikRequests(), 3u);
+  EXPECT_EQ(metrics.ikFailures(), 1u);
+
+  metrics.recordJob(0, std::chrono::seconds(30));
+  // unknown statuses still count the duration
+  metrics.recordJob(7, std::chrono::seconds(10));
+
+  std::string text = metrics.prometheusText(RLLPhaseTimers());
+  EXPECT_NE(text.find("rll_jobs_total{status=\"0\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("rll_jobs_total{status=\"1\"} 0\n"), std::string::npos);
+  EXPECT_NE(text.find("rll_job_duration_seconds_count{} 2\n"), std::string::npos);
+  EXPECT_NE(text.find("rll_ik_requests_total 3\n"), std::string::npos);
+  EXPECT_NE(text.find("rll_ik_failures_total 1\n"), std::string::npos);
+}
+
+TEST(ServiceMetricsTest, testPrometheusText)
+{
+  RLLServiceMetrics metrics;
+  RLLServiceMetrics::Service* check_path = metrics.service("check_path");
+  check_path->begin();
+  check_path->end(0, std::chrono::microseconds(800));
+  check_path->begin();
+  check_path->end(0, std::chrono::milliseconds(20));
+
+  RLLPhaseTimers phase_timers;
+  phase_timers.record(RLLTimedPhase::PATH_IK, std::chrono::milliseconds(2));
+
+  std::string text = metrics.prometheusText(phase_timers);
+  EXPECT_NE(text.find("rll_service_calls_total{service=\"check_path\",error_code=\"0\"} 2\n"), std::string::npos);
+  EXPECT_NE(text.find("rll_service_calls_in_flight{service=\"check_path\"} 0\n"), std::string::npos);
+  // the buckets are cumulative
+  EXPECT_NE(text.find("rll_service_latency_seconds_bucket{service=\"check_path\",le=\"0.001\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("rll_service_latency_seconds_bucket{service=\"check_path\",le=\"0.025\"} 2\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("rll_service_latency_seconds_bucket{service=\"check_path\",le=\"+Inf\"} 2\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("rll_service_latency_seconds_count{service=\"check_path\"} 2\n"), std::string::npos);
+  EXPECT_NE(text.find("rll_phase_seconds_count{phase=\"path_ik\"} 1\n"), std::string::npos);
+
+  auto values = metrics.summaryValues();
+  ASSERT_EQ(values.size(), 3u);
+  EXPECT_EQ(values[0].first, "check_path");
+  EXPECT_EQ(values[2].first, "ik");
+}
+
+TEST(ServiceMetricsTest, testConcurrentRecording)
+{
+  RLLServiceMetrics metrics;
+  const int num_threads = 4;
+  const int calls_per_thread = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t)
+  {
+    threads.emplace_back([&metrics, t]() {
+      for (int i = 0; i < calls_per_thread; ++i)
+      {
+        RLLServiceMetrics::Service* service = metrics.service(t % 2 == 0 ? "check_path" : "move_lin");
+        service->begin();
+        service->end(0, std::chrono::microseconds(i));
+        metrics.countIK(i % 2 == 0);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  EXPECT_EQ(metrics.service("check_path")->calls(), 2u * calls_per_thread);
+  EXPECT_EQ(metrics.service("move_lin")->calls(), 2u * calls_per_thread);
+  EXPECT_EQ(metrics.inFlight(), 0);
+  EXPECT_EQ(metrics.ikRequests(), static_cast<uint64_t>(num_threads * calls_per_thread));
+  EXPECT_EQ(metrics.ikFailures(), static_cast<uint64_t>(num_threads * calls_per_thread / 2));
+}
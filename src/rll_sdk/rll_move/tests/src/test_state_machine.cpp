@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <ros/ros.h>
+#include <thread>
 
 #include <rll_move/move_iface_state_machine.h>
 
@@ -131,3 +132,62 @@ TEST(PermissionsTest, testFullDemoRun)
   success = s.leaveState();
   ASSERT_TRUE(success);
 }
+
+TEST(PermissionsTest, testWaitForServiceCallsToEnd)
+{
+  RLLMoveIfaceStateMachine s;
+  s.enterState(RLLMoveIfaceState::RUNNING_JOB);
+  ASSERT_TRUE(s.waitForServiceCallsToEnd(std::chrono::milliseconds(0)));
+
+  s.beginServiceCall("test", true);
+  ASSERT_FALSE(s.waitForServiceCallsToEnd(std::chrono::milliseconds(10)));
+
+  std::thread service_call([&s] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    s.endServiceCall("test", true);
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(s.waitForServiceCallsToEnd(std::chrono::seconds(2)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  service_call.join();
+}
+
+TEST(PermissionsTest, testInternalErrorCallback)
+{
+  RLLMoveIfaceStateMachine s;
+  int num_calls = 0;
+  s.setInternalErrorCallback([&num_calls] { ++num_calls; });
+
+  s.enterState(RLLMoveIfaceState::RUNNING_JOB);
+  ASSERT_EQ(num_calls, 0);
+
+  // only invoked once, when the INTERNAL_ERROR state is entered
+  s.enterState(RLLMoveIfaceState::IDLING);
+  ASSERT_EQ(num_calls, 1);
+  s.enterErrorState();
+  ASSERT_EQ(num_calls, 1);
+}
+
+TEST(PermissionsTest, testQueryDuringServiceCall)
+{
+  RLLMoveIfaceStateMachine s;
+  ASSERT_EQ(s.checkQueryAllowed("query", true).value(), RLLErrorCode::SERVICE_CALL_NOT_ALLOWED);
+  ASSERT_EQ(s.checkQueryAllowed("query", false).value(), RLLErrorCode::SUCCESS);
+
+  s.enterState(RLLMoveIfaceState::RUNNING_JOB);
+  auto resp = s.beginServiceCall("move", true);
+  ASSERT_EQ(resp.value(), RLLErrorCode::SUCCESS);
+
+  // queries neither conflict with the service call in execution nor with each other
+  ASSERT_EQ(s.checkQueryAllowed("query", true).value(), RLLErrorCode::SUCCESS);
+  ASSERT_EQ(s.checkQueryAllowed("query", true).value(), RLLErrorCode::SUCCESS);
+  ASSERT_TRUE(s.isServiceCallInExecution());
+
+  resp = s.endServiceCall("move", true);
+  ASSERT_EQ(resp.value(), RLLErrorCode::SUCCESS);
+  ASSERT_TRUE(s.leaveState());
+
+  s.enterErrorState();
+  ASSERT_EQ(s.checkQueryAllowed("query", false).value(), RLLErrorCode::INTERNAL_ERROR);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <rll_move/time_parameterization_cache.h>
+
+namespace
+{
+moveit_msgs::RobotTrajectory path(double start, double goal, size_t num_points = 5)
+{
+  moveit_msgs::RobotTrajectory path;
+  path.joint_trajectory.joint_names = { "joint_1", "joint_2" };
+  for (size_t i = 0; i < num_points; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint point;
+    double position = start + (goal - start) * i / (num_points - 1);
+    point.positions = { position, -position };
+    path.joint_trajectory.points.push_back(point);
+  }
+  return path;
+}
+
+moveit_msgs::RobotTrajectory timed(const moveit_msgs::RobotTrajectory& path, double duration)
+{
+  moveit_msgs::RobotTrajectory timed = path;
+  auto& points = timed.joint_trajectory.points;
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    points[i].time_from_start = ros::Duration(duration * i / (points.size() - 1));
+  }
+  return timed;
+}
+}  // namespace
+
+TEST(TimeParameterizationCacheTest, testLookup)
+{
+  RLLTimeParameterizationCache cache;
+  moveit_msgs::RobotTrajectory cached;
+  EXPECT_FALSE(cache.lookup(path(0.0, 1.0), 0.5, 0.5, &cached));
+
+  cache.insert(path(0.0, 1.0), 0.5, 0.5, timed(path(0.0, 1.0), 2.0));
+  ASSERT_TRUE(cache.lookup(path(0.0, 1.0), 0.5, 0.5, &cached));
+  EXPECT_EQ(cached.joint_trajectory.points.back().time_from_start, ros::Duration(2.0));
+
+  // the path and the scaling factors have to match exactly
+  EXPECT_FALSE(cache.lookup(path(0.0, 1.0 + 1E-12), 0.5, 0.5, &cached));
+  EXPECT_FALSE(cache.lookup(path(0.0, 1.0, 6), 0.5, 0.5, &cached));
+  EXPECT_FALSE(cache.lookup(path(0.0, 1.0), 1.0, 0.5, &cached));
+  EXPECT_FALSE(cache.lookup(path(0.0, 1.0), 0.5, 1.0, &cached));
+
+  moveit_msgs::RobotTrajectory renamed = path(0.0, 1.0);
+  renamed.joint_trajectory.joint_names[1] = "joint_3";
+  EXPECT_FALSE(cache.lookup(renamed, 0.5, 0.5, &cached));
+
+  // a new result for the same path replaces the old one
+  cache.insert(path(0.0, 1.0), 0.5, 0.5, timed(path(0.0, 1.0), 3.0));
+  EXPECT_EQ(cache.size(), 1u);
+  ASSERT_TRUE(cache.lookup(path(0.0, 1.0), 0.5, 0.5, &cached));
+  EXPECT_EQ(cached.joint_trajectory.points.back().time_from_start, ros::Duration(3.0));
+}
+
+TEST(TimeParameterizationCacheTest, testHash)
+{
+  uint64_t hash = RLLTimeParameterizationCache::hash(path(0.0, 1.0), 0.5, 0.5);
+  EXPECT_EQ(RLLTimeParameterizationCache::hash(path(0.0, 1.0), 0.5, 0.5), hash);
+  EXPECT_NE(RLLTimeParameterizationCache::hash(path(0.0, 1.0), 0.5, 0.6), hash);
+  EXPECT_NE(RLLTimeParameterizationCache::hash(path(1.0, 0.0), 0.5, 0.5), hash);
+}
+
+TEST(TimeParameterizationCacheTest, testEviction)
+{
+  RLLTimeParameterizationCache cache;
+  for (size_t i = 0; i <= RLLTimeParameterizationCache::MAX_ENTRIES; ++i)
+  {
+    cache.insert(path(0.0, i + 1.0), 1.0, 1.0, timed(path(0.0, i + 1.0), 1.0));
+  }
+  EXPECT_EQ(cache.size(), RLLTimeParameterizationCache::MAX_ENTRIES);
+
+  moveit_msgs::RobotTrajectory cached;
+  EXPECT_FALSE(cache.lookup(path(0.0, 1.0), 1.0, 1.0, &cached));
+  EXPECT_TRUE(cache.lookup(path(0.0, 2.0), 1.0, 1.0, &cached));
+
+  cache.insert(moveit_msgs::RobotTrajectory(), 1.0, 1.0, moveit_msgs::RobotTrajectory());
+  EXPECT_EQ(cache.size(), RLLTimeParameterizationCache::MAX_ENTRIES);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <rll_move/trajectory_cache.h>
+
+namespace
+{
+moveit_msgs::RobotTrajectory trajectory(double start, double goal, size_t num_points = 5)
+{
+  moveit_msgs::RobotTrajectory trajectory;
+  trajectory.joint_trajectory.joint_names = { "joint_1", "joint_2" };
+  for (size_t i = 0; i < num_points; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint point;
+    double position = start + (goal - start) * i / (num_points - 1);
+    point.positions = { position, -position };
+    trajectory.joint_trajectory.points.push_back(point);
+  }
+  return trajectory;
+}
+}  // namespace
+
+TEST(TrajectoryCacheTest, testLookup)
+{
+  RLLTrajectoryCache cache;
+  moveit_msgs::RobotTrajectory cached;
+  EXPECT_FALSE(cache.lookup({ 0.0, 0.0 }, { 1.0, -1.0 }, &cached));
+
+  cache.insert(trajectory(0.0, 1.0));
+  ASSERT_TRUE(cache.lookup({ 0.0005, 0.0 }, { 1.0, -0.9995 }, &cached));
+  EXPECT_EQ(cached.joint_trajectory.points.size(), 5u);
+
+  EXPECT_FALSE(cache.lookup({ 0.01, 0.0 }, { 1.0, -1.0 }, &cached));
+  EXPECT_FALSE(cache.lookup({ 0.0, 0.0 }, { 1.0, 1.0 }, &cached));
+  EXPECT_FALSE(cache.lookup({ 0.0 }, { 1.0 }, &cached));
+
+  // a new trajectory for the same transition replaces the old one
+  cache.insert(trajectory(0.0, 1.0, 7));
+  ASSERT_TRUE(cache.lookup({ 0.0, 0.0 }, { 1.0, -1.0 }, &cached));
+  EXPECT_EQ(cached.joint_trajectory.points.size(), 7u);
+  EXPECT_EQ(cache.size(), 1u);
+
+  cache.erase({ 0.0, 0.0 }, { 1.0, -1.0 });
+  EXPECT_FALSE(cache.lookup({ 0.0, 0.0 }, { 1.0, -1.0 }, &cached));
+}
+
+TEST(TrajectoryCacheTest, testOldestDropped)
+{
+  RLLTrajectoryCache cache;
+  for (size_t i = 0; i <= RLLTrajectoryCache::MAX_ENTRIES; ++i)
+  {
+    cache.insert(trajectory(0.0, 0.1 * (i + 1)));
+  }
+  EXPECT_EQ(cache.size(), RLLTrajectoryCache::MAX_ENTRIES);
+
+  moveit_msgs::RobotTrajectory cached;
+  EXPECT_FALSE(cache.lookup({ 0.0, 0.0 }, { 0.1, -0.1 }, &cached));
+  EXPECT_TRUE(cache.lookup({ 0.0, 0.0 }, { 0.2, -0.2 }, &cached));
+  double last_goal = 0.1 * (RLLTrajectoryCache::MAX_ENTRIES + 1);
+  EXPECT_TRUE(cache.lookup({ 0.0, 0.0 }, { last_goal, -last_goal }, &cached));
+}
+
+TEST(TrajectoryCacheTest, testLookupGoalPredicate)
+{
+  RLLTrajectoryCache cache;
+  cache.insert(trajectory(0.0, 1.0));
+  cache.insert(trajectory(0.0, 2.0));
+
+  moveit_msgs::RobotTrajectory cached;
+  auto beyond = [](double limit) { return [limit](const std::vector<double>& goal) { return goal[0] > limit; }; };
+  ASSERT_TRUE(cache.lookup({ 0.0, 0.0 }, beyond(1.5), &cached));
+  EXPECT_DOUBLE_EQ(cached.joint_trajectory.points.back().positions[0], 2.0);
+  EXPECT_FALSE(cache.lookup({ 0.0, 0.0 }, beyond(2.5), &cached));
+  EXPECT_FALSE(cache.lookup({ 0.5, 0.0 }, beyond(0.0), &cached));
+}
+
+TEST(TrajectoryCacheTest, testLookupKeepsRecentlyUsed)
+{
+  RLLTrajectoryCache cache;
+  moveit_msgs::RobotTrajectory cached;
+  cache.insert(trajectory(0.0, 0.1));
+  for (size_t i = 1; i <= RLLTrajectoryCache::MAX_ENTRIES; ++i)
+  {
+    // the first trajectory is replayed between the inserts of the others
+    EXPECT_TRUE(cache.lookup({ 0.0, 0.0 }, { 0.1, -0.1 }, &cached));
+    cache.insert(trajectory(0.0, 0.1 * (i + 1)));
+  }
+  EXPECT_EQ(cache.size(), RLLTrajectoryCache::MAX_ENTRIES);
+
+  EXPECT_TRUE(cache.lookup({ 0.0, 0.0 }, { 0.1, -0.1 }, &cached));
+  EXPECT_FALSE(cache.lookup({ 0.0, 0.0 }, { 0.2, -0.2 }, &cached));
+}
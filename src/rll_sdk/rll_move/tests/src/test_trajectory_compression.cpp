@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cmath>
+
+#include <rll_move/trajectory_compression.h>
+
+namespace
+{
+// samples of a smooth motion with positions, velocities and accelerations
+trajectory_msgs::JointTrajectory sineTrajectory(size_t num_points, double duration)
+{
+  trajectory_msgs::JointTrajectory trajectory;
+  trajectory.joint_names = { "joint_1", "joint_2" };
+  for (size_t i = 0; i < num_points; ++i)
+  {
+    double t = duration * i / (num_points - 1);
+    trajectory_msgs::JointTrajectoryPoint point;
+    point.positions = { std::sin(t), 0.5 * t };
+    point.velocities = { std::cos(t), 0.5 };
+    point.accelerations = { -std::sin(t), 0.0 };
+    point.time_from_start = ros::Duration(t);
+    trajectory.points.push_back(point);
+  }
+  return trajectory;
+}
+
+double maxDeviation(const trajectory_msgs::JointTrajectory& original,
+                    const trajectory_msgs::JointTrajectory& compressed)
+{
+  double max_deviation = 0.0;
+  size_t segment = 0;
+  std::vector<double> positions;
+  for (const auto& point : original.points)
+  {
+    double time = point.time_from_start.toSec();
+    while (compressed.points[segment + 1].time_from_start.toSec() < time)
+    {
+      ++segment;
+    }
+    const auto& from = compressed.points[segment];
+    const auto& to = compressed.points[segment + 1];
+    double start = from.time_from_start.toSec();
+    RLLTrajectoryCompression::interpolate(from, to, to.time_from_start.toSec() - start, time - start, &positions);
+    for (size_t j = 0; j < positions.size(); ++j)
+    {
+      max_deviation = std::max(max_deviation, std::fabs(positions[j] - point.positions[j]));
+    }
+  }
+  return max_deviation;
+}
+}  // namespace
+
+TEST(TrajectoryCompressionTest, testLinearMotion)
+{
+  trajectory_msgs::JointTrajectory trajectory;
+  for (size_t i = 0; i <= 10; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint point;
+    point.positions = { 0.1 * i };
+    point.time_from_start = ros::Duration(0.1 * i);
+    trajectory.points.push_back(point);
+  }
+
+  RLLTrajectoryCompression compression(1E-06);
+  EXPECT_EQ(compression.compress(&trajectory), 9u);
+  ASSERT_EQ(trajectory.points.size(), 2u);
+  EXPECT_NEAR(trajectory.points.back().positions[0], 1.0, 1E-12);
+}
+
+TEST(TrajectoryCompressionTest, testWithinTolerance)
+{
+  trajectory_msgs::JointTrajectory original = sineTrajectory(2001, 6.0);
+  trajectory_msgs::JointTrajectory trajectory = original;
+
+  const double tolerance = 1E-04;
+  RLLTrajectoryCompression compression(tolerance);
+  size_t num_removed = compression.compress(&trajectory);
+  EXPECT_GT(num_removed, 1900u);
+  EXPECT_EQ(trajectory.points.size() + num_removed, original.points.size());
+  EXPECT_EQ(trajectory.points.front().time_from_start, original.points.front().time_from_start);
+  EXPECT_EQ(trajectory.points.back().time_from_start, original.points.back().time_from_start);
+  EXPECT_LE(maxDeviation(original, trajectory), tolerance);
+}
+
+TEST(TrajectoryCompressionTest, testCartesianTolerance)
+{
+  trajectory_msgs::JointTrajectory trajectory = sineTrajectory(101, 6.0);
+
+  // every point is rejected by the Cartesian check
+  RLLTrajectoryCompression compression(1E-03, 1E-04, [](size_t, const std::vector<double>&) { return 1.0; });
+  EXPECT_EQ(compression.compress(&trajectory), 0u);
+  EXPECT_EQ(trajectory.points.size(), 101u);
+
+  std::vector<size_t> checked;
+  RLLTrajectoryCompression recording(1E-03, 1E-04, [&](size_t i, const std::vector<double>&) {
+    checked.push_back(i);
+    return 0.0;
+  });
+  EXPECT_GT(recording.compress(&trajectory), 0u);
+  EXPECT_FALSE(checked.empty());
+}
+
+TEST(TrajectoryCompressionTest, testMaxRemovedPoints)
+{
+  trajectory_msgs::JointTrajectory trajectory;
+  size_t num_points = 3 * RLLTrajectoryCompression::MAX_REMOVED_POINTS;
+  for (size_t i = 0; i < num_points; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint point;
+    point.positions = { 0.0 };
+    point.time_from_start = ros::Duration(0.01 * i);
+    trajectory.points.push_back(point);
+  }
+
+  RLLTrajectoryCompression compression(1E-06);
+  compression.compress(&trajectory);
+  EXPECT_EQ(trajectory.points.size(), 4u);
+}
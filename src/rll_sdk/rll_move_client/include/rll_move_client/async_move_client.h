@@ -0,0 +1,107 @@
+/*
+ * This file is part of the Robot Learning Lab Move Client
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RLL_MOVE_CLIENT_ASYNC_MOVE_CLIENT_H
+#define RLL_MOVE_CLIENT_ASYNC_MOVE_CLIENT_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <rll_move_client/move_client.h>
+
+// Runs service calls one after another on a worker thread, in the order in which they were pushed.
+class RLLServiceCallQueue
+{
+public:
+  RLLServiceCallQueue();
+  // finishes all pending calls
+  ~RLLServiceCallQueue();
+
+  std::future<bool> push(std::function<bool()> call);
+
+private:
+  void run();
+
+  std::mutex mutex_;
+  std::condition_variable pushed_;
+  std::deque<std::packaged_task<bool()>> calls_;
+  bool stop_ = false;
+  std::thread worker_;
+};
+
+// Non-blocking variants of the move client calls over persistent service connections. The futures become ready with
+// the result of the blocking call, exceptions on (critical) failures are rethrown by std::future::get().
+//
+// Motions are executed in the order in which they were requested. Queries run on their own connections and worker,
+// e.g. the current pose can be polled while a motion is still executing. Result pointers have to stay valid until the
+// future is ready.
+class RLLAsyncMoveClient : public virtual RLLMoveClientBase
+{
+public:
+  explicit RLLAsyncMoveClient() = default;
+
+  std::future<bool> moveRandomAsync(geometry_msgs::Pose* result_pose = nullptr);
+  std::future<bool> movePTPAsync(const geometry_msgs::Pose& pose);
+  std::future<bool> movePTPArmangleAsync(const geometry_msgs::Pose& pose, double arm_angle);
+  std::future<bool> moveLinAsync(const geometry_msgs::Pose& pose);
+  std::future<bool> moveLinArmangleAsync(const geometry_msgs::Pose& pose, double arm_angle, bool direction);
+  std::future<bool> moveJointsAsync(const std::vector<double>& joint_values);
+
+  std::future<bool> getCurrentPoseAsync(geometry_msgs::Pose* pose);
+  std::future<bool> getCurrentJointValuesAsync(std::vector<double>* joint_values);
+
+  std::future<bool> pickPlaceAsync(const geometry_msgs::Pose& pose_approach, const geometry_msgs::Pose& pose_grip,
+                                   const geometry_msgs::Pose& pose_retreat, bool gripper_close,
+                                   const std::string& grasp_object);
+
+protected:
+  // (re)connects on the first call and after the move interface restarted, only used from one worker at a time
+  template <class SrvMsg>
+  bool callPersistentService(const std::string& srv_name, ros::ServiceClient* srv_client, SrvMsg* srv_data);
+
+  ros::ServiceClient move_joints_persistent_;
+  ros::ServiceClient move_ptp_persistent_;
+  ros::ServiceClient move_lin_persistent_;
+  ros::ServiceClient move_ptp_armangle_persistent_;
+  ros::ServiceClient move_lin_armangle_persistent_;
+  ros::ServiceClient move_random_persistent_;
+  ros::ServiceClient pick_place_persistent_;
+  ros::ServiceClient get_joint_values_persistent_;
+  ros::ServiceClient get_pose_persistent_;
+
+  // declared last, so that the workers are joined before the service clients are destroyed
+  RLLServiceCallQueue motion_queue_;
+  RLLServiceCallQueue query_queue_;
+};
+
+template <class SrvMsg>
+bool RLLAsyncMoveClient::callPersistentService(const std::string& srv_name, ros::ServiceClient* srv_client,
+                                               SrvMsg* srv_data)
+{
+  if (!srv_client->isValid())
+  {
+    *srv_client = nh_.serviceClient<SrvMsg>(srv_name, true);
+  }
+
+  return callServiceWithErrorCode(srv_name, *srv_client, *srv_data);
+}
+
+#endif  // RLL_MOVE_CLIENT_ASYNC_MOVE_CLIENT_H
@@ -20,6 +20,7 @@
 #ifndef RLL_MOVE_CLIENT_MOVE_CLIENT_DEFAULT_H
 #define RLL_MOVE_CLIENT_MOVE_CLIENT_DEFAULT_H
 
+#include <rll_move_client/async_move_client.h>
 #include <rll_move_client/move_client.h>
 #include <rll_move_client/move_client_listener.h>
 
@@ -35,6 +36,13 @@ public:
   explicit RLLDefaultPickPlaceMoveClient() = default;
 };
 
+// blocking and non-blocking calls, e.g. to query the current pose while a motion is executed
+class RLLDefaultAsyncMoveClient : public RLLDefaultPickPlaceMoveClient, public RLLAsyncMoveClient
+{
+public:
+  explicit RLLDefaultAsyncMoveClient() = default;
+};
+
 // if you do not want to derive from RLLMoveClientListener, you can use this template class
 // and specify a callback function which will be passed a MoveClient instance
 template <class Client>
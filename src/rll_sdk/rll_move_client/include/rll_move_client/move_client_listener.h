@@ -21,6 +21,10 @@
 #ifndef RLL_MOVE_CLIENT_MOVE_CLIENT_LISTENER_H
 #define RLL_MOVE_CLIENT_MOVE_CLIENT_LISTENER_H
 
+#include <cstdint>
+#include <deque>
+
+#include <rll_move/client_channel.h>
 #include <rll_move_client/move_client.h>
 
 class RLLMoveClientListener : public virtual RLLMoveClientBase
@@ -35,11 +39,16 @@ protected:
   bool virtual execute() = 0;
 
 private:
+  static const size_t MAX_CONNECTIONS = 4;
+
   bool is_job_running_ = false;
   int socket_;
   ros::ServiceClient job_finished_;
+  // started jobs are acknowledged right away and executed in the order they were received
+  std::deque<uint32_t> job_queue_;
 
   void executeCallback();
+  void handleMessage(int socket, const RLLClientMessage& msg);
 };
 
 #endif  // RLL_MOVE_CLIENT_MOVE_CLIENT_LISTENER_H
@@ -0,0 +1,198 @@
+/*
+ * This file is part of the Robot Learning Lab Move Client
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <rll_move_client/async_move_client.h>
+
+RLLServiceCallQueue::RLLServiceCallQueue() : worker_(&RLLServiceCallQueue::run, this)
+{
+}
+
+RLLServiceCallQueue::~RLLServiceCallQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  pushed_.notify_one();
+  worker_.join();
+}
+
+std::future<bool> RLLServiceCallQueue::push(std::function<bool()> call)
+{
+  std::packaged_task<bool()> task(std::move(call));
+  std::future<bool> result = task.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    calls_.push_back(std::move(task));
+  }
+  pushed_.notify_one();
+  return result;
+}
+
+void RLLServiceCallQueue::run()
+{
+  while (true)
+  {
+    std::packaged_task<bool()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      pushed_.wait(lock, [this] { return stop_ || !calls_.empty(); });
+      if (calls_.empty())
+      {
+        return;
+      }
+      task = std::move(calls_.front());
+      calls_.pop_front();
+    }
+
+    // exceptions are stored in the future
+    task();
+  }
+}
+
+std::future<bool> RLLAsyncMoveClient::moveRandomAsync(geometry_msgs::Pose* const result_pose)
+{
+  return motion_queue_.push([this, result_pose] {
+    rll_msgs::MoveRandom move_random_msg;
+    bool success =
+        callPersistentService(RLLMoveIfaceServices::MOVE_RANDOM_SRV_NAME, &move_random_persistent_, &move_random_msg);
+    if (success && result_pose != nullptr)
+    {
+      *result_pose = move_random_msg.response.pose;
+    }
+    return success;
+  });
+}
+
+std::future<bool> RLLAsyncMoveClient::movePTPAsync(const geometry_msgs::Pose& pose)
+{
+  rll_msgs::MovePTP move_ptp_msg;
+  move_ptp_msg.request.pose = pose;
+
+  return motion_queue_.push([this, move_ptp_msg]() mutable {
+    return callPersistentService(RLLMoveIfaceServices::MOVE_PTP_SRV_NAME, &move_ptp_persistent_, &move_ptp_msg);
+  });
+}
+
+std::future<bool> RLLAsyncMoveClient::movePTPArmangleAsync(const geometry_msgs::Pose& pose, double arm_angle)
+{
+  rll_msgs::MovePTPArmangle move_ptp_msg;
+  move_ptp_msg.request.pose = pose;
+  move_ptp_msg.request.arm_angle = arm_angle;
+
+  return motion_queue_.push([this, move_ptp_msg]() mutable {
+    return callPersistentService(RLLMoveIfaceServices::MOVE_PTP_ARMANGLE_SRV_NAME, &move_ptp_armangle_persistent_,
+                                 &move_ptp_msg);
+  });
+}
+
+std::future<bool> RLLAsyncMoveClient::moveLinAsync(const geometry_msgs::Pose& pose)
+{
+  rll_msgs::MoveLin move_lin_msg;
+  move_lin_msg.request.pose = pose;
+
+  return motion_queue_.push([this, move_lin_msg]() mutable {
+    return callPersistentService(RLLMoveIfaceServices::MOVE_LIN_SRV_NAME, &move_lin_persistent_, &move_lin_msg);
+  });
+}
+
+std::future<bool> RLLAsyncMoveClient::moveLinArmangleAsync(const geometry_msgs::Pose& pose, double arm_angle,
+                                                           bool direction)
+{
+  rll_msgs::MoveLinArmangle move_lin_msg;
+  move_lin_msg.request.pose = pose;
+  move_lin_msg.request.arm_angle = arm_angle;
+  move_lin_msg.request.direction = static_cast<unsigned char>(direction);
+
+  return motion_queue_.push([this, move_lin_msg]() mutable {
+    return callPersistentService(RLLMoveIfaceServices::MOVE_LIN_ARMANGLE_SRV_NAME, &move_lin_armangle_persistent_,
+                                 &move_lin_msg);
+  });
+}
+
+std::future<bool> RLLAsyncMoveClient::moveJointsAsync(const std::vector<double>& joint_values)
+{
+  if (joint_values.size() < RLL_NUM_JOINTS)
+  {
+    ROS_WARN("You need to pass seven joint values");
+    std::promise<bool> failed;
+    failed.set_value(false);
+    return failed.get_future();
+  }
+
+  rll_msgs::MoveJoints move_joints_msg;
+  move_joints_msg.request.joint_1 = joint_values[0];
+  move_joints_msg.request.joint_2 = joint_values[1];
+  move_joints_msg.request.joint_3 = joint_values[2];
+  move_joints_msg.request.joint_4 = joint_values[3];
+  move_joints_msg.request.joint_5 = joint_values[4];
+  move_joints_msg.request.joint_6 = joint_values[5];
+  move_joints_msg.request.joint_7 = joint_values[6];
+
+  return motion_queue_.push([this, move_joints_msg]() mutable {
+    return callPersistentService(RLLMoveIfaceServices::MOVE_JOINTS_SRV_NAME, &move_joints_persistent_,
+                                 &move_joints_msg);
+  });
+}
+
+std::future<bool> RLLAsyncMoveClient::getCurrentPoseAsync(geometry_msgs::Pose* const pose)
+{
+  return query_queue_.push([this, pose] {
+    rll_msgs::GetPose get_pose_msg;
+    bool success = callPersistentService(RLLMoveIfaceServices::GET_POSE_SRV_NAME, &get_pose_persistent_, &get_pose_msg);
+    if (success)
+    {
+      *pose = get_pose_msg.response.pose;
+    }
+    return success;
+  });
+}
+
+std::future<bool> RLLAsyncMoveClient::getCurrentJointValuesAsync(std::vector<double>* const joint_values)
+{
+  return query_queue_.push([this, joint_values] {
+    rll_msgs::GetJointValues get_joint_values_msg;
+    bool success = callPersistentService(RLLMoveIfaceServices::GET_JOINT_VALUES_SRV_NAME,
+                                         &get_joint_values_persistent_, &get_joint_values_msg);
+    if (success)
+    {
+      *joint_values = { get_joint_values_msg.response.joint_1, get_joint_values_msg.response.joint_2,
+                        get_joint_values_msg.response.joint_3, get_joint_values_msg.response.joint_4,
+                        get_joint_values_msg.response.joint_5, get_joint_values_msg.response.joint_6,
+                        get_joint_values_msg.response.joint_7 };
+    }
+    return success;
+  });
+}
+
+std::future<bool> RLLAsyncMoveClient::pickPlaceAsync(const geometry_msgs::Pose& pose_approach,
+                                                     const geometry_msgs::Pose& pose_grip,
+                                                     const geometry_msgs::Pose& pose_retreat, bool gripper_close,
+                                                     const std::string& grasp_object)
+{
+  rll_msgs::PickPlace pick_place_msg;
+  pick_place_msg.request.pose_approach = pose_approach;
+  pick_place_msg.request.pose_grip = pose_grip;
+  pick_place_msg.request.pose_retreat = pose_retreat;
+  pick_place_msg.request.gripper_close = gripper_close ? 1u : 0u;
+  pick_place_msg.request.grasp_object = grasp_object;
+
+  return motion_queue_.push([this, pick_place_msg]() mutable {
+    return callPersistentService(RLLMoveIfaceGripperServices::PICK_PLACE_SRV_NAME, &pick_place_persistent_,
+                                 &pick_place_msg);
+  });
+}
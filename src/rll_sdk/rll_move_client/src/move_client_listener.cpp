@@ -19,8 +19,14 @@
  */
 
 #include <arpa/inet.h>
+#include <poll.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
+#include <cerrno>
+#include <vector>
+
+#include <rll_move/client_channel.h>
 #include <rll_move/move_iface_base.h>
 #include <rll_move_client/move_client_listener.h>
 
@@ -36,19 +42,9 @@ RLLMoveClientListener::RLLMoveClientListener()
   }
 
   // set a timeout of 2s for reading and writing
-  struct timeval timeout;
-  timeout.tv_sec = 2;
-  timeout.tv_usec = 0;
-
-  if (setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<char*>(&timeout), sizeof(timeout)) < 0)
+  if (!setClientSocketTimeouts(socket_, 2))
   {
-    ROS_ERROR("setsockopt for receive timeout failed");
-    return;
-  }
-
-  if (setsockopt(socket_, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<char*>(&timeout), sizeof(timeout)) < 0)
-  {
-    ROS_ERROR("setsockopt for send timeout failed");
+    ROS_ERROR("setsockopt for the socket timeouts failed");
     return;
   }
 
@@ -66,8 +62,8 @@ RLLMoveClientListener::RLLMoveClientListener()
     return;
   }
 
-  // only allow one connection
-  if (listen(socket_, 1) < 0)
+  // the interface keeps its connection open, allow a few more, e.g. while it reconnects
+  if (listen(socket_, MAX_CONNECTIONS) < 0)
   {
     ROS_ERROR("failed to init socket listener");
   }
@@ -132,36 +128,111 @@ void RLLMoveClientListener::notifyJobFinished(bool success)
 
 void RLLMoveClientListener::spin()
 {
-  int tmp_socket;
-  struct sockaddr_in conn_addr;
-  socklen_t conn_len;
-  char recv_msg[RLLMoveIfaceBase::CLIENT_SERVER_BUFFER_SIZE];
-  memset(recv_msg, 0, RLLMoveIfaceBase::CLIENT_SERVER_BUFFER_SIZE * sizeof(char));
+  struct Connection
+  {
+    int socket;
+    RLLClientMessageReader reader;
+  };
+  std::vector<Connection> connections;
+  std::vector<struct pollfd> fds;
+  char data[RLLClientMessage::MAX_LINE_LENGTH];
 
   while (ros::ok())
   {
-    tmp_socket = accept(socket_, reinterpret_cast<struct sockaddr*>(&conn_addr), &conn_len);
-    if (tmp_socket < 0)
+    fds.assign(1, { socket_, POLLIN, 0 });
+    for (const auto& connection : connections)
+    {
+      fds.push_back({ connection.socket, POLLIN, 0 });
+    }
+
+    // wake up regularly to check if ROS is still ok, don't wait if jobs are queued
+    if (poll(fds.data(), fds.size(), job_queue_.empty() ? 100 : 0) < 0)
     {
       continue;
     }
 
-    ROS_INFO("got a connection from addr %s and port %d", inet_ntoa(conn_addr.sin_addr), ntohs(conn_addr.sin_port));
+    for (size_t i = connections.size(); i > 0; --i)
+    {
+      if (fds[i].revents == 0)
+      {
+        continue;
+      }
+
+      Connection& connection = connections[i - 1];
+      ssize_t received = recv(connection.socket, data, sizeof(data), MSG_DONTWAIT);
+      if (received <= 0)
+      {
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        {
+          continue;
+        }
+
+        ROS_INFO("connection closed");
+        close(connection.socket);
+        connections.erase(connections.begin() + (i - 1));
+        continue;
+      }
+
+      connection.reader.append(data, static_cast<size_t>(received));
+      RLLClientMessage msg;
+      while (connection.reader.next(&msg))
+      {
+        handleMessage(connection.socket, msg);
+      }
+    }
 
-    recv(tmp_socket, recv_msg, RLLMoveIfaceBase::CLIENT_SERVER_BUFFER_SIZE, 0);
-    if (strcmp(recv_msg, RLLMoveIfaceBase::CLIENT_SERVER_START_CMD_) == 0)
+    if ((fds[0].revents & POLLIN) != 0)
     {
-      ROS_INFO("received start signal");
-      send(tmp_socket, RLLMoveIfaceBase::CLIENT_SERVER_OK_RESP_, strlen(RLLMoveIfaceBase::CLIENT_SERVER_OK_RESP_), 0);
-      executeCallback();
+      struct sockaddr_in conn_addr;
+      socklen_t conn_len = sizeof(conn_addr);
+      int conn_socket = accept(socket_, reinterpret_cast<struct sockaddr*>(&conn_addr), &conn_len);
+      if (conn_socket >= 0 && connections.size() >= MAX_CONNECTIONS)
+      {
+        ROS_WARN("too many connections, rejecting connection from addr %s", inet_ntoa(conn_addr.sin_addr));
+        close(conn_socket);
+      }
+      else if (conn_socket >= 0)
+      {
+        ROS_INFO("got a connection from addr %s and port %d", inet_ntoa(conn_addr.sin_addr),
+                 ntohs(conn_addr.sin_port));
+        setClientSocketTimeouts(conn_socket, 2);
+        connections.push_back({ conn_socket, RLLClientMessageReader() });
+      }
     }
-    else
+
+    if (!job_queue_.empty())
     {
-      ROS_ERROR("error receiving start signal");
-      send(tmp_socket, RLLMoveIfaceBase::CLIENT_SERVER_ERROR_RESP_, strlen(RLLMoveIfaceBase::CLIENT_SERVER_ERROR_RESP_),
-           0);
+      uint32_t job_id = job_queue_.front();
+      job_queue_.pop_front();
+      ROS_INFO("running job %u", job_id);
+      executeCallback();
     }
+  }
+
+  for (const auto& connection : connections)
+  {
+    close(connection.socket);
+  }
+}
+
+void RLLMoveClientListener::handleMessage(int socket, const RLLClientMessage& msg)
+{
+  RLLClientMessage response;
+  response.job_id = msg.job_id;
+  if (msg.command == RLLClientMessage::START_CMD)
+  {
+    ROS_INFO("received start signal for job %u", msg.job_id);
+    response.command = RLLClientMessage::OK_RESP;
+    job_queue_.push_back(msg.job_id);
+  }
+  else
+  {
+    ROS_ERROR("error receiving start signal");
+    response.command = RLLClientMessage::ERROR_RESP;
+  }
 
-    close(tmp_socket);
+  if (!sendClientMessage(socket, response))
+  {
+    ROS_ERROR("failed to respond to job %u", msg.job_id);
   }
 }
@@ -19,8 +19,10 @@
 # along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #
 import re
+import select
 import socket
 import traceback
+from collections import deque
 from math import pi
 from typing import Union, Sequence, List  # pylint: disable=unused-import
 
@@ -136,6 +138,13 @@ class RLLMoveClientBase(object):
 
 class RLLMoveClientListener(object):
     JOB_FINISHED_SRV_NAME = "job_finished"
+    # the interface keeps one connection open across jobs and sends
+    # "<command> <job id>\n" lines, see rll_move/client_channel.h
+    START_CMD = b"start"
+    OK_RESP = b"ok"
+    ERROR_RESP = b"error"
+    MAX_LINE_LENGTH = 64
+    MAX_CONNECTIONS = 4
 
     def __init__(self, execute_func=None, tcp_port=5005):
         self.execute_func = execute_func
@@ -161,8 +170,9 @@ class RLLMoveClientListener(object):
         self.sock.settimeout(2.0)
         # listen on all interfaces
         self.sock.bind(('', tcp_port))
-        # only allow one connection
-        self.sock.listen(1)
+        # the interface keeps its connection open, allow a few more,
+        # e.g. while it reconnects
+        self.sock.listen(self.MAX_CONNECTIONS)
 
         rospy.loginfo("Socket listener started")
 
@@ -241,45 +251,100 @@ class RLLMoveClientListener(object):
             rospy.logwarn("Client code interrupted during a job run!")
             self.notify_job_finished(False)
 
-    def spin(self, oneshot=False):  # noqa: C901
+    def _handle_message(self, conn, line, job_queue):
+        parts = line.split(b" ")
+        if len(parts) != 2 or not parts[1].isdigit():
+            rospy.logerr("received malformed message in listener spinner")
+            return
+
+        command, job_id = parts
+        if command == self.START_CMD:
+            rospy.loginfo("received start signal for job %s", job_id)
+            job_queue.append(int(job_id))
+            response = self.OK_RESP
+        else:
+            rospy.logerr("error receiving start signal")
+            response = self.ERROR_RESP
+
+        try:
+            conn.sendall(response + b" " + job_id + b"\n")
+        except socket.error as err:
+            rospy.logerr("socket error %s", err)
+
+    def _receive(self, conn, connections, job_queue):
+        try:
+            data = conn.recv(self.MAX_LINE_LENGTH)
+        except socket.error as err:
+            rospy.loginfo("socket error %s", err)
+            data = None
+
+        if not data:
+            rospy.loginfo("connection closed")
+            conn.close()
+            del connections[conn]
+            return
+
+        buf = connections[conn] + data
+        lines = buf.split(b"\n")
+        # the last element is an incomplete line
+        connections[conn] = lines.pop()
+        if len(connections[conn]) > self.MAX_LINE_LENGTH:
+            connections[conn] = b""
+
+        for line in lines:
+            self._handle_message(conn, line, job_queue)
+
+    def spin(self, oneshot=False):
         # type: (bool) -> bool
 
-        buffer_size = 10
         last_result = False
+        # open connections and their partially received lines
+        connections = {}
+        # started jobs are acknowledged right away and run in order
+        job_queue = deque()
 
         rospy.on_shutdown(self._on_ros_shutdown)
 
         while not rospy.is_shutdown():
+            # wake up regularly to check for a shutdown
+            timeout = 0 if job_queue else 0.1
             try:
-                conn, addr = self.sock.accept()
-            except socket.timeout:
-                continue
-            except socket.error as err:
+                readable, _, _ = select.select(
+                    [self.sock] + list(connections), [], [], timeout)
+            except (select.error, socket.error) as err:
                 rospy.loginfo("socket error %s", err)
                 continue
 
-            rospy.loginfo("got a connection from addr %s", addr)
-
-            try:
-                data = conn.recv(buffer_size)  # pylint: disable=no-member
-            except socket.error as err:
-                rospy.logerr("socket error %s", err)
-                continue
-
-            if not data:
-                rospy.logerr("did not receive any data in listener spinner")
-                continue
-
-            if data == b"start":
-                rospy.loginfo("received start signal")
-                conn.send(b'ok')  # pylint: disable=no-member
+            for conn in readable:
+                if conn is not self.sock:
+                    self._receive(conn, connections, job_queue)
+                    continue
+
+                try:
+                    conn, addr = self.sock.accept()
+                except socket.error as err:
+                    rospy.loginfo("socket error %s", err)
+                    continue
+
+                if len(connections) >= self.MAX_CONNECTIONS:
+                    rospy.logwarn("too many connections, rejecting "
+                                  "connection from addr %s", addr)
+                    conn.close()
+                    continue
+
+                rospy.loginfo("got a connection from addr %s", addr)
+                conn.settimeout(2.0)
+                connections[conn] = b""
+
+            if job_queue:
+                rospy.loginfo("running job %d", job_queue.popleft())
                 last_result = self.__execute()
 
                 if oneshot:
                     break
-            else:
-                rospy.logerr("error receiving start signal")
-                conn.send(b'error')  # pylint: disable=no-member
+
+        for conn in connections:
+            conn.close()
 
         try:
             self.sock.close()